@@ -22,7 +22,7 @@
     //Add a custom read-only cache path
     NSString *bundledPath = [[NSBundle mainBundle].resourcePath stringByAppendingPathComponent:@"CustomPathImages"];
     [TXImageCache sharedImageCache].additionalCachePathBlock = ^NSString * _Nullable(NSString * _Nonnull key) {
-        NSString *fileName = [[TXImageCache sharedImageCache] cachePathForKey:key].lastPathComponent;
+        NSString *fileName = TXDiskCacheLegacyFileNameForKey(key);
         return [bundledPath stringByAppendingPathComponent:fileName.stringByDeletingPathExtension];
     };
     
@@ -274,6 +274,17 @@ static CGFloat SDImageScaleFromPath(NSString *string) {
     return [self.animatedCoder animatedImageDurationAtIndex:index];
 }
 
+- (BOOL)animatedImageFrameThreadSafe {
+    if (self.isAllFramesLoaded) {
+        return YES;
+    }
+    id<TXAnimatedImageCoder> animatedCoder = self.animatedCoder;
+    if ([animatedCoder respondsToSelector:@selector(animatedImageFrameThreadSafe)]) {
+        return animatedCoder.animatedImageFrameThreadSafe;
+    }
+    return NO;
+}
+
 @end
 
 @implementation TXAnimatedImage (MemoryCacheCost)
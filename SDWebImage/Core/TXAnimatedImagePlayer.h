@@ -60,13 +60,37 @@ typedef NS_ENUM(NSUInteger, TXAnimatedImagePlaybackMode) {
 @property (nonatomic, assign) TXAnimatedImagePlaybackMode playbackMode;
 
 /// Provide a max buffer size by bytes. This is used to adjust frame buffer count and can be useful when the decoding cost is expensive (such as Animated WebP software decoding). Default is 0.
-/// `0` means automatically adjust by calculating current memory usage.
+/// `0` means share the process-wide budget `totalMaxBufferSize` with the other players.
 /// `1` means without any buffer cache, each of frames will be decoded and then be freed after rendering. (Lowest Memory and Highest CPU)
 /// `NSUIntegerMax` means cache all the buffer. (Lowest CPU and Highest Memory)
 @property (nonatomic, assign) NSUInteger maxBufferSize;
 
+/// The max buffer size by bytes shared by all the players which `maxBufferSize` is 0. Default is 0.
+/// `0` means automatically adjust by calculating current memory usage.
+/// The budget is allocated across the players by visibility and frame rate. Each player gets at least one frame, the playing and visible player with higher frame rate gets more, and the player never gets more than its total frames.
+/// @note The player which specify its own `maxBufferSize` still takes up this budget.
+@property (nonatomic, class, assign) NSUInteger totalMaxBufferSize;
+
+/// Whether or not to store the buffered frames as 8-bit color indices plus palette, and only expand to BGRA8888 bitmap for the frame about to be displayed. Default is NO.
+/// This is useful for palette based format like GIF/APNG, which cost about 1/4 memory compared to the decoded bitmap, so more frames (or the whole animation) can fit in the frame buffer.
+/// @note The frame which contains more than 256 colors is still buffered as decoded bitmap.
+@property (nonatomic, assign) BOOL shouldUseIndexedFrameBuffer;
+
+/// The bytes cost for one buffered frame, which is used to calculate the frame buffer count from `maxBufferSize`.
+/// When `shouldUseIndexedFrameBuffer` is YES, this is the max bytes of the frames buffered so far. Otherwise this is the decoded bitmap bytes of current frame.
+@property (nonatomic, assign, readonly) NSUInteger bytesPerFrame;
+
+/// The count of upcoming frames to decode ahead of displaying, following the `playbackMode` direction. Default is 0.
+/// `0` means automatically adjust by comparing the measured frame decoding time with the frame duration.
+/// @note If the provider's `animatedImageFrameThreadSafe` is YES, these frames are decoded in parallel. The count is also limited by the frame buffer count.
+@property (nonatomic, assign) NSUInteger prefetchFrameCount;
+
+/// The count of buffer miss, which means the frame is not decoded yet when it should be displayed, and the animation stutters. This value is reset when stop playing.
+@property (nonatomic, assign, readonly) NSUInteger bufferMissCount;
+
 /// You can specify a runloop mode to let it rendering.
 /// Default is NSRunLoopCommonModes on multi-core device, NSDefaultRunLoopMode on single-core device
+/// @note All the players using the same runloop mode are driven by one shared display link, which only wakes up when the earliest frame of these players is due.
 @property (nonatomic, copy, nonnull) NSRunLoopMode runLoopMode;
 
 /// Create a player with animated image provider. If the provider's `animatedImageFrameCount` is less than 1, returns nil.
@@ -87,6 +111,10 @@ typedef NS_ENUM(NSUInteger, TXAnimatedImagePlaybackMode) {
 /// The handler block when one loop count finished.
 @property (nonatomic, copy, nullable) void (^animationLoopHandler)(NSUInteger loopCount);
 
+/// The handler block to check whether the rendering target is visible, called on main thread before rendering the frame. Default is nil, which means always visible.
+/// When it returns NO, the player skip this frame without decoding, the animation time does not elapse, and it will be checked again with a low rate. This is useful for the offscreen view which is still in the window, like the scrolled out one.
+@property (nonatomic, copy, nullable) BOOL (^animationVisibilityHandler)(void);
+
 /// Return the status whether animation is playing.
 @property (nonatomic, readonly) BOOL isPlaying;
 
@@ -8,27 +8,59 @@
 
 #import "TXAnimatedImagePlayer.h"
 #import "NSImage+Compatibility.h"
-#import "TXDisplayLink.h"
-#import "TXDeviceHelper.h"
+#import "TXSharedDisplayLink.h"
+#import "TXAnimatedFrameBudgetManager.h"
+#import "TXAnimatedFrameDecodePool.h"
 #import "TXInternalMacros.h"
+#import "TXIndexedImageFrame.h"
+#import "TXAnimatedFrameRingBuffer.h"
+#import <stdatomic.h>
 
-@interface TXAnimatedImagePlayer () {
+// The max prefetch frame count when `prefetchFrameCount` is 0
+static const NSUInteger kSDAnimatedImageMaxAutoPrefetchFrameCount = 8;
+
+// Returns the frame index after the specify one, following the playback mode. `shouldReverse` is the bounce direction, which is updated in place.
+static inline NSUInteger SDAnimatedImageNextFrameIndex(NSUInteger index, NSUInteger totalFrameCount, TXAnimatedImagePlaybackMode playbackMode, BOOL *shouldReverse) {
+    switch (playbackMode) {
+        case TXAnimatedImagePlaybackModeReverse:
+            return index == 0 ? (totalFrameCount - 1) : (index - 1) % totalFrameCount;
+        case TXAnimatedImagePlaybackModeBounce:
+        case TXAnimatedImagePlaybackModeReversedBounce:
+            if (index == 0) {
+                *shouldReverse = NO;
+            } else if (index == totalFrameCount - 1) {
+                *shouldReverse = YES;
+            }
+            return (*shouldReverse ? (index - 1) : (index + 1)) % totalFrameCount;
+        default:
+            return (index + 1) % totalFrameCount;
+    }
+}
+
+@interface TXAnimatedImagePlayer () <TXSharedDisplayLinkTarget, TXAnimatedFrameBudgetClient> {
     SD_LOCK_DECLARE(_lock);
     NSRunLoopMode _runLoopMode;
+    _Atomic(BOOL) _playing; // Read by decoding thread
+    BOOL _visible;
+    NSTimeInterval _loopDuration;
+    NSUInteger _loopDurationFrameCount; // The frame count when `_loopDuration` is calculated
+    NSUInteger _bufferedBytesPerFrame;
+    _Atomic(NSUInteger) _decodeMicroseconds; // Moving average of frame decoding time
 }
 
 @property (nonatomic, strong, readwrite) UIImage *currentFrame;
 @property (nonatomic, assign, readwrite) NSUInteger currentFrameIndex;
 @property (nonatomic, assign, readwrite) NSUInteger currentLoopCount;
+@property (nonatomic, assign, readwrite) NSUInteger bufferMissCount;
 @property (nonatomic, strong) id<TXAnimatedImageProvider> animatedProvider;
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, UIImage *> *frameBuffer;
+@property (nonatomic, strong) TXAnimatedFrameRingBuffer *frameBuffer; // `UIImage` or `TXIndexedImageFrame`, only touched on display thread
 @property (nonatomic, assign) NSTimeInterval currentTime;
 @property (nonatomic, assign) BOOL bufferMiss;
 @property (nonatomic, assign) BOOL needsDisplayWhenImageBecomesAvailable;
 @property (nonatomic, assign) BOOL shouldReverse;
 @property (nonatomic, assign) NSUInteger maxBufferCount;
-@property (nonatomic, strong) NSOperationQueue *fetchQueue;
-@property (nonatomic, strong) TXDisplayLink *displayLink;
+@property (nonatomic, strong) TXAnimatedFrameDecodeQueue *fetchQueue;
+@property (nonatomic, strong) TXIndexedImageFrameBufferPool *indexedFrameBufferPool; // reuse the bitmap of the expanded indexed frames
 
 @end
 
@@ -48,6 +80,9 @@
         self.animatedProvider = provider;
         self.playbackRate = 1.0;
         SD_LOCK_INIT(_lock);
+        atomic_init(&_decodeMicroseconds, 0);
+        atomic_init(&_playing, NO);
+        _visible = YES;
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
@@ -69,59 +104,63 @@
 }
 
 - (void)didReceiveMemoryWarning:(NSNotification *)notification {
-    [_fetchQueue cancelAllOperations];
-    [_fetchQueue addOperationWithBlock:^{
-        NSNumber *currentFrameIndex = @(self.currentFrameIndex);
-        SD_LOCK(self->_lock);
-        NSArray *keys = self.frameBuffer.allKeys;
-        // only keep the next frame for later rendering
-        for (NSNumber * key in keys) {
-            if (![key isEqualToNumber:currentFrameIndex]) {
-                [self.frameBuffer removeObjectForKey:key];
-            }
-        }
-        SD_UNLOCK(self->_lock);
-    }];
+    [_fetchQueue cancelAllTasks];
+    // The notification is posted on main thread, which is the same as display thread
+    // only keep the current frame for later rendering
+    [_frameBuffer removeAllFramesExceptIndex:self.currentFrameIndex];
 }
 
 #pragma mark - Private
-- (NSOperationQueue *)fetchQueue {
+- (TXAnimatedFrameDecodeQueue *)fetchQueue {
     if (!_fetchQueue) {
-        _fetchQueue = [[NSOperationQueue alloc] init];
-        _fetchQueue.maxConcurrentOperationCount = 1;
+        // All the players share the decoding workers, which are scheduled in round-robin order
+        _fetchQueue = [[TXAnimatedFrameDecodeQueue alloc] initWithPool:TXAnimatedFrameDecodePool.sharedPool];
+        _fetchQueue.maxConcurrentCount = self.maxConcurrentFetchCount;
     }
     return _fetchQueue;
 }
 
-- (NSMutableDictionary<NSNumber *,UIImage *> *)frameBuffer {
+- (NSUInteger)maxConcurrentFetchCount {
+    id<TXAnimatedImageProvider> animatedProvider = self.animatedProvider;
+    if (![animatedProvider respondsToSelector:@selector(animatedImageFrameThreadSafe)] || !animatedProvider.animatedImageFrameThreadSafe) {
+        // Decode one by one
+        return 1;
+    }
+    NSUInteger count = self.prefetchFrameCount > 0 ? self.prefetchFrameCount : kSDAnimatedImageMaxAutoPrefetchFrameCount;
+    return MAX(MIN(count, [NSProcessInfo processInfo].activeProcessorCount), 1);
+}
+
+- (void)setPrefetchFrameCount:(NSUInteger)prefetchFrameCount {
+    _prefetchFrameCount = prefetchFrameCount;
+    _fetchQueue.maxConcurrentCount = self.maxConcurrentFetchCount;
+}
+
+- (TXAnimatedFrameRingBuffer *)frameBuffer {
     if (!_frameBuffer) {
-        _frameBuffer = [NSMutableDictionary dictionary];
+        // Before calculating the max buffer count, use the frame count, it will be resized during `startPlaying`
+        NSUInteger capacity = self.maxBufferCount > 0 ? MIN(self.maxBufferCount, self.totalFrameCount) : self.totalFrameCount;
+        _frameBuffer = [[TXAnimatedFrameRingBuffer alloc] initWithCapacity:capacity];
     }
     return _frameBuffer;
 }
 
-- (TXDisplayLink *)displayLink {
-    if (!_displayLink) {
-        _displayLink = [TXDisplayLink displayLinkWithTarget:self selector:@selector(displayDidRefresh:)];
-        [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:self.runLoopMode];
-        [_displayLink stop];
-    }
-    return _displayLink;
+- (TXSharedDisplayLink *)displayLink {
+    // All the players on the same runloop mode share one display link
+    return [TXSharedDisplayLink sharedDisplayLinkForRunLoopMode:self.runLoopMode];
 }
 
 - (void)setRunLoopMode:(NSRunLoopMode)runLoopMode {
     if ([_runLoopMode isEqual:runLoopMode]) {
         return;
     }
-    if (_displayLink) {
-        if (_runLoopMode) {
-            [_displayLink removeFromRunLoop:[NSRunLoop mainRunLoop] forMode:_runLoopMode];
-        }
-        if (runLoopMode.length > 0) {
-            [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:runLoopMode];
-        }
+    BOOL isPlaying = self.isPlaying;
+    if (isPlaying && _runLoopMode) {
+        [self.displayLink removeTarget:self];
     }
     _runLoopMode = [runLoopMode copy];
+    if (isPlaying && runLoopMode.length > 0) {
+        [self.displayLink addTarget:self];
+    }
 }
 
 - (NSRunLoopMode)runLoopMode {
@@ -152,9 +191,7 @@
         #endif
         if (posterFrame) {
             self.currentFrame = posterFrame;
-            SD_LOCK(self->_lock);
-            self.frameBuffer[@(self.currentFrameIndex)] = self.currentFrame;
-            SD_UNLOCK(self->_lock);
+            [self.frameBuffer setFrame:self.currentFrame atIndex:self.currentFrameIndex];
             [self handleFrameChange];
         }
     }
@@ -168,18 +205,21 @@
     _currentLoopCount = 0;
     _currentTime = 0;
     _bufferMiss = NO;
+    _bufferMissCount = 0;
     _needsDisplayWhenImageBecomesAvailable = NO;
 }
 
 - (void)clearFrameBuffer {
+    [_frameBuffer removeAllFrames];
     SD_LOCK(_lock);
-    [_frameBuffer removeAllObjects];
+    _bufferedBytesPerFrame = 0;
     SD_UNLOCK(_lock);
 }
 
 #pragma mark - Animation Control
 - (void)startPlaying {
-    [self.displayLink start];
+    atomic_store_explicit(&_playing, YES, memory_order_relaxed);
+    [self.displayLink addTarget:self];
     // Setup frame
     [self setupCurrentFrame];
     // Calculate max buffer size
@@ -187,20 +227,31 @@
 }
 
 - (void)stopPlaying {
-    [_fetchQueue cancelAllOperations];
-    // Using `_displayLink` here because when UIImageView dealloc, it may trigger `[self stopAnimating]`, we already release the display link in TXAnimatedImageView's dealloc method.
-    [_displayLink stop];
+    [_fetchQueue cancelAllTasks];
+    // The cancelled tasks never run, release their reservations
+    [_frameBuffer cancelPendingFrames];
+    [self stopDisplayLink];
     // We need to reset the frame status, but not trigger any handle. This can ensure next time's playing status correct.
     [self resetCurrentFrameStatus];
 }
 
 - (void)pausePlaying {
-    [_fetchQueue cancelAllOperations];
-    [_displayLink stop];
+    [_fetchQueue cancelAllTasks];
+    [_frameBuffer cancelPendingFrames];
+    [self stopDisplayLink];
+}
+
+- (void)stopDisplayLink {
+    // When UIImageView dealloc, it may trigger `[self stopAnimating]`, only touch the display link when we are playing.
+    if (atomic_exchange_explicit(&_playing, NO, memory_order_relaxed)) {
+        [self.displayLink removeTarget:self];
+        // Give the frame budget to the playing ones
+        [TXAnimatedFrameBudgetManager.sharedManager setNeedsUpdateClient:self];
+    }
 }
 
 - (BOOL)isPlaying {
-    return _displayLink.isRunning;
+    return atomic_load_explicit(&_playing, memory_order_relaxed);
 }
 
 - (void)seekToFrameAtIndex:(NSUInteger)index loopCount:(NSUInteger)loopCount {
@@ -214,13 +265,40 @@
 }
 
 #pragma mark - Core Render
-- (void)displayDidRefresh:(TXDisplayLink *)displayLink {
+- (NSTimeInterval)sharedDisplayLinkDidRefreshWithDuration:(NSTimeInterval)duration {
     // If for some reason a wild call makes it through when we shouldn't be animating, bail.
     // Early return!
     if (!self.isPlaying) {
-        return;
+        return -1;
+    }
+    
+    [self renderFrameWithDuration:duration];
+    if (!self.isPlaying) {
+        return -1;
     }
     
+    // Wait for the new frame (or the missing frame) at the next refresh, otherwise sleep until current frame duration is reached
+    if (self.needsDisplayWhenImageBecomesAvailable) {
+        return 0;
+    }
+    NSTimeInterval currentDuration = [self.animatedProvider animatedImageDurationAtIndex:self.currentFrameIndex] / self.playbackRate;
+    return MAX(currentDuration - self.currentTime, 0);
+}
+
+- (BOOL)isVisibleForSharedDisplayLink {
+    BOOL (^visibilityHandler)(void) = self.animationVisibilityHandler;
+    BOOL visible = visibilityHandler ? visibilityHandler() : YES;
+    if (visible != _visible) {
+        _visible = visible;
+        // The invisible player gets less frame budget
+        [TXAnimatedFrameBudgetManager.sharedManager setNeedsUpdateClient:self];
+    }
+    return visible;
+}
+
+// This is the per-tick path, it should not take any lock or allocate memory unless a new frame fetch is needed.
+- (void)renderFrameWithDuration:(NSTimeInterval)duration {
+    
     NSUInteger totalFrameCount = self.totalFrameCount;
     if (totalFrameCount <= 1) {
         // Total frame count less than 1, wrong configuration and stop animating
@@ -235,47 +313,27 @@
         return;
     }
     
-    // Calculate refresh duration
-    NSTimeInterval duration = self.displayLink.duration;
-    
     NSUInteger currentFrameIndex = self.currentFrameIndex;
-    NSUInteger nextFrameIndex = (currentFrameIndex + 1) % totalFrameCount;
-    
-    if (self.playbackMode == TXAnimatedImagePlaybackModeReverse) {
-        nextFrameIndex = currentFrameIndex == 0 ? (totalFrameCount - 1) : (currentFrameIndex - 1) % totalFrameCount;
-        
-    } else if (self.playbackMode == TXAnimatedImagePlaybackModeBounce ||
-               self.playbackMode == TXAnimatedImagePlaybackModeReversedBounce) {
-        if (currentFrameIndex == 0) {
-            self.shouldReverse = false;
-        } else if (currentFrameIndex == totalFrameCount - 1) {
-            self.shouldReverse = true;
-        }
-        nextFrameIndex = self.shouldReverse ? (currentFrameIndex - 1) : (currentFrameIndex + 1);
-        nextFrameIndex %= totalFrameCount;
-    }
+    TXAnimatedImagePlaybackMode playbackMode = self.playbackMode;
+    BOOL shouldReverse = self.shouldReverse;
+    NSUInteger nextFrameIndex = SDAnimatedImageNextFrameIndex(currentFrameIndex, totalFrameCount, playbackMode, &shouldReverse);
+    self.shouldReverse = shouldReverse;
     
     
     // Check if we need to display new frame firstly
+    TXAnimatedFrameRingBuffer *frameBuffer = self.frameBuffer;
     BOOL bufferFull = NO;
     if (self.needsDisplayWhenImageBecomesAvailable) {
-        UIImage *currentFrame;
-        SD_LOCK(_lock);
-        currentFrame = self.frameBuffer[@(currentFrameIndex)];
-        SD_UNLOCK(_lock);
+        // Expand the indexed frame only when it's about to be displayed
+        UIImage *currentFrame = [self imageWithBufferedFrame:[frameBuffer frameAtIndex:currentFrameIndex]];
         
         // Update the current frame
         if (currentFrame) {
-            SD_LOCK(_lock);
-            // Remove the frame buffer if need
-            if (self.frameBuffer.count > self.maxBufferCount) {
-                self.frameBuffer[@(currentFrameIndex)] = nil;
-            }
+            // When the buffer capacity is less than frame count, the displayed frame stay in its slot, until the slot is reserved by another frame
             // Check whether we can stop fetch
-            if (self.frameBuffer.count == totalFrameCount) {
+            if (frameBuffer.count == totalFrameCount) {
                 bufferFull = YES;
             }
-            SD_UNLOCK(_lock);
             
             // Update the current frame immediately
             self.currentFrame = currentFrame;
@@ -285,6 +343,9 @@
             self.needsDisplayWhenImageBecomesAvailable = NO;
         }
         else {
+            if (!self.bufferMiss) {
+                self.bufferMissCount++;
+            }
             self.bufferMiss = YES;
         }
     }
@@ -334,32 +395,106 @@
     // Check if we should prefetch next frame or current frame
     // When buffer miss, means the decode speed is slower than render speed, we fetch current miss frame
     // Or, most cases, the decode speed is faster than render speed, we fetch next frame
+    // Then continue with the upcoming frames in the lookahead window, following the playback direction
+    if (bufferFull) {
+        return;
+    }
     NSUInteger fetchFrameIndex = self.bufferMiss? currentFrameIndex : nextFrameIndex;
-    UIImage *fetchFrame;
-    SD_LOCK(_lock);
-    fetchFrame = self.bufferMiss? nil : self.frameBuffer[@(nextFrameIndex)];
-    SD_UNLOCK(_lock);
-    
-    if (!fetchFrame && !bufferFull && self.fetchQueue.operationCount == 0) {
-        // Prefetch next frame in background queue
-        id<TXAnimatedImageProvider> animatedProvider = self.animatedProvider;
-        @weakify(self);
-        NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
-            @strongify(self);
-            if (!self) {
-                return;
+    NSTimeInterval fetchFrameDuration = [self.animatedProvider animatedImageDurationAtIndex:fetchFrameIndex] / playbackRate;
+    NSUInteger prefetchCount = [self prefetchCountWithFrameDuration:fetchFrameDuration capacity:frameBuffer.capacity];
+    BOOL prefetchReverse = shouldReverse;
+    for (NSUInteger i = 0; i < prefetchCount; i++) {
+        if (i > 0) {
+            fetchFrameIndex = SDAnimatedImageNextFrameIndex(fetchFrameIndex, totalFrameCount, playbackMode, &prefetchReverse);
+        }
+        // The reservation fails if the frame is already in buffer, or being fetched
+        if ([frameBuffer reserveFrameAtIndex:fetchFrameIndex]) {
+            [self fetchFrameAtIndex:fetchFrameIndex frameBuffer:frameBuffer];
+        }
+    }
+}
+
+- (NSUInteger)prefetchCountWithFrameDuration:(NSTimeInterval)frameDuration capacity:(NSUInteger)capacity {
+    NSUInteger count = self.prefetchFrameCount;
+    if (count == 0) {
+        // Keep enough frames in flight to cover the decoding time
+        count = 1;
+        NSTimeInterval decodeTime = atomic_load_explicit(&_decodeMicroseconds, memory_order_relaxed) / 1000000.0;
+        if (frameDuration > 0 && decodeTime > frameDuration) {
+            count = MIN((NSUInteger)ceil(decodeTime / frameDuration) + 1, kSDAnimatedImageMaxAutoPrefetchFrameCount);
+        }
+    }
+    // Frames in the window should not evict each other, keep one slot for current frame
+    if (capacity > 1) {
+        count = MIN(count, capacity - 1);
+    } else {
+        count = 1;
+    }
+    return count;
+}
+
+- (void)fetchFrameAtIndex:(NSUInteger)fetchFrameIndex frameBuffer:(TXAnimatedFrameRingBuffer *)frameBuffer {
+    // Prefetch frame in background queue
+    id<TXAnimatedImageProvider> animatedProvider = self.animatedProvider;
+    BOOL shouldUseIndexedFrameBuffer = self.shouldUseIndexedFrameBuffer;
+    @weakify(self);
+    [self.fetchQueue addTask:^{
+        @strongify(self);
+        if (!self) {
+            [frameBuffer fulfillFrame:nil atIndex:fetchFrameIndex];
+            return;
+        }
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        UIImage *frame = [animatedProvider animatedImageFrameAtIndex:fetchFrameIndex];
+        id bufferedFrame = frame;
+        NSUInteger bufferedBytes = 0;
+        if (frame && shouldUseIndexedFrameBuffer) {
+            TXIndexedImageFrame *indexedFrame = [TXIndexedImageFrame frameWithImage:frame];
+            if (indexedFrame) {
+                bufferedFrame = indexedFrame;
+                bufferedBytes = indexedFrame.bytesCount;
+            } else {
+                bufferedBytes = CGImageGetBytesPerRow(frame.CGImage) * CGImageGetHeight(frame.CGImage);
             }
-            UIImage *frame = [animatedProvider animatedImageFrameAtIndex:fetchFrameIndex];
+        }
+        // Moving average, it's fine to lose some samples when decoding in parallel
+        NSUInteger decodeMicroseconds = (CFAbsoluteTimeGetCurrent() - startTime) * 1000000;
+        NSUInteger averageMicroseconds = atomic_load_explicit(&self->_decodeMicroseconds, memory_order_relaxed);
+        averageMicroseconds = averageMicroseconds > 0 ? (averageMicroseconds * 3 + decodeMicroseconds) / 4 : decodeMicroseconds;
+        atomic_store_explicit(&self->_decodeMicroseconds, averageMicroseconds, memory_order_relaxed);
 
-            BOOL isAnimating = self.displayLink.isRunning;
-            if (isAnimating) {
-                SD_LOCK(self->_lock);
-                self.frameBuffer[@(fetchFrameIndex)] = frame;
-                SD_UNLOCK(self->_lock);
+        BOOL isAnimating = self.isPlaying;
+        if (!isAnimating) {
+            bufferedFrame = nil;
+        }
+        // Nil frame cancel the reservation
+        if ([frameBuffer fulfillFrame:bufferedFrame atIndex:fetchFrameIndex]) {
+            BOOL bytesChanged = NO;
+            SD_LOCK(self->_lock);
+            if (bufferedBytes > self->_bufferedBytesPerFrame) {
+                self->_bufferedBytesPerFrame = bufferedBytes;
+                bytesChanged = YES;
             }
-        }];
-        [self.fetchQueue addOperation:operation];
+            SD_UNLOCK(self->_lock);
+            if (bytesChanged) {
+                // The buffer count depends on the real buffered bytes, update it on the display thread
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [self calculateMaxBufferCount];
+                });
+            }
+        }
+    }];
+}
+
+- (UIImage *)imageWithBufferedFrame:(id)bufferedFrame {
+    if ([bufferedFrame isKindOfClass:[TXIndexedImageFrame class]]) {
+        if (!self.indexedFrameBufferPool) {
+            // The displayed frame and the previous one which may still be on the layer, plus the next one
+            self.indexedFrameBufferPool = [[TXIndexedImageFrameBufferPool alloc] initWithMaxCount:3];
+        }
+        return [(TXIndexedImageFrame *)bufferedFrame expandedImageWithBufferPool:self.indexedFrameBufferPool];
     }
+    return bufferedFrame;
 }
 
 - (void)handleFrameChange {
@@ -374,28 +509,97 @@
     }
 }
 
+#pragma mark - Frame Budget
+- (BOOL)isFrameBudgetActive {
+    return self.isPlaying && _visible;
+}
+
+- (double)framesPerSecond {
+    NSUInteger totalFrameCount = self.totalFrameCount;
+    if (_loopDurationFrameCount != totalFrameCount) {
+        // Cache it, the frame count only changes for progressive animation
+        NSTimeInterval loopDuration = 0;
+        for (NSUInteger i = 0; i < totalFrameCount; i++) {
+            loopDuration += [self.animatedProvider animatedImageDurationAtIndex:i];
+        }
+        _loopDuration = loopDuration;
+        _loopDurationFrameCount = totalFrameCount;
+    }
+    if (_loopDuration <= 0) {
+        return 0;
+    }
+    return totalFrameCount / _loopDuration * MAX(self.playbackRate, 0);
+}
+
+- (void)frameBudgetDidChange {
+    [self updateMaxBufferCount];
+}
+
++ (NSUInteger)totalMaxBufferSize {
+    return TXAnimatedFrameBudgetManager.sharedManager.maxBufferSize;
+}
+
++ (void)setTotalMaxBufferSize:(NSUInteger)totalMaxBufferSize {
+    TXAnimatedFrameBudgetManager.sharedManager.maxBufferSize = totalMaxBufferSize;
+}
+
 #pragma mark - Util
+- (NSUInteger)bytesPerFrame {
+    NSUInteger bytes = 0;
+    if (self.shouldUseIndexedFrameBuffer) {
+        SD_LOCK(_lock);
+        bytes = _bufferedBytesPerFrame;
+        SD_UNLOCK(_lock);
+    }
+    if (bytes == 0) {
+        bytes = CGImageGetBytesPerRow(self.currentFrame.CGImage) * CGImageGetHeight(self.currentFrame.CGImage);
+    }
+    return bytes;
+}
+
 - (void)calculateMaxBufferCount {
-    NSUInteger bytes = CGImageGetBytesPerRow(self.currentFrame.CGImage) * CGImageGetHeight(self.currentFrame.CGImage);
-    if (bytes == 0) bytes = 1024;
-    
-    NSUInteger max = 0;
+    // The frame bytes or playing status changed, the other players may get different budget
+    [TXAnimatedFrameBudgetManager.sharedManager setNeedsUpdateClient:self];
+    [self updateMaxBufferCount];
+}
+
+- (void)updateMaxBufferCount {
+    NSUInteger maxBufferCount = 0;
     if (self.maxBufferSize > 0) {
-        max = self.maxBufferSize;
+        NSUInteger bytes = self.bytesPerFrame;
+        if (bytes == 0) bytes = 1024;
+        maxBufferCount = (double)self.maxBufferSize / (double)bytes;
     } else {
-        // Calculate based on current memory, these factors are by experience
-        NSUInteger total = [TXDeviceHelper totalMemory];
-        NSUInteger free = [TXDeviceHelper freeMemory];
-        max = MIN(total * 0.2, free * 0.6);
+        // Share the process-wide budget with other players, by visibility and frame rate
+        maxBufferCount = [TXAnimatedFrameBudgetManager.sharedManager bufferCountForClient:self];
     }
-    
-    NSUInteger maxBufferCount = (double)max / (double)bytes;
     if (!maxBufferCount) {
         // At least 1 frame
         maxBufferCount = 1;
     }
     
     self.maxBufferCount = maxBufferCount;
+    // The provider may become thread-safe, like progressive loading finished
+    _fetchQueue.maxConcurrentCount = self.maxConcurrentFetchCount;
+    
+    // Resize the ring buffer, keep the frames which still fit
+    NSUInteger capacity = MAX(MIN(maxBufferCount, self.totalFrameCount), 1);
+    if (_frameBuffer && _frameBuffer.capacity != capacity) {
+        TXAnimatedFrameRingBuffer *frameBuffer = [[TXAnimatedFrameRingBuffer alloc] initWithCapacity:capacity];
+        NSUInteger currentFrameIndex = self.currentFrameIndex;
+        id currentBufferedFrame = [_frameBuffer frameAtIndex:currentFrameIndex];
+        [_frameBuffer enumerateFramesUsingBlock:^(NSUInteger index, id _Nonnull frame) {
+            if (index != currentFrameIndex) {
+                [frameBuffer setFrame:frame atIndex:index];
+            }
+        }];
+        // Current frame takes priority when slot conflicts
+        if (currentBufferedFrame) {
+            [frameBuffer setFrame:currentBufferedFrame atIndex:currentFrameIndex];
+        }
+        [_fetchQueue cancelAllTasks];
+        _frameBuffer = frameBuffer;
+    }
 }
 
 + (NSString *)defaultRunLoopMode {
@@ -65,11 +65,16 @@
 
 /**
  Provide a max buffer size by bytes. This is used to adjust frame buffer count and can be useful when the decoding cost is expensive (such as Animated WebP software decoding). Default is 0.
- `0` means automatically adjust by calculating current memory usage.
+ `0` means share the process-wide budget with other animated image views, see `TXAnimatedImagePlayer.totalMaxBufferSize`.
  `1` means without any buffer cache, each of frames will be decoded and then be freed after rendering. (Lowest Memory and Highest CPU)
  `NSUIntegerMax` means cache all the buffer. (Lowest CPU and Highest Memory)
  */
 @property (nonatomic, assign) NSUInteger maxBufferSize;
+/**
+ Whether or not to store the buffered frames as 8-bit color indices plus palette, and only expand the frame about to be displayed. This can reduce the frame buffer memory for GIF/APNG to about 1/4. See `TXAnimatedImagePlayer.shouldUseIndexedFrameBuffer`
+ Default is NO.
+ */
+@property (nonatomic, assign) BOOL shouldUseIndexedFrameBuffer;
 /**
  Whehter or not to enable incremental image load for animated image. This is for the animated image which `sd_isIncremental` is YES (See `UIImage+Metadata.h`). If enable, animated image rendering will stop at the last frame available currently, and continue when another `setImage:` trigger, where the new animated image's `animatedImageData` should be updated from the previous one. If the `sd_isIncremental` is NO. The incremental image load stop.
  @note If you are confused about this description, open Chrome browser to view some large GIF images with low network speed to see the animation behavior.
@@ -161,6 +161,9 @@
         // Max Buffer Size
         self.player.maxBufferSize = self.maxBufferSize;
         
+        // Indexed Frame Buffer
+        self.player.shouldUseIndexedFrameBuffer = self.shouldUseIndexedFrameBuffer;
+        
         // Play Rate
         self.player.playbackRate = self.playbackRate;
         
@@ -186,6 +189,10 @@
                 self.currentLoopCount = loopCount;
             }
         };
+        self.player.animationVisibilityHandler = ^BOOL{
+            @strongify(self);
+            return [self isVisibleInWindow];
+        };
         
         // Ensure disabled highlighting; it's not supported (see `-setHighlighted:`).
         super.highlighted = NO;
@@ -228,6 +235,12 @@
     return _maxBufferSize; // Defaults to 0
 }
 
+- (void)setShouldUseIndexedFrameBuffer:(BOOL)shouldUseIndexedFrameBuffer
+{
+    _shouldUseIndexedFrameBuffer = shouldUseIndexedFrameBuffer;
+    self.player.shouldUseIndexedFrameBuffer = shouldUseIndexedFrameBuffer;
+}
+
 - (void)setPlaybackRate:(double)playbackRate
 {
     _playbackRate = playbackRate;
@@ -441,6 +454,29 @@
     self.shouldAnimate = self.player && isVisible;
 }
 
+// The hidden, alpha and window changes already stop the animation. But the view scrolled out of the window's bounds does not receive any notification, check it before rendering each frame.
+- (BOOL)isVisibleInWindow
+{
+    if (!self.shouldAnimate) {
+        return NO;
+    }
+#if SD_MAC
+    NSView *contentView = self.window.contentView;
+    if (!contentView) {
+        return NO;
+    }
+    CGRect windowBounds = [contentView convertRect:contentView.bounds toView:nil];
+#else
+    CGRect windowBounds = self.window.bounds;
+#endif
+    CGRect rect = [self convertRect:self.bounds toView:nil];
+    if (CGRectIsEmpty(rect)) {
+        // Not laid out yet, keep the previous behavior
+        return YES;
+    }
+    return CGRectIntersectsRect(rect, windowBounds);
+}
+
 // Update progressive status only after `setImage:` call.
 - (void)updateIsProgressiveWithImage:(UIImage *)image
 {
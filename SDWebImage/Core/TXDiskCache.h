@@ -9,6 +9,16 @@
 #import "TXWebImageCompat.h"
 
 @class TXImageCacheConfig;
+@class TXImageCacheTierStatistics;
+
+/**
+ Return the file name of the key in `TXDiskCache` (v2, the default `TXImageCacheConfigFileNameVersion2`), which is the XXH3 128-bit hex string of the key's UTF-8 bytes, with the path extension of the key (alphanumeric only, the query and fragment are ignored). `TXWebImageCacheKey` memoizes it, and `TXImageCache` passes it to `dataForKey:fileName:`.
+ */
+FOUNDATION_EXPORT NSString * _Nonnull TXDiskCacheFileNameForKey(NSString * _Nullable key);
+/**
+ Return the legacy file name of the key in `TXDiskCache` (v1, `TXImageCacheConfigFileNameVersion1`), which is the MD5 hex string of the key, with the path extension of the key. `TXDiskCache` uses it to find and migrate the existing file.
+ */
+FOUNDATION_EXPORT NSString * _Nonnull TXDiskCacheLegacyFileNameForKey(NSString * _Nullable key);
 /**
  A protocol to allow custom disk cache used in TXImageCache.
  */
@@ -128,8 +138,23 @@
  */
 @property (nonatomic, strong, readonly, nonnull) TXImageCacheConfig *config;
 
+/**
+ The statistics to record the eviction by `removeExpiredData` (the age and size limit), set by `TXImageCache` when `shouldRecordStatistics` is enabled. Defaults to nil.
+ */
+@property (nonatomic, strong, nullable) TXImageCacheTierStatistics *statistics;
+
 - (nonnull instancetype)init NS_UNAVAILABLE;
 
+/**
+ Returns the data associated with a given key, with the file name of the key computed by the caller (like the memoized `diskFileName` of `TXWebImageCacheKey`), so the key is not hashed again.
+ The file name is ignored for `TXImageCacheConfigFileNameVersion1`.
+
+ @param key A string identifying the data.
+ @param fileName The file name from `TXDiskCacheFileNameForKey` of the key, nil to compute it.
+ @return The value associated with key, or nil if no value is associated with key.
+ */
+- (nullable NSData *)dataForKey:(nonnull NSString *)key fileName:(nullable NSString *)fileName;
+
 /**
  Move the cache directory from old location to new location, the old location will be removed after finish.
  If the old location does not exist, does nothing.
@@ -9,14 +9,21 @@
 #import "TXDiskCache.h"
 #import "TXImageCacheConfig.h"
 #import "TXFileAttributeHelper.h"
+#import "TXImageCacheStatistics.h"
 #import <CommonCrypto/CommonDigest.h>
 
 static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDiskCache";
+// The extended attribute of the cache directory, which records the legacy file name migration
+static NSString * const TXDiskCacheLegacyMigrationAttributeName = @"com.hackemist.TXDiskCache.legacyMigration";
+// The extended attribute of the file renamed from the legacy name, it keeps the dates of the legacy file
+static NSString * const TXDiskCacheMigratedAttributeName = @"com.hackemist.TXDiskCache.migrated";
 
 @interface TXDiskCache ()
 
 @property (nonatomic, copy) NSString *diskCachePath;
 @property (nonatomic, strong, nonnull) NSFileManager *fileManager;
+// The files modified before this date may have the legacy name, nil if the migration is completed
+@property (nonatomic, strong, nullable) NSDate *legacyFileDate;
 
 @end
 
@@ -43,6 +50,7 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
     } else {
         self.fileManager = [NSFileManager new];
     }
+    [self loadLegacyMigrationState];
 }
 
 - (BOOL)containsDataForKey:(NSString *)key {
@@ -50,31 +58,33 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
     NSString *filePath = [self cachePathForKey:key];
     BOOL exists = [self.fileManager fileExistsAtPath:filePath];
     
-    // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
-    // checking the key with and without the extension
+    // fallback to the legacy file names, and migrate it
     if (!exists) {
-        exists = [self.fileManager fileExistsAtPath:filePath.stringByDeletingPathExtension];
+        exists = [self migrateLegacyFileForKey:key toPath:filePath] != nil;
     }
     
     return exists;
 }
 
 - (NSData *)dataForKey:(NSString *)key {
+    return [self dataForKey:key fileName:nil];
+}
+
+- (NSData *)dataForKey:(NSString *)key fileName:(NSString *)fileName {
     NSParameterAssert(key);
-    NSString *filePath = [self cachePathForKey:key];
+    NSString *filePath = [self cachePathForKey:key fileName:fileName];
     NSData *data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
     if (data) {
         return data;
     }
     
-    // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
-    // checking the key with and without the extension
-    data = [NSData dataWithContentsOfFile:filePath.stringByDeletingPathExtension options:self.config.diskCacheReadingOptions error:nil];
-    if (data) {
-        return data;
+    // fallback to the legacy file names, and migrate it
+    NSString *legacyFilePath = [self migrateLegacyFileForKey:key toPath:filePath];
+    if (legacyFilePath) {
+        data = [NSData dataWithContentsOfFile:legacyFilePath options:self.config.diskCacheReadingOptions error:nil];
     }
     
-    return nil;
+    return data;
 }
 
 - (void)setData:(NSData *)data forKey:(NSString *)key {
@@ -82,6 +92,8 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
     NSParameterAssert(key);
     if (![self.fileManager fileExistsAtPath:self.diskCachePath]) {
         [self.fileManager createDirectoryAtPath:self.diskCachePath withIntermediateDirectories:YES attributes:nil error:NULL];
+        // Nothing to migrate in the new directory
+        [self recordLegacyFileDate:nil];
     }
     
     // get cache Path for image key
@@ -105,6 +117,13 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
     NSString *cachePathForKey = [self cachePathForKey:key];
     
     NSData *extendedData = [TXFileAttributeHelper extendedAttribute:TXDiskCacheExtendedAttributeName atPath:cachePathForKey traverseLink:NO error:nil];
+    if (!extendedData && ![self.fileManager fileExistsAtPath:cachePathForKey]) {
+        // The extended attribute is moved together with the legacy file
+        NSString *legacyFilePath = [self migrateLegacyFileForKey:key toPath:cachePathForKey];
+        if (legacyFilePath) {
+            extendedData = [TXFileAttributeHelper extendedAttribute:TXDiskCacheExtendedAttributeName atPath:legacyFilePath traverseLink:NO error:nil];
+        }
+    }
     
     return extendedData;
 }
@@ -127,6 +146,10 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
     NSParameterAssert(key);
     NSString *filePath = [self cachePathForKey:key];
     [self.fileManager removeItemAtPath:filePath error:nil];
+    // Remove the not migrated legacy file as well, or it's migrated back by the next query
+    if (self.config.diskCacheFileNameVersion != TXImageCacheConfigFileNameVersion1) {
+        [self.fileManager removeItemAtPath:[self legacyCachePathForKey:key] error:nil];
+    }
 }
 
 - (void)removeAllData {
@@ -135,6 +158,7 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
             withIntermediateDirectories:YES
                              attributes:nil
                                   error:NULL];
+    [self recordLegacyFileDate:nil];
 }
 
 - (void)removeExpiredData {
@@ -159,7 +183,12 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
             break;
     }
     
-    NSArray<NSString *> *resourceKeys = @[NSURLIsDirectoryKey, cacheContentDateKey, NSURLTotalFileAllocatedSizeKey];
+    NSMutableArray<NSString *> *resourceKeys = [NSMutableArray arrayWithObjects:NSURLIsDirectoryKey, cacheContentDateKey, NSURLTotalFileAllocatedSizeKey, nil];
+    // The sweep finds the remaining legacy files by the modification date as well
+    NSDate *legacyFileDate = self.legacyFileDate;
+    if (legacyFileDate && ![cacheContentDateKey isEqualToString:NSURLContentModificationDateKey]) {
+        [resourceKeys addObject:NSURLContentModificationDateKey];
+    }
     
     // This enumerator prefetches useful properties for our cache files.
     NSDirectoryEnumerator *fileEnumerator = [self.fileManager enumeratorAtURL:diskCacheURL
@@ -176,30 +205,48 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
     //  1. Removing files that are older than the expiration date.
     //  2. Storing file attributes for the size-based cleanup pass.
     NSMutableArray<NSURL *> *urlsToDelete = [[NSMutableArray alloc] init];
+    NSMutableDictionary<NSURL *, NSNumber *> *expiredFileSizes = [NSMutableDictionary dictionary];
+    NSMutableSet<NSURL *> *legacyFileURLs = [NSMutableSet set];
+    BOOL sweepFailed = NO;
     for (NSURL *fileURL in fileEnumerator) {
         NSError *error;
         NSDictionary<NSString *, id> *resourceValues = [fileURL resourceValuesForKeys:resourceKeys error:&error];
         
-        // Skip directories and errors.
-        if (error || !resourceValues || [resourceValues[NSURLIsDirectoryKey] boolValue]) {
+        // Skip directories and errors. The file with error may be a legacy file.
+        if (error || !resourceValues) {
+            sweepFailed = YES;
+            continue;
+        }
+        if ([resourceValues[NSURLIsDirectoryKey] boolValue]) {
             continue;
         }
         
         // Remove files that are older than the expiration date;
         NSDate *modifiedDate = resourceValues[cacheContentDateKey];
+        NSNumber *totalAllocatedSize = resourceValues[NSURLTotalFileAllocatedSizeKey];
         if (expirationDate && [[modifiedDate laterDate:expirationDate] isEqualToDate:expirationDate]) {
             [urlsToDelete addObject:fileURL];
+            expiredFileSizes[fileURL] = totalAllocatedSize;
             continue;
         }
         
         // Store a reference to this file and account for its total size.
-        NSNumber *totalAllocatedSize = resourceValues[NSURLTotalFileAllocatedSizeKey];
         currentCacheSize += totalAllocatedSize.unsignedIntegerValue;
         cacheFiles[fileURL] = resourceValues;
+        
+        if (legacyFileDate && [resourceValues[NSURLContentModificationDateKey] compare:legacyFileDate] == NSOrderedAscending
+            && ![TXFileAttributeHelper hasExtendedAttribute:TXDiskCacheMigratedAttributeName atPath:fileURL.path traverseLink:NO error:nil]) {
+            [legacyFileURLs addObject:fileURL];
+        }
     }
     
+    NSUInteger evictedCount = 0;
+    NSUInteger evictedSize = 0;
     for (NSURL *fileURL in urlsToDelete) {
-        [self.fileManager removeItemAtURL:fileURL error:nil];
+        if ([self.fileManager removeItemAtURL:fileURL error:nil]) {
+            evictedCount++;
+            evictedSize += expiredFileSizes[fileURL].unsignedIntegerValue;
+        }
     }
     
     // If our remaining disk cache exceeds a configured maximum size, perform a second
@@ -221,12 +268,23 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
                 NSDictionary<NSString *, id> *resourceValues = cacheFiles[fileURL];
                 NSNumber *totalAllocatedSize = resourceValues[NSURLTotalFileAllocatedSizeKey];
                 currentCacheSize -= totalAllocatedSize.unsignedIntegerValue;
+                [legacyFileURLs removeObject:fileURL];
+                evictedCount++;
+                evictedSize += totalAllocatedSize.unsignedIntegerValue;
                 
                 if (currentCacheSize < desiredCacheSize) {
                     break;
                 }
             }
         }
+    }    
+    if (evictedCount > 0) {
+        [self.statistics recordEvictionWithCount:evictedCount bytes:evictedSize];
+    }
+    
+    // All of the legacy files are migrated or removed, skip the fallback from now on
+    if (legacyFileDate && !sweepFailed && legacyFileURLs.count == 0) {
+        [self recordLegacyFileDate:nil];
     }
 }
 
@@ -256,8 +314,84 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
 #pragma mark - Cache paths
 
 - (nullable NSString *)cachePathForKey:(nullable NSString *)key inPath:(nonnull NSString *)path {
-    NSString *filename = TXDiskCacheFileNameForKey(key);
-    return [path stringByAppendingPathComponent:filename];
+    if (self.config.diskCacheFileNameVersion == TXImageCacheConfigFileNameVersion1) {
+        return [path stringByAppendingPathComponent:TXDiskCacheLegacyFileNameForKey(key)];
+    }
+    return [path stringByAppendingPathComponent:TXDiskCacheFileNameForKey(key)];
+}
+
+- (nonnull NSString *)cachePathForKey:(nonnull NSString *)key fileName:(nullable NSString *)fileName {
+    if (!fileName || self.config.diskCacheFileNameVersion == TXImageCacheConfigFileNameVersion1) {
+        return [self cachePathForKey:key];
+    }
+    return [self.diskCachePath stringByAppendingPathComponent:fileName];
+}
+
+- (nonnull NSString *)legacyCachePathForKey:(nonnull NSString *)key {
+    return [self.diskCachePath stringByAppendingPathComponent:TXDiskCacheLegacyFileNameForKey(key)];
+}
+
+// Find the file with the legacy name when the current one is missing, and rename it to the current path, so the existing disk cache survives the file name change. It's lazy, only the queried key pays the cost once, and it's skipped after `removeExpiredData` finds no legacy file.
+// Return the path of the found file, which is the current path if renamed, nil if not found.
+- (nullable NSString *)migrateLegacyFileForKey:(nonnull NSString *)key toPath:(nonnull NSString *)filePath {
+    NSString *legacyFilePath = filePath;
+    if (self.config.diskCacheFileNameVersion != TXImageCacheConfigFileNameVersion1) {
+        if (!self.legacyFileDate) {
+            // Migration completed
+            return nil;
+        }
+        legacyFilePath = [self legacyCachePathForKey:key];
+    }
+    NSMutableArray<NSString *> *legacyFilePaths = [NSMutableArray arrayWithCapacity:2];
+    if (![legacyFilePath isEqualToString:filePath]) {
+        [legacyFilePaths addObject:legacyFilePath];
+    }
+    // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
+    // checking the key with and without the extension
+    if (legacyFilePath.pathExtension.length > 0) {
+        [legacyFilePaths addObject:legacyFilePath.stringByDeletingPathExtension];
+    }
+    for (NSString *path in legacyFilePaths) {
+        if (![self.fileManager fileExistsAtPath:path]) {
+            continue;
+        }
+        if ([self.fileManager moveItemAtPath:path toPath:filePath error:nil]) {
+            if (self.legacyFileDate) {
+                // Mark it instead of touching, so the expiration by date is not changed, and the sweep does not count it as a legacy file
+                [TXFileAttributeHelper setExtendedAttribute:TXDiskCacheMigratedAttributeName value:[NSData dataWithBytes:"1" length:1] atPath:filePath traverseLink:NO overwrite:YES error:nil];
+            }
+            return filePath;
+        }
+        // Failed to rename (like the read-only directory), still use it
+        return path;
+    }
+    return nil;
+}
+
+// v2 records the date it first opens the cache directory, the files modified before it may have the legacy name, unless marked as migrated. Nothing to migrate if the directory is new or empty.
+- (void)loadLegacyMigrationState {
+    if (self.config.diskCacheFileNameVersion == TXImageCacheConfigFileNameVersion1) {
+        return;
+    }
+    NSData *stateData = [TXFileAttributeHelper extendedAttribute:TXDiskCacheLegacyMigrationAttributeName atPath:self.diskCachePath traverseLink:NO error:nil];
+    NSTimeInterval legacyFileTime = 0;
+    if (stateData.length == sizeof(legacyFileTime)) {
+        [stateData getBytes:&legacyFileTime length:sizeof(legacyFileTime)];
+        self.legacyFileDate = legacyFileTime > 0 ? [NSDate dateWithTimeIntervalSince1970:legacyFileTime] : nil;
+        return;
+    }
+    NSArray<NSString *> *contents = [self.fileManager contentsOfDirectoryAtPath:self.diskCachePath error:nil];
+    [self recordLegacyFileDate:contents.count > 0 ? [NSDate date] : nil];
+}
+
+- (void)recordLegacyFileDate:(nullable NSDate *)legacyFileDate {
+    if (self.config.diskCacheFileNameVersion == TXImageCacheConfigFileNameVersion1) {
+        return;
+    }
+    self.legacyFileDate = legacyFileDate;
+    NSTimeInterval legacyFileTime = legacyFileDate.timeIntervalSince1970;
+    NSData *stateData = [NSData dataWithBytes:&legacyFileTime length:sizeof(legacyFileTime)];
+    [TXFileAttributeHelper setExtendedAttribute:TXDiskCacheLegacyMigrationAttributeName value:stateData atPath:self.diskCachePath traverseLink:NO overwrite:YES error:nil];
 }
 
 - (void)moveCacheDirectoryFromPath:(nonnull NSString *)srcPath toPath:(nonnull NSString *)dstPath {
@@ -295,15 +429,21 @@ static NSString * const TXDiskCacheExtendedAttributeName = @"com.hackemist.TXDis
         // Remove the old path
         [self.fileManager removeItemAtPath:srcPath error:nil];
     }
+    if ([dstPath isEqualToString:self.diskCachePath]) {
+        // The moved files may have the legacy name
+        [self recordLegacyFileDate:[NSDate date]];
+    }
 }
 
 #pragma mark - Hash
 
-#define SD_MAX_FILE_EXTENSION_LENGTH (NAME_MAX - CC_MD5_DIGEST_LENGTH * 2 - 1)
+// Both the MD5 (v1) and XXH3 128-bit (v2) digest are 16 bytes, 32 characters in hex
+#define SD_MD5_DIGEST_LENGTH 16
+#define SD_MAX_FILE_EXTENSION_LENGTH (NAME_MAX - SD_MD5_DIGEST_LENGTH * 2 - 1)
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
-static inline NSString * _Nonnull TXDiskCacheFileNameForKey(NSString * _Nullable key) {
+NSString * _Nonnull TXDiskCacheLegacyFileNameForKey(NSString * _Nullable key) {
     const char *str = key.UTF8String;
     if (str == NULL) {
         str = "";
@@ -323,4 +463,297 @@ static inline NSString * _Nonnull TXDiskCacheFileNameForKey(NSString * _Nullable
 }
 #pragma clang diagnostic pop
 
+// XXH3 128-bit (xxHash 0.8, seed 0 and the default secret), the scalar path of the reference implementation. It's much faster than MD5 for the short key, and the output is the same on all platforms.
+#define SD_XXH_PRIME32_1 0x9E3779B1U
+#define SD_XXH_PRIME32_2 0x85EBCA77U
+#define SD_XXH_PRIME32_3 0xC2B2AE3DU
+#define SD_XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define SD_XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define SD_XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define SD_XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define SD_XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define SD_XXH_PRIME_MX1 0x165667919E3779F9ULL
+#define SD_XXH_PRIME_MX2 0x9FB21C651E98DF25ULL
+#define SD_XXH3_SECRET_SIZE 192
+#define SD_XXH3_STRIPE_LENGTH 64
+
+static const uint8_t kTXDiskCacheXXH3Secret[SD_XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+typedef struct {
+    uint64_t low64;
+    uint64_t high64;
+} TXDiskCacheHash128;
+
+static inline uint32_t TXDiskCacheReadLE32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t TXDiskCacheReadLE64(const uint8_t *p) {
+    return (uint64_t)TXDiskCacheReadLE32(p) | ((uint64_t)TXDiskCacheReadLE32(p + 4) << 32);
+}
+
+static inline uint32_t TXDiskCacheSwap32(uint32_t x) {
+    return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) | ((x >> 8) & 0x0000ff00) | ((x >> 24) & 0x000000ff);
+}
+
+static inline uint64_t TXDiskCacheSwap64(uint64_t x) {
+    return ((uint64_t)TXDiskCacheSwap32((uint32_t)x) << 32) | TXDiskCacheSwap32((uint32_t)(x >> 32));
+}
+
+static inline TXDiskCacheHash128 TXDiskCacheMult64to128(uint64_t lhs, uint64_t rhs) {
+    TXDiskCacheHash128 r128;
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)lhs * rhs;
+    r128.low64 = (uint64_t)product;
+    r128.high64 = (uint64_t)(product >> 64);
+#else
+    // 32-bit platforms (armv7k), the schoolbook multiplication
+    uint64_t loLo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    uint64_t hiLo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    uint64_t loHi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+    r128.high64 = (hiLo >> 32) + (cross >> 32) + hiHi;
+    r128.low64 = (cross << 32) | (loLo & 0xFFFFFFFF);
+#endif
+    return r128;
+}
+
+static inline uint64_t TXDiskCacheMul128Fold64(uint64_t lhs, uint64_t rhs) {
+    TXDiskCacheHash128 product = TXDiskCacheMult64to128(lhs, rhs);
+    return product.low64 ^ product.high64;
+}
+
+static inline uint64_t TXDiskCacheXXH64Avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= SD_XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= SD_XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t TXDiskCacheXXH3Avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= SD_XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t TXDiskCacheXXH3Mix16B(const uint8_t *input, const uint8_t *secret) {
+    return TXDiskCacheMul128Fold64(TXDiskCacheReadLE64(input) ^ TXDiskCacheReadLE64(secret), TXDiskCacheReadLE64(input + 8) ^ TXDiskCacheReadLE64(secret + 8));
+}
+
+static inline TXDiskCacheHash128 TXDiskCacheXXH3Mix32B(TXDiskCacheHash128 acc, const uint8_t *input1, const uint8_t *input2, const uint8_t *secret) {
+    acc.low64 += TXDiskCacheXXH3Mix16B(input1, secret);
+    acc.low64 ^= TXDiskCacheReadLE64(input2) + TXDiskCacheReadLE64(input2 + 8);
+    acc.high64 += TXDiskCacheXXH3Mix16B(input2, secret + 16);
+    acc.high64 ^= TXDiskCacheReadLE64(input1) + TXDiskCacheReadLE64(input1 + 8);
+    return acc;
+}
+
+static inline void TXDiskCacheXXH3Accumulate512(uint64_t *acc, const uint8_t *input, const uint8_t *secret) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t dataValue = TXDiskCacheReadLE64(input + 8 * i);
+        uint64_t dataKey = dataValue ^ TXDiskCacheReadLE64(secret + 8 * i);
+        acc[i ^ 1] += dataValue;
+        acc[i] += (uint64_t)(uint32_t)dataKey * (dataKey >> 32);
+    }
+}
+
+static inline void TXDiskCacheXXH3ScrambleAcc(uint64_t *acc, const uint8_t *secret) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t acc64 = acc[i];
+        acc64 ^= acc64 >> 47;
+        acc64 ^= TXDiskCacheReadLE64(secret + 8 * i);
+        acc64 *= SD_XXH_PRIME32_1;
+        acc[i] = acc64;
+    }
+}
+
+static inline uint64_t TXDiskCacheXXH3MergeAccs(const uint64_t *acc, const uint8_t *secret, uint64_t start) {
+    uint64_t result = start;
+    for (int i = 0; i < 4; i++) {
+        result += TXDiskCacheMul128Fold64(acc[2 * i] ^ TXDiskCacheReadLE64(secret + 16 * i), acc[2 * i + 1] ^ TXDiskCacheReadLE64(secret + 16 * i + 8));
+    }
+    return TXDiskCacheXXH3Avalanche(result);
+}
+
+static TXDiskCacheHash128 TXDiskCacheXXH3Hash128(const void *data, size_t length) {
+    const uint8_t *input = data;
+    const uint8_t *secret = kTXDiskCacheXXH3Secret;
+    TXDiskCacheHash128 h128;
+    if (length <= 16) {
+        if (length > 8) {
+            uint64_t bitflipLow = TXDiskCacheReadLE64(secret + 32) ^ TXDiskCacheReadLE64(secret + 40);
+            uint64_t bitflipHigh = TXDiskCacheReadLE64(secret + 48) ^ TXDiskCacheReadLE64(secret + 56);
+            uint64_t inputLow = TXDiskCacheReadLE64(input);
+            uint64_t inputHigh = TXDiskCacheReadLE64(input + length - 8);
+            TXDiskCacheHash128 m128 = TXDiskCacheMult64to128(inputLow ^ inputHigh ^ bitflipLow, SD_XXH_PRIME64_1);
+            m128.low64 += (uint64_t)(length - 1) << 54;
+            inputHigh ^= bitflipHigh;
+            m128.high64 += inputHigh + (uint64_t)(uint32_t)inputHigh * (SD_XXH_PRIME32_2 - 1);
+            m128.low64 ^= TXDiskCacheSwap64(m128.high64);
+            h128 = TXDiskCacheMult64to128(m128.low64, SD_XXH_PRIME64_2);
+            h128.high64 += m128.high64 * SD_XXH_PRIME64_2;
+            h128.low64 = TXDiskCacheXXH3Avalanche(h128.low64);
+            h128.high64 = TXDiskCacheXXH3Avalanche(h128.high64);
+        } else if (length >= 4) {
+            uint64_t input64 = TXDiskCacheReadLE32(input) + ((uint64_t)TXDiskCacheReadLE32(input + length - 4) << 32);
+            uint64_t bitflip = TXDiskCacheReadLE64(secret + 16) ^ TXDiskCacheReadLE64(secret + 24);
+            h128 = TXDiskCacheMult64to128(input64 ^ bitflip, SD_XXH_PRIME64_1 + ((uint64_t)length << 2));
+            h128.high64 += h128.low64 << 1;
+            h128.low64 ^= h128.high64 >> 3;
+            h128.low64 ^= h128.low64 >> 35;
+            h128.low64 *= SD_XXH_PRIME_MX2;
+            h128.low64 ^= h128.low64 >> 28;
+            h128.high64 = TXDiskCacheXXH3Avalanche(h128.high64);
+        } else if (length > 0) {
+            uint32_t combinedLow = ((uint32_t)input[0] << 16) | ((uint32_t)input[length >> 1] << 24) | (uint32_t)input[length - 1] | ((uint32_t)length << 8);
+            uint32_t combinedHigh = TXDiskCacheSwap32(combinedLow);
+            combinedHigh = (combinedHigh << 13) | (combinedHigh >> 19);
+            uint64_t bitflipLow = TXDiskCacheReadLE32(secret) ^ TXDiskCacheReadLE32(secret + 4);
+            uint64_t bitflipHigh = TXDiskCacheReadLE32(secret + 8) ^ TXDiskCacheReadLE32(secret + 12);
+            h128.low64 = TXDiskCacheXXH64Avalanche((uint64_t)combinedLow ^ bitflipLow);
+            h128.high64 = TXDiskCacheXXH64Avalanche((uint64_t)combinedHigh ^ bitflipHigh);
+        } else {
+            h128.low64 = TXDiskCacheXXH64Avalanche(TXDiskCacheReadLE64(secret + 64) ^ TXDiskCacheReadLE64(secret + 72));
+            h128.high64 = TXDiskCacheXXH64Avalanche(TXDiskCacheReadLE64(secret + 80) ^ TXDiskCacheReadLE64(secret + 88));
+        }
+        return h128;
+    }
+    if (length <= 240) {
+        TXDiskCacheHash128 acc = {length * SD_XXH_PRIME64_1, 0};
+        if (length <= 128) {
+            if (length > 32) {
+                if (length > 64) {
+                    if (length > 96) {
+                        acc = TXDiskCacheXXH3Mix32B(acc, input + 48, input + length - 64, secret + 96);
+                    }
+                    acc = TXDiskCacheXXH3Mix32B(acc, input + 32, input + length - 48, secret + 64);
+                }
+                acc = TXDiskCacheXXH3Mix32B(acc, input + 16, input + length - 32, secret + 32);
+            }
+            acc = TXDiskCacheXXH3Mix32B(acc, input, input + length - 16, secret);
+        } else {
+            size_t i;
+            for (i = 32; i < 160; i += 32) {
+                acc = TXDiskCacheXXH3Mix32B(acc, input + i - 32, input + i - 16, secret + i - 32);
+            }
+            acc.low64 = TXDiskCacheXXH3Avalanche(acc.low64);
+            acc.high64 = TXDiskCacheXXH3Avalanche(acc.high64);
+            for (i = 160; i <= length; i += 32) {
+                acc = TXDiskCacheXXH3Mix32B(acc, input + i - 32, input + i - 16, secret + 3 + i - 160);
+            }
+            // The last 32 bytes
+            acc = TXDiskCacheXXH3Mix32B(acc, input + length - 16, input + length - 32, secret + 136 - 17 - 16);
+        }
+        h128.low64 = TXDiskCacheXXH3Avalanche(acc.low64 + acc.high64);
+        h128.high64 = 0 - TXDiskCacheXXH3Avalanche((acc.low64 * SD_XXH_PRIME64_1) + (acc.high64 * SD_XXH_PRIME64_4) + (length * SD_XXH_PRIME64_2));
+        return h128;
+    }
+    // The long input, accumulate the stripes of each 1KB block then scramble
+    uint64_t acc[8] = {SD_XXH_PRIME32_3, SD_XXH_PRIME64_1, SD_XXH_PRIME64_2, SD_XXH_PRIME64_3, SD_XXH_PRIME64_4, SD_XXH_PRIME32_2, SD_XXH_PRIME64_5, SD_XXH_PRIME32_1};
+    const size_t stripesPerBlock = (SD_XXH3_SECRET_SIZE - SD_XXH3_STRIPE_LENGTH) / 8;
+    const size_t blockLength = SD_XXH3_STRIPE_LENGTH * stripesPerBlock;
+    const size_t blockCount = (length - 1) / blockLength;
+    for (size_t n = 0; n < blockCount; n++) {
+        for (size_t s = 0; s < stripesPerBlock; s++) {
+            TXDiskCacheXXH3Accumulate512(acc, input + n * blockLength + s * SD_XXH3_STRIPE_LENGTH, secret + s * 8);
+        }
+        TXDiskCacheXXH3ScrambleAcc(acc, secret + SD_XXH3_SECRET_SIZE - SD_XXH3_STRIPE_LENGTH);
+    }
+    const size_t stripeCount = ((length - 1) - blockLength * blockCount) / SD_XXH3_STRIPE_LENGTH;
+    for (size_t s = 0; s < stripeCount; s++) {
+        TXDiskCacheXXH3Accumulate512(acc, input + blockCount * blockLength + s * SD_XXH3_STRIPE_LENGTH, secret + s * 8);
+    }
+    // The last stripe
+    TXDiskCacheXXH3Accumulate512(acc, input + length - SD_XXH3_STRIPE_LENGTH, secret + SD_XXH3_SECRET_SIZE - SD_XXH3_STRIPE_LENGTH - 7);
+    h128.low64 = TXDiskCacheXXH3MergeAccs(acc, secret + 11, length * SD_XXH_PRIME64_1);
+    h128.high64 = TXDiskCacheXXH3MergeAccs(acc, secret + SD_XXH3_SECRET_SIZE - SD_XXH3_STRIPE_LENGTH - 11, ~(length * SD_XXH_PRIME64_2));
+    return h128;
+}
+
+static inline BOOL TXDiskCacheIsAlphanumeric(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// The path extension of the key by scanning the bytes, without parsing the URL: the last path component before the query and fragment, skip the trailing slash. Only the alphanumeric extension is kept, so it's always safe for the file name.
+static size_t TXDiskCacheFileExtension(const uint8_t *str, size_t length, const uint8_t **extension) {
+    size_t end = 0;
+    while (end < length && str[end] != '?' && str[end] != '#') {
+        end++;
+    }
+    // Skip the scheme and host of URL, so the host is not treated as the extension
+    size_t start = 0;
+    for (size_t i = 0; i + 2 < end; i++) {
+        if (str[i] == '/') {
+            if (i > 0 && str[i - 1] == ':' && str[i + 1] == '/') {
+                start = i + 2;
+                while (start < end && str[start] != '/') {
+                    start++;
+                }
+            }
+            break;
+        }
+    }
+    while (end > start && str[end - 1] == '/') {
+        end--;
+    }
+    size_t i = end;
+    while (i > start && TXDiskCacheIsAlphanumeric(str[i - 1])) {
+        i--;
+    }
+    // The dot should not be the first character of the path component (hidden file)
+    if (i == end || i < start + 2 || str[i - 1] != '.' || str[i - 2] == '/') {
+        return 0;
+    }
+    size_t extensionLength = end - i;
+    if (extensionLength > SD_MAX_FILE_EXTENSION_LENGTH) {
+        return 0;
+    }
+    *extension = str + i;
+    return extensionLength;
+}
+
+NSString * _Nonnull TXDiskCacheFileNameForKey(NSString * _Nullable key) {
+    const char *str = key.UTF8String;
+    if (str == NULL) {
+        str = "";
+    }
+    size_t length = strlen(str);
+    TXDiskCacheHash128 h128 = TXDiskCacheXXH3Hash128(str, length);
+    // The canonical representation, high 64 bits first, big endian
+    static const char hexDigits[16] = "0123456789abcdef";
+    char filename[NAME_MAX + 1];
+    for (int i = 0; i < 16; i++) {
+        uint64_t value = i < 8 ? h128.high64 : h128.low64;
+        uint8_t byte = (uint8_t)(value >> (56 - 8 * (i % 8)));
+        filename[i * 2] = hexDigits[byte >> 4];
+        filename[i * 2 + 1] = hexDigits[byte & 0xF];
+    }
+    size_t filenameLength = SD_MD5_DIGEST_LENGTH * 2;
+    const uint8_t *extension = NULL;
+    size_t extensionLength = TXDiskCacheFileExtension((const uint8_t *)str, length, &extension);
+    if (extensionLength > 0) {
+        filename[filenameLength++] = '.';
+        memcpy(filename + filenameLength, extension, extensionLength);
+        filenameLength += extensionLength;
+    }
+    return [[NSString alloc] initWithBytes:filename length:filenameLength encoding:NSASCIIStringEncoding];
+}
+
 @end
@@ -13,6 +13,7 @@
 #import "TXImageCacheDefine.h"
 #import "TXMemoryCache.h"
 #import "TXDiskCache.h"
+#import "TXImageCacheStatistics.h"
 
 /// Image Cache Options
 typedef NS_OPTIONS(NSUInteger, TXImageCacheOptions) {
@@ -59,7 +60,7 @@ typedef NS_OPTIONS(NSUInteger, TXImageCacheOptions) {
  * TXImageCache maintains a memory cache and a disk cache. Disk cache write operations are performed
  * asynchronous so it doesn’t add unnecessary latency to the UI.
  */
-@interface TXImageCache : NSObject
+@interface TXImageCache : NSObject <TXImageCacheStatisticsProvider>
 
 #pragma mark - Properties
 
@@ -96,6 +97,13 @@ typedef NS_OPTIONS(NSUInteger, TXImageCacheOptions) {
  */
 @property (nonatomic, copy, nullable) TXImageCacheAdditionalCachePathBlock additionalCachePathBlock;
 
+/**
+ *  The live statistics of the cache, the hit/miss/eviction counters and the latency histograms for each tier. Use `copy` to take a snapshot.
+ *  It's only recorded when `config.shouldRecordStatistics` is enabled at the time the cache is created, else all the values are 0.
+ *  @note The eviction is only recorded by the built-in `TXMemoryCache` and `TXDiskCache`.
+ */
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheStatistics *statistics;
+
 #pragma mark - Singleton and initialization
 
 /**
@@ -257,22 +265,22 @@ typedef NS_OPTIONS(NSUInteger, TXImageCacheOptions) {
  * Asynchronously queries the cache with operation and call the completion when done.
  *
  * @param key       The unique key used to store the wanted image. If you want transformed or thumbnail image, calculate the key with `SDTransformedKeyForKey`, `SDThumbnailedKeyForKey`, or generate the cache key from url with `cacheKeyForURL:context:`.
- * @param doneBlock The completion block. Will not get called if the operation is cancelled
+ * @param doneBlock The completion block. If the operation is cancelled during the disk query, it's still called with nil image
  *
- * @return a NSOperation instance containing the cache op
+ * @return a cancellation token for the disk query, nil if the query does not need the disk (memory cache hit or invalid key)
  */
-- (nullable NSOperation *)queryCacheOperationForKey:(nullable NSString *)key done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(nullable NSString *)key done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
 
 /**
  * Asynchronously queries the cache with operation and call the completion when done.
  *
  * @param key       The unique key used to store the wanted image. If you want transformed or thumbnail image, calculate the key with `SDTransformedKeyForKey`, `SDThumbnailedKeyForKey`, or generate the cache key from url with `cacheKeyForURL:context:`.
  * @param options   A mask to specify options to use for this cache query
- * @param doneBlock The completion block. Will not get called if the operation is cancelled
+ * @param doneBlock The completion block. If the operation is cancelled during the disk query, it's still called with nil image
  *
- * @return a NSOperation instance containing the cache op
+ * @return a cancellation token for the disk query, nil if the query does not need the disk (memory cache hit or invalid key)
  */
-- (nullable NSOperation *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
 
 /**
  * Asynchronously queries the cache with operation and call the completion when done.
@@ -280,11 +288,11 @@ typedef NS_OPTIONS(NSUInteger, TXImageCacheOptions) {
  * @param key       The unique key used to store the wanted image. If you want transformed or thumbnail image, calculate the key with `SDTransformedKeyForKey`, `SDThumbnailedKeyForKey`, or generate the cache key from url with `cacheKeyForURL:context:`.
  * @param options   A mask to specify options to use for this cache query
  * @param context   A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`. This hold the extra objects which `options` enum can not hold.
- * @param doneBlock The completion block. Will not get called if the operation is cancelled
+ * @param doneBlock The completion block. If the operation is cancelled during the disk query, it's still called with nil image
  *
- * @return a NSOperation instance containing the cache op
+ * @return a cancellation token for the disk query, nil if the query does not need the disk (memory cache hit or invalid key)
  */
-- (nullable NSOperation *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
 
 /**
  * Asynchronously queries the cache with operation and call the completion when done.
@@ -293,11 +301,11 @@ typedef NS_OPTIONS(NSUInteger, TXImageCacheOptions) {
  * @param options   A mask to specify options to use for this cache query
  * @param context   A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`. This hold the extra objects which `options` enum can not hold.
  * @param queryCacheType Specify where to query the cache from. By default we use `.all`, which means both memory cache and disk cache. You can choose to query memory only or disk only as well. Pass `.none` is invalid and callback with nil immediately.
- * @param doneBlock The completion block. Will not get called if the operation is cancelled
+ * @param doneBlock The completion block. If the operation is cancelled during the disk query, it's still called with nil image
  *
- * @return a NSOperation instance containing the cache op
+ * @return a cancellation token for the disk query, nil if the query does not need the disk (memory cache hit or invalid key)
  */
-- (nullable NSOperation *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(TXImageCacheType)queryCacheType done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(TXImageCacheType)queryCacheType done:(nullable TXImageCacheQueryCompletionBlock)doneBlock;
 
 /**
  * Synchronously query the memory cache.
@@ -14,10 +14,14 @@
 #import "UIImage+MemoryCacheCost.h"
 #import "UIImage+Metadata.h"
 #import "UIImage+ExtendedCacheData.h"
+#import "TXWebImageTimeline.h"
+#import "TXWebImageCacheKey.h"
 
 static NSString * _defaultDiskCacheDirectory;
 
-@interface TXImageCache ()
+@interface TXImageCache () {
+    BOOL _shouldRecordStatistics;
+}
 
 #pragma mark - Properties
 @property (nonatomic, strong, readwrite, nonnull) id<TXMemoryCache> memoryCache;
@@ -25,6 +29,7 @@ static NSString * _defaultDiskCacheDirectory;
 @property (nonatomic, copy, readwrite, nonnull) TXImageCacheConfig *config;
 @property (nonatomic, copy, readwrite, nonnull) NSString *diskCachePath;
 @property (nonatomic, strong, nullable) dispatch_queue_t ioQueue;
+@property (nonatomic, strong, readwrite, nonnull) TXImageCacheStatistics *statistics;
 
 @end
 
@@ -94,6 +99,18 @@ static NSString * _defaultDiskCacheDirectory;
         NSAssert([config.diskCacheClass conformsToProtocol:@protocol(TXDiskCache)], @"Custom disk cache class must conform to `TXDiskCache` protocol");
         _diskCache = [[config.diskCacheClass alloc] initWithCachePath:_diskCachePath config:_config];
         
+        // Init the statistics, the eviction can only be recorded by the built-in memory and disk cache
+        _statistics = [TXImageCacheStatistics new];
+        _shouldRecordStatistics = _config.shouldRecordStatistics;
+        if (_shouldRecordStatistics) {
+            if ([_memoryCache isKindOfClass:[TXMemoryCache class]]) {
+                ((TXMemoryCache *)_memoryCache).statistics = _statistics.memory;
+            }
+            if ([_diskCache isKindOfClass:[TXDiskCache class]]) {
+                ((TXDiskCache *)_diskCache).statistics = _statistics.disk;
+            }
+        }
+        
         // Check and migrate disk cache directory if need
         [self migrateDiskCacheDirectory];
 
@@ -190,8 +207,7 @@ static NSString * _defaultDiskCacheDirectory;
     }
     // if memory cache is enabled
     if (toMemory && self.config.shouldCacheImagesInMemory) {
-        NSUInteger cost = image.sd_memoryCost;
-        [self.memoryCache setObject:image forKey:key cost:cost];
+        [self _storeImageToMemory:image forKey:key];
     }
     
     if (!toDisk) {
@@ -268,8 +284,18 @@ static NSString * _defaultDiskCacheDirectory;
     if (!image || !key) {
         return;
     }
+    [self _storeImageToMemory:image forKey:key];
+}
+
+- (void)_storeImageToMemory:(nonnull UIImage *)image forKey:(nonnull NSString *)key {
     NSUInteger cost = image.sd_memoryCost;
+    if (!_shouldRecordStatistics) {
+        [self.memoryCache setObject:image forKey:key cost:cost];
+        return;
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
     [self.memoryCache setObject:image forKey:key cost:cost];
+    [self.statistics.memory recordStoreWithBytes:cost latency:[TXWebImageTimeline currentTime] - startTime];
 }
 
 - (void)storeImageDataToDisk:(nullable NSData *)imageData
@@ -289,7 +315,13 @@ static NSString * _defaultDiskCacheDirectory;
         return;
     }
     
+    if (!_shouldRecordStatistics) {
+        [self.diskCache setData:imageData forKey:key];
+        return;
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
     [self.diskCache setData:imageData forKey:key];
+    [self.statistics.disk recordStoreWithBytes:imageData.length latency:[TXWebImageTimeline currentTime] - startTime];
 }
 
 #pragma mark - Query and Retrieve Ops
@@ -351,7 +383,14 @@ static NSString * _defaultDiskCacheDirectory;
 }
 
 - (nullable UIImage *)imageFromMemoryCacheForKey:(nullable NSString *)key {
-    return [self.memoryCache objectForKey:key];
+    if (!_shouldRecordStatistics) {
+        return [self.memoryCache objectForKey:key];
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
+    UIImage *image = [self.memoryCache objectForKey:key];
+    uint64_t latency = [TXWebImageTimeline currentTime] - startTime;
+    [self.statistics.memory recordQueryWithHit:image != nil bytes:image.sd_memoryCost latency:latency];
+    return image;
 }
 
 - (nullable UIImage *)imageFromDiskCacheForKey:(nullable NSString *)key {
@@ -360,7 +399,7 @@ static NSString * _defaultDiskCacheDirectory;
 
 - (nullable UIImage *)imageFromDiskCacheForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context {
     NSData *data = [self diskImageDataForKey:key];
-    UIImage *diskImage = [self diskImageForKey:key data:data options:options context:context];
+    UIImage *diskImage = [self diskImageForKey:key data:data options:options context:context cancellationToken:nil];
     
     BOOL shouldCacheToMomery = YES;
     if (context[SDWebImageContextStoreCacheType]) {
@@ -368,8 +407,7 @@ static NSString * _defaultDiskCacheDirectory;
         shouldCacheToMomery = (cacheType == TXImageCacheTypeAll || cacheType == TXImageCacheTypeMemory);
     }
     if (diskImage && self.config.shouldCacheImagesInMemory && shouldCacheToMomery) {
-        NSUInteger cost = diskImage.sd_memoryCost;
-        [self.memoryCache setObject:diskImage forKey:key cost:cost];
+        [self _storeImageToMemory:diskImage forKey:key];
     }
 
     return diskImage;
@@ -414,11 +452,32 @@ static NSString * _defaultDiskCacheDirectory;
 }
 
 - (nullable NSData *)diskImageDataBySearchingAllPathsForKey:(nullable NSString *)key {
+    return [self diskImageDataBySearchingAllPathsForKey:key context:nil];
+}
+
+- (nullable NSData *)diskImageDataBySearchingAllPathsForKey:(nullable NSString *)key context:(nullable SDWebImageContext *)context {
     if (!key) {
         return nil;
     }
-    
-    NSData *data = [self.diskCache dataForKey:key];
+    if (!_shouldRecordStatistics) {
+        return [self _diskImageDataBySearchingAllPathsForKey:key context:context];
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
+    NSData *data = [self _diskImageDataBySearchingAllPathsForKey:key context:context];
+    uint64_t latency = [TXWebImageTimeline currentTime] - startTime;
+    [self.statistics.disk recordQueryWithHit:data != nil bytes:data.length latency:latency];
+    return data;
+}
+
+- (nullable NSData *)_diskImageDataBySearchingAllPathsForKey:(nonnull NSString *)key context:(nullable SDWebImageContext *)context {
+    NSData *data;
+    TXWebImageCacheKey *cacheKey = context[SDWebImageContextImageCacheKey];
+    if ([self.diskCache isKindOfClass:[TXDiskCache class]] && [cacheKey isKindOfClass:TXWebImageCacheKey.class] && [cacheKey.stringValue isEqualToString:key]) {
+        // Reuse the file name memoized by the cache key of the image request
+        data = [((TXDiskCache *)self.diskCache) dataForKey:key fileName:cacheKey.diskFileName];
+    } else {
+        data = [self.diskCache dataForKey:key];
+    }
     if (data) {
         return data;
     }
@@ -440,14 +499,14 @@ static NSString * _defaultDiskCacheDirectory;
 }
 
 - (nullable UIImage *)diskImageForKey:(nullable NSString *)key data:(nullable NSData *)data {
-    return [self diskImageForKey:key data:data options:0 context:nil];
+    return [self diskImageForKey:key data:data options:0 context:nil cancellationToken:nil];
 }
 
-- (nullable UIImage *)diskImageForKey:(nullable NSString *)key data:(nullable NSData *)data options:(TXImageCacheOptions)options context:(SDWebImageContext *)context {
+- (nullable UIImage *)diskImageForKey:(nullable NSString *)key data:(nullable NSData *)data options:(TXImageCacheOptions)options context:(SDWebImageContext *)context cancellationToken:(nullable TXWebImageCancellationToken *)cancellationToken {
     if (!data) {
         return nil;
     }
-    UIImage *image = TXImageCacheDecodeImageData(data, key, [[self class] imageOptionsFromCacheOptions:options], context);
+    UIImage *image = TXImageCacheDecodeImageDataWithCancellationToken(data, key, [[self class] imageOptionsFromCacheOptions:options], context, cancellationToken);
     [self _unarchiveObjectWithImage:image forKey:key];
     return image;
 }
@@ -483,19 +542,19 @@ static NSString * _defaultDiskCacheDirectory;
     image.sd_extendedObject = extendedObject;
 }
 
-- (nullable NSOperation *)queryCacheOperationForKey:(NSString *)key done:(TXImageCacheQueryCompletionBlock)doneBlock {
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(NSString *)key done:(TXImageCacheQueryCompletionBlock)doneBlock {
     return [self queryCacheOperationForKey:key options:0 done:doneBlock];
 }
 
-- (nullable NSOperation *)queryCacheOperationForKey:(NSString *)key options:(TXImageCacheOptions)options done:(TXImageCacheQueryCompletionBlock)doneBlock {
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(NSString *)key options:(TXImageCacheOptions)options done:(TXImageCacheQueryCompletionBlock)doneBlock {
     return [self queryCacheOperationForKey:key options:options context:nil done:doneBlock];
 }
 
-- (nullable NSOperation *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context done:(nullable TXImageCacheQueryCompletionBlock)doneBlock {
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context done:(nullable TXImageCacheQueryCompletionBlock)doneBlock {
     return [self queryCacheOperationForKey:key options:options context:context cacheType:TXImageCacheTypeAll done:doneBlock];
 }
 
-- (nullable NSOperation *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(TXImageCacheType)queryCacheType done:(nullable TXImageCacheQueryCompletionBlock)doneBlock {
+- (nullable TXWebImageCancellationToken *)queryCacheOperationForKey:(nullable NSString *)key options:(TXImageCacheOptions)options context:(nullable SDWebImageContext *)context cacheType:(TXImageCacheType)queryCacheType done:(nullable TXImageCacheQueryCompletionBlock)doneBlock {
     if (!key) {
         if (doneBlock) {
             doneBlock(nil, nil, TXImageCacheTypeNone);
@@ -511,9 +570,12 @@ static NSString * _defaultDiskCacheDirectory;
     }
     
     // First check the in-memory cache...
+    TXWebImageTimeline *timeline = context[SDWebImageContextTimeline];
     UIImage *image;
     if (queryCacheType != TXImageCacheTypeDisk) {
+        [timeline beginStage:SDWebImageTimelineStageMemoryQuery];
         image = [self imageFromMemoryCacheForKey:key];
+        [timeline endStage:SDWebImageTimelineStageMemoryQuery];
     }
     
     if (image) {
@@ -546,18 +608,23 @@ static NSString * _defaultDiskCacheDirectory;
     }
     
     // Second check the disk cache...
-    NSOperation *operation = [NSOperation new];
+    TXWebImageCancellationToken *operation = [TXWebImageCancellationToken new];
     // Check whether we need to synchronously query disk
     // 1. in-memory cache hit & memoryDataSync
     // 2. in-memory cache miss & diskDataSync
     BOOL shouldQueryDiskSync = ((image && options & TXImageCacheQueryMemoryDataSync) ||
                                 (!image && options & TXImageCacheQueryDiskDataSync));
     NSData* (^queryDiskDataBlock)(void) = ^NSData* {
+        [timeline endStage:SDWebImageTimelineStageDiskQueueWait];
         if (operation.isCancelled) {
             return nil;
         }
         
-        return [self diskImageDataBySearchingAllPathsForKey:key];
+        [timeline beginStage:SDWebImageTimelineStageDiskRead];
+        NSData *diskData = [self diskImageDataBySearchingAllPathsForKey:key context:context];
+        [timeline endStage:SDWebImageTimelineStageDiskRead];
+        timeline.dataLength = diskData.length;
+        return diskData;
     };
     
     UIImage* (^queryDiskImageBlock)(NSData*) = ^UIImage*(NSData* diskData) {
@@ -576,16 +643,23 @@ static NSString * _defaultDiskCacheDirectory;
                 shouldCacheToMomery = (cacheType == TXImageCacheTypeAll || cacheType == TXImageCacheTypeMemory);
             }
             // decode image data only if in-memory cache missed
-            diskImage = [self diskImageForKey:key data:diskData options:options context:context];
+            [timeline beginStage:SDWebImageTimelineStageDecode];
+            diskImage = [self diskImageForKey:key data:diskData options:options context:context cancellationToken:operation];
+            [timeline endStage:SDWebImageTimelineStageDecode];
+            [timeline recordDecodedImage:diskImage data:diskData context:context];
+            if (operation.isCancelled) {
+                // Cancelled during the decode, do not pollute the memory cache
+                return nil;
+            }
             if (shouldCacheToMomery && diskImage && self.config.shouldCacheImagesInMemory) {
-                NSUInteger cost = diskImage.sd_memoryCost;
-                [self.memoryCache setObject:diskImage forKey:key cost:cost];
+                [self _storeImageToMemory:diskImage forKey:key];
             }
         }
         return diskImage;
     };
     
     // Query in ioQueue to keep IO-safe
+    [timeline beginStage:SDWebImageTimelineStageDiskQueueWait];
     if (shouldQueryDiskSync) {
         __block NSData* diskData;
         __block UIImage* diskImage;
@@ -627,12 +701,12 @@ static NSString * _defaultDiskCacheDirectory;
     }
 
     if (fromMemory && self.config.shouldCacheImagesInMemory) {
-        [self.memoryCache removeObjectForKey:key];
+        [self _removeImageFromMemoryForKey:key];
     }
 
     if (fromDisk) {
         dispatch_async(self.ioQueue, ^{
-            [self.diskCache removeDataForKey:key];
+            [self _removeImageFromDiskForKey:key];
             
             if (completion) {
                 dispatch_async(dispatch_get_main_queue(), ^{
@@ -650,7 +724,17 @@ static NSString * _defaultDiskCacheDirectory;
         return;
     }
     
+    [self _removeImageFromMemoryForKey:key];
+}
+
+- (void)_removeImageFromMemoryForKey:(nonnull NSString *)key {
+    if (!_shouldRecordStatistics) {
+        [self.memoryCache removeObjectForKey:key];
+        return;
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
     [self.memoryCache removeObjectForKey:key];
+    [self.statistics.memory recordRemoveWithLatency:[TXWebImageTimeline currentTime] - startTime];
 }
 
 - (void)removeImageFromDiskForKey:(NSString *)key {
@@ -668,18 +752,34 @@ static NSString * _defaultDiskCacheDirectory;
         return;
     }
     
+    if (!_shouldRecordStatistics) {
+        [self.diskCache removeDataForKey:key];
+        return;
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
     [self.diskCache removeDataForKey:key];
+    [self.statistics.disk recordRemoveWithLatency:[TXWebImageTimeline currentTime] - startTime];
 }
 
 #pragma mark - Cache clean Ops
 
 - (void)clearMemory {
+    if (!_shouldRecordStatistics) {
+        [self.memoryCache removeAllObjects];
+        return;
+    }
+    uint64_t startTime = [TXWebImageTimeline currentTime];
     [self.memoryCache removeAllObjects];
+    [self.statistics.memory recordRemoveWithLatency:[TXWebImageTimeline currentTime] - startTime];
 }
 
 - (void)clearDiskOnCompletion:(nullable SDWebImageNoParamsBlock)completion {
     dispatch_async(self.ioQueue, ^{
+        uint64_t startTime = [TXWebImageTimeline currentTime];
         [self.diskCache removeAllData];
+        if (self->_shouldRecordStatistics) {
+            [self.statistics.disk recordRemoveWithLatency:[TXWebImageTimeline currentTime] - startTime];
+        }
         if (completion) {
             dispatch_async(dispatch_get_main_queue(), ^{
                 completion();
@@ -29,6 +29,18 @@ typedef NS_ENUM(NSUInteger, TXImageCacheConfigExpireType) {
     TXImageCacheConfigExpireTypeChangeDate,
 };
 
+/// Disk Cache File Name Version
+typedef NS_ENUM(NSUInteger, TXImageCacheConfigFileNameVersion) {
+    /**
+     * The MD5 hex string of the key, with the path extension of the key. The legacy scheme, use it to share the disk cache directory with the older version of the framework.
+     */
+    TXImageCacheConfigFileNameVersion1 = 1,
+    /**
+     * The XXH3 128-bit hex string of the key, with the path extension of the key (Default). The v1 file is renamed to v2 when queried.
+     */
+    TXImageCacheConfigFileNameVersion2 = 2,
+};
+
 /**
  The class contains all the config for image cache
  @note This class conform to NSCopying, make sure to add the property in `copyWithZone:` as well.
@@ -74,6 +86,13 @@ typedef NS_ENUM(NSUInteger, TXImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) BOOL shouldRemoveExpiredDataWhenTerminate;
 
+/**
+ * Whether or not to record the cache statistics, the hit/miss/eviction counters and the latency histograms for query/store/remove of each tier. See `TXImageCache.statistics`.
+ * The recording is lock-free, but it still takes the timestamps on the hot path, so it's disabled by default. It takes effect when the cache is created, change it on the config before that.
+ * Defaults to NO.
+ */
+@property (assign, nonatomic) BOOL shouldRecordStatistics;
+
 /**
  * The reading options while reading cache from disk.
  * Defaults to 0. You can set this to `NSDataReadingMappedIfSafe` to improve performance.
@@ -119,6 +138,13 @@ typedef NS_ENUM(NSUInteger, TXImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) TXImageCacheConfigExpireType diskCacheExpireType;
 
+/*
+ * The file name version of disk cache. When it's not v1, the file with the v1 name (MD5) is renamed to the current name on the first query (lazy migration), so the existing disk cache survives the change. Once `removeExpiredData` finds no v1 file left, it's recorded in the cache directory and the missed query no longer looks for the v1 name.
+ * Default is v2
+ * @note This value does not support dynamic changes. Which means further modification on this value after cache initialized has no effect.
+ */
+@property (assign, nonatomic) TXImageCacheConfigFileNameVersion diskCacheFileNameVersion;
+
 /**
  * The custom file manager for disk cache. Pass nil to let disk cache choose the proper file manager.
  * Defaults to nil.
@@ -30,11 +30,13 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
         _shouldUseWeakMemoryCache = NO;
         _shouldRemoveExpiredDataWhenEnterBackground = YES;
         _shouldRemoveExpiredDataWhenTerminate = YES;
+        _shouldRecordStatistics = NO;
         _diskCacheReadingOptions = 0;
         _diskCacheWritingOptions = NSDataWritingAtomic;
         _maxDiskAge = kDefaultCacheMaxDiskAge;
         _maxDiskSize = 0;
         _diskCacheExpireType = TXImageCacheConfigExpireTypeModificationDate;
+        _diskCacheFileNameVersion = TXImageCacheConfigFileNameVersion2;
         _memoryCacheClass = [TXMemoryCache class];
         _diskCacheClass = [TXDiskCache class];
     }
@@ -48,6 +50,7 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
     config.shouldUseWeakMemoryCache = self.shouldUseWeakMemoryCache;
     config.shouldRemoveExpiredDataWhenEnterBackground = self.shouldRemoveExpiredDataWhenEnterBackground;
     config.shouldRemoveExpiredDataWhenTerminate = self.shouldRemoveExpiredDataWhenTerminate;
+    config.shouldRecordStatistics = self.shouldRecordStatistics;
     config.diskCacheReadingOptions = self.diskCacheReadingOptions;
     config.diskCacheWritingOptions = self.diskCacheWritingOptions;
     config.maxDiskAge = self.maxDiskAge;
@@ -55,6 +58,7 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
     config.maxMemoryCost = self.maxMemoryCost;
     config.maxMemoryCount = self.maxMemoryCount;
     config.diskCacheExpireType = self.diskCacheExpireType;
+    config.diskCacheFileNameVersion = self.diskCacheFileNameVersion;
     config.fileManager = self.fileManager; // NSFileManager does not conform to NSCopying, just pass the reference
     config.memoryCacheClass = self.memoryCacheClass;
     config.diskCacheClass = self.diskCacheClass;
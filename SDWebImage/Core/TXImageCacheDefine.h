@@ -54,6 +54,18 @@ typedef void(^TXImageCacheContainsCompletionBlock)(TXImageCacheType containsCach
  */
 FOUNDATION_EXPORT UIImage * _Nullable TXImageCacheDecodeImageData(NSData * _Nonnull imageData, NSString * _Nonnull cacheKey, SDWebImageOptions options, SDWebImageContext * _Nullable context);
 
+/**
+ The same as `TXImageCacheDecodeImageData`, but check the cancellation token at the checkpoints (before the decode, and before the force decode or preloading all frames), and return nil once it's cancelled.
+ 
+ @param imageData The image data from the cache. Should not be nil
+ @param cacheKey The image cache key from the input. Should not be nil
+ @param options The options arg from the input
+ @param context The context arg from the input
+ @param cancellationToken The cancellation token of the query, pass nil to never bail out
+ @return The decoded image for current image data query from cache, or nil if cancelled
+ */
+FOUNDATION_EXPORT UIImage * _Nullable TXImageCacheDecodeImageDataWithCancellationToken(NSData * _Nonnull imageData, NSString * _Nonnull cacheKey, SDWebImageOptions options, SDWebImageContext * _Nullable context, TXWebImageCancellationToken * _Nullable cancellationToken);
+
 /**
  This is the image cache protocol to provide custom image cache for `TXWebImageManager`.
  Though the best practice to custom image cache, is to write your own class which conform `TXMemoryCache` or `TXDiskCache` protocol for `TXImageCache` class (See more on `TXImageCacheConfig.memoryCacheClass & TXImageCacheConfig.diskCacheClass`).
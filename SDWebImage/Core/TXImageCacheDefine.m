@@ -9,34 +9,23 @@
 #import "TXImageCacheDefine.h"
 #import "TXImageCodersManager.h"
 #import "TXImageCoderHelper.h"
+#import "TXImageDecodeOptions.h"
 #import "TXAnimatedImage.h"
 #import "UIImage+Metadata.h"
 #import "TXInternalMacros.h"
 
 UIImage * _Nullable TXImageCacheDecodeImageData(NSData * _Nonnull imageData, NSString * _Nonnull cacheKey, SDWebImageOptions options, SDWebImageContext * _Nullable context) {
-    UIImage *image;
-    BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
-    NSNumber *scaleValue = context[SDWebImageContextImageScaleFactor];
-    CGFloat scale = scaleValue.doubleValue >= 1 ? scaleValue.doubleValue : SDImageScaleFactorForKey(cacheKey);
-    NSNumber *preserveAspectRatioValue = context[SDWebImageContextImagePreserveAspectRatio];
-    NSValue *thumbnailSizeValue;
-    BOOL shouldScaleDown = SD_OPTIONS_CONTAINS(options, SDWebImageScaleDownLargeImages);
-    if (shouldScaleDown) {
-        CGFloat thumbnailPixels = TXImageCoderHelper.defaultScaleDownLimitBytes / 4;
-        CGFloat dimension = ceil(sqrt(thumbnailPixels));
-        thumbnailSizeValue = @(CGSizeMake(dimension, dimension));
-    }
-    if (context[SDWebImageContextImageThumbnailPixelSize]) {
-        thumbnailSizeValue = context[SDWebImageContextImageThumbnailPixelSize];
+    return TXImageCacheDecodeImageDataWithCancellationToken(imageData, cacheKey, options, context, nil);
+}
+
+UIImage * _Nullable TXImageCacheDecodeImageDataWithCancellationToken(NSData * _Nonnull imageData, NSString * _Nonnull cacheKey, SDWebImageOptions options, SDWebImageContext * _Nullable context, TXWebImageCancellationToken * _Nullable cancellationToken) {
+    if (cancellationToken.isCancelled) {
+        return nil;
     }
-    
-    TXImageCoderMutableOptions *mutableCoderOptions = [NSMutableDictionary dictionaryWithCapacity:2];
-    mutableCoderOptions[TXImageCoderDecodeFirstFrameOnly] = @(decodeFirstFrame);
-    mutableCoderOptions[TXImageCoderDecodeScaleFactor] = @(scale);
-    mutableCoderOptions[TXImageCoderDecodePreserveAspectRatio] = preserveAspectRatioValue;
-    mutableCoderOptions[TXImageCoderDecodeThumbnailPixelSize] = thumbnailSizeValue;
-    mutableCoderOptions[TXImageCoderWebImageContext] = context;
-    TXImageCoderOptions *coderOptions = [mutableCoderOptions copy];
+    UIImage *image;
+    TXImageDecodeOptions *coderOptions = [TXImageDecodeOptions decodeOptionsWithCacheKey:cacheKey options:options context:context];
+    BOOL decodeFirstFrame = coderOptions.firstFrameOnly;
+    CGFloat scale = coderOptions.scaleFactor;
     
     // Grab the image coder
     id<TXImageCoder> imageCoder;
@@ -52,6 +41,9 @@ UIImage * _Nullable TXImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
         if ([animatedImageClass isSubclassOfClass:[UIImage class]] && [animatedImageClass conformsToProtocol:@protocol(TXAnimatedImage)]) {
             image = [[animatedImageClass alloc] initWithData:imageData scale:scale options:coderOptions];
             if (image) {
+                if (cancellationToken.isCancelled) {
+                    return nil;
+                }
                 // Preload frames if supported
                 if (options & SDWebImagePreloadAllFrames && [image respondsToSelector:@selector(preloadAllFrames)]) {
                     [((id<TXAnimatedImage>)image) preloadAllFrames];
@@ -77,6 +69,9 @@ UIImage * _Nullable TXImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
             shouldDecode = NO;
         }
         if (shouldDecode) {
+            if (cancellationToken.isCancelled) {
+                return nil;
+            }
             image = [TXImageCoderHelper decodedImageWithImage:image];
         }
     }
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+
+/**
+ A latency histogram with HDR-style log-linear buckets: each power of two range is divided into 16 linear buckets, so the relative error of the percentile is about 6%, from 1 nanosecond to about 68 seconds (the larger value is clamped).
+ Recording is lock-free and wait-free (atomic counters only), so it can be called from any thread on the hot path.
+ @note Use `copy` to take a snapshot, the snapshot is not affected by the later recording.
+ */
+@interface TXImageCacheHistogram : NSObject <NSCopying>
+
+/// The count of recorded values
+@property (nonatomic, assign, readonly) uint64_t count;
+/// The sum of recorded values, in nanoseconds
+@property (nonatomic, assign, readonly) uint64_t totalValue;
+/// The max recorded value, in nanoseconds
+@property (nonatomic, assign, readonly) uint64_t maxValue;
+/// The mean of recorded values, in nanoseconds. 0 if no value recorded.
+@property (nonatomic, assign, readonly) double meanValue;
+
+/// Record a value, in nanoseconds
+- (void)recordValue:(uint64_t)value;
+
+/// The value at the percentile (0-100), in nanoseconds, which is the upper bound of the bucket. 0 if no value recorded.
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+/// Add all the recorded values of another histogram to this one, used to aggregate
+- (void)addHistogram:(nonnull TXImageCacheHistogram *)histogram;
+
+/// Clear all the recorded values
+- (void)reset;
+
+@end
+
+/**
+ The statistics of one cache tier (memory or disk), the counters and latency histograms.
+ */
+@interface TXImageCacheTierStatistics : NSObject <NSCopying>
+
+/// The count of query which found the image (or data)
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+/// The count of query which found nothing
+@property (nonatomic, assign, readonly) NSUInteger missCount;
+/// The hit rate, `hitCount / (hitCount + missCount)`. 0 if nothing queried.
+@property (nonatomic, assign, readonly) double hitRate;
+/// The count of store
+@property (nonatomic, assign, readonly) NSUInteger storeCount;
+/// The count of remove by user, including the clear
+@property (nonatomic, assign, readonly) NSUInteger removeCount;
+/// The count of entries removed by the cache itself, by the cost/count limit or memory warning for memory cache, by the age/size limit for disk cache
+@property (nonatomic, assign, readonly) NSUInteger evictionCount;
+/// The bytes read by query. For memory cache, it's the memory cost of the hit image.
+@property (nonatomic, assign, readonly) NSUInteger bytesRead;
+/// The bytes written by store. For memory cache, it's the memory cost of the stored image.
+@property (nonatomic, assign, readonly) NSUInteger bytesWritten;
+/// The bytes removed by eviction. For memory cache, it's the memory cost of the evicted image.
+@property (nonatomic, assign, readonly) NSUInteger bytesEvicted;
+
+/// The latency of query
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheHistogram *queryLatency;
+/// The latency of store
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheHistogram *storeLatency;
+/// The latency of remove
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheHistogram *removeLatency;
+
+/// Record a query, the latency is in nanoseconds
+- (void)recordQueryWithHit:(BOOL)hit bytes:(NSUInteger)bytes latency:(uint64_t)latency;
+/// Record a store, the latency is in nanoseconds
+- (void)recordStoreWithBytes:(NSUInteger)bytes latency:(uint64_t)latency;
+/// Record a remove, the latency is in nanoseconds
+- (void)recordRemoveWithLatency:(uint64_t)latency;
+/// Record the entries evicted by the cache itself
+- (void)recordEvictionWithCount:(NSUInteger)count bytes:(NSUInteger)bytes;
+
+/// Add all the counters and histograms of another statistics to this one, used to aggregate
+- (void)addStatistics:(nonnull TXImageCacheTierStatistics *)statistics;
+/// Clear all the counters and histograms
+- (void)reset;
+
+@end
+
+/**
+ The statistics of an image cache, for each tier. `TXImageCache` records it when `TXImageCacheConfig.shouldRecordStatistics` is enabled, and `TXImageCachesManager` aggregates it from all the caches.
+ @note Use `copy` to take a snapshot.
+ */
+@interface TXImageCacheStatistics : NSObject <NSCopying>
+
+/// The statistics of memory cache
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheTierStatistics *memory;
+/// The statistics of disk cache
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheTierStatistics *disk;
+
+/// Add all the tiers of another statistics to this one, used to aggregate
+- (void)addStatistics:(nonnull TXImageCacheStatistics *)statistics;
+/// Clear all the tiers
+- (void)reset;
+
+/// The dictionary representation for logging or uploading, contains the counters, and the latency percentiles (p50, p90, p99, max) in microseconds for each tier
+- (nonnull NSDictionary<NSString *, id> *)dictionaryRepresentation;
+
+@end
+
+/**
+ The object which provides the cache statistics, like `TXImageCache` and `TXImageCachesManager`.
+ */
+@protocol TXImageCacheStatisticsProvider <NSObject>
+
+/// The statistics of the cache. Use `copy` to take a snapshot if the returned one is live.
+- (nonnull TXImageCacheStatistics *)statistics;
+
+@end
+
+/// The block to report the statistics. The `statistics` is the snapshot, and the `delta` is the difference since last report (only the counters, the histograms are the same as snapshot).
+typedef void(^TXImageCacheStatisticsReportBlock)(TXImageCacheStatistics * _Nonnull statistics, NSDictionary<NSString *, id> * _Nonnull delta);
+
+/**
+ The reporter which takes the snapshot of the statistics periodically, for logging or uploading.
+ */
+@interface TXImageCacheStatisticsReporter : NSObject
+
+/// The statistics provider, like `TXImageCachesManager.sharedManager`
+@property (nonatomic, strong, readonly, nonnull) id<TXImageCacheStatisticsProvider> provider;
+/// The report interval in seconds
+@property (nonatomic, assign, readonly) NSTimeInterval interval;
+/// Whether the reporter is running
+@property (nonatomic, assign, readonly, getter=isRunning) BOOL running;
+
+/**
+ Create the reporter. Call `start` to begin.
+
+ @param provider The statistics provider
+ @param interval The report interval in seconds
+ @param queue The queue to call the report block periodically, nil means a global queue
+ @param reportBlock The block to report
+ */
+- (nonnull instancetype)initWithProvider:(nonnull id<TXImageCacheStatisticsProvider>)provider interval:(NSTimeInterval)interval queue:(nullable dispatch_queue_t)queue reportBlock:(nonnull TXImageCacheStatisticsReportBlock)reportBlock NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/// Start to report periodically
+- (void)start;
+/// Stop to report
+- (void)stop;
+/// Report immediately on the current thread, without affecting the periodical report
+- (void)reportNow;
+
+@end
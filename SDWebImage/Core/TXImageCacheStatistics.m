@@ -0,0 +1,448 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXImageCacheStatistics.h"
+#import "TXInternalMacros.h"
+#import <stdatomic.h>
+
+// Each power of two range has (1 << SD_HISTOGRAM_SUB_BITS) linear buckets
+#define SD_HISTOGRAM_SUB_BITS 4
+#define SD_HISTOGRAM_SUB_COUNT (1 << SD_HISTOGRAM_SUB_BITS)
+// The max value is (1 << (SD_HISTOGRAM_MAX_MSB + 1)) - 1 nanoseconds, about 68 seconds
+#define SD_HISTOGRAM_MAX_MSB 36
+#define SD_HISTOGRAM_BUCKET_COUNT ((SD_HISTOGRAM_MAX_MSB - SD_HISTOGRAM_SUB_BITS + 2) * SD_HISTOGRAM_SUB_COUNT)
+
+static inline NSUInteger SDHistogramBucketIndex(uint64_t value) {
+    if (value < SD_HISTOGRAM_SUB_COUNT) {
+        return (NSUInteger)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    if (msb > SD_HISTOGRAM_MAX_MSB) {
+        msb = SD_HISTOGRAM_MAX_MSB;
+        value = (1ULL << (SD_HISTOGRAM_MAX_MSB + 1)) - 1;
+    }
+    int shift = msb - SD_HISTOGRAM_SUB_BITS;
+    return (NSUInteger)((msb - SD_HISTOGRAM_SUB_BITS + 1) * SD_HISTOGRAM_SUB_COUNT + (value >> shift) - SD_HISTOGRAM_SUB_COUNT);
+}
+
+static inline uint64_t SDHistogramBucketUpperValue(NSUInteger index) {
+    if (index < SD_HISTOGRAM_SUB_COUNT) {
+        return index;
+    }
+    NSUInteger block = index / SD_HISTOGRAM_SUB_COUNT;
+    NSUInteger sub = index % SD_HISTOGRAM_SUB_COUNT;
+    int shift = (int)block - 1;
+    uint64_t lowerValue = (uint64_t)(SD_HISTOGRAM_SUB_COUNT + sub) << shift;
+    return lowerValue + (1ULL << shift) - 1;
+}
+
+static inline void SDAtomicStoreMax(atomic_ullong *target, uint64_t value) {
+    uint64_t current = atomic_load_explicit(target, memory_order_relaxed);
+    while (value > current && !atomic_compare_exchange_weak_explicit(target, &current, value, memory_order_relaxed, memory_order_relaxed)) {
+        // `current` is reloaded by the failed exchange
+    }
+}
+
+@interface TXImageCacheHistogram () {
+    atomic_ullong _buckets[SD_HISTOGRAM_BUCKET_COUNT];
+    atomic_ullong _count;
+    atomic_ullong _totalValue;
+    atomic_ullong _maxValue;
+}
+
+@end
+
+@implementation TXImageCacheHistogram
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        [self reset];
+    }
+    return self;
+}
+
+- (void)recordValue:(uint64_t)value {
+    atomic_fetch_add_explicit(&_buckets[SDHistogramBucketIndex(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_totalValue, value, memory_order_relaxed);
+    SDAtomicStoreMax(&_maxValue, value);
+}
+
+- (uint64_t)count {
+    return atomic_load_explicit(&_count, memory_order_relaxed);
+}
+
+- (uint64_t)totalValue {
+    return atomic_load_explicit(&_totalValue, memory_order_relaxed);
+}
+
+- (uint64_t)maxValue {
+    return atomic_load_explicit(&_maxValue, memory_order_relaxed);
+}
+
+- (double)meanValue {
+    uint64_t count = self.count;
+    if (count == 0) {
+        return 0;
+    }
+    return (double)self.totalValue / count;
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile {
+    uint64_t buckets[SD_HISTOGRAM_BUCKET_COUNT];
+    uint64_t count = 0;
+    for (NSUInteger i = 0; i < SD_HISTOGRAM_BUCKET_COUNT; i++) {
+        buckets[i] = atomic_load_explicit(&_buckets[i], memory_order_relaxed);
+        count += buckets[i];
+    }
+    if (count == 0) {
+        return 0;
+    }
+    percentile = MIN(MAX(percentile, 0), 100);
+    uint64_t targetCount = MAX((uint64_t)ceil(percentile / 100 * count), 1);
+    uint64_t currentCount = 0;
+    for (NSUInteger i = 0; i < SD_HISTOGRAM_BUCKET_COUNT; i++) {
+        currentCount += buckets[i];
+        if (currentCount >= targetCount) {
+            // The bucket upper bound can exceed the real max value
+            return MIN(SDHistogramBucketUpperValue(i), self.maxValue);
+        }
+    }
+    return self.maxValue;
+}
+
+- (void)addHistogram:(TXImageCacheHistogram *)histogram {
+    if (!histogram || histogram == self) {
+        return;
+    }
+    for (NSUInteger i = 0; i < SD_HISTOGRAM_BUCKET_COUNT; i++) {
+        uint64_t value = atomic_load_explicit(&histogram->_buckets[i], memory_order_relaxed);
+        if (value > 0) {
+            atomic_fetch_add_explicit(&_buckets[i], value, memory_order_relaxed);
+        }
+    }
+    atomic_fetch_add_explicit(&_count, histogram.count, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_totalValue, histogram.totalValue, memory_order_relaxed);
+    SDAtomicStoreMax(&_maxValue, histogram.maxValue);
+}
+
+- (void)reset {
+    for (NSUInteger i = 0; i < SD_HISTOGRAM_BUCKET_COUNT; i++) {
+        atomic_store_explicit(&_buckets[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&_totalValue, 0, memory_order_relaxed);
+    atomic_store_explicit(&_maxValue, 0, memory_order_relaxed);
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    TXImageCacheHistogram *histogram = [[[self class] allocWithZone:zone] init];
+    [histogram addHistogram:self];
+    return histogram;
+}
+
+@end
+
+@interface TXImageCacheTierStatistics () {
+    atomic_ulong _hitCount;
+    atomic_ulong _missCount;
+    atomic_ulong _storeCount;
+    atomic_ulong _removeCount;
+    atomic_ulong _evictionCount;
+    atomic_ulong _bytesRead;
+    atomic_ulong _bytesWritten;
+    atomic_ulong _bytesEvicted;
+}
+
+@end
+
+@implementation TXImageCacheTierStatistics
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _queryLatency = [TXImageCacheHistogram new];
+        _storeLatency = [TXImageCacheHistogram new];
+        _removeLatency = [TXImageCacheHistogram new];
+        [self resetCounters];
+    }
+    return self;
+}
+
+- (NSUInteger)hitCount {
+    return atomic_load_explicit(&_hitCount, memory_order_relaxed);
+}
+
+- (NSUInteger)missCount {
+    return atomic_load_explicit(&_missCount, memory_order_relaxed);
+}
+
+- (double)hitRate {
+    NSUInteger hitCount = self.hitCount;
+    NSUInteger totalCount = hitCount + self.missCount;
+    if (totalCount == 0) {
+        return 0;
+    }
+    return (double)hitCount / totalCount;
+}
+
+- (NSUInteger)storeCount {
+    return atomic_load_explicit(&_storeCount, memory_order_relaxed);
+}
+
+- (NSUInteger)removeCount {
+    return atomic_load_explicit(&_removeCount, memory_order_relaxed);
+}
+
+- (NSUInteger)evictionCount {
+    return atomic_load_explicit(&_evictionCount, memory_order_relaxed);
+}
+
+- (NSUInteger)bytesRead {
+    return atomic_load_explicit(&_bytesRead, memory_order_relaxed);
+}
+
+- (NSUInteger)bytesWritten {
+    return atomic_load_explicit(&_bytesWritten, memory_order_relaxed);
+}
+
+- (NSUInteger)bytesEvicted {
+    return atomic_load_explicit(&_bytesEvicted, memory_order_relaxed);
+}
+
+- (void)recordQueryWithHit:(BOOL)hit bytes:(NSUInteger)bytes latency:(uint64_t)latency {
+    if (hit) {
+        atomic_fetch_add_explicit(&_hitCount, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&_bytesRead, bytes, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&_missCount, 1, memory_order_relaxed);
+    }
+    [self.queryLatency recordValue:latency];
+}
+
+- (void)recordStoreWithBytes:(NSUInteger)bytes latency:(uint64_t)latency {
+    atomic_fetch_add_explicit(&_storeCount, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_bytesWritten, bytes, memory_order_relaxed);
+    [self.storeLatency recordValue:latency];
+}
+
+- (void)recordRemoveWithLatency:(uint64_t)latency {
+    atomic_fetch_add_explicit(&_removeCount, 1, memory_order_relaxed);
+    [self.removeLatency recordValue:latency];
+}
+
+- (void)recordEvictionWithCount:(NSUInteger)count bytes:(NSUInteger)bytes {
+    atomic_fetch_add_explicit(&_evictionCount, count, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_bytesEvicted, bytes, memory_order_relaxed);
+}
+
+- (void)addStatistics:(TXImageCacheTierStatistics *)statistics {
+    if (!statistics || statistics == self) {
+        return;
+    }
+    atomic_fetch_add_explicit(&_hitCount, statistics.hitCount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_missCount, statistics.missCount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_storeCount, statistics.storeCount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_removeCount, statistics.removeCount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_evictionCount, statistics.evictionCount, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_bytesRead, statistics.bytesRead, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_bytesWritten, statistics.bytesWritten, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_bytesEvicted, statistics.bytesEvicted, memory_order_relaxed);
+    [self.queryLatency addHistogram:statistics.queryLatency];
+    [self.storeLatency addHistogram:statistics.storeLatency];
+    [self.removeLatency addHistogram:statistics.removeLatency];
+}
+
+- (void)resetCounters {
+    atomic_store_explicit(&_hitCount, 0, memory_order_relaxed);
+    atomic_store_explicit(&_missCount, 0, memory_order_relaxed);
+    atomic_store_explicit(&_storeCount, 0, memory_order_relaxed);
+    atomic_store_explicit(&_removeCount, 0, memory_order_relaxed);
+    atomic_store_explicit(&_evictionCount, 0, memory_order_relaxed);
+    atomic_store_explicit(&_bytesRead, 0, memory_order_relaxed);
+    atomic_store_explicit(&_bytesWritten, 0, memory_order_relaxed);
+    atomic_store_explicit(&_bytesEvicted, 0, memory_order_relaxed);
+}
+
+- (void)reset {
+    [self resetCounters];
+    [self.queryLatency reset];
+    [self.storeLatency reset];
+    [self.removeLatency reset];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    TXImageCacheTierStatistics *statistics = [[[self class] allocWithZone:zone] init];
+    [statistics addStatistics:self];
+    return statistics;
+}
+
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation {
+    NSDictionary<NSString *, id> * (^latency)(TXImageCacheHistogram *) = ^NSDictionary<NSString *, id> *(TXImageCacheHistogram *histogram) {
+        return @{@"count" : @(histogram.count),
+                 @"meanUs" : @(histogram.meanValue / 1000.0),
+                 @"p50Us" : @([histogram valueAtPercentile:50] / 1000.0),
+                 @"p90Us" : @([histogram valueAtPercentile:90] / 1000.0),
+                 @"p99Us" : @([histogram valueAtPercentile:99] / 1000.0),
+                 @"maxUs" : @(histogram.maxValue / 1000.0)};
+    };
+    return @{@"hitCount" : @(self.hitCount),
+             @"missCount" : @(self.missCount),
+             @"hitRate" : @(self.hitRate),
+             @"storeCount" : @(self.storeCount),
+             @"removeCount" : @(self.removeCount),
+             @"evictionCount" : @(self.evictionCount),
+             @"bytesRead" : @(self.bytesRead),
+             @"bytesWritten" : @(self.bytesWritten),
+             @"bytesEvicted" : @(self.bytesEvicted),
+             @"queryLatency" : latency(self.queryLatency),
+             @"storeLatency" : latency(self.storeLatency),
+             @"removeLatency" : latency(self.removeLatency)};
+}
+
+@end
+
+@implementation TXImageCacheStatistics
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _memory = [TXImageCacheTierStatistics new];
+        _disk = [TXImageCacheTierStatistics new];
+    }
+    return self;
+}
+
+- (void)addStatistics:(TXImageCacheStatistics *)statistics {
+    if (!statistics || statistics == self) {
+        return;
+    }
+    [self.memory addStatistics:statistics.memory];
+    [self.disk addStatistics:statistics.disk];
+}
+
+- (void)reset {
+    [self.memory reset];
+    [self.disk reset];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    TXImageCacheStatistics *statistics = [[[self class] allocWithZone:zone] init];
+    [statistics addStatistics:self];
+    return statistics;
+}
+
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation {
+    return @{@"memory" : [self.memory dictionaryRepresentation],
+             @"disk" : [self.disk dictionaryRepresentation]};
+}
+
+- (NSString *)description {
+    TXImageCacheTierStatistics *memory = self.memory;
+    TXImageCacheTierStatistics *disk = self.disk;
+    return [NSString stringWithFormat:@"<%@: %p, memory: hit %lu, miss %lu, evict %lu, p99 query %.1fus; disk: hit %lu, miss %lu, evict %lu, read %lu bytes, written %lu bytes, p99 query %.1fus>", self.class, self, (unsigned long)memory.hitCount, (unsigned long)memory.missCount, (unsigned long)memory.evictionCount, [memory.queryLatency valueAtPercentile:99] / 1000.0, (unsigned long)disk.hitCount, (unsigned long)disk.missCount, (unsigned long)disk.evictionCount, (unsigned long)disk.bytesRead, (unsigned long)disk.bytesWritten, [disk.queryLatency valueAtPercentile:99] / 1000.0];
+}
+
+@end
+
+@interface TXImageCacheStatisticsReporter () {
+    SD_LOCK_DECLARE(_reporterLock);
+}
+
+@property (nonatomic, strong, nonnull) dispatch_queue_t reportQueue;
+@property (nonatomic, copy, nonnull) TXImageCacheStatisticsReportBlock reportBlock;
+@property (nonatomic, strong, nullable) dispatch_source_t timer;
+@property (nonatomic, strong, nullable) TXImageCacheStatistics *lastStatistics;
+
+@end
+
+@implementation TXImageCacheStatisticsReporter
+
+- (instancetype)initWithProvider:(id<TXImageCacheStatisticsProvider>)provider interval:(NSTimeInterval)interval queue:(dispatch_queue_t)queue reportBlock:(TXImageCacheStatisticsReportBlock)reportBlock {
+    self = [super init];
+    if (self) {
+        _provider = provider;
+        _interval = MAX(interval, 0.001);
+        _reportQueue = queue ?: dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0);
+        _reportBlock = [reportBlock copy];
+        SD_LOCK_INIT(_reporterLock);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+    }
+}
+
+- (BOOL)isRunning {
+    SD_LOCK(_reporterLock);
+    BOOL running = self.timer != nil;
+    SD_UNLOCK(_reporterLock);
+    return running;
+}
+
+- (void)start {
+    SD_LOCK(_reporterLock);
+    if (self.timer) {
+        SD_UNLOCK(_reporterLock);
+        return;
+    }
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.reportQueue);
+    uint64_t interval = (uint64_t)(self.interval * NSEC_PER_SEC);
+    // Allow 10% leeway, the report is not time critical
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+    @weakify(self);
+    dispatch_source_set_event_handler(timer, ^{
+        @strongify(self);
+        [self reportNow];
+    });
+    self.timer = timer;
+    SD_UNLOCK(_reporterLock);
+    dispatch_resume(timer);
+}
+
+- (void)stop {
+    SD_LOCK(_reporterLock);
+    dispatch_source_t timer = self.timer;
+    self.timer = nil;
+    SD_UNLOCK(_reporterLock);
+    if (timer) {
+        dispatch_source_cancel(timer);
+    }
+}
+
+- (void)reportNow {
+    TXImageCacheStatistics *statistics = [[self.provider statistics] copy];
+    SD_LOCK(_reporterLock);
+    TXImageCacheStatistics *lastStatistics = self.lastStatistics;
+    self.lastStatistics = statistics;
+    SD_UNLOCK(_reporterLock);
+    NSDictionary<NSString *, id> *delta = @{@"memory" : [self deltaOfTier:statistics.memory lastTier:lastStatistics.memory],
+                                            @"disk" : [self deltaOfTier:statistics.disk lastTier:lastStatistics.disk]};
+    self.reportBlock(statistics, delta);
+}
+
+- (NSDictionary<NSString *, id> *)deltaOfTier:(TXImageCacheTierStatistics *)tier lastTier:(nullable TXImageCacheTierStatistics *)lastTier {
+    // The counter may decrease after reset, clamp to 0
+    NSNumber * (^delta)(NSUInteger, NSUInteger) = ^NSNumber *(NSUInteger value, NSUInteger lastValue) {
+        return @(value >= lastValue ? value - lastValue : 0);
+    };
+    return @{@"hitCount" : delta(tier.hitCount, lastTier.hitCount),
+             @"missCount" : delta(tier.missCount, lastTier.missCount),
+             @"storeCount" : delta(tier.storeCount, lastTier.storeCount),
+             @"removeCount" : delta(tier.removeCount, lastTier.removeCount),
+             @"evictionCount" : delta(tier.evictionCount, lastTier.evictionCount),
+             @"bytesRead" : delta(tier.bytesRead, lastTier.bytesRead),
+             @"bytesWritten" : delta(tier.bytesWritten, lastTier.bytesWritten),
+             @"bytesEvicted" : delta(tier.bytesEvicted, lastTier.bytesEvicted)};
+}
+
+@end
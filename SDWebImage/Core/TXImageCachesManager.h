@@ -8,6 +8,7 @@
 
 #import <Foundation/Foundation.h>
 #import "TXImageCacheDefine.h"
+#import "TXImageCacheStatistics.h"
 
 /// Policy for cache operation
 typedef NS_ENUM(NSUInteger, TXImageCachesManagerOperationPolicy) {
@@ -20,7 +21,7 @@ typedef NS_ENUM(NSUInteger, TXImageCachesManagerOperationPolicy) {
 /**
  A caches manager to manage multiple caches.
  */
-@interface TXImageCachesManager : NSObject <TXImageCache>
+@interface TXImageCachesManager : NSObject <TXImageCache, TXImageCacheStatisticsProvider>
 
 /**
  Returns the global shared caches manager instance. By default we will set [`TXImageCache.sharedImageCache`] into the caches array.
@@ -78,4 +79,10 @@ typedef NS_ENUM(NSUInteger, TXImageCachesManagerOperationPolicy) {
  */
 - (void)removeCache:(nonnull id<TXImageCache>)cache;
 
+/**
+ The aggregated statistics of all the caches which provide the statistics (like `TXImageCache`), including the nested caches manager. Each cache is counted once even if it's added more than once.
+ The returned one is a new snapshot each time.
+ */
+- (nonnull TXImageCacheStatistics *)statistics;
+
 @end
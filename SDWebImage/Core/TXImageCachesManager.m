@@ -81,6 +81,31 @@
     SD_UNLOCK(_cachesLock);
 }
 
+#pragma mark - Statistics
+
+- (TXImageCacheStatistics *)statistics {
+    TXImageCacheStatistics *statistics = [TXImageCacheStatistics new];
+    // The same cache may be added more than once, or shared by the nested caches manager, only count it once
+    NSHashTable *visitedCaches = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality | NSPointerFunctionsWeakMemory];
+    [self addStatisticsToStatistics:statistics visitedCaches:visitedCaches];
+    return statistics;
+}
+
+- (void)addStatisticsToStatistics:(TXImageCacheStatistics *)statistics visitedCaches:(NSHashTable *)visitedCaches {
+    if ([visitedCaches containsObject:self]) {
+        return;
+    }
+    [visitedCaches addObject:self];
+    for (id<TXImageCache> cache in self.caches) {
+        if ([cache isKindOfClass:[TXImageCachesManager class]]) {
+            [(TXImageCachesManager *)cache addStatisticsToStatistics:statistics visitedCaches:visitedCaches];
+        } else if ([cache conformsToProtocol:@protocol(TXImageCacheStatisticsProvider)] && ![visitedCaches containsObject:cache]) {
+            [visitedCaches addObject:cache];
+            [statistics addStatistics:[(id<TXImageCacheStatisticsProvider>)cache statistics]];
+        }
+    }
+}
+
 #pragma mark - TXImageCache
 
 - (id<TXWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(SDWebImageContext *)context completion:(TXImageCacheQueryCompletionBlock)completionBlock {
@@ -286,7 +311,7 @@
     NSParameterAssert(enumerator);
     NSParameterAssert(operation);
     for (id<TXImageCache> cache in enumerator) {
-        [cache queryImageForKey:key options:options context:context cacheType:queryCacheType completion:^(UIImage * _Nullable image, NSData * _Nullable data, TXImageCacheType cacheType) {
+        id<TXWebImageOperation> cacheOperation = [cache queryImageForKey:key options:options context:context cacheType:queryCacheType completion:^(UIImage * _Nullable image, NSData * _Nullable data, TXImageCacheType cacheType) {
             if (operation.isCancelled) {
                 // Cancelled
                 return;
@@ -312,6 +337,7 @@
                 }
             }
         }];
+        [operation addCacheOperation:cacheOperation];
     }
 }
 
@@ -438,7 +464,7 @@
         return;
     }
     @weakify(self);
-    [cache queryImageForKey:key options:options context:context cacheType:queryCacheType completion:^(UIImage * _Nullable image, NSData * _Nullable data, TXImageCacheType cacheType) {
+    id<TXWebImageOperation> cacheOperation = [cache queryImageForKey:key options:options context:context cacheType:queryCacheType completion:^(UIImage * _Nullable image, NSData * _Nullable data, TXImageCacheType cacheType) {
         @strongify(self);
         if (operation.isCancelled) {
             // Cancelled
@@ -460,6 +486,7 @@
         // Next
         [self serialQueryImageForKey:key options:options context:context cacheType:queryCacheType completion:completionBlock enumerator:enumerator operation:operation];
     }];
+    [operation addCacheOperation:cacheOperation];
 }
 
 - (void)serialStoreImage:(UIImage *)image imageData:(NSData *)imageData forKey:(NSString *)key cacheType:(TXImageCacheType)cacheType completion:(SDWebImageNoParamsBlock)completionBlock enumerator:(NSEnumerator<id<TXImageCache>> *)enumerator {
@@ -243,6 +243,15 @@ FOUNDATION_EXPORT TXImageCoderOption _Nonnull const TXImageCoderWebImageContext
  */
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index;
 
+@optional
+/**
+ Whether or not `animatedImageFrameAtIndex:` can be called from multiple threads at the same time. The animated image player use this to decode several upcoming frames in parallel.
+ If not implemented, treat as NO and frames are decoded one by one.
+ 
+ @return YES if the frame decoding is thread-safe
+ */
+@property (nonatomic, assign, readonly) BOOL animatedImageFrameThreadSafe;
+
 @end
 
 #pragma mark - Animated Coder
@@ -10,6 +10,18 @@
 #import "TXWebImageCompat.h"
 #import "TXImageFrame.h"
 
+/// The resampling backend used to scale the bitmap, see `CGImageCreateScaled:size:resampling:` and `decodedAndScaledDownImageWithImage:limitBytes:`
+typedef NS_ENUM(NSUInteger, TXImageCoderHelperResampling) {
+    /// Use the system framework, vImage for scale and CoreGraphics for scale down. This is the default.
+    TXImageCoderHelperResamplingSystem = 0,
+    /// Use the built-in portable resampler with box filter (area average), fastest
+    TXImageCoderHelperResamplingBox,
+    /// Use the built-in portable resampler with bilinear (triangle) filter
+    TXImageCoderHelperResamplingBilinear,
+    /// Use the built-in portable resampler with Lanczos-3 filter, sharpest
+    TXImageCoderHelperResamplingLanczos3,
+};
+
 /**
  Provide some common helper methods for building the image decoder/encoder.
  */
@@ -29,6 +41,7 @@
  Return frames array from an animated image.
  For UIKit, this will unapply the patch for the description above and then create frames array. This will also work for normal animated UIImage.
  For AppKit, NSImage does not support animates other than GIF. This will try to decode the GIF imageRep and then create frames array.
+ If the image class conforms to `TXAnimatedImage`, the frames are grabbed from `animatedImageFrameAtIndex:` instead.
 
  @param animatedImage A animated image. If it's not animated, return nil
  @return The frames array
@@ -83,6 +96,17 @@
  */
 + (CGImageRef _Nullable)CGImageCreateScaled:(_Nonnull CGImageRef)cgImage size:(CGSize)size CF_RETURNS_RETAINED;
 
+/**
+ Create a scaled CGImage by the provided CGImage and size, with the specify resampling backend. This follows The Create Rule and you are response to call release after usage.
+ @note `CGImageCreateScaled:size:` use the `defaultResampling`.
+ 
+ @param cgImage The CGImage
+ @param size The scale size in pixel.
+ @param resampling The resampling backend
+ @return A new created scaled image
+ */
++ (CGImageRef _Nullable)CGImageCreateScaled:(_Nonnull CGImageRef)cgImage size:(CGSize)size resampling:(TXImageCoderHelperResampling)resampling CF_RETURNS_RETAINED;
+
 /**
  Return the decoded image by the provided image. This one unlike `CGImageCreateDecoded:`, will not decode the image which contains alpha channel or animated image
  @param image The image to be decoded
@@ -106,6 +130,19 @@
  */
 @property (class, readwrite) NSUInteger defaultScaleDownLimitBytes;
 
+/**
+ Control the default resampling backend, used by `CGImageCreateScaled:size:` (the thumbnail decoding without preserving aspect ratio) and `decodedAndScaledDownImageWithImage:limitBytes:`.
+ The built-in resampler is portable and vectorized (SSE2/AVX2/NEON), and decodes the large image band by band for scale down as well. Defaults to `TXImageCoderHelperResamplingSystem`.
+ */
+@property (class, readwrite) TXImageCoderHelperResampling defaultResampling;
+
+/**
+ Control the maximum number of bands scaled concurrently by `decodedAndScaledDownImageWithImage:limitBytes:`. Each band is drawn into its own slice of the destination bitmap.
+ The source bands in flight share the tile budget (1/3 of the limit bytes), so the peak memory does not grow with the concurrency. Pass 1 to scale band by band on the calling thread.
+ Defaults to 0, which means the active processor count.
+ */
+@property (class, readwrite) NSUInteger defaultScaleDownConcurrency;
+
 #if SD_UIKIT || SD_WATCH
 /**
  Convert an EXIF image orientation to an iOS one.
@@ -11,12 +11,15 @@
 #import "NSImage+Compatibility.h"
 #import "NSData+ImageContentType.h"
 #import "TXAnimatedImageRep.h"
+#import "TXAnimatedImage.h"
 #import "UIImage+ForceDecode.h"
 #import "TXAssociatedObject.h"
 #import "UIImage+Metadata.h"
 #import "TXInternalMacros.h"
 #import "TXGraphicsImageRenderer.h"
+#import "TXImageResampler.h"
 #import <Accelerate/Accelerate.h>
+#import <stdatomic.h>
 
 static inline size_t SDByteAlign(size_t size, size_t alignment) {
     return ((size + (alignment - 1)) / alignment) * alignment;
@@ -42,6 +45,213 @@ static CGFloat kDestImageLimitBytes = 30.f * kBytesPerMB;
 
 static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to overlap the seems where tiles meet.
 
+static TXImageCoderHelperResampling kDefaultResampling = TXImageCoderHelperResamplingSystem;
+static NSUInteger kDefaultScaleDownConcurrency = 0;
+
+static inline BOOL SDImageResamplerKernelFromResampling(TXImageCoderHelperResampling resampling, SDImageResamplerKernel *kernel) {
+    switch (resampling) {
+        case TXImageCoderHelperResamplingBox:
+            *kernel = SDImageResamplerKernelBox;
+            return YES;
+        case TXImageCoderHelperResamplingBilinear:
+            *kernel = SDImageResamplerKernelBilinear;
+            return YES;
+        case TXImageCoderHelperResamplingLanczos3:
+            *kernel = SDImageResamplerKernelLanczos3;
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+// Draw the source image into the dest context with CoreGraphics, tile by tile
+static void SDCGContextDrawImageTiled(CGContextRef destContext, CGImageRef sourceImageRef, CGSize sourceResolution, CGSize destResolution, CGFloat imageScale, CGFloat tileTotalPixels) {
+    // Now define the size of the rectangle to be used for the
+    // incremental bits from the input image to the output image.
+    // we use a source tile width equal to the width of the source
+    // image due to the way that iOS retrieves image data from disk.
+    // iOS must decode an image from disk in full width 'bands', even
+    // if current graphics context is clipped to a subrect within that
+    // band. Therefore we fully utilize all of the pixel data that results
+    // from a decoding operation by anchoring our tile size to the full
+    // width of the input image.
+    CGRect sourceTile = CGRectZero;
+    sourceTile.size.width = sourceResolution.width;
+    // The source tile height is dynamic. Since we specified the size
+    // of the source tile in MB, see how many rows of pixels high it
+    // can be given the input image width.
+    sourceTile.size.height = MAX(1, (int)(tileTotalPixels / sourceTile.size.width));
+    sourceTile.origin.x = 0.0f;
+    // The output tile is the same proportions as the input tile, but
+    // scaled to image scale.
+    CGRect destTile;
+    destTile.size.width = destResolution.width;
+    destTile.size.height = sourceTile.size.height * imageScale;
+    destTile.origin.x = 0.0f;
+    // The source seem overlap is proportionate to the destination seem overlap.
+    // this is the amount of pixels to overlap each tile as we assemble the output image.
+    float sourceSeemOverlap = (int)((kDestSeemOverlap/destResolution.height)*sourceResolution.height);
+    CGImageRef sourceTileImageRef;
+    // calculate the number of read/write operations required to assemble the
+    // output image.
+    int iterations = (int)( sourceResolution.height / sourceTile.size.height );
+    // If tile height doesn't divide the image height evenly, add another iteration
+    // to account for the remaining pixels.
+    int remainder = (int)sourceResolution.height % (int)sourceTile.size.height;
+    if(remainder) {
+        iterations++;
+    }
+    // Add seem overlaps to the tiles, but save the original tile height for y coordinate calculations.
+    float sourceTileHeightMinusOverlap = sourceTile.size.height;
+    sourceTile.size.height += sourceSeemOverlap;
+    destTile.size.height += kDestSeemOverlap;
+    for( int y = 0; y < iterations; ++y ) {
+        @autoreleasepool {
+            sourceTile.origin.y = y * sourceTileHeightMinusOverlap + sourceSeemOverlap;
+            destTile.origin.y = destResolution.height - (( y + 1 ) * sourceTileHeightMinusOverlap * imageScale + kDestSeemOverlap);
+            sourceTileImageRef = CGImageCreateWithImageInRect( sourceImageRef, sourceTile );
+            if( y == iterations - 1 && remainder ) {
+                float dify = destTile.size.height;
+                destTile.size.height = CGImageGetHeight( sourceTileImageRef ) * imageScale;
+                dify -= destTile.size.height;
+                destTile.origin.y = MIN(0, destTile.origin.y + dify);
+            }
+            CGContextDrawImage( destContext, destTile, sourceTileImageRef );
+            CGImageRelease( sourceTileImageRef );
+        }
+    }
+}
+
+// Run the bands on a bounded worker pool, each worker takes the next band until all the bands are done or any band failed
+static BOOL SDScaleDownRunBands(size_t bandCount, NSUInteger workerCount, BOOL (^block)(size_t band)) {
+    workerCount = MIN(workerCount, bandCount);
+    if (workerCount <= 1) {
+        for (size_t band = 0; band < bandCount; band++) {
+            @autoreleasepool {
+                if (!block(band)) {
+                    return NO;
+                }
+            }
+        }
+        return YES;
+    }
+    // `dispatch_apply` is synchronous, the workers can access the stack
+    atomic_size_t nextBand;
+    atomic_init(&nextBand, 0);
+    atomic_bool failed;
+    atomic_init(&failed, false);
+    atomic_size_t *nextBandRef = &nextBand;
+    atomic_bool *failedRef = &failed;
+    dispatch_apply(workerCount, dispatch_get_global_queue(qos_class_self(), 0), ^(size_t worker) {
+        while (!atomic_load_explicit(failedRef, memory_order_relaxed)) {
+            size_t band = atomic_fetch_add_explicit(nextBandRef, 1, memory_order_relaxed);
+            if (band >= bandCount) {
+                break;
+            }
+            @autoreleasepool {
+                if (!block(band)) {
+                    atomic_store_explicit(failedRef, true, memory_order_relaxed);
+                }
+            }
+        }
+    });
+    return !atomic_load(&failed);
+}
+
+// Draw the source image into the dest context with CoreGraphics, each band into its own slice of the dest bitmap, so the bands can be drawn concurrently.
+// The source tiles in flight share the tile budget, so the peak memory is the same as drawing tile by tile.
+static BOOL SDCGContextDrawImageTiledConcurrently(CGContextRef destContext, CGImageRef sourceImageRef, CGFloat tileTotalPixels, NSUInteger workerCount) {
+    size_t sourceWidth = CGImageGetWidth(sourceImageRef);
+    size_t sourceHeight = CGImageGetHeight(sourceImageRef);
+    size_t destWidth = CGBitmapContextGetWidth(destContext);
+    size_t destHeight = CGBitmapContextGetHeight(destContext);
+    size_t destBytesPerRow = CGBitmapContextGetBytesPerRow(destContext);
+    uint8_t *destData = CGBitmapContextGetData(destContext);
+    if (!destData || sourceWidth == 0 || sourceHeight == 0 || workerCount == 0) {
+        return NO;
+    }
+    CGColorSpaceRef colorspaceRef = CGBitmapContextGetColorSpace(destContext);
+    CGBitmapInfo bitmapInfo = CGBitmapContextGetBitmapInfo(destContext);
+    CGFloat imageScale = (CGFloat)destHeight / sourceHeight;
+    size_t sourceTileHeight = MAX(1, (size_t)(tileTotalPixels / workerCount / sourceWidth));
+    size_t destTileHeight = MAX(1, (size_t)(sourceTileHeight * imageScale));
+    size_t bandCount = (destHeight + destTileHeight - 1) / destTileHeight;
+    // The source seem overlap is proportionate to the destination seem overlap, the overlapped rows are clipped by the slice.
+    size_t sourceSeemOverlap = (size_t)ceil(kDestSeemOverlap / imageScale);
+    BOOL success = SDScaleDownRunBands(bandCount, workerCount, ^BOOL(size_t band) {
+        size_t destY = band * destTileHeight;
+        size_t destRowCount = MIN(destTileHeight, destHeight - destY);
+        size_t sourceY = (size_t)floor(destY / imageScale);
+        size_t sourceEndY = MIN(sourceHeight, (size_t)ceil((destY + destRowCount) / imageScale) + sourceSeemOverlap);
+        sourceY = sourceY > sourceSeemOverlap ? sourceY - sourceSeemOverlap : 0;
+        CGImageRef sourceTileImageRef = CGImageCreateWithImageInRect(sourceImageRef, CGRectMake(0, sourceY, sourceWidth, sourceEndY - sourceY));
+        CGContextRef sliceContext = sourceTileImageRef ? CGBitmapContextCreate(destData + destY * destBytesPerRow, destWidth, destRowCount, kBitsPerComponent, destBytesPerRow, colorspaceRef, bitmapInfo) : NULL;
+        if (!sliceContext) {
+            CGImageRelease(sourceTileImageRef);
+            return NO;
+        }
+        CGContextSetInterpolationQuality(sliceContext, kCGInterpolationHigh);
+        CGContextSetBlendMode(sliceContext, kCGBlendModeCopy);
+        // The slice context is y-up, the origin is the bottom of the slice (dest row `destY + destRowCount`)
+        CGRect destTile = CGRectMake(0, (CGFloat)(destY + destRowCount) - sourceEndY * imageScale, destWidth, (sourceEndY - sourceY) * imageScale);
+        CGContextDrawImage(sliceContext, destTile, sourceTileImageRef);
+        CGContextRelease(sliceContext);
+        CGImageRelease(sourceTileImageRef);
+        return YES;
+    });
+    if (!success) {
+        // Clear the partial result, so the caller can fallback to draw
+        memset(destData, 0, destBytesPerRow * destHeight);
+    }
+    return success;
+}
+
+// Scale the source image into the dest context with the portable resampler, band by band (concurrently when `workerCount` > 1).
+// Each source band is decoded in full width (see above), and the resampled rows are written into the bitmap data of the dest context directly.
+static BOOL SDCGContextResampleImageTiled(CGContextRef destContext, CGImageRef sourceImageRef, CGFloat tileTotalPixels, SDImageResamplerKernel kernel, SDImageResamplerFormat format, NSUInteger workerCount) {
+    size_t sourceWidth = CGImageGetWidth(sourceImageRef);
+    size_t sourceHeight = CGImageGetHeight(sourceImageRef);
+    size_t destWidth = CGBitmapContextGetWidth(destContext);
+    size_t destHeight = CGBitmapContextGetHeight(destContext);
+    size_t destBytesPerRow = CGBitmapContextGetBytesPerRow(destContext);
+    uint8_t *destData = CGBitmapContextGetData(destContext);
+    if (!destData || sourceWidth == 0 || sourceHeight == 0 || workerCount == 0) {
+        return NO;
+    }
+    CGColorSpaceRef colorspaceRef = CGBitmapContextGetColorSpace(destContext);
+    CGBitmapInfo bitmapInfo = CGBitmapContextGetBitmapInfo(destContext);
+    SDImageResamplerISA isa = SDImageResamplerGetBestISA();
+    // The same source tile size as CoreGraphics (shared by the workers), the dest tile is proportional
+    size_t sourceTileHeight = MAX(1, (size_t)(tileTotalPixels / workerCount / sourceWidth));
+    size_t destTileHeight = MAX(1, sourceTileHeight * destHeight / sourceHeight);
+    size_t bandCount = (destHeight + destTileHeight - 1) / destTileHeight;
+    BOOL success = SDScaleDownRunBands(bandCount, workerCount, ^BOOL(size_t band) {
+        size_t destY = band * destTileHeight;
+        size_t destRowCount = MIN(destTileHeight, destHeight - destY);
+        size_t sourceY, sourceRowCount;
+        SDImageResamplerGetSourceRows(sourceHeight, destHeight, destY, destRowCount, kernel, &sourceY, &sourceRowCount);
+        CGImageRef sourceTileImageRef = CGImageCreateWithImageInRect(sourceImageRef, CGRectMake(0, sourceY, sourceWidth, sourceRowCount));
+        CGContextRef sourceContext = sourceTileImageRef ? CGBitmapContextCreate(NULL, sourceWidth, sourceRowCount, kBitsPerComponent, 0, colorspaceRef, bitmapInfo) : NULL;
+        if (!sourceContext) {
+            CGImageRelease(sourceTileImageRef);
+            return NO;
+        }
+        CGContextSetBlendMode(sourceContext, kCGBlendModeCopy);
+        CGContextDrawImage(sourceContext, CGRectMake(0, 0, sourceWidth, sourceRowCount), sourceTileImageRef);
+        CGImageRelease(sourceTileImageRef);
+        SDImageResamplerBuffer sourceBuffer = {CGBitmapContextGetData(sourceContext), sourceWidth, sourceRowCount, CGBitmapContextGetBytesPerRow(sourceContext)};
+        SDImageResamplerBuffer destBuffer = {destData + destY * destBytesPerRow, destWidth, destRowCount, destBytesPerRow};
+        bool bandSuccess = SDImageResamplerScaleRows(&sourceBuffer, sourceY, sourceHeight, &destBuffer, destY, destHeight, kernel, format, isa);
+        CGContextRelease(sourceContext);
+        return bandSuccess;
+    });
+    if (!success) {
+        // Clear the partial result, so the caller can fallback to draw
+        memset(destData, 0, destBytesPerRow * destHeight);
+    }
+    return success;
+}
+
 @implementation TXImageCoderHelper
 
 + (UIImage *)animatedImageWithFrames:(NSArray<TXImageFrame *> *)frames {
@@ -124,6 +334,26 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     NSMutableArray<TXImageFrame *> *frames = [NSMutableArray array];
     NSUInteger frameCount = 0;
     
+    // The animated image class (like `TXTransformedAnimatedImage`) may not have the original data, grab the frames from the provider
+    if ([animatedImage.class conformsToProtocol:@protocol(TXAnimatedImage)]) {
+        id<TXAnimatedImage> provider = (id<TXAnimatedImage>)animatedImage;
+        frameCount = provider.animatedImageFrameCount;
+        if (frameCount > 1) {
+            for (size_t i = 0; i < frameCount; i++) {
+                @autoreleasepool {
+                    UIImage *frameImage = [provider animatedImageFrameAtIndex:i];
+                    if (!frameImage) {
+                        return nil;
+                    }
+                    NSTimeInterval frameDuration = [provider animatedImageDurationAtIndex:i];
+                    TXImageFrame *frame = [TXImageFrame frameWithImage:frameImage duration:frameDuration];
+                    [frames addObject:frame];
+                }
+            }
+            return frames;
+        }
+    }
+    
 #if SD_UIKIT || SD_WATCH
     NSArray<UIImage *> *animatedImages = animatedImage.images;
     frameCount = animatedImages.count;
@@ -267,6 +497,10 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
 }
 
 + (CGImageRef)CGImageCreateScaled:(CGImageRef)cgImage size:(CGSize)size {
+    return [self CGImageCreateScaled:cgImage size:size resampling:kDefaultResampling];
+}
+
++ (CGImageRef)CGImageCreateScaled:(CGImageRef)cgImage size:(CGSize)size resampling:(TXImageCoderHelperResampling)resampling {
     if (!cgImage) {
         return NULL;
     }
@@ -276,6 +510,10 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
         CGImageRetain(cgImage);
         return cgImage;
     }
+    SDImageResamplerKernel kernel;
+    if (SDImageResamplerKernelFromResampling(resampling, &kernel)) {
+        return [self CGImageCreateResampled:cgImage size:size kernel:kernel];
+    }
     
     __block vImage_Buffer input_buffer = {}, output_buffer = {};
     @onExit {
@@ -325,6 +563,45 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     return outputImage;
 }
 
++ (CGImageRef)CGImageCreateResampled:(CGImageRef)cgImage size:(CGSize)size kernel:(SDImageResamplerKernel)kernel CF_RETURNS_RETAINED {
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    size_t newWidth = MAX(size.width, 0);
+    size_t newHeight = MAX(size.height, 0);
+    if (width == 0 || height == 0 || newWidth == 0 || newHeight == 0) {
+        return NULL;
+    }
+    BOOL hasAlpha = [self CGImageContainsAlpha:cgImage];
+    // Same bitmap info as vImage above
+    CGBitmapInfo bitmapInfo;
+    if (hasAlpha) {
+        bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst;
+    } else {
+        bitmapInfo = kCGBitmapByteOrderDefault | kCGImageAlphaNoneSkipLast;
+    }
+    CGColorSpaceRef colorspaceRef = [self colorSpaceGetDeviceRGB];
+    CGContextRef sourceContext = CGBitmapContextCreate(NULL, width, height, kBitsPerComponent, 0, colorspaceRef, bitmapInfo);
+    if (!sourceContext) {
+        return NULL;
+    }
+    CGContextRef destContext = CGBitmapContextCreate(NULL, newWidth, newHeight, kBitsPerComponent, SDByteAlign(newWidth * kBytesPerPixel, 64), colorspaceRef, bitmapInfo);
+    if (!destContext) {
+        CGContextRelease(sourceContext);
+        return NULL;
+    }
+    CGContextSetBlendMode(sourceContext, kCGBlendModeCopy);
+    CGContextDrawImage(sourceContext, CGRectMake(0, 0, width, height), cgImage);
+    SDImageResamplerBuffer sourceBuffer = {CGBitmapContextGetData(sourceContext), width, height, CGBitmapContextGetBytesPerRow(sourceContext)};
+    SDImageResamplerBuffer destBuffer = {CGBitmapContextGetData(destContext), newWidth, newHeight, CGBitmapContextGetBytesPerRow(destContext)};
+    SDImageResamplerFormat format = hasAlpha ? SDImageResamplerFormatBGRA8 : SDImageResamplerFormatRGBX8;
+    bool success = SDImageResamplerScale(&sourceBuffer, &destBuffer, kernel, format, SDImageResamplerGetBestISA());
+    CGContextRelease(sourceContext);
+    CGImageRef outputImage = success ? CGBitmapContextCreateImage(destContext) : NULL;
+    CGContextRelease(destContext);
+    
+    return outputImage;
+}
+
 + (UIImage *)decodedImageWithImage:(UIImage *)image {
     if (![self shouldDecodeImage:image]) {
         return image;
@@ -414,59 +691,17 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
         }
         CGContextSetInterpolationQuality(destContext, kCGInterpolationHigh);
         
-        // Now define the size of the rectangle to be used for the
-        // incremental bits from the input image to the output image.
-        // we use a source tile width equal to the width of the source
-        // image due to the way that iOS retrieves image data from disk.
-        // iOS must decode an image from disk in full width 'bands', even
-        // if current graphics context is clipped to a subrect within that
-        // band. Therefore we fully utilize all of the pixel data that results
-        // from a decoding operation by anchoring our tile size to the full
-        // width of the input image.
-        CGRect sourceTile = CGRectZero;
-        sourceTile.size.width = sourceResolution.width;
-        // The source tile height is dynamic. Since we specified the size
-        // of the source tile in MB, see how many rows of pixels high it
-        // can be given the input image width.
-        sourceTile.size.height = MAX(1, (int)(tileTotalPixels / sourceTile.size.width));
-        sourceTile.origin.x = 0.0f;
-        // The output tile is the same proportions as the input tile, but
-        // scaled to image scale.
-        CGRect destTile;
-        destTile.size.width = destResolution.width;
-        destTile.size.height = sourceTile.size.height * imageScale;
-        destTile.origin.x = 0.0f;
-        // The source seem overlap is proportionate to the destination seem overlap.
-        // this is the amount of pixels to overlap each tile as we assemble the output image.
-        float sourceSeemOverlap = (int)((kDestSeemOverlap/destResolution.height)*sourceResolution.height);
-        CGImageRef sourceTileImageRef;
-        // calculate the number of read/write operations required to assemble the
-        // output image.
-        int iterations = (int)( sourceResolution.height / sourceTile.size.height );
-        // If tile height doesn't divide the image height evenly, add another iteration
-        // to account for the remaining pixels.
-        int remainder = (int)sourceResolution.height % (int)sourceTile.size.height;
-        if(remainder) {
-            iterations++;
+        NSUInteger concurrency = kDefaultScaleDownConcurrency > 0 ? kDefaultScaleDownConcurrency : [NSProcessInfo processInfo].activeProcessorCount;
+        BOOL drawn = NO;
+        SDImageResamplerKernel kernel;
+        if (SDImageResamplerKernelFromResampling(kDefaultResampling, &kernel)) {
+            drawn = SDCGContextResampleImageTiled(destContext, sourceImageRef, tileTotalPixels, kernel, hasAlpha ? SDImageResamplerFormatBGRA8 : SDImageResamplerFormatRGBX8, concurrency);
         }
-        // Add seem overlaps to the tiles, but save the original tile height for y coordinate calculations.
-        float sourceTileHeightMinusOverlap = sourceTile.size.height;
-        sourceTile.size.height += sourceSeemOverlap;
-        destTile.size.height += kDestSeemOverlap;
-        for( int y = 0; y < iterations; ++y ) {
-            @autoreleasepool {
-                sourceTile.origin.y = y * sourceTileHeightMinusOverlap + sourceSeemOverlap;
-                destTile.origin.y = destResolution.height - (( y + 1 ) * sourceTileHeightMinusOverlap * imageScale + kDestSeemOverlap);
-                sourceTileImageRef = CGImageCreateWithImageInRect( sourceImageRef, sourceTile );
-                if( y == iterations - 1 && remainder ) {
-                    float dify = destTile.size.height;
-                    destTile.size.height = CGImageGetHeight( sourceTileImageRef ) * imageScale;
-                    dify -= destTile.size.height;
-                    destTile.origin.y = MIN(0, destTile.origin.y + dify);
-                }
-                CGContextDrawImage( destContext, destTile, sourceTileImageRef );
-                CGImageRelease( sourceTileImageRef );
-            }
+        if (!drawn && concurrency > 1) {
+            drawn = SDCGContextDrawImageTiledConcurrently(destContext, sourceImageRef, tileTotalPixels, concurrency);
+        }
+        if (!drawn) {
+            SDCGContextDrawImageTiled(destContext, sourceImageRef, sourceResolution, destResolution, imageScale, tileTotalPixels);
         }
         
         CGImageRef destImageRef = CGBitmapContextCreateImage(destContext);
@@ -500,6 +735,22 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     kDestImageLimitBytes = defaultScaleDownLimitBytes;
 }
 
++ (TXImageCoderHelperResampling)defaultResampling {
+    return kDefaultResampling;
+}
+
++ (void)setDefaultResampling:(TXImageCoderHelperResampling)defaultResampling {
+    kDefaultResampling = defaultResampling;
+}
+
++ (NSUInteger)defaultScaleDownConcurrency {
+    return kDefaultScaleDownConcurrency;
+}
+
++ (void)setDefaultScaleDownConcurrency:(NSUInteger)defaultScaleDownConcurrency {
+    kDefaultScaleDownConcurrency = defaultScaleDownConcurrency;
+}
+
 #if SD_UIKIT || SD_WATCH
 // Convert an EXIF image orientation to an iOS one.
 + (UIImageOrientation)imageOrientationFromEXIFOrientation:(CGImagePropertyOrientation)exifOrientation {
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+#import "TXWebImageDefine.h"
+#import "TXImageCoder.h"
+
+/**
+ The immutable decode options with typed fields, built once for each decode request and shared by all the coders it's passed to.
+ It's a `TXImageCoderOptions` dictionary itself, so it can be passed to any coder API. The coder which opts in reads the typed fields directly (use `decodeOptionsWithCoderOptions:`), the other coders read it as the dictionary (`TXImageCoderDecodeScaleFactor`, `TXImageCoderDecodeThumbnailPixelSize`, `TXImageCoderDecodePreserveAspectRatio`, `TXImageCoderDecodeFirstFrameOnly` and `TXImageCoderWebImageContext`), the value is boxed on demand.
+ @note This class is immutable and thread-safe, `copy` returns self.
+ */
+@interface TXImageDecodeOptions : NSDictionary<TXImageCoderOption, id>
+
+/// The scale factor, `TXImageCoderDecodeScaleFactor`. Always >= 1, defaults to 1.
+@property (nonatomic, assign, readonly) CGFloat scaleFactor;
+/// The thumbnail pixel size, `TXImageCoderDecodeThumbnailPixelSize`. `CGSizeZero` means full size, defaults to `CGSizeZero`.
+@property (nonatomic, assign, readonly) CGSize thumbnailPixelSize;
+/// Whether to preserve the aspect ratio for the thumbnail, `TXImageCoderDecodePreserveAspectRatio`. Defaults to YES.
+@property (nonatomic, assign, readonly) BOOL preserveAspectRatio;
+/// Whether to decode the first frame only, `TXImageCoderDecodeFirstFrameOnly`. Defaults to NO.
+@property (nonatomic, assign, readonly) BOOL firstFrameOnly;
+/// The context of the image request, `TXImageCoderWebImageContext`. Defaults to nil.
+@property (nonatomic, copy, readonly, nullable) SDWebImageContext *webImageContext;
+
+/**
+ Create the decode options with the typed fields.
+ */
+- (nonnull instancetype)initWithScaleFactor:(CGFloat)scaleFactor thumbnailPixelSize:(CGSize)thumbnailPixelSize preserveAspectRatio:(BOOL)preserveAspectRatio firstFrameOnly:(BOOL)firstFrameOnly webImageContext:(nullable SDWebImageContext *)webImageContext NS_DESIGNATED_INITIALIZER;
+
+/**
+ The typed form of the coder options. Return the options itself if it's already `TXImageDecodeOptions`, or read the values from the dictionary, the absent one uses the default value.
+ Used by the coder to opt in.
+ */
++ (nonnull instancetype)decodeOptionsWithCoderOptions:(nullable TXImageCoderOptions *)options;
+
+/**
+ The decode options of an image request, from the options and context: `SDWebImageDecodeFirstFrameOnly`, `SDWebImageScaleDownLargeImages`, `SDWebImageContextImageScaleFactor` (or the scale from the key, like `@2x`), `SDWebImageContextImageThumbnailPixelSize` and `SDWebImageContextImagePreserveAspectRatio`.
+ This is the only place to build the options for the built-in decoding process, `TXImageCacheDecodeImageData`, `TXImageLoaderDecodeImageData` and `TXImageLoaderDecodeProgressiveImageData`.
+
+ @param cacheKey The key to detect the scale factor, like the image cache key or the URL's absolute string
+ @param options The options of the image request
+ @param context The context of the image request
+ @return The decode options
+ */
++ (nonnull instancetype)decodeOptionsWithCacheKey:(nullable NSString *)cacheKey options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context;
+
+@end
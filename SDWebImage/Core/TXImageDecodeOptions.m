@@ -0,0 +1,153 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXImageDecodeOptions.h"
+#import "TXImageCoderHelper.h"
+#import "TXInternalMacros.h"
+
+static inline CGSize TXImageDecodeOptionsSizeFromValue(NSValue *value) {
+    if (![value isKindOfClass:NSValue.class]) {
+        return CGSizeZero;
+    }
+#if SD_MAC
+    return value.sizeValue;
+#else
+    return value.CGSizeValue;
+#endif
+}
+
+@implementation TXImageDecodeOptions
+
+- (instancetype)initWithScaleFactor:(CGFloat)scaleFactor thumbnailPixelSize:(CGSize)thumbnailPixelSize preserveAspectRatio:(BOOL)preserveAspectRatio firstFrameOnly:(BOOL)firstFrameOnly webImageContext:(SDWebImageContext *)webImageContext {
+    self = [super init];
+    if (self) {
+        _scaleFactor = MAX(scaleFactor, 1);
+        _thumbnailPixelSize = thumbnailPixelSize;
+        _preserveAspectRatio = preserveAspectRatio;
+        _firstFrameOnly = firstFrameOnly;
+        _webImageContext = [webImageContext copy];
+    }
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithScaleFactor:1 thumbnailPixelSize:CGSizeZero preserveAspectRatio:YES firstFrameOnly:NO webImageContext:nil];
+}
+
+- (instancetype)initWithObjects:(const id _Nonnull [])objects forKeys:(const id<NSCopying> _Nonnull [])keys count:(NSUInteger)cnt {
+    // Used by the `NSDictionary` convenience initializers, read the values from the plain dictionary
+    NSDictionary *dictionary = [[NSDictionary alloc] initWithObjects:objects forKeys:keys count:cnt];
+    return [self initWithCoderOptions:dictionary];
+}
+
+- (instancetype)initWithCoder:(NSCoder *)coder {
+    NSDictionary *dictionary = [[NSDictionary alloc] initWithCoder:coder];
+    return [self initWithCoderOptions:dictionary];
+}
+
+- (instancetype)initWithCoderOptions:(TXImageCoderOptions *)options {
+    NSNumber *scaleFactorValue = options[TXImageCoderDecodeScaleFactor];
+    NSNumber *preserveAspectRatioValue = options[TXImageCoderDecodePreserveAspectRatio];
+    CGFloat scaleFactor = scaleFactorValue != nil ? scaleFactorValue.doubleValue : 1;
+    CGSize thumbnailPixelSize = TXImageDecodeOptionsSizeFromValue(options[TXImageCoderDecodeThumbnailPixelSize]);
+    BOOL preserveAspectRatio = preserveAspectRatioValue != nil ? preserveAspectRatioValue.boolValue : YES;
+    BOOL firstFrameOnly = [options[TXImageCoderDecodeFirstFrameOnly] boolValue];
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    SDWebImageContext *webImageContext = options[TXImageCoderWebImageContext];
+#pragma clang diagnostic pop
+    return [self initWithScaleFactor:scaleFactor thumbnailPixelSize:thumbnailPixelSize preserveAspectRatio:preserveAspectRatio firstFrameOnly:firstFrameOnly webImageContext:webImageContext];
+}
+
++ (instancetype)decodeOptionsWithCoderOptions:(TXImageCoderOptions *)options {
+    if ([options isKindOfClass:TXImageDecodeOptions.class]) {
+        return (TXImageDecodeOptions *)options;
+    }
+    return [[self alloc] initWithCoderOptions:options];
+}
+
++ (instancetype)decodeOptionsWithCacheKey:(NSString *)cacheKey options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
+    NSNumber *scaleValue = context[SDWebImageContextImageScaleFactor];
+    CGFloat scale = scaleValue.doubleValue >= 1 ? scaleValue.doubleValue : SDImageScaleFactorForKey(cacheKey);
+    NSNumber *preserveAspectRatioValue = context[SDWebImageContextImagePreserveAspectRatio];
+    BOOL preserveAspectRatio = preserveAspectRatioValue != nil ? preserveAspectRatioValue.boolValue : YES;
+    CGSize thumbnailSize = CGSizeZero;
+    BOOL shouldScaleDown = SD_OPTIONS_CONTAINS(options, SDWebImageScaleDownLargeImages);
+    if (shouldScaleDown) {
+        CGFloat thumbnailPixels = TXImageCoderHelper.defaultScaleDownLimitBytes / 4;
+        CGFloat dimension = ceil(sqrt(thumbnailPixels));
+        thumbnailSize = CGSizeMake(dimension, dimension);
+    }
+    if (context[SDWebImageContextImageThumbnailPixelSize]) {
+        thumbnailSize = TXImageDecodeOptionsSizeFromValue(context[SDWebImageContextImageThumbnailPixelSize]);
+    }
+    return [[self alloc] initWithScaleFactor:scale thumbnailPixelSize:thumbnailSize preserveAspectRatio:preserveAspectRatio firstFrameOnly:decodeFirstFrame webImageContext:context];
+}
+
+#pragma mark - NSDictionary
+
+- (NSUInteger)count {
+    // scale factor, preserve aspect ratio, first frame only, and the optional thumbnail pixel size and context
+    NSUInteger count = 3;
+    if (!CGSizeEqualToSize(self.thumbnailPixelSize, CGSizeZero)) {
+        count++;
+    }
+    if (self.webImageContext) {
+        count++;
+    }
+    return count;
+}
+
+- (id)objectForKey:(id)aKey {
+    if (![aKey isKindOfClass:NSString.class]) {
+        return nil;
+    }
+    if ([aKey isEqualToString:TXImageCoderDecodeScaleFactor]) {
+        return @(self.scaleFactor);
+    } else if ([aKey isEqualToString:TXImageCoderDecodePreserveAspectRatio]) {
+        return @(self.preserveAspectRatio);
+    } else if ([aKey isEqualToString:TXImageCoderDecodeFirstFrameOnly]) {
+        return @(self.firstFrameOnly);
+    } else if ([aKey isEqualToString:TXImageCoderDecodeThumbnailPixelSize]) {
+        return CGSizeEqualToSize(self.thumbnailPixelSize, CGSizeZero) ? nil : @(self.thumbnailPixelSize);
+    }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    else if ([aKey isEqualToString:TXImageCoderWebImageContext]) {
+        return self.webImageContext;
+    }
+#pragma clang diagnostic pop
+    return nil;
+}
+
+- (NSEnumerator *)keyEnumerator {
+    NSMutableArray<TXImageCoderOption> *keys = [NSMutableArray arrayWithObjects:TXImageCoderDecodeScaleFactor, TXImageCoderDecodePreserveAspectRatio, TXImageCoderDecodeFirstFrameOnly, nil];
+    if (!CGSizeEqualToSize(self.thumbnailPixelSize, CGSizeZero)) {
+        [keys addObject:TXImageCoderDecodeThumbnailPixelSize];
+    }
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    if (self.webImageContext) {
+        [keys addObject:TXImageCoderWebImageContext];
+    }
+#pragma clang diagnostic pop
+    return keys.objectEnumerator;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    // Immutable
+    return self;
+}
+
+- (Class)classForCoder {
+    // Archived as the plain dictionary
+    return NSDictionary.class;
+}
+
+@end
@@ -11,6 +11,7 @@
 #import "UIImage+Metadata.h"
 #import "NSData+ImageContentType.h"
 #import "TXImageCoderHelper.h"
+#import "TXImageDecodeOptions.h"
 #import "TXAnimatedImageRep.h"
 #import "UIImage+ForceDecode.h"
 
@@ -38,6 +39,7 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     NSUInteger _frameCount;
     NSArray<TXImageIOCoderFrame *> *_frames;
     BOOL _finished;
+    BOOL _incremental;
     BOOL _preserveAspectRatio;
     CGSize _thumbnailSize;
 }
@@ -284,27 +286,10 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     if (!data) {
         return nil;
     }
-    CGFloat scale = 1;
-    NSNumber *scaleFactor = options[TXImageCoderDecodeScaleFactor];
-    if (scaleFactor != nil) {
-        scale = MAX([scaleFactor doubleValue], 1);
-    }
-    
-    CGSize thumbnailSize = CGSizeZero;
-    NSValue *thumbnailSizeValue = options[TXImageCoderDecodeThumbnailPixelSize];
-    if (thumbnailSizeValue != nil) {
-#if SD_MAC
-        thumbnailSize = thumbnailSizeValue.sizeValue;
-#else
-        thumbnailSize = thumbnailSizeValue.CGSizeValue;
-#endif
-    }
-    
-    BOOL preserveAspectRatio = YES;
-    NSNumber *preserveAspectRatioValue = options[TXImageCoderDecodePreserveAspectRatio];
-    if (preserveAspectRatioValue != nil) {
-        preserveAspectRatio = preserveAspectRatioValue.boolValue;
-    }
+    TXImageDecodeOptions *decodeOptions = [TXImageDecodeOptions decodeOptionsWithCoderOptions:options];
+    CGFloat scale = decodeOptions.scaleFactor;
+    CGSize thumbnailSize = decodeOptions.thumbnailPixelSize;
+    BOOL preserveAspectRatio = decodeOptions.preserveAspectRatio;
     
 #if SD_MAC
     // If don't use thumbnail, prefers the built-in generation of frames (GIF/APNG)
@@ -326,7 +311,7 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     size_t count = CGImageSourceGetCount(source);
     UIImage *animatedImage;
     
-    BOOL decodeFirstFrame = [options[TXImageCoderDecodeFirstFrameOnly] boolValue];
+    BOOL decodeFirstFrame = decodeOptions.firstFrameOnly;
     if (decodeFirstFrame || count <= 1) {
         animatedImage = [self.class createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize options:nil];
     } else {
@@ -365,29 +350,12 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     self = [super init];
     if (self) {
         NSString *imageUTType = self.class.imageUTType;
+        _incremental = YES;
         _imageSource = CGImageSourceCreateIncremental((__bridge CFDictionaryRef)@{(__bridge NSString *)kCGImageSourceTypeIdentifierHint : imageUTType});
-        CGFloat scale = 1;
-        NSNumber *scaleFactor = options[TXImageCoderDecodeScaleFactor];
-        if (scaleFactor != nil) {
-            scale = MAX([scaleFactor doubleValue], 1);
-        }
-        _scale = scale;
-        CGSize thumbnailSize = CGSizeZero;
-        NSValue *thumbnailSizeValue = options[TXImageCoderDecodeThumbnailPixelSize];
-        if (thumbnailSizeValue != nil) {
-    #if SD_MAC
-            thumbnailSize = thumbnailSizeValue.sizeValue;
-    #else
-            thumbnailSize = thumbnailSizeValue.CGSizeValue;
-    #endif
-        }
-        _thumbnailSize = thumbnailSize;
-        BOOL preserveAspectRatio = YES;
-        NSNumber *preserveAspectRatioValue = options[TXImageCoderDecodePreserveAspectRatio];
-        if (preserveAspectRatioValue != nil) {
-            preserveAspectRatio = preserveAspectRatioValue.boolValue;
-        }
-        _preserveAspectRatio = preserveAspectRatio;
+        TXImageDecodeOptions *decodeOptions = [TXImageDecodeOptions decodeOptionsWithCoderOptions:options];
+        _scale = decodeOptions.scaleFactor;
+        _thumbnailSize = decodeOptions.thumbnailPixelSize;
+        _preserveAspectRatio = decodeOptions.preserveAspectRatio;
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
@@ -569,28 +537,10 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
             CFRelease(imageSource);
             return nil;
         }
-        CGFloat scale = 1;
-        NSNumber *scaleFactor = options[TXImageCoderDecodeScaleFactor];
-        if (scaleFactor != nil) {
-            scale = MAX([scaleFactor doubleValue], 1);
-        }
-        _scale = scale;
-        CGSize thumbnailSize = CGSizeZero;
-        NSValue *thumbnailSizeValue = options[TXImageCoderDecodeThumbnailPixelSize];
-        if (thumbnailSizeValue != nil) {
-    #if SD_MAC
-            thumbnailSize = thumbnailSizeValue.sizeValue;
-    #else
-            thumbnailSize = thumbnailSizeValue.CGSizeValue;
-    #endif
-        }
-        _thumbnailSize = thumbnailSize;
-        BOOL preserveAspectRatio = YES;
-        NSNumber *preserveAspectRatioValue = options[TXImageCoderDecodePreserveAspectRatio];
-        if (preserveAspectRatioValue != nil) {
-            preserveAspectRatio = preserveAspectRatioValue.boolValue;
-        }
-        _preserveAspectRatio = preserveAspectRatio;
+        TXImageDecodeOptions *decodeOptions = [TXImageDecodeOptions decodeOptionsWithCoderOptions:options];
+        _scale = decodeOptions.scaleFactor;
+        _thumbnailSize = decodeOptions.thumbnailPixelSize;
+        _preserveAspectRatio = decodeOptions.preserveAspectRatio;
         _imageSource = imageSource;
         _imageData = data;
 #if SD_UIKIT
@@ -641,6 +591,11 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     return _frames[index].duration;
 }
 
+- (BOOL)animatedImageFrameThreadSafe {
+    // CGImageSource is thread-safe, but the incremental one is mutated during updating data
+    return !_incremental || _finished;
+}
+
 - (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
     if (index >= _frameCount) {
         return nil;
@@ -8,6 +8,7 @@
 
 #import "TXImageIOCoder.h"
 #import "TXImageCoderHelper.h"
+#import "TXImageDecodeOptions.h"
 #import "NSImage+Compatibility.h"
 #import <ImageIO/ImageIO.h>
 #import "UIImage+Metadata.h"
@@ -61,27 +62,10 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     if (!data) {
         return nil;
     }
-    CGFloat scale = 1;
-    NSNumber *scaleFactor = options[TXImageCoderDecodeScaleFactor];
-    if (scaleFactor != nil) {
-        scale = MAX([scaleFactor doubleValue], 1) ;
-    }
-    
-    CGSize thumbnailSize = CGSizeZero;
-    NSValue *thumbnailSizeValue = options[TXImageCoderDecodeThumbnailPixelSize];
-    if (thumbnailSizeValue != nil) {
-#if SD_MAC
-        thumbnailSize = thumbnailSizeValue.sizeValue;
-#else
-        thumbnailSize = thumbnailSizeValue.CGSizeValue;
-#endif
-    }
-    
-    BOOL preserveAspectRatio = YES;
-    NSNumber *preserveAspectRatioValue = options[TXImageCoderDecodePreserveAspectRatio];
-    if (preserveAspectRatioValue != nil) {
-        preserveAspectRatio = preserveAspectRatioValue.boolValue;
-    }
+    TXImageDecodeOptions *decodeOptions = [TXImageDecodeOptions decodeOptionsWithCoderOptions:options];
+    CGFloat scale = decodeOptions.scaleFactor;
+    CGSize thumbnailSize = decodeOptions.thumbnailPixelSize;
+    BOOL preserveAspectRatio = decodeOptions.preserveAspectRatio;
     
     CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
     if (!source) {
@@ -108,28 +92,10 @@ static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestination
     self = [super init];
     if (self) {
         _imageSource = CGImageSourceCreateIncremental(NULL);
-        CGFloat scale = 1;
-        NSNumber *scaleFactor = options[TXImageCoderDecodeScaleFactor];
-        if (scaleFactor != nil) {
-            scale = MAX([scaleFactor doubleValue], 1);
-        }
-        _scale = scale;
-        CGSize thumbnailSize = CGSizeZero;
-        NSValue *thumbnailSizeValue = options[TXImageCoderDecodeThumbnailPixelSize];
-        if (thumbnailSizeValue != nil) {
-    #if SD_MAC
-            thumbnailSize = thumbnailSizeValue.sizeValue;
-    #else
-            thumbnailSize = thumbnailSizeValue.CGSizeValue;
-    #endif
-        }
-        _thumbnailSize = thumbnailSize;
-        BOOL preserveAspectRatio = YES;
-        NSNumber *preserveAspectRatioValue = options[TXImageCoderDecodePreserveAspectRatio];
-        if (preserveAspectRatioValue != nil) {
-            preserveAspectRatio = preserveAspectRatioValue.boolValue;
-        }
-        _preserveAspectRatio = preserveAspectRatio;
+        TXImageDecodeOptions *decodeOptions = [TXImageDecodeOptions decodeOptionsWithCoderOptions:options];
+        _scale = decodeOptions.scaleFactor;
+        _thumbnailSize = decodeOptions.thumbnailPixelSize;
+        _preserveAspectRatio = decodeOptions.preserveAspectRatio;
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
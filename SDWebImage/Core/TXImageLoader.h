@@ -37,6 +37,18 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextLoader
  */
 FOUNDATION_EXPORT UIImage * _Nullable TXImageLoaderDecodeImageData(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, SDWebImageOptions options, SDWebImageContext * _Nullable context);
 
+/**
+ The same as `TXImageLoaderDecodeImageData`, but check the cancellation token at the checkpoints of the decoding process, and return nil once it's cancelled. See `TXImageCacheDecodeImageDataWithCancellationToken`.
+
+ @param imageData The image data from the network. Should not be nil
+ @param imageURL The image URL from the input. Should not be nil
+ @param options The options arg from the input
+ @param context The context arg from the input
+ @param cancellationToken The cancellation token of the load, pass nil to never bail out
+ @return The decoded image for current image data load from the network, or nil if cancelled
+ */
+FOUNDATION_EXPORT UIImage * _Nullable TXImageLoaderDecodeImageDataWithCancellationToken(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, SDWebImageOptions options, SDWebImageContext * _Nullable context, TXWebImageCancellationToken * _Nullable cancellationToken);
+
 /**
  This is the built-in decoding process for image progressive download from network. It's used when `SDWebImageProgressiveLoad` option is set. (It's not required when your loader does not support progressive image loading)
  @note If you want to implement your custom loader with `requestImageWithURL:options:context:progress:completed:` API, but also want to keep compatible with SDWebImage's behavior, you'd better use this to produce image.
@@ -118,7 +130,7 @@ FOUNDATION_EXPORT void TXImageLoaderSetProgressiveCoder(id<TXWebImageOperation>
 
 /**
  Whether the error from image loader should be marked indeed un-recoverable or not.
- If this return YES, failed URL which does not using `SDWebImageRetryFailed` will be blocked into black list. Else not.
+ If this return YES, failed URL which does not using `SDWebImageRetryFailed` will be blocked into black list until the retry time with backoff, see `TXWebImageManager.failedURLCache`. Else not.
 
  @param url The URL represent the image. Note this may not be a HTTP URL
  @param error The URL's loading error, from previous `requestImageWithURL:options:context:progress:completed:` completedBlock's error.
@@ -130,7 +142,7 @@ FOUNDATION_EXPORT void TXImageLoaderSetProgressiveCoder(id<TXWebImageOperation>
 @optional
 /**
  Whether the error from image loader should be marked indeed un-recoverable or not, with associated options and context.
- If this return YES, failed URL which does not using `SDWebImageRetryFailed` will be blocked into black list. Else not.
+ If this return YES, failed URL which does not using `SDWebImageRetryFailed` will be blocked into black list until the retry time with backoff, see `TXWebImageManager.failedURLCache`. Else not.
 
  @param url The URL represent the image. Note this may not be a HTTP URL
  @param error The URL's loading error, from previous `requestImageWithURL:options:context:progress:completed:` completedBlock's error.
@@ -10,6 +10,9 @@
 #import "TXWebImageCacheKeyFilter.h"
 #import "TXImageCodersManager.h"
 #import "TXImageCoderHelper.h"
+#import "TXImageCacheDefine.h"
+#import "TXImageDecodeOptions.h"
+#import "TXWebImageCacheKey.h"
 #import "TXAnimatedImage.h"
 #import "UIImage+Metadata.h"
 #import "TXInternalMacros.h"
@@ -18,6 +21,7 @@
 SDWebImageContextOption const SDWebImageContextLoaderCachedImage = @"loaderCachedImage";
 
 static void * TXImageLoaderProgressiveCoderKey = &TXImageLoaderProgressiveCoderKey;
+static void * TXImageLoaderProgressiveDecodeOptionsKey = &TXImageLoaderProgressiveDecodeOptionsKey;
 
 id<SDProgressiveImageCoder> TXImageLoaderGetProgressiveCoder(id<TXWebImageOperation> operation) {
     NSCParameterAssert(operation);
@@ -29,86 +33,31 @@ void TXImageLoaderSetProgressiveCoder(id<TXWebImageOperation> operation, id<SDPr
     objc_setAssociatedObject(operation, TXImageLoaderProgressiveCoderKey, progressiveCoder, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 }
 
-UIImage * _Nullable TXImageLoaderDecodeImageData(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, SDWebImageOptions options, SDWebImageContext * _Nullable context) {
-    NSCParameterAssert(imageData);
-    NSCParameterAssert(imageURL);
-    
-    UIImage *image;
+// The key to detect the scale factor, the same as the image cache key without the thumbnail and transformer
+static NSString * TXImageLoaderCacheKeyForURL(NSURL * _Nonnull imageURL, SDWebImageContext * _Nullable context) {
+    TXWebImageCacheKey *imageCacheKey = context[SDWebImageContextImageCacheKey];
+    if ([imageCacheKey isKindOfClass:TXWebImageCacheKey.class]) {
+        // Computed once by the manager
+        return imageCacheKey.URLKey;
+    }
     id<TXWebImageCacheKeyFilter> cacheKeyFilter = context[SDWebImageContextCacheKeyFilter];
-    NSString *cacheKey;
     if (cacheKeyFilter) {
-        cacheKey = [cacheKeyFilter cacheKeyForURL:imageURL];
-    } else {
-        cacheKey = imageURL.absoluteString;
-    }
-    BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
-    NSNumber *scaleValue = context[SDWebImageContextImageScaleFactor];
-    CGFloat scale = scaleValue.doubleValue >= 1 ? scaleValue.doubleValue : SDImageScaleFactorForKey(cacheKey);
-    NSNumber *preserveAspectRatioValue = context[SDWebImageContextImagePreserveAspectRatio];
-    NSValue *thumbnailSizeValue;
-    BOOL shouldScaleDown = SD_OPTIONS_CONTAINS(options, SDWebImageScaleDownLargeImages);
-    if (shouldScaleDown) {
-        CGFloat thumbnailPixels = TXImageCoderHelper.defaultScaleDownLimitBytes / 4;
-        CGFloat dimension = ceil(sqrt(thumbnailPixels));
-        thumbnailSizeValue = @(CGSizeMake(dimension, dimension));
-    }
-    if (context[SDWebImageContextImageThumbnailPixelSize]) {
-        thumbnailSizeValue = context[SDWebImageContextImageThumbnailPixelSize];
-    }
-    
-    TXImageCoderMutableOptions *mutableCoderOptions = [NSMutableDictionary dictionaryWithCapacity:2];
-    mutableCoderOptions[TXImageCoderDecodeFirstFrameOnly] = @(decodeFirstFrame);
-    mutableCoderOptions[TXImageCoderDecodeScaleFactor] = @(scale);
-    mutableCoderOptions[TXImageCoderDecodePreserveAspectRatio] = preserveAspectRatioValue;
-    mutableCoderOptions[TXImageCoderDecodeThumbnailPixelSize] = thumbnailSizeValue;
-    mutableCoderOptions[TXImageCoderWebImageContext] = context;
-    TXImageCoderOptions *coderOptions = [mutableCoderOptions copy];
-    
-    // Grab the image coder
-    id<TXImageCoder> imageCoder;
-    if ([context[SDWebImageContextImageCoder] conformsToProtocol:@protocol(TXImageCoder)]) {
-        imageCoder = context[SDWebImageContextImageCoder];
-    } else {
-        imageCoder = [TXImageCodersManager sharedManager];
-    }
-    
-    if (!decodeFirstFrame) {
-        // check whether we should use `TXAnimatedImage`
-        Class animatedImageClass = context[SDWebImageContextAnimatedImageClass];
-        if ([animatedImageClass isSubclassOfClass:[UIImage class]] && [animatedImageClass conformsToProtocol:@protocol(TXAnimatedImage)]) {
-            image = [[animatedImageClass alloc] initWithData:imageData scale:scale options:coderOptions];
-            if (image) {
-                // Preload frames if supported
-                if (options & SDWebImagePreloadAllFrames && [image respondsToSelector:@selector(preloadAllFrames)]) {
-                    [((id<TXAnimatedImage>)image) preloadAllFrames];
-                }
-            } else {
-                // Check image class matching
-                if (options & SDWebImageMatchAnimatedImageClass) {
-                    return nil;
-                }
-            }
-        }
-    }
-    if (!image) {
-        image = [imageCoder decodedImageWithData:imageData options:coderOptions];
-    }
-    if (image) {
-        BOOL shouldDecode = !SD_OPTIONS_CONTAINS(options, SDWebImageAvoidDecodeImage);
-        if ([image.class conformsToProtocol:@protocol(TXAnimatedImage)]) {
-            // `TXAnimatedImage` do not decode
-            shouldDecode = NO;
-        } else if (image.sd_isAnimated) {
-            // animated image do not decode
-            shouldDecode = NO;
-        }
-        
-        if (shouldDecode) {
-            image = [TXImageCoderHelper decodedImageWithImage:image];
-        }
+        return [cacheKeyFilter cacheKeyForURL:imageURL];
     }
+    return imageURL.absoluteString;
+}
+
+UIImage * _Nullable TXImageLoaderDecodeImageData(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, SDWebImageOptions options, SDWebImageContext * _Nullable context) {
+    return TXImageLoaderDecodeImageDataWithCancellationToken(imageData, imageURL, options, context, nil);
+}
+
+UIImage * _Nullable TXImageLoaderDecodeImageDataWithCancellationToken(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, SDWebImageOptions options, SDWebImageContext * _Nullable context, TXWebImageCancellationToken * _Nullable cancellationToken) {
+    NSCParameterAssert(imageData);
+    NSCParameterAssert(imageURL);
     
-    return image;
+    // The same decoding process as the image from cache
+    NSString *cacheKey = TXImageLoaderCacheKeyForURL(imageURL, context);
+    return TXImageCacheDecodeImageDataWithCancellationToken(imageData, cacheKey ?: @"", options, context, cancellationToken);
 }
 
 UIImage * _Nullable TXImageLoaderDecodeProgressiveImageData(NSData * _Nonnull imageData, NSURL * _Nonnull imageURL, BOOL finished,  id<TXWebImageOperation> _Nonnull operation, SDWebImageOptions options, SDWebImageContext * _Nullable context) {
@@ -117,35 +66,15 @@ UIImage * _Nullable TXImageLoaderDecodeProgressiveImageData(NSData * _Nonnull im
     NSCParameterAssert(operation);
     
     UIImage *image;
-    id<TXWebImageCacheKeyFilter> cacheKeyFilter = context[SDWebImageContextCacheKeyFilter];
-    NSString *cacheKey;
-    if (cacheKeyFilter) {
-        cacheKey = [cacheKeyFilter cacheKeyForURL:imageURL];
-    } else {
-        cacheKey = imageURL.absoluteString;
+    // The options does not change during the progressive decoding, build once for each operation
+    TXImageDecodeOptions *coderOptions = objc_getAssociatedObject(operation, TXImageLoaderProgressiveDecodeOptionsKey);
+    if (!coderOptions) {
+        NSString *cacheKey = TXImageLoaderCacheKeyForURL(imageURL, context);
+        coderOptions = [TXImageDecodeOptions decodeOptionsWithCacheKey:cacheKey options:options context:context];
+        objc_setAssociatedObject(operation, TXImageLoaderProgressiveDecodeOptionsKey, coderOptions, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
     }
-    BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
-    NSNumber *scaleValue = context[SDWebImageContextImageScaleFactor];
-    CGFloat scale = scaleValue.doubleValue >= 1 ? scaleValue.doubleValue : SDImageScaleFactorForKey(cacheKey);
-    NSNumber *preserveAspectRatioValue = context[SDWebImageContextImagePreserveAspectRatio];
-    NSValue *thumbnailSizeValue;
-    BOOL shouldScaleDown = SD_OPTIONS_CONTAINS(options, SDWebImageScaleDownLargeImages);
-    if (shouldScaleDown) {
-        CGFloat thumbnailPixels = TXImageCoderHelper.defaultScaleDownLimitBytes / 4;
-        CGFloat dimension = ceil(sqrt(thumbnailPixels));
-        thumbnailSizeValue = @(CGSizeMake(dimension, dimension));
-    }
-    if (context[SDWebImageContextImageThumbnailPixelSize]) {
-        thumbnailSizeValue = context[SDWebImageContextImageThumbnailPixelSize];
-    }
-    
-    TXImageCoderMutableOptions *mutableCoderOptions = [NSMutableDictionary dictionaryWithCapacity:2];
-    mutableCoderOptions[TXImageCoderDecodeFirstFrameOnly] = @(decodeFirstFrame);
-    mutableCoderOptions[TXImageCoderDecodeScaleFactor] = @(scale);
-    mutableCoderOptions[TXImageCoderDecodePreserveAspectRatio] = preserveAspectRatioValue;
-    mutableCoderOptions[TXImageCoderDecodeThumbnailPixelSize] = thumbnailSizeValue;
-    mutableCoderOptions[TXImageCoderWebImageContext] = context;
-    TXImageCoderOptions *coderOptions = [mutableCoderOptions copy];
+    BOOL decodeFirstFrame = coderOptions.firstFrameOnly;
+    CGFloat scale = coderOptions.scaleFactor;
     
     // Grab the progressive image coder
     id<SDProgressiveImageCoder> progressiveCoder = TXImageLoaderGetProgressiveCoder(operation);
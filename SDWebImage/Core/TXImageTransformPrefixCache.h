@@ -0,0 +1,76 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+#import "TXImageTransformer.h"
+
+@class TXImageCacheConfig;
+
+/**
+ A memory cache for the transformer chain results, used by `TXWebImageManager` to reuse the transformed images between the chains sharing a prefix.
+ The result of each requested chain (not the intermediate result inside the chain) is stored with the key of the original image and the transformer chain (built by `+[SDImagePipelineTransformer cacheKeyForTransformers:]`). A later chain starts from the longest prefix which was requested and cached before, and only the remaining transformers are applied. For example, `resize` -> `resize, round` -> `resize, round, blur` applies 3 transformers in total, instead of 6.
+ @note A single transformer (not a pipeline transformer) is treated as a chain of one transformer.
+ */
+@interface TXImageTransformPrefixCache : NSObject
+
+/**
+ The config for the memory cache. Only `maxMemoryCost`, `maxMemoryCount` and `shouldUseWeakMemoryCache` are used.
+ */
+@property (nonatomic, strong, readonly, nonnull) TXImageCacheConfig *config;
+
+/**
+ The count of transform which the whole chain is cached.
+ */
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+
+/**
+ The count of transform which a prefix of the chain is cached, so only the remaining transformers are applied.
+ */
+@property (nonatomic, assign, readonly) NSUInteger prefixHitCount;
+
+/**
+ The count of transform which nothing is cached, so the whole chain is applied.
+ */
+@property (nonatomic, assign, readonly) NSUInteger missCount;
+
+/**
+ The total count of transformers skipped by the hit and prefix hit.
+ */
+@property (nonatomic, assign, readonly) NSUInteger skippedTransformerCount;
+
+/**
+ Create the cache with the default config, the `maxMemoryCost` is limited to 32MB.
+ */
+- (nonnull instancetype)init;
+
+/**
+ Create the cache with the config.
+ */
+- (nonnull instancetype)initWithConfig:(nonnull TXImageCacheConfig *)config NS_DESIGNATED_INITIALIZER;
+
+/**
+ Transform the image, start from the longest cached prefix of the transformer chain, and store the result.
+
+ @param image The original image
+ @param transformer The transformer, or the pipeline transformer for chain
+ @param key The cache key for the original image, without any transformer key applied
+ @return The transformed image, or nil if transform failed
+ */
+- (nullable UIImage *)transformedImageWithImage:(nonnull UIImage *)image transformer:(nonnull id<TXImageTransformer>)transformer forKey:(nonnull NSString *)key;
+
+/**
+ Remove all the transformed images.
+ */
+- (void)removeAllImages;
+
+/**
+ Reset the statistics counts to 0.
+ */
+- (void)resetStatistics;
+
+@end
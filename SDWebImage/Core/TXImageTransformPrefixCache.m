@@ -0,0 +1,148 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXImageTransformPrefixCache.h"
+#import "TXImageCacheConfig.h"
+#import "TXMemoryCache.h"
+#import "UIImage+MemoryCacheCost.h"
+#import "TXInternalMacros.h"
+
+@interface TXImageTransformPrefixCache () {
+    SD_LOCK_DECLARE(_statisticsLock); // a lock to keep the access to statistics counts thread-safe
+}
+
+@property (nonatomic, strong, nonnull) TXMemoryCache<NSString *, UIImage *> *memoryCache;
+
+@end
+
+@implementation TXImageTransformPrefixCache
+
+// The transformed images are kept out of the image cache's limit, so keep them bounded by default
+static const NSUInteger kSDTransformPrefixCacheDefaultMaxMemoryCost = 32 * 1024 * 1024;
+
+- (instancetype)init {
+    TXImageCacheConfig *config = [[TXImageCacheConfig alloc] init];
+    config.maxMemoryCost = kSDTransformPrefixCacheDefaultMaxMemoryCost;
+    return [self initWithConfig:config];
+}
+
+- (instancetype)initWithConfig:(TXImageCacheConfig *)config {
+    self = [super init];
+    if (self) {
+        _config = [config copy];
+        _memoryCache = [[TXMemoryCache alloc] initWithConfig:_config];
+        _memoryCache.name = @"com.hackemist.TXImageTransformPrefixCache";
+        SD_LOCK_INIT(_statisticsLock);
+    }
+    return self;
+}
+
+#pragma mark - Transform
+
+- (UIImage *)transformedImageWithImage:(UIImage *)image transformer:(id<TXImageTransformer>)transformer forKey:(NSString *)key {
+    if (!image || !transformer || !key) {
+        return nil;
+    }
+    NSArray<id<TXImageTransformer>> *transformers;
+    if ([transformer isKindOfClass:[SDImagePipelineTransformer class]]) {
+        transformers = ((SDImagePipelineTransformer *)transformer).transformers;
+    } else {
+        transformers = @[transformer];
+    }
+    NSUInteger count = transformers.count;
+    if (count == 0) {
+        return [transformer transformedImageWithImage:image forKey:key];
+    }
+
+    // Find the longest cached prefix
+    NSString *transformedKey = SDTransformedKeyForKey(key, [SDImagePipelineTransformer cacheKeyForTransformers:transformers]);
+    UIImage *prefixImage;
+    NSUInteger prefixLength = 0;
+    for (NSUInteger length = count; length > 0; length--) {
+        NSString *prefixKey = length == count ? transformedKey : SDTransformedKeyForKey(key, [SDImagePipelineTransformer cacheKeyForTransformers:[transformers subarrayWithRange:NSMakeRange(0, length)]]);
+        prefixImage = [self.memoryCache objectForKey:prefixKey];
+        if (prefixImage) {
+            prefixLength = length;
+            break;
+        }
+    }
+
+    SD_LOCK(_statisticsLock);
+    if (prefixLength == count) {
+        _hitCount++;
+    } else if (prefixLength > 0) {
+        _prefixHitCount++;
+    } else {
+        _missCount++;
+    }
+    _skippedTransformerCount += prefixLength;
+    SD_UNLOCK(_statisticsLock);
+
+    if (prefixLength == count) {
+        return prefixImage;
+    }
+
+    UIImage *transformedImage;
+    if (prefixLength == 0) {
+        transformedImage = [transformer transformedImageWithImage:image forKey:key];
+    } else {
+        // Apply the remaining transformers, which are still fused if possible
+        NSArray<id<TXImageTransformer>> *remainingTransformers = [transformers subarrayWithRange:NSMakeRange(prefixLength, count - prefixLength)];
+        id<TXImageTransformer> remainingTransformer = remainingTransformers.count == 1 ? remainingTransformers.firstObject : [SDImagePipelineTransformer transformerWithTransformers:remainingTransformers];
+        transformedImage = [remainingTransformer transformedImageWithImage:prefixImage forKey:key];
+    }
+    if (transformedImage) {
+        [self.memoryCache setObject:transformedImage forKey:transformedKey cost:transformedImage.sd_memoryCost];
+    }
+    return transformedImage;
+}
+
+- (void)removeAllImages {
+    [self.memoryCache removeAllObjects];
+}
+
+#pragma mark - Statistics
+
+- (NSUInteger)hitCount {
+    SD_LOCK(_statisticsLock);
+    NSUInteger count = _hitCount;
+    SD_UNLOCK(_statisticsLock);
+    return count;
+}
+
+- (NSUInteger)prefixHitCount {
+    SD_LOCK(_statisticsLock);
+    NSUInteger count = _prefixHitCount;
+    SD_UNLOCK(_statisticsLock);
+    return count;
+}
+
+- (NSUInteger)missCount {
+    SD_LOCK(_statisticsLock);
+    NSUInteger count = _missCount;
+    SD_UNLOCK(_statisticsLock);
+    return count;
+}
+
+- (NSUInteger)skippedTransformerCount {
+    SD_LOCK(_statisticsLock);
+    NSUInteger count = _skippedTransformerCount;
+    SD_UNLOCK(_statisticsLock);
+    return count;
+}
+
+- (void)resetStatistics {
+    SD_LOCK(_statisticsLock);
+    _hitCount = 0;
+    _prefixHitCount = 0;
+    _missCount = 0;
+    _skippedTransformerCount = 0;
+    SD_UNLOCK(_statisticsLock);
+}
+
+@end
@@ -60,6 +60,7 @@ FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullab
 /**
  Pipeline transformer. Which you can bind multiple transformers together to let the image to be transformed one by one in order and generate the final image.
  @note Because transformers are lightweight, if you want to append or arrange transformers, create another pipeline transformer instead. This class is considered as immutable.
+ @note The adjacent built-in geometry and blending transformers (resizing, cropping, flipping, rotation, round corner, tint) are fused and rendered in one pass into one bitmap, instead of one bitmap per transformer. The other transformers (like blur, filter and custom ones) break the fusion and are applied in order as usual.
  */
 @interface SDImagePipelineTransformer : NSObject <TXImageTransformer>
 
@@ -71,6 +72,11 @@ FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullab
 - (nonnull instancetype)init NS_UNAVAILABLE;
 + (nonnull instancetype)transformerWithTransformers:(nonnull NSArray<id<TXImageTransformer>> *)transformers;
 
+/**
+ Return the transformer key for the transformers chain, which is the `transformerKey` of the pipeline transformer created with them.
+ */
++ (nonnull NSString *)cacheKeyForTransformers:(nonnull NSArray<id<TXImageTransformer>> *)transformers;
+
 @end
 
 // There are some built-in transformers based on the `UIImage+Transformer` category to provide the common image geometry, image blending and image effect process. Those transform are useful for static image only but you can create your own to support animated image as well.
@@ -218,8 +224,15 @@ FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullab
  */
 @property (nonatomic, assign, readonly) CGFloat blurRadius;
 
+/**
+ The quality/speed preset of the blur. Defaults to `SDImageBlurQualitySystem`.
+ @note Prefer `SDImageBlurQualityBalanced` for the large radius background blur, which downsamples the image before blur.
+ */
+@property (nonatomic, assign, readonly) SDImageBlurQuality quality;
+
 - (nonnull instancetype)init NS_UNAVAILABLE;
 + (nonnull instancetype)transformerWithRadius:(CGFloat)blurRadius;
++ (nonnull instancetype)transformerWithRadius:(CGFloat)blurRadius quality:(SDImageBlurQuality)quality;
 
 @end
 
@@ -8,6 +8,7 @@
 
 #import "TXImageTransformer.h"
 #import "UIColor+SDHexString.h"
+#import "TXImageTransformCanvas.h"
 #if SD_UIKIT || SD_MAC
 #import <CoreImage/CoreImage.h>
 #endif
@@ -78,15 +79,52 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
         return nil;
     }
     UIImage *transformedImage = image;
+    TXImageTransformCanvas *canvas;
+    NSMutableArray<id<TXImageTransformer>> *fusedTransformers = [NSMutableArray array];
     for (id<TXImageTransformer> transformer in self.transformers) {
+        if ([transformer conformsToProtocol:@protocol(TXImageFusibleTransformer)]) {
+            if (!canvas) {
+                // Nil for CIImage based image, which is transformed one by one
+                canvas = [[TXImageTransformCanvas alloc] initWithImage:transformedImage];
+            }
+            if (canvas && [(id<TXImageFusibleTransformer>)transformer fuseIntoCanvas:canvas]) {
+                [fusedTransformers addObject:transformer];
+                continue;
+            }
+        }
+        if (canvas) {
+            transformedImage = [self renderCanvas:canvas fusedTransformers:fusedTransformers forKey:key];
+            canvas = nil;
+            [fusedTransformers removeAllObjects];
+            if (!transformedImage) {
+                return nil;
+            }
+        }
         transformedImage = [transformer transformedImageWithImage:transformedImage forKey:key];
+        if (!transformedImage) {
+            return nil;
+        }
+    }
+    if (canvas) {
+        transformedImage = [self renderCanvas:canvas fusedTransformers:fusedTransformers forKey:key];
     }
     return transformedImage;
 }
 
+- (UIImage *)renderCanvas:(TXImageTransformCanvas *)canvas fusedTransformers:(NSArray<id<TXImageTransformer>> *)fusedTransformers forKey:(NSString *)key {
+    if (fusedTransformers.count == 0) {
+        return canvas.image;
+    } else if (fusedTransformers.count == 1) {
+        // Nothing to fuse, the transformer itself may have a cheaper way, like cropping the CGImage
+        return [fusedTransformers.firstObject transformedImageWithImage:canvas.image forKey:key];
+    } else {
+        return [canvas render];
+    }
+}
+
 @end
 
-@interface SDImageRoundCornerTransformer ()
+@interface SDImageRoundCornerTransformer () <TXImageFusibleTransformer>
 
 @property (nonatomic, assign) CGFloat cornerRadius;
 @property (nonatomic, assign) SDRectCorner corners;
@@ -118,9 +156,42 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return [image sd_roundedCornerImageWithRadius:self.cornerRadius corners:self.corners borderWidth:self.borderWidth borderColor:self.borderColor];
 }
 
+- (BOOL)fuseIntoCanvas:(TXImageTransformCanvas *)canvas {
+    // Same as `sd_roundedCornerImageWithRadius:corners:borderWidth:borderColor:`
+    CGSize size = canvas.size;
+    CGFloat scale = canvas.scale;
+    CGRect rect = CGRectMake(0, 0, size.width, size.height);
+    CGFloat cornerRadius = self.cornerRadius;
+    SDRectCorner corners = self.corners;
+    CGFloat borderWidth = self.borderWidth;
+    UIColor *borderColor = self.borderColor;
+    
+    CGFloat minSize = MIN(size.width, size.height);
+    if (borderWidth < minSize / 2) {
+        [canvas clipWithActions:^(CGContextRef  _Nonnull context) {
+            SDGraphicsClipRoundedRect(CGRectInset(rect, borderWidth, borderWidth), corners, cornerRadius);
+        }];
+    } else {
+        // The border covers the whole image
+        [canvas clipWithActions:^(CGContextRef  _Nonnull context) {
+            CGContextClipToRect(context, CGRectZero);
+        }];
+    }
+    
+    if (borderColor && borderWidth < minSize / 2 && borderWidth > 0) {
+        CGFloat strokeInset = (floor(borderWidth * scale) + 0.5) / scale;
+        CGRect strokeRect = CGRectInset(rect, strokeInset, strokeInset);
+        CGFloat strokeRadius = cornerRadius > scale / 2 ? cornerRadius - scale / 2 : 0;
+        [canvas drawWithActions:^(CGContextRef  _Nonnull context) {
+            SDGraphicsStrokeRoundedRect(strokeRect, corners, strokeRadius, borderWidth, borderColor);
+        }];
+    }
+    return YES;
+}
+
 @end
 
-@interface SDImageResizingTransformer ()
+@interface SDImageResizingTransformer () <TXImageFusibleTransformer>
 
 @property (nonatomic, assign) CGSize size;
 @property (nonatomic, assign) SDImageScaleMode scaleMode;
@@ -149,9 +220,23 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return [image sd_resizedImageWithSize:self.size scaleMode:self.scaleMode];
 }
 
+- (BOOL)fuseIntoCanvas:(TXImageTransformCanvas *)canvas {
+    CGSize size = self.size;
+    CGSize canvasSize = canvas.size;
+    if (size.width <= 0 || size.height <= 0 || canvasSize.width <= 0 || canvasSize.height <= 0) {
+        return NO;
+    }
+    // Same as `sd_resizedImageWithSize:scaleMode:`, which draws the image in the fit rect
+    CGRect drawRect = SDCGRectFitWithScaleMode(CGRectMake(0, 0, size.width, size.height), canvasSize, self.scaleMode);
+    CGAffineTransform transform = CGAffineTransformMakeScale(drawRect.size.width / canvasSize.width, drawRect.size.height / canvasSize.height);
+    transform = CGAffineTransformConcat(transform, CGAffineTransformMakeTranslation(drawRect.origin.x, drawRect.origin.y));
+    [canvas applyTransform:transform size:size];
+    return YES;
+}
+
 @end
 
-@interface SDImageCroppingTransformer ()
+@interface SDImageCroppingTransformer () <TXImageFusibleTransformer>
 
 @property (nonatomic, assign) CGRect rect;
 
@@ -178,9 +263,35 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return [image sd_croppedImageWithRect:self.rect];
 }
 
+- (BOOL)fuseIntoCanvas:(TXImageTransformCanvas *)canvas {
+    // The crop rect is in pixel, which does not match the canvas coordinate for non-up orientation
+    if (!canvas.isOrientationUp) {
+        return NO;
+    }
+    CGFloat scale = canvas.scale;
+    CGSize canvasSize = canvas.size;
+    CGRect rect = self.rect;
+    rect = CGRectMake(rect.origin.x * scale, rect.origin.y * scale, rect.size.width * scale, rect.size.height * scale);
+    if (rect.size.width <= 0 || rect.size.height <= 0) {
+        return NO;
+    }
+    // Same as `CGImageCreateWithImageInRect`
+    rect = CGRectIntegral(CGRectIntersection(rect, CGRectMake(0, 0, canvasSize.width * scale, canvasSize.height * scale)));
+    if (CGRectIsEmpty(rect)) {
+        return NO;
+    }
+    rect = CGRectMake(rect.origin.x / scale, rect.origin.y / scale, rect.size.width / scale, rect.size.height / scale);
+#if SD_MAC
+    // The pixel origin is top-left, while the context origin is bottom-left
+    rect.origin.y = canvasSize.height - CGRectGetMaxY(rect);
+#endif
+    [canvas applyTransform:CGAffineTransformMakeTranslation(-rect.origin.x, -rect.origin.y) size:rect.size];
+    return YES;
+}
+
 @end
 
-@interface SDImageFlippingTransformer ()
+@interface SDImageFlippingTransformer () <TXImageFusibleTransformer>
 
 @property (nonatomic, assign) BOOL horizontal;
 @property (nonatomic, assign) BOOL vertical;
@@ -208,9 +319,31 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return [image sd_flippedImageWithHorizontal:self.horizontal vertical:self.vertical];
 }
 
+- (BOOL)fuseIntoCanvas:(TXImageTransformCanvas *)canvas {
+    // Same as `sd_flippedImageWithHorizontal:vertical:`, which draws the image in the integral size
+    CGSize canvasSize = canvas.size;
+    size_t width = canvasSize.width;
+    size_t height = canvasSize.height;
+    if (width == 0 || height == 0) {
+        return NO;
+    }
+    CGAffineTransform transform = CGAffineTransformMakeScale(width / canvasSize.width, height / canvasSize.height);
+    // Use UIKit coordinate system
+    if (self.vertical) {
+        CGAffineTransform flipVertical = CGAffineTransformMake(1, 0, 0, -1, 0, height);
+        transform = CGAffineTransformConcat(transform, flipVertical);
+    }
+    if (self.horizontal) {
+        CGAffineTransform flipHorizontal = CGAffineTransformMake(-1, 0, 0, 1, width, 0);
+        transform = CGAffineTransformConcat(transform, flipHorizontal);
+    }
+    [canvas applyTransform:transform size:canvasSize];
+    return YES;
+}
+
 @end
 
-@interface SDImageRotationTransformer ()
+@interface SDImageRotationTransformer () <TXImageFusibleTransformer>
 
 @property (nonatomic, assign) CGFloat angle;
 @property (nonatomic, assign) BOOL fitSize;
@@ -238,11 +371,35 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return [image sd_rotatedImageWithAngle:self.angle fitSize:self.fitSize];
 }
 
+- (BOOL)fuseIntoCanvas:(TXImageTransformCanvas *)canvas {
+    // Same as `sd_rotatedImageWithAngle:fitSize:`
+    CGSize canvasSize = canvas.size;
+    size_t width = canvasSize.width;
+    size_t height = canvasSize.height;
+    if (width == 0 || height == 0) {
+        return NO;
+    }
+    CGFloat angle = self.angle;
+    CGRect newRect = CGRectApplyAffineTransform(CGRectMake(0, 0, width, height),
+                                                self.fitSize ? CGAffineTransformMakeRotation(angle) : CGAffineTransformIdentity);
+    CGAffineTransform transform = CGAffineTransformMakeScale(width / canvasSize.width, height / canvasSize.height);
+    transform = CGAffineTransformConcat(transform, CGAffineTransformMakeTranslation(-(width * 0.5), -(height * 0.5)));
+#if SD_UIKIT || SD_WATCH
+    // Use UIKit coordinate system counterclockwise (⟲)
+    transform = CGAffineTransformConcat(transform, CGAffineTransformMakeRotation(-angle));
+#else
+    transform = CGAffineTransformConcat(transform, CGAffineTransformMakeRotation(angle));
+#endif
+    transform = CGAffineTransformConcat(transform, CGAffineTransformMakeTranslation(+(newRect.size.width * 0.5), +(newRect.size.height * 0.5)));
+    [canvas applyTransform:transform size:newRect.size];
+    return YES;
+}
+
 @end
 
 #pragma mark - Image Blending
 
-@interface SDImageTintTransformer ()
+@interface SDImageTintTransformer () <TXImageFusibleTransformer>
 
 @property (nonatomic, strong, nonnull) UIColor *tintColor;
 
@@ -268,6 +425,22 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return [image sd_tintedImageWithColor:self.tintColor];
 }
 
+- (BOOL)fuseIntoCanvas:(TXImageTransformCanvas *)canvas {
+    UIColor *tintColor = self.tintColor;
+    BOOL hasTint = CGColorGetAlpha(tintColor.CGColor) > __FLT_EPSILON__;
+    if (!hasTint) {
+        return YES;
+    }
+    // Same as `sd_tintedImageWithColor:`, fill over the content drawn before
+    CGSize size = canvas.size;
+    [canvas drawWithActions:^(CGContextRef  _Nonnull context) {
+        CGContextSetBlendMode(context, kCGBlendModeSourceAtop);
+        CGContextSetFillColorWithColor(context, tintColor.CGColor);
+        CGContextFillRect(context, CGRectMake(0, 0, size.width, size.height));
+    }];
+    return YES;
+}
+
 @end
 
 #pragma mark - Image Effect
@@ -275,27 +448,36 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
 @interface SDImageBlurTransformer ()
 
 @property (nonatomic, assign) CGFloat blurRadius;
+@property (nonatomic, assign) SDImageBlurQuality quality;
 
 @end
 
 @implementation SDImageBlurTransformer
 
 + (instancetype)transformerWithRadius:(CGFloat)blurRadius {
+    return [self transformerWithRadius:blurRadius quality:SDImageBlurQualitySystem];
+}
+
++ (instancetype)transformerWithRadius:(CGFloat)blurRadius quality:(SDImageBlurQuality)quality {
     SDImageBlurTransformer *transformer = [SDImageBlurTransformer new];
     transformer.blurRadius = blurRadius;
+    transformer.quality = quality;
     
     return transformer;
 }
 
 - (NSString *)transformerKey {
-    return [NSString stringWithFormat:@"SDImageBlurTransformer(%f)", self.blurRadius];
+    if (self.quality == SDImageBlurQualitySystem) {
+        return [NSString stringWithFormat:@"SDImageBlurTransformer(%f)", self.blurRadius];
+    }
+    return [NSString stringWithFormat:@"SDImageBlurTransformer(%f,%lu)", self.blurRadius, (unsigned long)self.quality];
 }
 
 - (UIImage *)transformedImageWithImage:(UIImage *)image forKey:(NSString *)key {
     if (!image) {
         return nil;
     }
-    return [image sd_blurredImageWithRadius:self.blurRadius];
+    return [image sd_blurredImageWithRadius:self.blurRadius quality:self.quality];
 }
 
 @end
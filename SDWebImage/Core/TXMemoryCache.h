@@ -9,6 +9,7 @@
 #import "TXWebImageCompat.h"
 
 @class TXImageCacheConfig;
+@class TXImageCacheTierStatistics;
 /**
  A protocol to allow custom memory cache used in TXImageCache.
  */
@@ -75,4 +76,10 @@
 
 @property (nonatomic, strong, nonnull, readonly) TXImageCacheConfig *config;
 
+/**
+ The statistics to record the eviction (by the cost/count limit or memory warning), set by `TXImageCache` when `shouldRecordStatistics` is enabled. Defaults to nil.
+ @note When set, the cache becomes its own `delegate` to get the eviction callback. If you set another delegate, the eviction is not recorded.
+ */
+@property (nonatomic, strong, nullable) TXImageCacheTierStatistics *statistics;
+
 @end
@@ -10,10 +10,13 @@
 #import "TXImageCacheConfig.h"
 #import "UIImage+MemoryCacheCost.h"
 #import "TXInternalMacros.h"
+#import "TXImageCacheStatistics.h"
 
 static void * TXMemoryCacheContext = &TXMemoryCacheContext;
+// Whether the current thread is removing the object explicitly, `NSCache` calls `cache:willEvictObject:` for that as well, which should not be recorded as eviction
+static __thread BOOL TXMemoryCacheIsRemoving = NO;
 
-@interface TXMemoryCache <KeyType, ObjectType> () {
+@interface TXMemoryCache <KeyType, ObjectType> () <NSCacheDelegate> {
 #if SD_UIKIT
     SD_LOCK_DECLARE(_weakCacheLock); // a lock to keep the access to `weakCache` thread-safe
 #endif
@@ -73,6 +76,27 @@ static void * TXMemoryCacheContext = &TXMemoryCacheContext;
 #endif
 }
 
+- (void)setStatistics:(TXImageCacheTierStatistics *)statistics {
+    _statistics = statistics;
+    if (statistics) {
+        self.delegate = self;
+    }
+}
+
+#pragma mark - NSCacheDelegate
+
+- (void)cache:(NSCache *)cache willEvictObject:(id)obj {
+    TXImageCacheTierStatistics *statistics = self.statistics;
+    if (!statistics || TXMemoryCacheIsRemoving) {
+        return;
+    }
+    NSUInteger cost = 0;
+    if ([obj isKindOfClass:[UIImage class]]) {
+        cost = [(UIImage *)obj sd_memoryCost];
+    }
+    [statistics recordEvictionWithCount:1 bytes:cost];
+}
+
 // Current this seems no use on macOS (macOS use virtual memory and do not clear cache when memory warning). So we only override on iOS/tvOS platform.
 #if SD_UIKIT
 - (void)didReceiveMemoryWarning:(NSNotification *)notification {
@@ -115,9 +139,13 @@ static void * TXMemoryCacheContext = &TXMemoryCacheContext;
     }
     return obj;
 }
+#endif
 
 - (void)removeObjectForKey:(id)key {
+    TXMemoryCacheIsRemoving = YES;
     [super removeObjectForKey:key];
+    TXMemoryCacheIsRemoving = NO;
+#if SD_UIKIT
     if (!self.config.shouldUseWeakMemoryCache) {
         return;
     }
@@ -127,10 +155,14 @@ static void * TXMemoryCacheContext = &TXMemoryCacheContext;
         [self.weakCache removeObjectForKey:key];
         SD_UNLOCK(_weakCacheLock);
     }
+#endif
 }
 
 - (void)removeAllObjects {
+    TXMemoryCacheIsRemoving = YES;
     [super removeAllObjects];
+    TXMemoryCacheIsRemoving = NO;
+#if SD_UIKIT
     if (!self.config.shouldUseWeakMemoryCache) {
         return;
     }
@@ -138,8 +170,8 @@ static void * TXMemoryCacheContext = &TXMemoryCacheContext;
     SD_LOCK(_weakCacheLock);
     [self.weakCache removeAllObjects];
     SD_UNLOCK(_weakCacheLock);
-}
 #endif
+}
 
 #pragma mark - KVO
 
@@ -0,0 +1,50 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+#import "TXAnimatedImage.h"
+#import "TXImageTransformer.h"
+
+/**
+ The animated image which applies the transformer to each frame of another animated image provider lazily.
+ The frame is transformed on demand inside `animatedImageFrameAtIndex:` (on the fetch thread of `TXAnimatedImagePlayer`) and it is not kept by this class, the player's frame buffer caches the transformed frames as the normal decoded frames. So the animation is preserved, and the transform cost is paid only for the frames actually shown.
+ The poster image (the `CGImage` of this image) is the transformed first frame.
+ @note `TXWebImageManager` uses this class for the animated image (the image class conforms to `TXAnimatedImage`) when `SDWebImageTransformAnimatedImage` is set.
+ @note The transformed frames have no encoded data, so `animatedImageData` is nil. `TXWebImageManager` stores this image to memory cache only, the disk cache keeps the original data under the original key, which is transformed lazily again on the next load. Encoding it explicitly (like `framesFromAnimatedImage:`) transforms all the frames.
+ @note The memory cost includes the poster frame, and the provider's encoded data and decoded frames, which are retained by this image.
+ @note The transformer should be thread-safe if the provider decodes frames from multiple threads (see `animatedImageFrameThreadSafe`), the built-in transformers are.
+ */
+@interface TXTransformedAnimatedImage : UIImage <TXAnimatedImage>
+
+/**
+ The animated image provider for the original frames. Nil if the image is decoded from `NSCoder`, which only keeps the poster image.
+ */
+@property (nonatomic, strong, readonly, nullable) id<TXAnimatedImageProvider> provider;
+
+/**
+ The transformer applied to each frame. Nil means the original frames are returned.
+ */
+@property (nonatomic, strong, readonly, nullable) id<TXImageTransformer> transformer;
+
+/**
+ The cache key passed to the transformer.
+ */
+@property (nonatomic, copy, readonly, nullable) NSString *key;
+
+/**
+ Create the image with the provider and transformer. The first frame is transformed immediately for the poster image.
+
+ @param provider The animated image provider, like `TXAnimatedImage`
+ @param transformer The transformer, or the pipeline transformer for chain
+ @param key The cache key passed to the transformer
+ @return The image, or nil if the first frame is not available or the transform failed
+ */
+- (nullable instancetype)initWithProvider:(nonnull id<TXAnimatedImageProvider>)provider transformer:(nullable id<TXImageTransformer>)transformer key:(nullable NSString *)key;
++ (nullable instancetype)imageWithProvider:(nonnull id<TXAnimatedImageProvider>)provider transformer:(nullable id<TXImageTransformer>)transformer key:(nullable NSString *)key;
+
+@end
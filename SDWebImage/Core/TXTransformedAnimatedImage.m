@@ -0,0 +1,183 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXTransformedAnimatedImage.h"
+#import "NSImage+Compatibility.h"
+#import "UIImage+MemoryCacheCost.h"
+#import "UIImage+Metadata.h"
+#import "objc/runtime.h"
+
+@interface TXTransformedAnimatedImage ()
+
+@property (nonatomic, strong, readwrite, nullable) id<TXAnimatedImageProvider> provider;
+@property (nonatomic, strong, readwrite, nullable) id<TXImageTransformer> transformer;
+@property (nonatomic, copy, readwrite, nullable) NSString *key;
+
+@end
+
+@implementation TXTransformedAnimatedImage
+
++ (instancetype)imageWithProvider:(id<TXAnimatedImageProvider>)provider transformer:(id<TXImageTransformer>)transformer key:(NSString *)key {
+    return [[self alloc] initWithProvider:provider transformer:transformer key:key];
+}
+
+- (instancetype)initWithProvider:(id<TXAnimatedImageProvider>)provider transformer:(id<TXImageTransformer>)transformer key:(NSString *)key {
+    if (!provider) {
+        return nil;
+    }
+    UIImage *image = [provider animatedImageFrameAtIndex:0];
+    if (!image && [provider isKindOfClass:[UIImage class]]) {
+        // `TXAnimatedImage` returns nil frame when frame count <= 1, use itself instead
+        image = (UIImage *)provider;
+    }
+    if (!image) {
+        return nil;
+    }
+    if (transformer) {
+        image = [transformer transformedImageWithImage:image forKey:key ?: @""];
+    }
+    CGImageRef imageRef = image.CGImage;
+    if (!imageRef) {
+        return nil;
+    }
+#if SD_MAC
+    self = [super initWithCGImage:imageRef scale:MAX(image.scale, 1) orientation:kCGImagePropertyOrientationUp];
+#else
+    self = [super initWithCGImage:imageRef scale:MAX(image.scale, 1) orientation:image.imageOrientation];
+#endif
+    if (self) {
+        _provider = provider;
+        _transformer = transformer;
+        _key = [key copy];
+    }
+    return self;
+}
+
+#pragma mark - TXAnimatedImage
+
+- (instancetype)initWithData:(NSData *)data scale:(CGFloat)scale options:(TXImageCoderOptions *)options {
+    TXAnimatedImage *animatedImage = [[TXAnimatedImage alloc] initWithData:data scale:scale options:options];
+    if (!animatedImage) {
+        return nil;
+    }
+    return [self initWithProvider:animatedImage transformer:nil key:nil];
+}
+
+- (instancetype)initWithAnimatedCoder:(id<TXAnimatedImageCoder>)animatedCoder scale:(CGFloat)scale {
+    TXAnimatedImage *animatedImage = [[TXAnimatedImage alloc] initWithAnimatedCoder:animatedCoder scale:scale];
+    if (!animatedImage) {
+        return nil;
+    }
+    return [self initWithProvider:animatedImage transformer:nil key:nil];
+}
+
+#pragma mark - TXAnimatedImageProvider
+
+- (NSData *)animatedImageData {
+    // The transformed frames can not be represented by the original data
+    if (!self.transformer) {
+        return self.provider.animatedImageData;
+    }
+    return nil;
+}
+
+- (NSUInteger)animatedImageFrameCount {
+    return self.provider.animatedImageFrameCount;
+}
+
+- (NSUInteger)animatedImageLoopCount {
+    return self.provider.animatedImageLoopCount;
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
+    UIImage *image = [self.provider animatedImageFrameAtIndex:index];
+    if (!image) {
+        return nil;
+    }
+    id<TXImageTransformer> transformer = self.transformer;
+    if (!transformer) {
+        return image;
+    }
+    // Not cached here, the player's frame buffer keeps the frame if need
+    return [transformer transformedImageWithImage:image forKey:self.key ?: @""];
+}
+
+- (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
+    return [self.provider animatedImageDurationAtIndex:index];
+}
+
+- (BOOL)animatedImageFrameThreadSafe {
+    id<TXAnimatedImageProvider> provider = self.provider;
+    if ([provider respondsToSelector:@selector(animatedImageFrameThreadSafe)]) {
+        return provider.animatedImageFrameThreadSafe;
+    }
+    return NO;
+}
+
+@end
+
+@implementation TXTransformedAnimatedImage (MemoryCacheCost)
+
+- (NSUInteger)sd_memoryCost {
+    NSNumber *value = objc_getAssociatedObject(self, @selector(sd_memoryCost));
+    if (value != nil) {
+        return value.unsignedIntegerValue;
+    }
+
+    // The transformed poster frame, the other frames are transformed on demand
+    NSUInteger cost = 0;
+    CGImageRef imageRef = self.CGImage;
+    if (imageRef) {
+        cost += CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+    }
+    // The provider is retained, which keeps the encoded data and the decoded frames (like the preloaded frames of `TXAnimatedImage`)
+    id<TXAnimatedImageProvider> provider = self.provider;
+    cost += provider.animatedImageData.length;
+    if ([provider isKindOfClass:[UIImage class]]) {
+        cost += ((UIImage *)provider).sd_memoryCost;
+    }
+    return cost;
+}
+
+@end
+
+@implementation TXTransformedAnimatedImage (Metadata)
+
+- (BOOL)sd_isAnimated {
+    return self.animatedImageFrameCount > 1;
+}
+
+- (NSUInteger)sd_imageLoopCount {
+    return self.animatedImageLoopCount;
+}
+
+- (void)setSd_imageLoopCount:(NSUInteger)sd_imageLoopCount {
+    return;
+}
+
+- (NSUInteger)sd_imageFrameCount {
+    return self.animatedImageFrameCount;
+}
+
+- (SDImageFormat)sd_imageFormat {
+    id<TXAnimatedImageProvider> provider = self.provider;
+    if ([provider isKindOfClass:[UIImage class]]) {
+        return ((UIImage *)provider).sd_imageFormat;
+    }
+    return SDImageFormatUndefined;
+}
+
+- (void)setSd_imageFormat:(SDImageFormat)sd_imageFormat {
+    return;
+}
+
+- (BOOL)sd_isVector {
+    return NO;
+}
+
+@end
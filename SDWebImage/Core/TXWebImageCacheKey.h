@@ -0,0 +1,50 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+
+/**
+ The cache key of an image request, built from the components: the key of the URL (after the cache key filter), the thumbnail pixel size and the transformer key.
+ The instances are interned: `cacheKeyWithURLKey:thumbnailPixelSize:preserveAspectRatio:transformerKey:` returns the same instance for the same components, so the string form (`SDThumbnailedKeyForKey` and `SDTransformedKeyForKey`, which parse the URL), the hash and the disk file name (XXH3) are computed once and reused by the later requests.
+ `TXWebImageManager` creates it once per request and passes it to the image cache and image loader with `SDWebImageContextImageCacheKey`, and `TXImageCache` passes the memoized file name to `TXDiskCache`.
+ @note The intern table is a `NSCache` of at most 4096 keys, which evicts some keys when full instead of resetting all of them. This class is immutable and thread-safe.
+ */
+@interface TXWebImageCacheKey : NSObject <NSCopying>
+
+/// The key of the URL, from the cache key filter or the URL's absolute string
+@property (nonatomic, copy, readonly, nonnull) NSString *URLKey;
+/// The thumbnail pixel size, `CGSizeZero` means no thumbnail
+@property (nonatomic, assign, readonly) CGSize thumbnailPixelSize;
+/// Whether to preserve the aspect ratio for the thumbnail, always YES if no thumbnail
+@property (nonatomic, assign, readonly) BOOL preserveAspectRatio;
+/// The transformer key, nil means no transformer
+@property (nonatomic, copy, readonly, nullable) NSString *transformerKey;
+
+/// The string form, the same as `-[TXWebImageManager cacheKeyForURL:context:]` used for the image cache
+@property (nonatomic, copy, readonly, nonnull) NSString *stringValue;
+/// The 64-bit FNV-1a hash of the components
+@property (nonatomic, assign, readonly) uint64_t hash64;
+/// The key without the transformer, which is used to cache the original image. Self if no transformer.
+@property (nonatomic, strong, readonly, nonnull) TXWebImageCacheKey *originalKey;
+/// The file name in `TXDiskCache`, computed on first access
+@property (nonatomic, copy, readonly, nonnull) NSString *diskFileName;
+
+/**
+ Return the interned cache key for the components.
+
+ @param URLKey The key of the URL
+ @param thumbnailPixelSize The thumbnail pixel size, `CGSizeZero` means no thumbnail
+ @param preserveAspectRatio Whether to preserve the aspect ratio for the thumbnail
+ @param transformerKey The transformer key, nil means no transformer
+ @return The cache key
+ */
++ (nonnull instancetype)cacheKeyWithURLKey:(nonnull NSString *)URLKey thumbnailPixelSize:(CGSize)thumbnailPixelSize preserveAspectRatio:(BOOL)preserveAspectRatio transformerKey:(nullable NSString *)transformerKey;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
@@ -0,0 +1,169 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCacheKey.h"
+#import "TXImageTransformer.h"
+#import "TXDiskCache.h"
+#import "TXInternalMacros.h"
+
+// The max count of interned keys, NSCache evicts some keys when full instead of resetting the whole table
+static const NSUInteger kSDWebImageCacheKeyInternLimit = 4096;
+
+#define SD_FNV1A_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define SD_FNV1A_PRIME 0x100000001b3ULL
+
+static inline uint64_t SDFNV1aAppendBytes(uint64_t hash, const void *bytes, size_t length) {
+    const uint8_t *p = bytes;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= SD_FNV1A_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t SDFNV1aAppendString(uint64_t hash, NSString *string) {
+    // Hash the UTF-16 code units in chunks, without creating the UTF-8 copy
+    unichar buffer[64];
+    NSUInteger length = string.length;
+    for (NSUInteger location = 0; location < length; location += 64) {
+        NSUInteger count = MIN(64, length - location);
+        [string getCharacters:buffer range:NSMakeRange(location, count)];
+        hash = SDFNV1aAppendBytes(hash, buffer, count * sizeof(unichar));
+    }
+    // Separator, so the components do not collide by moving characters between them
+    uint8_t separator = 0xFF;
+    return SDFNV1aAppendBytes(hash, &separator, 1);
+}
+
+SD_LOCK_DECLARE_STATIC(_internTableLock);
+
+@interface TXWebImageCacheKey ()
+
+@property (nonatomic, copy, readwrite, nonnull) NSString *stringValue;
+@property (nonatomic, strong, readwrite, nonnull) TXWebImageCacheKey *originalKey;
+@property (atomic, copy, nullable) NSString *cachedDiskFileName;
+
+@end
+
+@implementation TXWebImageCacheKey
+
++ (NSCache<TXWebImageCacheKey *, TXWebImageCacheKey *> *)internTable {
+    static NSCache<TXWebImageCacheKey *, TXWebImageCacheKey *> *internTable;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        SD_LOCK_INIT(_internTableLock);
+        internTable = [[NSCache alloc] init];
+        internTable.name = @"com.hackemist.TXWebImageCacheKey";
+        internTable.countLimit = kSDWebImageCacheKeyInternLimit;
+    });
+    return internTable;
+}
+
+- (instancetype)initWithURLKey:(NSString *)URLKey thumbnailPixelSize:(CGSize)thumbnailPixelSize preserveAspectRatio:(BOOL)preserveAspectRatio transformerKey:(NSString *)transformerKey {
+    self = [super init];
+    if (self) {
+        BOOL hasThumbnail = !CGSizeEqualToSize(thumbnailPixelSize, CGSizeZero);
+        _URLKey = [URLKey copy];
+        _thumbnailPixelSize = hasThumbnail ? thumbnailPixelSize : CGSizeZero;
+        _preserveAspectRatio = hasThumbnail ? preserveAspectRatio : YES;
+        _transformerKey = [transformerKey copy];
+
+        uint64_t hash = SD_FNV1A_OFFSET_BASIS;
+        hash = SDFNV1aAppendString(hash, _URLKey);
+        if (hasThumbnail) {
+            double components[2] = {_thumbnailPixelSize.width, _thumbnailPixelSize.height};
+            hash = SDFNV1aAppendBytes(hash, components, sizeof(components));
+            hash = SDFNV1aAppendBytes(hash, &_preserveAspectRatio, sizeof(_preserveAspectRatio));
+        }
+        if (_transformerKey) {
+            hash = SDFNV1aAppendString(hash, _transformerKey);
+        }
+        _hash64 = hash;
+    }
+    return self;
+}
+
++ (instancetype)cacheKeyWithURLKey:(NSString *)URLKey thumbnailPixelSize:(CGSize)thumbnailPixelSize preserveAspectRatio:(BOOL)preserveAspectRatio transformerKey:(NSString *)transformerKey {
+    NSParameterAssert(URLKey);
+    TXWebImageCacheKey *lookupKey = [[self alloc] initWithURLKey:URLKey thumbnailPixelSize:thumbnailPixelSize preserveAspectRatio:preserveAspectRatio transformerKey:transformerKey];
+    NSCache<TXWebImageCacheKey *, TXWebImageCacheKey *> *internTable = [self internTable];
+    // NSCache is thread-safe, the lock only makes the check-and-insert below atomic
+    TXWebImageCacheKey *cacheKey = [internTable objectForKey:lookupKey];
+    if (cacheKey) {
+        return cacheKey;
+    }
+
+    // Build the string form once, outside the lock because it parses the URL
+    cacheKey = lookupKey;
+    NSString *key = cacheKey.URLKey;
+    if (!CGSizeEqualToSize(cacheKey.thumbnailPixelSize, CGSizeZero)) {
+        key = SDThumbnailedKeyForKey(key, cacheKey.thumbnailPixelSize, cacheKey.preserveAspectRatio);
+    }
+    if (cacheKey.transformerKey) {
+        cacheKey.originalKey = [self cacheKeyWithURLKey:URLKey thumbnailPixelSize:thumbnailPixelSize preserveAspectRatio:preserveAspectRatio transformerKey:nil];
+        key = SDTransformedKeyForKey(key, cacheKey.transformerKey);
+    } else {
+        cacheKey.originalKey = cacheKey;
+    }
+    cacheKey.stringValue = key ?: @"";
+
+    SD_LOCK(_internTableLock);
+    TXWebImageCacheKey *internedKey = [internTable objectForKey:cacheKey];
+    if (internedKey) {
+        // Interned by another thread
+        cacheKey = internedKey;
+    } else {
+        [internTable setObject:cacheKey forKey:cacheKey];
+    }
+    SD_UNLOCK(_internTableLock);
+    return cacheKey;
+}
+
+- (NSString *)diskFileName {
+    // Benign race, the same value may be computed twice
+    NSString *diskFileName = self.cachedDiskFileName;
+    if (!diskFileName) {
+        diskFileName = TXDiskCacheFileNameForKey(self.stringValue);
+        self.cachedDiskFileName = diskFileName;
+    }
+    return diskFileName;
+}
+
+#pragma mark - NSObject
+
+- (NSUInteger)hash {
+    return (NSUInteger)self.hash64;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+    if (![object isKindOfClass:TXWebImageCacheKey.class]) {
+        return NO;
+    }
+    TXWebImageCacheKey *other = object;
+    if (self.hash64 != other.hash64) {
+        return NO;
+    }
+    return [self.URLKey isEqualToString:other.URLKey]
+        && CGSizeEqualToSize(self.thumbnailPixelSize, other.thumbnailPixelSize)
+        && self.preserveAspectRatio == other.preserveAspectRatio
+        && (self.transformerKey == other.transformerKey || [self.transformerKey isEqualToString:other.transformerKey]);
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    // Immutable
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, key: %@>", self.class, self, self.stringValue];
+}
+
+@end
@@ -313,6 +313,22 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextDownlo
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextDownloadDecryptor;
 
+/**
+ A NSNumber instance bridged from BOOL. If YES, the downloader does not decode the downloaded image, the completion block is called with the image data only and a nil image. This is used by the disk-only prefetching of `TXWebImagePrefetcher`. Defaults to NO. (NSNumber)
+ @note If another request without this option reuses the same download operation, the image is decoded as usual.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextDownloadDataOnly;
+
+/**
+ A TXWebImageTimeline instance to record the stages of the image request. This is set by `TXWebImageManager` when it has a `timelineObserver`, you don't need to set it manually. The image cache and image loader record the stages into it if available. (TXWebImageTimeline)
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextTimeline;
+
+/**
+ A TXWebImageCacheKey instance of the image request, which memoizes the cache key string, hash and disk file name. This is set by `TXWebImageManager` for each request, you don't need to set it manually. The image cache and image loader can use it instead of computing the cache key again. (TXWebImageCacheKey)
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageCacheKey;
+
 /**
  A id<TXWebImageCacheKeyFilter> instance to convert an URL into a cache key. It's used when manager need cache key to use image cache. If you provide one, it will ignore the `cacheKeyFilter` in manager and use provided one instead. (id<TXWebImageCacheKeyFilter>)
  */
@@ -142,5 +142,8 @@ SDWebImageContextOption const SDWebImageContextAnimatedImageClass = @"animatedIm
 SDWebImageContextOption const SDWebImageContextDownloadRequestModifier = @"downloadRequestModifier";
 SDWebImageContextOption const SDWebImageContextDownloadResponseModifier = @"downloadResponseModifier";
 SDWebImageContextOption const SDWebImageContextDownloadDecryptor = @"downloadDecryptor";
+SDWebImageContextOption const SDWebImageContextDownloadDataOnly = @"downloadDataOnly";
+SDWebImageContextOption const SDWebImageContextTimeline = @"timeline";
+SDWebImageContextOption const SDWebImageContextImageCacheKey = @"imageCacheKey";
 SDWebImageContextOption const SDWebImageContextCacheKeyFilter = @"cacheKeyFilter";
 SDWebImageContextOption const SDWebImageContextCacheSerializer = @"cacheSerializer";
@@ -188,6 +188,16 @@ typedef TXImageLoaderCompletedBlock TXWebImageDownloaderCompletedBlock;
  */
 @property (nonatomic, assign, readonly) NSUInteger currentDownloadCount;
 
+/**
+ * Shows the current amount of foreground downloads, which are not finished and not in low priority (`TXWebImageDownloaderLowPriority`), like the prefetching.
+ */
+@property (nonatomic, assign, readonly) NSUInteger currentForegroundDownloadCount;
+
+/**
+ * Shows the current amount of foreground downloads which are still waiting in the queue, because the `maxConcurrentDownloads` limit is reached or the queue is suspended.
+ */
+@property (nonatomic, assign, readonly) NSUInteger pendingForegroundDownloadCount;
+
 /**
  *  Returns the global shared downloader instance. Which use the `TXWebImageDownloaderConfig.defaultDownloaderConfig` config.
  */
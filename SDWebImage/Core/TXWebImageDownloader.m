@@ -239,6 +239,10 @@ static void * TXWebImageDownloaderContext = &TXWebImageDownloaderContext;
         // So we lock the operation here, and in `TXWebImageDownloaderOperation`, we use `@synchonzied (self)`, to ensure the thread safe between these two classes.
         @synchronized (operation) {
             downloadOperationCancelToken = [operation addHandlersForProgress:progressBlock completed:completedBlock];
+            if (![context[SDWebImageContextDownloadDataOnly] boolValue] && [operation isKindOfClass:[TXWebImageDownloaderOperation class]]) {
+                // The new request needs the decoded image
+                ((TXWebImageDownloaderOperation *)operation).dataOnly = NO;
+            }
         }
         if (!operation.isExecuting) {
             if (options & TXWebImageDownloaderHighPriority) {
@@ -393,6 +397,26 @@ static void * TXWebImageDownloaderContext = &TXWebImageDownloaderContext;
     return self.downloadQueue.operationCount;
 }
 
+- (NSUInteger)currentForegroundDownloadCount {
+    NSUInteger count = 0;
+    for (NSOperation *operation in self.downloadQueue.operations) {
+        if (!operation.isFinished && !operation.isCancelled && operation.queuePriority > NSOperationQueuePriorityLow) {
+            count++;
+        }
+    }
+    return count;
+}
+
+- (NSUInteger)pendingForegroundDownloadCount {
+    NSUInteger count = 0;
+    for (NSOperation *operation in self.downloadQueue.operations) {
+        if (!operation.isExecuting && !operation.isFinished && !operation.isCancelled && operation.queuePriority > NSOperationQueuePriorityLow) {
+            count++;
+        }
+    }
+    return count;
+}
+
 - (NSURLSessionConfiguration *)sessionConfiguration {
     return self.session.configuration;
 }
@@ -619,6 +643,11 @@ didReceiveResponse:(NSURLResponse *)response
     if ([error.domain isEqualToString:TXWebImageErrorDomain]) {
         shouldBlockFailedURL = (   error.code == TXWebImageErrorInvalidURL
                                 || error.code == TXWebImageErrorBadImageData);
+        if (error.code == TXWebImageErrorInvalidDownloadStatusCode) {
+            // Too many requests or server error, the failed URL is blocked with backoff (or `Retry-After`) to not hammer the origin
+            NSInteger statusCode = [error.userInfo[TXWebImageErrorDownloadStatusCodeKey] integerValue];
+            shouldBlockFailedURL = (statusCode == 429 || statusCode >= 500);
+        }
     } else if ([error.domain isEqualToString:NSURLErrorDomain]) {
         shouldBlockFailedURL = (   error.code != NSURLErrorNotConnectedToInternet
                                 && error.code != NSURLErrorCancelled
@@ -114,6 +114,12 @@
  */
 @property (copy, nonatomic, readonly, nullable) SDWebImageContext *context;
 
+/**
+ * Whether to skip decoding the downloaded image, the completion blocks are called with the image data only. Defaults to the `SDWebImageContextDownloadDataOnly` value of context.
+ * @note The downloader sets it to NO when a request without `SDWebImageContextDownloadDataOnly` reuses this operation.
+ */
+@property (assign, atomic) BOOL dataOnly;
+
 /**
  *  Initializes a `TXWebImageDownloaderOperation` object
  *
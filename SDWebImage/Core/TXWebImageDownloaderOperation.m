@@ -11,6 +11,7 @@
 #import "TXInternalMacros.h"
 #import "TXWebImageDownloaderResponseModifier.h"
 #import "TXWebImageDownloaderDecryptor.h"
+#import "TXWebImageTimeline.h"
 
 static NSString *const kProgressCallbackKey = @"progress";
 static NSString *const kCompletedCallbackKey = @"completed";
@@ -36,6 +37,7 @@ typedef NSMutableDictionary<NSString *, id> SDCallbacksDictionary;
 
 @property (strong, nonatomic, nullable) id<TXWebImageDownloaderResponseModifier> responseModifier; // modify original URLResponse
 @property (strong, nonatomic, nullable) id<TXWebImageDownloaderDecryptor> decryptor; // decrypt image data
+@property (strong, nonatomic, nullable) TXWebImageTimeline *timeline; // record the stages of the request which creates this operation
 
 // This is weak because it is injected by whoever manages this session. If this gets nil-ed out, we won't be able to run
 // the task associated with this operation
@@ -48,6 +50,7 @@ typedef NSMutableDictionary<NSString *, id> SDCallbacksDictionary;
 @property (strong, nonatomic, readwrite, nullable) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macosx(10.12), ios(10.0), watchos(3.0), tvos(10.0));
 
 @property (strong, nonatomic, nonnull) NSOperationQueue *coderQueue; // the serial operation queue to do image decoding
+@property (strong, nonatomic, nonnull) TXWebImageCancellationToken *decodeCancellationToken; // cancelled with the operation, checked by the decoding in progress
 #if SD_UIKIT
 @property (assign, nonatomic) UIBackgroundTaskIdentifier backgroundTaskId;
 #endif
@@ -78,12 +81,16 @@ typedef NSMutableDictionary<NSString *, id> SDCallbacksDictionary;
         _callbackBlocks = [NSMutableArray new];
         _responseModifier = context[SDWebImageContextDownloadResponseModifier];
         _decryptor = context[SDWebImageContextDownloadDecryptor];
+        _dataOnly = [context[SDWebImageContextDownloadDataOnly] boolValue];
+        _timeline = context[SDWebImageContextTimeline];
+        [_timeline beginStage:SDWebImageTimelineStageDownloadQueueWait];
         _executing = NO;
         _finished = NO;
         _expectedSize = 0;
         _unownedSession = session;
         _coderQueue = [NSOperationQueue new];
         _coderQueue.maxConcurrentOperationCount = 1;
+        _decodeCancellationToken = [TXWebImageCancellationToken new];
 #if SD_UIKIT
         _backgroundTaskId = UIBackgroundTaskInvalid;
 #endif
@@ -204,6 +211,7 @@ typedef NSMutableDictionary<NSString *, id> SDCallbacksDictionary;
         
         self.dataTask = [session dataTaskWithRequest:self.request];
         self.executing = YES;
+        [self.timeline endStage:SDWebImageTimelineStageDownloadQueueWait beginStage:SDWebImageTimelineStageDownload];
     }
 
     if (self.dataTask) {
@@ -241,6 +249,7 @@ typedef NSMutableDictionary<NSString *, id> SDCallbacksDictionary;
 - (void)cancelInternal {
     if (self.isFinished) return;
     [super cancel];
+    [self.decodeCancellationToken cancel];
     
     __block typeof(self) strongSelf = self;
     dispatch_async(dispatch_get_main_queue(), ^{
@@ -419,7 +428,7 @@ didReceiveResponse:(NSURLResponse *)response
     self.previousProgress = currentProgress;
     
     // Using data decryptor will disable the progressive decoding, since there are no support for progressive decrypt
-    BOOL supportProgressive = (self.options & TXWebImageDownloaderProgressiveLoad) && !self.decryptor;
+    BOOL supportProgressive = (self.options & TXWebImageDownloaderProgressiveLoad) && !self.decryptor && !self.dataOnly;
     // Progressive decoding Only decode partial image, full image in `URLSession:task:didCompleteWithError:`
     if (supportProgressive && !finished) {
         // Get the image data
@@ -471,6 +480,8 @@ didReceiveResponse:(NSURLResponse *)response
     // If we already cancel the operation or anything mark the operation finished, don't callback twice
     if (self.isFinished) return;
     
+    TXWebImageTimeline *timeline = self.timeline;
+    [timeline endStage:SDWebImageTimelineStageDownload];
     @synchronized(self) {
         self.dataTask = nil;
         __block typeof(self) strongSelf = self;
@@ -513,19 +524,38 @@ didReceiveResponse:(NSURLResponse *)response
                 } else {
                     // decode the image in coder queue, cancel all previous decoding process
                     [self.coderQueue cancelAllOperations];
+                    [timeline beginStage:SDWebImageTimelineStageDecodeQueueWait];
                     @weakify(self);
                     [self.coderQueue addOperationWithBlock:^{
                         @strongify(self);
                         if (!self) {
                             return;
                         }
+                        if (self.dataOnly) {
+                            [timeline endStage:SDWebImageTimelineStageDecodeQueueWait];
+                            // skip decoding, the caller only needs the data
+                            [self callCompletionBlocksWithImage:nil imageData:imageData error:nil finished:YES];
+                            [self done];
+                            return;
+                        }
+                        [timeline endStage:SDWebImageTimelineStageDecodeQueueWait beginStage:SDWebImageTimelineStageDecode];
                         // check if we already use progressive decoding, use that to produce faster decoding
                         id<SDProgressiveImageCoder> progressiveCoder = TXImageLoaderGetProgressiveCoder(self);
                         UIImage *image;
                         if (progressiveCoder) {
                             image = TXImageLoaderDecodeProgressiveImageData(imageData, self.request.URL, YES, self, [[self class] imageOptionsFromDownloaderOptions:self.options], self.context);
                         } else {
-                            image = TXImageLoaderDecodeImageData(imageData, self.request.URL, [[self class] imageOptionsFromDownloaderOptions:self.options], self.context);
+                            image = TXImageLoaderDecodeImageDataWithCancellationToken(imageData, self.request.URL, [[self class] imageOptionsFromDownloaderOptions:self.options], self.context, self.decodeCancellationToken);
+                        }
+                        if (self.decodeCancellationToken.isCancelled) {
+                            // Cancelled during the decoding, the completion blocks have been called with the cancelled error
+                            [timeline endStage:SDWebImageTimelineStageDecode];
+                            return;
+                        }
+                        [timeline endStage:SDWebImageTimelineStageDecode];
+                        [timeline recordDecodedImage:image data:imageData context:self.context];
+                        if (progressiveCoder) {
+                            timeline.coderName = NSStringFromClass(progressiveCoder.class);
                         }
                         CGSize imageSize = image.size;
                         if (imageSize.width == 0 || imageSize.height == 0) {
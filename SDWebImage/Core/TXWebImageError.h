@@ -23,7 +23,7 @@ typedef NS_ERROR_ENUM(TXWebImageErrorDomain, TXWebImageError) {
     TXWebImageErrorInvalidURL = 1000, // The URL is invalid, such as nil URL or corrupted URL
     TXWebImageErrorBadImageData = 1001, // The image data can not be decoded to image, or the image data is empty
     TXWebImageErrorCacheNotModified = 1002, // The remote location specify that the cached image is not modified, such as the HTTP response 304 code. It's useful for `SDWebImageRefreshCached`
-    TXWebImageErrorBlackListed = 1003, // The URL is blacklisted because of unrecoverable failure marked by downloader (such as 404), you can use `.retryFailed` option to avoid this
+    TXWebImageErrorBlackListed = 1003, // The URL is blacklisted because of failure marked by downloader (such as bad image data, or 5xx status code), until the retry time with backoff (see `TXWebImageManager.failedURLCache`), you can use `.retryFailed` option to avoid this
     TXWebImageErrorInvalidDownloadOperation = 2000, // The image download operation is invalid, such as nil operation or unexpected error occur when operation initialized
     TXWebImageErrorInvalidDownloadStatusCode = 2001, // The image download response a invalid status code. You can check the status code in error's userInfo under `TXWebImageErrorDownloadStatusCodeKey`
     TXWebImageErrorCancelled = 2002, // The image loading operation is cancelled before finished, during either async disk cache query, or waiting before actual network request. For actual network request error, check `NSURLErrorDomain` error domain and code.
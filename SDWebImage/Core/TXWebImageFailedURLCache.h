@@ -0,0 +1,86 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+
+/**
+ The bounded cache of the failed URLs, used by `TXWebImageManager` to block the URL which failed recently (the loader's `shouldBlockFailedURLWithURL:error:` returns YES).
+ Each entry carries the failure count and the time to retry. The URL is blocked until the retry time, which is computed with the exponential backoff (`baseRetryInterval * 2^(failureCount - 1)`, capped by `maxRetryInterval`) and the random jitter, or from the `Retry-After` header of the HTTP response when provided. After that, the next request is sent, it resets the entry if succeed, or blocks the URL again with a longer interval if failed.
+ When exceeding the `countLimit`, the least recently failed entry is removed.
+ @note This class is thread-safe.
+ */
+@interface TXWebImageFailedURLCache : NSObject
+
+/**
+ The maximum count of the failed URLs, the least recently failed one is removed when exceeding. 0 means no limit.
+ Defaults to 1000.
+ */
+@property (atomic, assign) NSUInteger countLimit;
+
+/**
+ The interval in seconds to block the URL after the first failure, it's doubled for each subsequent failure.
+ Defaults to 10.
+ */
+@property (atomic, assign) NSTimeInterval baseRetryInterval;
+
+/**
+ The maximum interval in seconds to block the URL, including the one from `Retry-After` header.
+ Defaults to 3600 (1 hour).
+ */
+@property (atomic, assign) NSTimeInterval maxRetryInterval;
+
+/**
+ The ratio of the random jitter, between 0 and 1. The backoff interval is randomly reduced by at most this ratio, so the clients which failed at the same time do not retry at the same time. The `Retry-After` interval is not jittered.
+ Defaults to 0.25.
+ */
+@property (atomic, assign) double jitterFactor;
+
+/**
+ The count of the failed URLs, including the ones which can retry now.
+ */
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/**
+ Record a failure of the URL, and block it until the retry time.
+
+ @param url The failed URL
+ @param error The error, the `Retry-After` header of its HTTP response (`TXWebImageErrorDownloadResponseKey`) is used if available
+ */
+- (void)recordFailureForURL:(nonnull NSURL *)url error:(nullable NSError *)error;
+
+/**
+ Whether the URL is blocked now, which means it failed and the retry time is not reached.
+ */
+- (BOOL)isBlockedURL:(nonnull NSURL *)url;
+
+/**
+ The count of the continuous failures of the URL, 0 if not failed.
+ */
+- (NSUInteger)failureCountForURL:(nonnull NSURL *)url;
+
+/**
+ The remaining interval in seconds until the URL can retry, 0 if not blocked.
+ */
+- (NSTimeInterval)retryIntervalForURL:(nonnull NSURL *)url;
+
+/**
+ Remove the URL, for example when it succeeds.
+ */
+- (void)removeURL:(nonnull NSURL *)url;
+
+/**
+ Remove all the URLs.
+ */
+- (void)removeAllURLs;
+
+/**
+ The interval in seconds from the `Retry-After` header of the HTTP response, which can be the delay seconds or the HTTP date. -1 if not available.
+ */
++ (NSTimeInterval)retryAfterIntervalForResponse:(nullable NSURLResponse *)response;
+
+@end
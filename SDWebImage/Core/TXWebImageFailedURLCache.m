@@ -0,0 +1,194 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageFailedURLCache.h"
+#import "TXWebImageError.h"
+#import "TXInternalMacros.h"
+
+// The monotonic time in seconds, not affected by the system clock change
+static inline NSTimeInterval SDFailedURLCurrentTime(void) {
+    return NSProcessInfo.processInfo.systemUptime;
+}
+
+@interface SDWebImageFailedURLEntry : NSObject
+
+@property (nonatomic, assign) NSUInteger failureCount;
+@property (nonatomic, assign) NSTimeInterval retryTime;
+
+@end
+
+@implementation SDWebImageFailedURLEntry
+@end
+
+@interface TXWebImageFailedURLCache () {
+    SD_LOCK_DECLARE(_entriesLock); // a lock to keep the access to `entries` and `failedOrder` thread-safe
+}
+
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSURL *, SDWebImageFailedURLEntry *> *entries;
+// The URLs in failure order, the first one is the least recently failed
+@property (nonatomic, strong, nonnull) NSMutableOrderedSet<NSURL *> *failedOrder;
+
+@end
+
+@implementation TXWebImageFailedURLCache
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _countLimit = 1000;
+        _baseRetryInterval = 10;
+        _maxRetryInterval = 3600;
+        _jitterFactor = 0.25;
+        _entries = [NSMutableDictionary dictionary];
+        _failedOrder = [NSMutableOrderedSet orderedSet];
+        SD_LOCK_INIT(_entriesLock);
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    SD_LOCK(_entriesLock);
+    NSUInteger count = self.entries.count;
+    SD_UNLOCK(_entriesLock);
+    return count;
+}
+
+- (void)recordFailureForURL:(NSURL *)url error:(NSError *)error {
+    if (!url) {
+        return;
+    }
+    NSTimeInterval maxRetryInterval = MAX(self.maxRetryInterval, 0);
+    NSTimeInterval retryAfterInterval = [self.class retryAfterIntervalForResponse:error.userInfo[TXWebImageErrorDownloadResponseKey]];
+    NSUInteger countLimit = self.countLimit;
+
+    SD_LOCK(_entriesLock);
+    SDWebImageFailedURLEntry *entry = self.entries[url];
+    if (!entry) {
+        entry = [SDWebImageFailedURLEntry new];
+        self.entries[url] = entry;
+    } else {
+        // Move to the most recently failed
+        [self.failedOrder removeObject:url];
+    }
+    [self.failedOrder addObject:url];
+    entry.failureCount += 1;
+
+    NSTimeInterval retryInterval;
+    if (retryAfterInterval >= 0) {
+        // The server knows better when to retry
+        retryInterval = retryAfterInterval;
+    } else {
+        // Exponential backoff, the exponent is clamped to avoid overflow, the result is capped anyway
+        NSUInteger exponent = MIN(entry.failureCount - 1, 32);
+        retryInterval = MAX(self.baseRetryInterval, 0) * (double)(1ULL << exponent);
+        retryInterval = MIN(retryInterval, maxRetryInterval);
+        double jitterFactor = MIN(MAX(self.jitterFactor, 0), 1);
+        if (jitterFactor > 0) {
+            double random = (double)arc4random_uniform(UINT32_MAX) / UINT32_MAX;
+            retryInterval -= retryInterval * jitterFactor * random;
+        }
+    }
+    retryInterval = MIN(retryInterval, maxRetryInterval);
+    entry.retryTime = SDFailedURLCurrentTime() + retryInterval;
+
+    // Remove the least recently failed ones when exceeding the limit
+    if (countLimit > 0) {
+        while (self.failedOrder.count > countLimit) {
+            NSURL *leastURL = self.failedOrder.firstObject;
+            [self.failedOrder removeObjectAtIndex:0];
+            [self.entries removeObjectForKey:leastURL];
+        }
+    }
+    SD_UNLOCK(_entriesLock);
+}
+
+- (BOOL)isBlockedURL:(NSURL *)url {
+    return [self retryIntervalForURL:url] > 0;
+}
+
+- (NSUInteger)failureCountForURL:(NSURL *)url {
+    if (!url) {
+        return 0;
+    }
+    SD_LOCK(_entriesLock);
+    NSUInteger failureCount = self.entries[url].failureCount;
+    SD_UNLOCK(_entriesLock);
+    return failureCount;
+}
+
+- (NSTimeInterval)retryIntervalForURL:(NSURL *)url {
+    if (!url) {
+        return 0;
+    }
+    SD_LOCK(_entriesLock);
+    SDWebImageFailedURLEntry *entry = self.entries[url];
+    NSTimeInterval retryTime = entry ? entry.retryTime : 0;
+    SD_UNLOCK(_entriesLock);
+    if (retryTime <= 0) {
+        return 0;
+    }
+    return MAX(retryTime - SDFailedURLCurrentTime(), 0);
+}
+
+- (void)removeURL:(NSURL *)url {
+    if (!url) {
+        return;
+    }
+    SD_LOCK(_entriesLock);
+    if (self.entries[url]) {
+        [self.entries removeObjectForKey:url];
+        [self.failedOrder removeObject:url];
+    }
+    SD_UNLOCK(_entriesLock);
+}
+
+- (void)removeAllURLs {
+    SD_LOCK(_entriesLock);
+    [self.entries removeAllObjects];
+    [self.failedOrder removeAllObjects];
+    SD_UNLOCK(_entriesLock);
+}
+
+#pragma mark - Retry-After
+
++ (NSTimeInterval)retryAfterIntervalForResponse:(NSURLResponse *)response {
+    if (![response isKindOfClass:NSHTTPURLResponse.class]) {
+        return -1;
+    }
+    // Header field name is case-insensitive
+    __block NSString *retryAfter;
+    [((NSHTTPURLResponse *)response).allHeaderFields enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+        if ([key isKindOfClass:NSString.class] && [obj isKindOfClass:NSString.class] && [key caseInsensitiveCompare:@"Retry-After"] == NSOrderedSame) {
+            retryAfter = [obj stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+            *stop = YES;
+        }
+    }];
+    if (retryAfter.length == 0) {
+        return -1;
+    }
+    // delay-seconds
+    if ([retryAfter rangeOfCharacterFromSet:NSCharacterSet.decimalDigitCharacterSet.invertedSet].location == NSNotFound) {
+        return (NSTimeInterval)retryAfter.longLongValue;
+    }
+    // HTTP-date, like "Wed, 21 Oct 2015 07:28:00 GMT"
+    static NSDateFormatter *dateFormatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        dateFormatter = [NSDateFormatter new];
+        dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        dateFormatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        dateFormatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    NSDate *date = [dateFormatter dateFromString:retryAfter];
+    if (!date) {
+        return -1;
+    }
+    return MAX(date.timeIntervalSinceNow, 0);
+}
+
+@end
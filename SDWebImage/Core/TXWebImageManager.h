@@ -11,9 +11,13 @@
 #import "TXImageCacheDefine.h"
 #import "TXImageLoader.h"
 #import "TXImageTransformer.h"
+#import "TXImageTransformPrefixCache.h"
 #import "TXWebImageCacheKeyFilter.h"
 #import "TXWebImageCacheSerializer.h"
 #import "TXWebImageOptionsProcessor.h"
+#import "TXWebImageTimeline.h"
+#import "TXWebImageFailedURLCache.h"
+#import "TXWebImageCacheKey.h"
 
 typedef void(^SDExternalCompletionBlock)(UIImage * _Nullable image, NSError * _Nullable error, TXImageCacheType cacheType, NSURL * _Nullable imageURL);
 
@@ -39,6 +43,11 @@ typedef void(^SDInternalCompletionBlock)(UIImage * _Nullable image, NSData * _Nu
  */
 @property (strong, nonatomic, nullable, readonly) id<TXWebImageOperation> loaderOperation;
 
+/**
+ The timeline of the stages for this request. Nil if the manager has no `timelineObserver` when the request started.
+ */
+@property (strong, nonatomic, nullable, readonly) TXWebImageTimeline *timeline;
+
 @end
 
 
@@ -119,6 +128,13 @@ TXWebImageManager *manager = [TXWebImageManager sharedManager];
  */
 @property (strong, nonatomic, nullable) id<TXImageTransformer> transformer;
 
+/**
+ The memory cache for the transformed images of transformer chain prefix. When the transformed image is not cached, the transform starts from the longest cached prefix of the chain (the pipeline transformer's `transformers`), instead of from the original image. Check its statistics for the prefix hit.
+ Defaults to nil, which disables it. It keeps another copy of the transformed images out of the image cache's memory limit, set it only when the transformer chains share prefix.
+ @note It's not used for progressive image or `SDWebImageRefreshCached` option, because the original image may change.
+ */
+@property (strong, nonatomic, nullable) TXImageTransformPrefixCache *transformPrefixCache;
+
 /**
  * The cache filter is used to convert an URL into a cache key each time TXWebImageManager need cache key to use image cache.
  *
@@ -180,6 +196,26 @@ TXWebImageManager *manager = [TXWebImageManager sharedManager];
  */
 @property (nonatomic, strong, nullable) id<TXWebImageOptionsProcessor> optionsProcessor;
 
+/**
+ * The observer to receive the timeline of each finished request, which contains the time of each stage (memory lookup, disk queue wait and read, download, decode, transform, store) and the result. Use `TXWebImageTraceExporter` to export the timelines to the Chrome trace event JSON.
+ * Defaults to nil, which means no timeline is recorded, so there is near-zero overhead.
+ * @note The timeline is passed to the image cache and image loader by `SDWebImageContextTimeline` context option.
+ */
+@property (nonatomic, strong, nullable) id<TXWebImageTimelineObserver> timelineObserver;
+
+/**
+ * The cache of the failed URLs. The URL is blocked (the request fails with `TXWebImageErrorBlackListed`) after it failed, until the retry time computed with exponential backoff or from the `Retry-After` header. You can config the backoff intervals and the count limit. `SDWebImageRetryFailed` option ignores the block.
+ */
+@property (nonatomic, strong, readonly, nonnull) TXWebImageFailedURLCache *failedURLCache;
+
+/**
+ * Whether to coalesce the identical in-flight load requests. The requests with the same cache key (see `cacheKeyForURL:context:`, which includes the transformer and thumbnail), options and context share one cache query, load, decode and transform, and each caller receives the progress, progressive images and result of the shared load.
+ * Each caller still gets its own `SDWebImageCombinedOperation`. Cancelling it only detaches that caller (with the `TXWebImageErrorCancelled` error), the shared load is cancelled when all the callers cancelled.
+ * Defaults to YES.
+ * @note The request with `SDWebImageRefreshCached` is not coalesced. The caller attached later only receives the progressive images after it attached. With the `timelineObserver`, the stages are recorded on the timeline of the first caller, the other callers' timelines only have the start and end time.
+ */
+@property (nonatomic, assign) BOOL shouldCoalesceRequests;
+
 /**
  * Check one or more operations running
  */
@@ -284,4 +320,10 @@ TXWebImageManager *manager = [TXWebImageManager sharedManager];
 */
 - (nullable NSString *)cacheKeyForURL:(nullable NSURL *)url context:(nullable SDWebImageContext *)context;
 
+/**
+ * Return the interned cache key object for a given URL and context option, which memoizes the string form (the same as `cacheKeyForURL:context:`), the hash and the disk file name. The manager computes it once for each request and passes it by `SDWebImageContextImageCacheKey` context option.
+ * @return The cache key, nil if the URL is nil or the cache key filter returns nil.
+ */
+- (nullable TXWebImageCacheKey *)imageCacheKeyForURL:(nullable NSURL *)url context:(nullable SDWebImageContext *)context;
+
 @end
@@ -13,28 +13,75 @@
 #import "TXAssociatedObject.h"
 #import "TXWebImageError.h"
 #import "TXInternalMacros.h"
+#import "TXTransformedAnimatedImage.h"
+#import "TXWebImageCacheHitObserver.h"
+#import <stdatomic.h>
+
+SDWebImageContextOption const SDWebImageContextIgnoresCacheHitObservers = @"ignoresCacheHitObservers";
+
+SD_LOCK_DECLARE_STATIC(_cacheHitObserversLock);
+static NSHashTable<id<TXWebImageCacheHitObserver>> *_cacheHitObservers;
+// Checked by each load without lock, so the cost is nothing without observer
+static atomic_size_t _cacheHitObserverCount;
 
 static id<TXImageCache> _defaultImageCache;
 static id<TXImageLoader> _defaultImageLoader;
 
+@class SDWebImageLoadGroup;
+
 @interface SDWebImageCombinedOperation ()
 
 @property (assign, nonatomic, getter = isCancelled) BOOL cancelled;
 @property (strong, nonatomic, readwrite, nullable) id<TXWebImageOperation> loaderOperation;
 @property (strong, nonatomic, readwrite, nullable) id<TXWebImageOperation> cacheOperation;
+@property (strong, nonatomic, readwrite, nullable) TXWebImageTimeline *timeline;
 @property (weak, nonatomic, nullable) TXWebImageManager *manager;
+// The coalesced load this caller is attached to, nil if not coalesced or the result has been delivered
+@property (strong, atomic, nullable) SDWebImageLoadGroup *attachedGroup;
+// The coalesced load this operation runs the pipeline for, only for the shared operation of the group
+@property (weak, nonatomic, nullable) SDWebImageLoadGroup *ownerGroup;
+// The caller's arguments, used to deliver the result of the coalesced load
+@property (strong, nonatomic, nullable) NSURL *url;
+@property (copy, nonatomic, nullable) TXImageLoaderProgressBlock progressBlock;
+@property (copy, nonatomic, nullable) SDInternalCompletionBlock completedBlock;
+// Whether the cache hit of this caller is not reported to the cache hit observers
+@property (assign, nonatomic) BOOL ignoresCacheHitObservers;
+
+@end
+
+// The in-flight load of one cache key, shared by all the callers attached to it
+@interface SDWebImageLoadGroup : NSObject {
+    SD_LOCK_DECLARE(_operationsLock); // a lock to keep the access to `operations` and `closed` thread-safe
+}
+
+@property (copy, nonatomic, readonly, nonnull) NSString *key;
+@property (assign, nonatomic, readonly) SDWebImageOptions options;
+@property (copy, nonatomic, readonly, nullable) SDWebImageContext *context;
+// The operation running the cache, load and transform pipeline, it's not visible to the callers
+@property (strong, nonatomic, readonly, nonnull) SDWebImageCombinedOperation *operation;
+@property (strong, nonatomic, nonnull) NSMutableArray<SDWebImageCombinedOperation *> *operations;
+// Once closed (final result delivered, or all the callers cancelled), no more caller can attach
+@property (assign, atomic) BOOL closed;
+
+- (nonnull instancetype)initWithKey:(nonnull NSString *)key options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context operation:(nonnull SDWebImageCombinedOperation *)operation;
+- (BOOL)canCoalesceOptions:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context;
+// Attach a caller, return NO if the group is closed
+- (BOOL)addOperation:(nonnull SDWebImageCombinedOperation *)operation;
+// Detach a caller, return NO if it's not attached. `isLast` is YES if no caller remains, and the group is closed
+- (BOOL)removeOperation:(nonnull SDWebImageCombinedOperation *)operation isLast:(nonnull BOOL *)isLast;
+// The callers to deliver a result. If it's the final result, all the callers are detached and the group is closed
+- (nonnull NSArray<SDWebImageCombinedOperation *> *)operationsForResultWithFinal:(BOOL)final;
 
 @end
 
 @interface TXWebImageManager () {
-    SD_LOCK_DECLARE(_failedURLsLock); // a lock to keep the access to `failedURLs` thread-safe
     SD_LOCK_DECLARE(_runningOperationsLock); // a lock to keep the access to `runningOperations` thread-safe
 }
 
 @property (strong, nonatomic, readwrite, nonnull) TXImageCache *imageCache;
 @property (strong, nonatomic, readwrite, nonnull) id<TXImageLoader> imageLoader;
-@property (strong, nonatomic, nonnull) NSMutableSet<NSURL *> *failedURLs;
 @property (strong, nonatomic, nonnull) NSMutableSet<SDWebImageCombinedOperation *> *runningOperations;
+@property (strong, nonatomic, nonnull) NSMutableDictionary<NSString *, SDWebImageLoadGroup *> *runningLoadGroups;
 
 @end
 
@@ -87,10 +134,11 @@ static id<TXImageLoader> _defaultImageLoader;
     if ((self = [super init])) {
         _imageCache = cache;
         _imageLoader = loader;
-        _failedURLs = [NSMutableSet new];
-        SD_LOCK_INIT(_failedURLsLock);
+        _failedURLCache = [[TXWebImageFailedURLCache alloc] init];
         _runningOperations = [NSMutableSet new];
+        _runningLoadGroups = [NSMutableDictionary new];
         SD_LOCK_INIT(_runningOperationsLock);
+        _shouldCoalesceRequests = YES;
     }
     return self;
 }
@@ -117,6 +165,14 @@ static id<TXImageLoader> _defaultImageLoader;
         return @"";
     }
     
+    return [self imageCacheKeyForURL:url context:context].stringValue;
+}
+
+- (nullable TXWebImageCacheKey *)imageCacheKeyForURL:(nullable NSURL *)url context:(nullable SDWebImageContext *)context {
+    if (!url) {
+        return nil;
+    }
+    
     NSString *key;
     // Cache Key Filter
     id<TXWebImageCacheKeyFilter> cacheKeyFilter = self.cacheKeyFilter;
@@ -129,21 +185,24 @@ static id<TXImageLoader> _defaultImageLoader;
         key = url.absoluteString;
     }
     
+    if (!key) {
+        return nil;
+    }
+    
     // Thumbnail Key Appending
+    CGSize thumbnailSize = CGSizeZero;
+    BOOL preserveAspectRatio = YES;
     NSValue *thumbnailSizeValue = context[SDWebImageContextImageThumbnailPixelSize];
     if (thumbnailSizeValue != nil) {
-        CGSize thumbnailSize = CGSizeZero;
 #if SD_MAC
         thumbnailSize = thumbnailSizeValue.sizeValue;
 #else
         thumbnailSize = thumbnailSizeValue.CGSizeValue;
 #endif
-        BOOL preserveAspectRatio = YES;
         NSNumber *preserveAspectRatioValue = context[SDWebImageContextImagePreserveAspectRatio];
         if (preserveAspectRatioValue != nil) {
             preserveAspectRatio = preserveAspectRatioValue.boolValue;
         }
-        key = SDThumbnailedKeyForKey(key, thumbnailSize, preserveAspectRatio);
     }
     
     // Transformer Key Appending
@@ -154,11 +213,17 @@ static id<TXImageLoader> _defaultImageLoader;
             transformer = nil;
         }
     }
-    if (transformer) {
-        key = SDTransformedKeyForKey(key, transformer.transformerKey);
-    }
     
-    return key;
+    return [TXWebImageCacheKey cacheKeyWithURLKey:key thumbnailPixelSize:thumbnailSize preserveAspectRatio:preserveAspectRatio transformerKey:transformer.transformerKey];
+}
+
+// The cache key of the request, which is computed once by `loadImageWithURL:` and passed in the context
+- (nullable TXWebImageCacheKey *)requestCacheKeyForURL:(nonnull NSURL *)url context:(nullable SDWebImageContext *)context {
+    TXWebImageCacheKey *cacheKey = context[SDWebImageContextImageCacheKey];
+    if ([cacheKey isKindOfClass:TXWebImageCacheKey.class]) {
+        return cacheKey;
+    }
+    return [self imageCacheKeyForURL:url context:context];
 }
 
 - (SDWebImageCombinedOperation *)loadImageWithURL:(NSURL *)url options:(SDWebImageOptions)options progress:(TXImageLoaderProgressBlock)progressBlock completed:(SDInternalCompletionBlock)completedBlock {
@@ -186,12 +251,15 @@ static id<TXImageLoader> _defaultImageLoader;
 
     SDWebImageCombinedOperation *operation = [SDWebImageCombinedOperation new];
     operation.manager = self;
+    operation.ignoresCacheHitObservers = [context[SDWebImageContextIgnoresCacheHitObservers] boolValue];
+    id<TXWebImageTimelineObserver> timelineObserver = self.timelineObserver;
+    if (timelineObserver) {
+        operation.timeline = [[TXWebImageTimeline alloc] initWithURL:url];
+    }
 
     BOOL isFailedUrl = NO;
     if (url) {
-        SD_LOCK(_failedURLsLock);
-        isFailedUrl = [self.failedURLs containsObject:url];
-        SD_UNLOCK(_failedURLsLock);
+        isFailedUrl = [self.failedURLCache isBlockedURL:url];
     }
 
     if (url.absoluteString.length == 0 || (!(options & SDWebImageRetryFailed) && isFailedUrl)) {
@@ -207,9 +275,63 @@ static id<TXImageLoader> _defaultImageLoader;
     
     // Preprocess the options and context arg to decide the final the result for manager
     SDWebImageOptionsResult *result = [self processedResultForURL:url options:options context:context];
+    SDWebImageContext *processedContext = result.context;
+    // Compute the cache key once, the stages below reuse it from the context
+    TXWebImageCacheKey *cacheKey = [self imageCacheKeyForURL:url context:processedContext];
+    
+    // Attach to the in-flight load of the same cache key, or start a new one which can be attached later
+    SDWebImageLoadGroup *group;
+    BOOL shouldCoalesce = self.shouldCoalesceRequests && cacheKey && !SD_OPTIONS_CONTAINS(result.options, SDWebImageRefreshCached);
+    if (shouldCoalesce) {
+        NSString *key = cacheKey.stringValue;
+        operation.url = url;
+        operation.progressBlock = progressBlock;
+        operation.completedBlock = completedBlock;
+        SD_LOCK(_runningOperationsLock);
+        SDWebImageLoadGroup *runningGroup = self.runningLoadGroups[key];
+        if (runningGroup && [runningGroup canCoalesceOptions:result.options context:processedContext] && [runningGroup addOperation:operation]) {
+            operation.attachedGroup = runningGroup;
+        } else if (!runningGroup || runningGroup.closed) {
+            SDWebImageCombinedOperation *sharedOperation = [SDWebImageCombinedOperation new];
+            sharedOperation.manager = self;
+            sharedOperation.timeline = operation.timeline;
+            group = [[SDWebImageLoadGroup alloc] initWithKey:key options:result.options context:processedContext operation:sharedOperation];
+            sharedOperation.ownerGroup = group;
+            [group addOperation:operation];
+            operation.attachedGroup = group;
+            self.runningLoadGroups[key] = group;
+        }
+        SD_UNLOCK(_runningOperationsLock);
+        if (operation.attachedGroup && !group) {
+            // The result will be delivered by the running load
+            return operation;
+        }
+    }
+    
+    if (cacheKey || operation.timeline) {
+        // Pass the cache key and timeline to the image cache and image loader
+        SDWebImageMutableContext *mutableContext = processedContext ? [processedContext mutableCopy] : [NSMutableDictionary dictionary];
+        mutableContext[SDWebImageContextImageCacheKey] = cacheKey;
+        mutableContext[SDWebImageContextTimeline] = operation.timeline;
+        processedContext = [mutableContext copy];
+    }
     
-    // Start the entry to load image from cache
-    [self callCacheProcessForOperation:operation url:url options:result.options context:result.context progress:progressBlock completed:completedBlock];
+    if (group) {
+        // Start the entry to load image from cache, and deliver the progress and result to all the attached callers
+        @weakify(group);
+        TXImageLoaderProgressBlock groupProgressBlock = ^(NSInteger receivedSize, NSInteger expectedSize, NSURL * _Nullable targetURL) {
+            @strongify(group);
+            for (SDWebImageCombinedOperation *attachedOperation in [group operationsForResultWithFinal:NO]) {
+                if (attachedOperation.progressBlock) {
+                    attachedOperation.progressBlock(receivedSize, expectedSize, targetURL);
+                }
+            }
+        };
+        [self callCacheProcessForOperation:group.operation url:url options:result.options context:processedContext progress:groupProgressBlock completed:nil];
+    } else {
+        // Start the entry to load image from cache
+        [self callCacheProcessForOperation:operation url:url options:result.options context:processedContext progress:progressBlock completed:completedBlock];
+    }
 
     return operation;
 }
@@ -233,15 +355,11 @@ static id<TXImageLoader> _defaultImageLoader;
     if (!url) {
         return;
     }
-    SD_LOCK(_failedURLsLock);
-    [self.failedURLs removeObject:url];
-    SD_UNLOCK(_failedURLsLock);
+    [self.failedURLCache removeURL:url];
 }
 
 - (void)removeAllFailedURLs {
-    SD_LOCK(_failedURLsLock);
-    [self.failedURLs removeAllObjects];
-    SD_UNLOCK(_failedURLsLock);
+    [self.failedURLCache removeAllURLs];
 }
 
 #pragma mark - Private
@@ -269,7 +387,7 @@ static id<TXImageLoader> _defaultImageLoader;
     // Check whether we should query cache
     BOOL shouldQueryCache = !SD_OPTIONS_CONTAINS(options, SDWebImageFromLoaderOnly);
     if (shouldQueryCache) {
-        NSString *key = [self cacheKeyForURL:url context:context];
+        NSString *key = [self requestCacheKeyForURL:url context:context].stringValue;
         @weakify(operation);
         operation.cacheOperation = [imageCache queryImageForKey:key options:options context:context cacheType:queryCacheType completion:^(UIImage * _Nullable cachedImage, NSData * _Nullable cachedData, TXImageCacheType cacheType) {
             @strongify(operation);
@@ -322,9 +440,7 @@ static id<TXImageLoader> _defaultImageLoader;
     BOOL shouldQueryOriginalCache = (originalQueryCacheType != TXImageCacheTypeNone);
     if (shouldQueryOriginalCache) {
         // Disable transformer for original cache key generation
-        SDWebImageMutableContext *tempContext = [context mutableCopy];
-        tempContext[SDWebImageContextImageTransformer] = [NSNull null];
-        NSString *key = [self cacheKeyForURL:url context:tempContext];
+        NSString *key = [self requestCacheKeyForURL:url context:context].originalKey.stringValue;
         @weakify(operation);
         operation.cacheOperation = [imageCache queryImageForKey:key options:options context:context cacheType:originalQueryCacheType completion:^(UIImage * _Nullable cachedImage, NSData * _Nullable cachedData, TXImageCacheType cacheType) {
             @strongify(operation);
@@ -393,8 +509,14 @@ static id<TXImageLoader> _defaultImageLoader;
             context = [mutableContext copy];
         }
         
+        TXWebImageTimeline *timeline = context[SDWebImageContextTimeline];
+        [timeline beginStage:SDWebImageTimelineStageLoad];
         @weakify(operation);
         operation.loaderOperation = [imageLoader requestImageWithURL:url options:options context:context progress:progressBlock completed:^(UIImage *downloadedImage, NSData *downloadedData, NSError *error, BOOL finished) {
+            if (finished) {
+                [timeline endStage:SDWebImageTimelineStageLoad];
+                timeline.dataLength = downloadedData.length;
+            }
             @strongify(operation);
             if (!operation || operation.isCancelled) {
                 // Image combined operation cancelled by user
@@ -409,15 +531,12 @@ static id<TXImageLoader> _defaultImageLoader;
                 BOOL shouldBlockFailedURL = [self shouldBlockFailedURLWithURL:url error:error options:options context:context];
                 
                 if (shouldBlockFailedURL) {
-                    SD_LOCK(self->_failedURLsLock);
-                    [self.failedURLs addObject:url];
-                    SD_UNLOCK(self->_failedURLsLock);
+                    [self.failedURLCache recordFailureForURL:url error:error];
                 }
             } else {
-                if ((options & SDWebImageRetryFailed)) {
-                    SD_LOCK(self->_failedURLsLock);
-                    [self.failedURLs removeObject:url];
-                    SD_UNLOCK(self->_failedURLsLock);
+                if (finished) {
+                    // Succeed, reset the failure count for backoff
+                    [self.failedURLCache removeURL:url];
                 }
                 // Continue store cache process
                 [self callStoreCacheProcessForOperation:operation url:url options:options context:context downloadedImage:downloadedImage downloadedData:downloadedData finished:finished progress:progressBlock completed:completedBlock];
@@ -470,9 +589,7 @@ static id<TXImageLoader> _defaultImageLoader;
         originalStoreCacheType = [context[SDWebImageContextOriginalStoreCacheType] integerValue];
     }
     // Disable transformer for original cache key generation
-    SDWebImageMutableContext *tempContext = [context mutableCopy];
-    tempContext[SDWebImageContextImageTransformer] = [NSNull null];
-    NSString *key = [self cacheKeyForURL:url context:tempContext];
+    NSString *key = [self requestCacheKeyForURL:url context:context].originalKey.stringValue;
     id<TXImageTransformer> transformer = context[SDWebImageContextImageTransformer];
     if (![transformer conformsToProtocol:@protocol(TXImageTransformer)]) {
         transformer = nil;
@@ -533,22 +650,46 @@ static id<TXImageLoader> _defaultImageLoader;
         storeCacheType = [context[SDWebImageContextStoreCacheType] integerValue];
     }
     // transformed cache key
-    NSString *key = [self cacheKeyForURL:url context:context];
+    TXWebImageCacheKey *cacheKey = [self requestCacheKeyForURL:url context:context];
+    NSString *key = cacheKey.stringValue;
     id<TXImageTransformer> transformer = context[SDWebImageContextImageTransformer];
     if (![transformer conformsToProtocol:@protocol(TXImageTransformer)]) {
         transformer = nil;
     }
     id<TXWebImageCacheSerializer> cacheSerializer = context[SDWebImageContextCacheSerializer];
+    // transformer chain prefix cache, only for the final original image
+    TXImageTransformPrefixCache *transformPrefixCache = self.transformPrefixCache;
+    NSString *originalKey;
+    if (transformPrefixCache && finished && !SD_OPTIONS_CONTAINS(options, SDWebImageRefreshCached)) {
+        // Disable transformer for original cache key generation
+        originalKey = cacheKey.originalKey.stringValue;
+    }
     
     BOOL shouldTransformImage = originalImage && transformer;
     shouldTransformImage = shouldTransformImage && (!originalImage.sd_isAnimated || (options & SDWebImageTransformAnimatedImage));
     shouldTransformImage = shouldTransformImage && (!originalImage.sd_isVector || (options & SDWebImageTransformVectorImage));
     // if available, store transformed image to cache
     if (shouldTransformImage) {
+        TXWebImageTimeline *timeline = context[SDWebImageContextTimeline];
+        [timeline beginStage:SDWebImageTimelineStageTransformQueueWait];
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
             @autoreleasepool {
-                UIImage *transformedImage = [transformer transformedImageWithImage:originalImage forKey:key];
-                if (transformedImage && finished) {
+                [timeline endStage:SDWebImageTimelineStageTransformQueueWait beginStage:SDWebImageTimelineStageTransform];
+                UIImage *transformedImage;
+                if ([originalImage.class conformsToProtocol:@protocol(TXAnimatedImage)] && ((id<TXAnimatedImage>)originalImage).animatedImageFrameCount > 1) {
+                    // Transform each frame lazily during playback, instead of the poster frame only
+                    transformedImage = [TXTransformedAnimatedImage imageWithProvider:(id<TXAnimatedImage>)originalImage transformer:transformer key:key];
+                } else if (originalKey) {
+                    transformedImage = [transformPrefixCache transformedImageWithImage:originalImage transformer:transformer forKey:originalKey];
+                } else {
+                    transformedImage = [transformer transformedImageWithImage:originalImage forKey:key];
+                }
+                [timeline endStage:SDWebImageTimelineStageTransform];
+                if ([transformedImage isKindOfClass:[TXTransformedAnimatedImage class]] && finished) {
+                    [self storeTransformedAnimatedImage:(TXTransformedAnimatedImage *)transformedImage originalData:originalData forKey:key originalKey:cacheKey.originalKey.stringValue imageCache:imageCache cacheType:storeCacheType options:options context:context completion:^{
+                        [self callCompletionBlockForOperation:operation completion:completedBlock image:transformedImage data:originalData error:nil cacheType:TXImageCacheTypeNone finished:finished url:url];
+                    }];
+                } else if (transformedImage && finished) {
                     BOOL imageWasTransformed = ![transformedImage isEqual:originalImage];
                     NSData *cacheData;
                     // pass nil if the image was transformed, so we can recalculate the data from the image
@@ -581,6 +722,14 @@ static id<TXImageLoader> _defaultImageLoader;
     SD_UNLOCK(_runningOperationsLock);
 }
 
+- (void)safelyRemoveLoadGroup:(nonnull SDWebImageLoadGroup *)group {
+    SD_LOCK(_runningOperationsLock);
+    if (self.runningLoadGroups[group.key] == group) {
+        [self.runningLoadGroups removeObjectForKey:group.key];
+    }
+    SD_UNLOCK(_runningOperationsLock);
+}
+
 - (void)storeImage:(nullable UIImage *)image
          imageData:(nullable NSData *)data
             forKey:(nullable NSString *)key
@@ -590,21 +739,51 @@ static id<TXImageLoader> _defaultImageLoader;
            context:(nullable SDWebImageContext *)context
         completion:(nullable SDWebImageNoParamsBlock)completion {
     BOOL waitStoreCache = SD_OPTIONS_CONTAINS(options, SDWebImageWaitStoreCache);
+    TXWebImageTimeline *timeline = context[SDWebImageContextTimeline];
+    [timeline beginStage:SDWebImageTimelineStageStore];
     // Check whether we should wait the store cache finished. If not, callback immediately
     [imageCache storeImage:image imageData:data forKey:key cacheType:cacheType completion:^{
         if (waitStoreCache) {
+            [timeline endStage:SDWebImageTimelineStageStore];
             if (completion) {
                 completion();
             }
         }
     }];
     if (!waitStoreCache) {
+        [timeline endStage:SDWebImageTimelineStageStore];
         if (completion) {
             completion();
         }
     }
 }
 
+// The frames of the transformed animated image are transformed lazily, so do not transform and encode all of them for the disk cache.
+// It's stored to memory cache only, the disk cache keeps the original data under the original key, which is queried and transformed lazily again on the next load.
+- (void)storeTransformedAnimatedImage:(nonnull TXTransformedAnimatedImage *)image
+                         originalData:(nullable NSData *)originalData
+                               forKey:(nullable NSString *)key
+                          originalKey:(nullable NSString *)originalKey
+                           imageCache:(nonnull id<TXImageCache>)imageCache
+                            cacheType:(TXImageCacheType)cacheType
+                              options:(SDWebImageOptions)options
+                              context:(nullable SDWebImageContext *)context
+                           completion:(nullable SDWebImageNoParamsBlock)completion {
+    BOOL toMemory = cacheType == TXImageCacheTypeMemory || cacheType == TXImageCacheTypeAll;
+    BOOL toDisk = cacheType == TXImageCacheTypeDisk || cacheType == TXImageCacheTypeAll;
+    TXImageCacheType originalStoreCacheType = TXImageCacheTypeDisk;
+    if (context[SDWebImageContextOriginalStoreCacheType]) {
+        originalStoreCacheType = [context[SDWebImageContextOriginalStoreCacheType] integerValue];
+    }
+    BOOL originalToDisk = originalStoreCacheType == TXImageCacheTypeDisk || originalStoreCacheType == TXImageCacheTypeAll;
+    if (toDisk && !originalToDisk && originalData && originalKey) {
+        // The original data was not stored to disk in store cache process, store it here instead of the transformed frames
+        UIImage *originalImage = [image.provider isKindOfClass:[UIImage class]] ? (UIImage *)image.provider : nil;
+        [imageCache storeImage:originalImage imageData:originalData forKey:originalKey cacheType:TXImageCacheTypeDisk completion:nil];
+    }
+    [self storeImage:image imageData:nil forKey:key imageCache:imageCache cacheType:(toMemory ? TXImageCacheTypeMemory : TXImageCacheTypeNone) options:options context:context completion:completion];
+}
+
 - (void)callCompletionBlockForOperation:(nullable SDWebImageCombinedOperation*)operation
                              completion:(nullable SDInternalCompletionBlock)completionBlock
                                   error:(nullable NSError *)error
@@ -620,6 +799,33 @@ static id<TXImageLoader> _defaultImageLoader;
                               cacheType:(TXImageCacheType)cacheType
                                finished:(BOOL)finished
                                     url:(nullable NSURL *)url {
+    SDWebImageLoadGroup *group = operation.ownerGroup;
+    if (group) {
+        // Coalesced load, deliver the result to each attached caller with its own timeline and URL
+        BOOL isFinal = finished || error;
+        NSArray<SDWebImageCombinedOperation *> *attachedOperations = [group operationsForResultWithFinal:isFinal];
+        if (isFinal) {
+            [self safelyRemoveLoadGroup:group];
+        }
+        for (SDWebImageCombinedOperation *attachedOperation in attachedOperations) {
+            if (isFinal) {
+                attachedOperation.attachedGroup = nil;
+                [self safelyRemoveOperationFromRunning:attachedOperation];
+            }
+            [self callCompletionBlockForOperation:attachedOperation completion:attachedOperation.completedBlock image:image data:data error:error cacheType:cacheType finished:finished url:attachedOperation.url];
+        }
+        return;
+    }
+    if (image && !error && finished && url && cacheType != TXImageCacheTypeNone && !operation.ignoresCacheHitObservers && atomic_load_explicit(&_cacheHitObserverCount, memory_order_relaxed) > 0) {
+        [self notifyCacheHitObserversWithURL:url cacheType:cacheType];
+    }
+    TXWebImageTimeline *timeline = operation.timeline;
+    if (timeline && (finished || error)) {
+        timeline.cacheType = cacheType;
+        if ([timeline finishWithError:error]) {
+            [self.timelineObserver didFinishTimeline:timeline];
+        }
+    }
     dispatch_main_async_safe(^{
         if (completionBlock) {
             completionBlock(image, data, error, cacheType, finished, url);
@@ -627,6 +833,15 @@ static id<TXImageLoader> _defaultImageLoader;
     });
 }
 
+- (void)notifyCacheHitObserversWithURL:(nonnull NSURL *)url cacheType:(TXImageCacheType)cacheType {
+    SD_LOCK(_cacheHitObserversLock);
+    NSArray<id<TXWebImageCacheHitObserver>> *observers = _cacheHitObservers.allObjects;
+    SD_UNLOCK(_cacheHitObserversLock);
+    for (id<TXWebImageCacheHitObserver> observer in observers) {
+        [observer imageManager:self didHitCacheWithURL:url cacheType:cacheType];
+    }
+}
+
 - (BOOL)shouldBlockFailedURLWithURL:(nonnull NSURL *)url
                               error:(nonnull NSError *)error
                             options:(SDWebImageOptions)options
@@ -694,14 +909,78 @@ static id<TXImageLoader> _defaultImageLoader;
 @end
 
 
+@implementation TXWebImageManager (CacheHitObserver)
+
++ (void)setupCacheHitObservers {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        SD_LOCK_INIT(_cacheHitObserversLock);
+        _cacheHitObservers = [NSHashTable weakObjectsHashTable];
+    });
+}
+
++ (void)addCacheHitObserver:(id<TXWebImageCacheHitObserver>)observer {
+    if (!observer) {
+        return;
+    }
+    [self setupCacheHitObservers];
+    SD_LOCK(_cacheHitObserversLock);
+    [_cacheHitObservers addObject:observer];
+    atomic_store_explicit(&_cacheHitObserverCount, _cacheHitObservers.allObjects.count, memory_order_relaxed);
+    SD_UNLOCK(_cacheHitObserversLock);
+}
+
++ (void)removeCacheHitObserver:(id<TXWebImageCacheHitObserver>)observer {
+    if (!observer) {
+        return;
+    }
+    [self setupCacheHitObservers];
+    SD_LOCK(_cacheHitObserversLock);
+    [_cacheHitObservers removeObject:observer];
+    atomic_store_explicit(&_cacheHitObserverCount, _cacheHitObservers.allObjects.count, memory_order_relaxed);
+    SD_UNLOCK(_cacheHitObserversLock);
+}
+
+@end
+
 @implementation SDWebImageCombinedOperation
 
+- (id<TXWebImageOperation>)cacheOperation {
+    SDWebImageLoadGroup *group = self.attachedGroup;
+    return group ? group.operation.cacheOperation : _cacheOperation;
+}
+
+- (id<TXWebImageOperation>)loaderOperation {
+    SDWebImageLoadGroup *group = self.attachedGroup;
+    return group ? group.operation.loaderOperation : _loaderOperation;
+}
+
 - (void)cancel {
     @synchronized(self) {
         if (self.isCancelled) {
             return;
         }
         self.cancelled = YES;
+        SDWebImageLoadGroup *group = self.attachedGroup;
+        if (group) {
+            // Detach from the coalesced load, which is cancelled only when no caller remains
+            self.attachedGroup = nil;
+            BOOL isLast = NO;
+            if ([group removeOperation:self isLast:&isLast]) {
+                TXWebImageManager *manager = self.manager;
+                if (isLast) {
+                    [manager safelyRemoveLoadGroup:group];
+                    [group.operation cancel];
+                }
+                [manager safelyRemoveOperationFromRunning:self];
+                NSError *error = [NSError errorWithDomain:TXWebImageErrorDomain code:TXWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user"}];
+                // Always callback asynchronously, the same as the operation which is not coalesced
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [manager callCompletionBlockForOperation:self completion:self.completedBlock error:error url:self.url];
+                });
+            }
+            return;
+        }
         if (self.cacheOperation) {
             [self.cacheOperation cancel];
             self.cacheOperation = nil;
@@ -715,3 +994,76 @@ static id<TXImageLoader> _defaultImageLoader;
 }
 
 @end
+
+
+@implementation SDWebImageLoadGroup
+
+- (instancetype)initWithKey:(NSString *)key options:(SDWebImageOptions)options context:(SDWebImageContext *)context operation:(SDWebImageCombinedOperation *)operation {
+    self = [super init];
+    if (self) {
+        _key = [key copy];
+        _options = options;
+        _context = [context copy];
+        _operation = operation;
+        _operations = [NSMutableArray array];
+        SD_LOCK_INIT(_operationsLock);
+    }
+    return self;
+}
+
+- (BOOL)canCoalesceOptions:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    if (options != self.options) {
+        return NO;
+    }
+    // The transformer, cache key filter and thumbnail are already represented by the cache key, and the operation key only matters for the caller
+    static NSArray<SDWebImageContextOption> *ignoredOptions;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        ignoredOptions = @[SDWebImageContextSetImageOperationKey, SDWebImageContextImageTransformer, SDWebImageContextCacheKeyFilter, SDWebImageContextTimeline, SDWebImageContextImageCacheKey, SDWebImageContextIgnoresCacheHitObservers];
+    });
+    SDWebImageMutableContext *context1 = self.context ? [self.context mutableCopy] : [SDWebImageMutableContext dictionary];
+    SDWebImageMutableContext *context2 = context ? [context mutableCopy] : [SDWebImageMutableContext dictionary];
+    [context1 removeObjectsForKeys:ignoredOptions];
+    [context2 removeObjectsForKeys:ignoredOptions];
+    return [context1 isEqualToDictionary:context2];
+}
+
+- (BOOL)addOperation:(SDWebImageCombinedOperation *)operation {
+    BOOL added = NO;
+    SD_LOCK(_operationsLock);
+    if (!self.closed) {
+        [self.operations addObject:operation];
+        added = YES;
+    }
+    SD_UNLOCK(_operationsLock);
+    return added;
+}
+
+- (BOOL)removeOperation:(SDWebImageCombinedOperation *)operation isLast:(BOOL *)isLast {
+    BOOL removed = NO;
+    SD_LOCK(_operationsLock);
+    if ([self.operations containsObject:operation]) {
+        [self.operations removeObject:operation];
+        removed = YES;
+        if (self.operations.count == 0) {
+            self.closed = YES;
+            *isLast = YES;
+        }
+    }
+    SD_UNLOCK(_operationsLock);
+    return removed;
+}
+
+- (NSArray<SDWebImageCombinedOperation *> *)operationsForResultWithFinal:(BOOL)final {
+    NSArray<SDWebImageCombinedOperation *> *operations;
+    SD_LOCK(_operationsLock);
+    operations = [self.operations copy];
+    if (final) {
+        [self.operations removeAllObjects];
+        self.closed = YES;
+    }
+    SD_UNLOCK(_operationsLock);
+    return operations;
+}
+
+@end
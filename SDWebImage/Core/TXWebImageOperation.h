@@ -19,3 +19,26 @@
 @interface NSOperation (TXWebImageOperation) <TXWebImageOperation>
 
 @end
+
+/**
+ A lightweight cancellation token conform to `TXWebImageOperation`, used for the work which is not scheduled on an `NSOperationQueue`, like the cache query. It only carries an atomic cancelled flag and the cancellation handlers, instead of allocating a whole `NSOperation` with the KVO state.
+ The work checks `isCancelled` at its checkpoints (before the disk read, before the decode, etc) to bail out early, and a token can be chained to another one with `addCancellationHandler:`, like the caches manager does for each cache it queries.
+ @note This class is thread-safe. The `cancel` can be called from any thread, only the first call take effect.
+ */
+@interface TXWebImageCancellationToken : NSObject <TXWebImageOperation>
+
+/// Whether the token is cancelled. This is a lock-free atomic read, which is cheap for the checkpoint.
+@property (nonatomic, assign, readonly, getter=isCancelled) BOOL cancelled;
+
+/// Cancel the token, and call the cancellation handlers on the current thread (in the order they were added).
+- (void)cancel;
+
+/**
+ Add a handler which is called once when the token is cancelled. If the token is already cancelled, the handler is called immediately on the current thread.
+ The handlers are released after they are called.
+
+ @param handler The cancellation handler
+ */
+- (void)addCancellationHandler:(nonnull dispatch_block_t)handler;
+
+@end
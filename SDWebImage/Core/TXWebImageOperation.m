@@ -7,8 +7,66 @@
  */
 
 #import "TXWebImageOperation.h"
+#import "TXInternalMacros.h"
+#import <stdatomic.h>
 
 /// NSOperation conform to `TXWebImageOperation`.
 @implementation NSOperation (TXWebImageOperation)
 
 @end
+
+@implementation TXWebImageCancellationToken {
+    atomic_bool _cancelled;
+    SD_LOCK_DECLARE(_handlersLock);
+    NSMutableArray<dispatch_block_t> *_handlers;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        atomic_init(&_cancelled, false);
+        SD_LOCK_INIT(_handlersLock);
+    }
+    return self;
+}
+
+- (BOOL)isCancelled {
+    return atomic_load_explicit(&_cancelled, memory_order_acquire);
+}
+
+- (void)cancel {
+    // The flag is set inside the lock, so a handler is either added before and called here, or called by `addCancellationHandler:` itself
+    SD_LOCK(_handlersLock);
+    if (atomic_exchange_explicit(&_cancelled, true, memory_order_acq_rel)) {
+        // Already cancelled
+        SD_UNLOCK(_handlersLock);
+        return;
+    }
+    NSArray<dispatch_block_t> *handlers = _handlers;
+    _handlers = nil;
+    SD_UNLOCK(_handlersLock);
+    // Call outside the lock, the handler may cancel another token
+    for (dispatch_block_t handler in handlers) {
+        handler();
+    }
+}
+
+- (void)addCancellationHandler:(dispatch_block_t)handler {
+    NSParameterAssert(handler);
+    if (!handler) {
+        return;
+    }
+    SD_LOCK(_handlersLock);
+    if (atomic_load_explicit(&_cancelled, memory_order_acquire)) {
+        SD_UNLOCK(_handlersLock);
+        handler();
+        return;
+    }
+    if (!_handlers) {
+        _handlers = [NSMutableArray arrayWithCapacity:1];
+    }
+    [_handlers addObject:[handler copy]];
+    SD_UNLOCK(_handlersLock);
+}
+
+@end
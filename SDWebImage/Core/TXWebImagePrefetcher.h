@@ -11,6 +11,55 @@
 
 @class TXWebImagePrefetcher;
 
+/// The prefetch mode, which controls how the prefetched images are loaded and stored
+typedef NS_ENUM(NSUInteger, SDWebImagePrefetchMode) {
+    /// Load through the manager like the normal image loading, the image is decoded and stored to memory and disk cache
+    SDWebImagePrefetchModeDefault = 0,
+    /// Download the image data and store it to disk cache only, without decoding or memory cache. The URL already in disk cache is not downloaded.
+    /// @note This requires the image cache to be `TXImageCache` class, or it falls back to the default mode. The image loader should support `SDWebImageContextDownloadDataOnly` (`TXWebImageDownloader` does), or the image is decoded but not used.
+    SDWebImagePrefetchModeDiskOnly,
+    /// Load through the manager with the `thumbnailPixelSize` as `SDWebImageContextImageThumbnailPixelSize`, so only the thumbnail is decoded and stored to memory cache, and the original data to disk cache
+    SDWebImagePrefetchModeThumbnail,
+};
+
+/**
+ An item for viewport prefetching, represents the URL and the position of the item (like a cell) along the scroll axis.
+ */
+@interface SDWebImagePrefetchItem : NSObject
+
+/**
+ The URL of the item.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURL *url;
+
+/**
+ The start position of the item along the scroll axis, in the same coordinate as the viewport offset. Such as the `minY` of the cell frame in a vertical scroll view.
+ */
+@property (nonatomic, assign, readonly) CGFloat position;
+
+/**
+ The length of the item along the scroll axis. Such as the height of the cell in a vertical scroll view.
+ */
+@property (nonatomic, assign, readonly) CGFloat length;
+
+/**
+ The current distance to the viewport in points, which is used to rank the pending items, the nearest one is prefetched first. 0 means visible.
+ The distance of the item ahead of the scroll direction is reduced by the scroll velocity, and the one behind is increased. See `viewportVelocityLookahead`.
+ */
+@property (atomic, assign, readonly) CGFloat distance;
+
+/**
+ Create the item with the URL and the position.
+
+ @param url The URL of the item
+ @param position The start position along the scroll axis
+ @param length The length along the scroll axis
+ @return The item
+ */
++ (nonnull instancetype)itemWithURL:(nonnull NSURL *)url position:(CGFloat)position length:(CGFloat)length;
+
+@end
+
 /**
  A token represents a list of URLs, can be used to cancel the download.
  */
@@ -26,6 +75,16 @@
  */
 @property (nonatomic, copy, readonly, nullable) NSArray<NSURL *> *urls;
 
+/**
+ list of items of current prefetching, nil if the prefetching is not created with items.
+ */
+@property (nonatomic, copy, readonly, nullable) NSArray<SDWebImagePrefetchItem *> *items;
+
+/**
+ The bytes downloaded by current prefetching, the URLs from cache are not counted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger receivedBytes;
+
 @end
 
 /**
@@ -71,9 +130,90 @@ typedef void(^TXWebImagePrefetcherCompletionBlock)(NSUInteger noOfFinishedUrls,
 
 /**
  * Maximum number of URLs to prefetch at the same time. Defaults to 3.
+ * @note When `adaptiveConcurrency` is enabled, this is the count used when the foreground downloads are running but none is waiting.
  */
 @property (nonatomic, assign) NSUInteger maxConcurrentPrefetchCount;
 
+/**
+ * Whether to adjust the concurrent prefetch count by the foreground downloads of the manager's `TXWebImageDownloader`. Defaults to NO.
+ * When the foreground downloads (not in low priority) are waiting in the download queue, the prefetcher yields to `minConcurrentPrefetchCount`. When there is no foreground download, it scales up to the downloader's `maxConcurrentDownloads` (if larger). Otherwise, `maxConcurrentPrefetchCount` is used.
+ * @note The count is re-evaluated when any download starts or stops, so the in-progress prefetching is not cancelled, only the new ones wait. If the image loader is not a `TXWebImageDownloader`, this has no effect.
+ */
+@property (nonatomic, assign) BOOL adaptiveConcurrency;
+
+/**
+ * The concurrent prefetch count when yielding to the waiting foreground downloads, see `adaptiveConcurrency`. Defaults to 1.
+ */
+@property (nonatomic, assign) NSUInteger minConcurrentPrefetchCount;
+
+/**
+ * The concurrent prefetch count in use, which is limited by `adaptiveConcurrency` and `maxBytesPerMinute`. 0 means the prefetching is paused.
+ */
+@property (nonatomic, assign, readonly) NSUInteger currentConcurrentPrefetchCount;
+
+/**
+ * The maximum bytes to download by prefetching in the last minute. When reached, the prefetching is paused until the bytes downloaded in the last minute is below it. Defaults to 0, which means no limit.
+ */
+@property (nonatomic, assign) NSUInteger maxBytesPerMinute;
+
+/**
+ * The maximum bytes to download by prefetching in total, across all the tokens. When reached, the remaining URLs are skipped, while the in-progress ones still finish. Defaults to 0, which means no limit.
+ * @note Call `resetReceivedBytes` to start a new budget.
+ */
+@property (nonatomic, assign) NSUInteger maxTotalBytes;
+
+/**
+ * The bytes downloaded by prefetching in total, the URLs from cache are not counted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger receivedBytes;
+
+/**
+ * The bytes downloaded by prefetching in the last minute.
+ */
+@property (nonatomic, assign, readonly) NSUInteger receivedBytesInLastMinute;
+
+/**
+ * The utilization of the byte budgets, the larger one of `receivedBytesInLastMinute / maxBytesPerMinute` and `receivedBytes / maxTotalBytes`. 1 or above means the prefetching is paused or stopped. 0 if no budget is set.
+ */
+@property (nonatomic, assign, readonly) double byteBudgetUtilization;
+
+/**
+ * The maximum distance from the viewport for an item to be prefetched, in points. Items farther than this are dropped when the viewport updates, the in-progress one is cancelled. Defaults to 0, which means 2 times of the viewport length.
+ */
+@property (nonatomic, assign) CGFloat viewportPrefetchLength;
+
+/**
+ * The time used to predict the scroll position by the scroll velocity, the distance of items ahead of the scroll direction is reduced by `velocity * viewportVelocityLookahead`, and the one behind is increased. Defaults to 0.5 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval viewportVelocityLookahead;
+
+/**
+ * The prefetch mode. Defaults to SDWebImagePrefetchModeDefault.
+ */
+@property (nonatomic, assign) SDWebImagePrefetchMode mode;
+
+/**
+ * The thumbnail pixel size used by SDWebImagePrefetchModeThumbnail. Defaults to CGSizeZero, which means the mode is the same as the default one.
+ * @note Use the same size as the thumbnail loading for display, so the thumbnail in memory cache can be hit.
+ */
+@property (nonatomic, assign) CGSize thumbnailPixelSize;
+
+/**
+ * The maximum bytes to download for each prefetching (each token). When reached, the remaining URLs are skipped, while the in-progress ones still finish. Defaults to 0, which means no limit.
+ * @note The budget is captured when the prefetching starts.
+ */
+@property (nonatomic, assign) NSUInteger maxBytesPerToken;
+
+/**
+ * The count of the images downloaded by prefetching, the URLs from cache are not counted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger prefetchedCount;
+
+/**
+ * The count of the prefetched images which are later loaded from cache by any `TXWebImageManager`, each prefetched image is counted once. The loads of the prefetching itself are not counted. Compare it with `prefetchedCount` to measure how many prefetched images are actually used.
+ */
+@property (nonatomic, assign, readonly) NSUInteger laterHitCount;
+
 /**
  * The options for prefetcher. Defaults to SDWebImageLowPriority.
  */
@@ -134,6 +274,35 @@ typedef void(^TXWebImagePrefetcherCompletionBlock)(NSUInteger noOfFinishedUrls,
                                           progress:(nullable TXWebImagePrefetcherProgressBlock)progressBlock
                                          completed:(nullable TXWebImagePrefetcherCompletionBlock)completionBlock;
 
+/**
+ * Assign list of items to let TXWebImagePrefetcher to queue the prefetching by the distance to the viewport, the nearest one is prefetched first. Call `updateViewportWithOffset:length:velocity:` when the scroll view scrolls, to re-rank the pending items.
+ * The viewport prefetching use the same `maxConcurrentPrefetchCount` limit as the URL prefetching, but counted separately.
+ * The item dropped for out of the prefetch window is counted as skipped in the progressBlock and completionBlock.
+ *
+ * @param items           list of items to prefetch
+ * @param progressBlock   block to be called when progress updates
+ * @param completionBlock block to be called when the current prefetching is completed
+ * @return the token to cancel the current prefetching.
+ */
+- (nullable SDWebImagePrefetchToken *)prefetchItems:(nullable NSArray<SDWebImagePrefetchItem *> *)items
+                                           progress:(nullable TXWebImagePrefetcherProgressBlock)progressBlock
+                                          completed:(nullable TXWebImagePrefetcherCompletionBlock)completionBlock;
+
+/**
+ * Report the current viewport of the scroll view, to re-rank the pending items of viewport prefetching.
+ * The items farther than `viewportPrefetchLength` are dropped. The pending items which become visible are promoted, they start immediately without `SDWebImageLowPriority` and the concurrent limit, so the regular load for the same URL (like `sd_setImageWithURL:`) can join the download.
+ *
+ * @param offset   The start position of the viewport along the scroll axis, such as `contentOffset.y`
+ * @param length   The length of the viewport along the scroll axis, such as `bounds.size.height`
+ * @param velocity The scroll velocity in points per second, positive means the offset is increasing
+ */
+- (void)updateViewportWithOffset:(CGFloat)offset length:(CGFloat)length velocity:(CGFloat)velocity;
+
+/**
+ * Reset the `receivedBytes` and `receivedBytesInLastMinute` to zero, which restarts the byte budgets.
+ */
+- (void)resetReceivedBytes;
+
 /**
  * Remove and cancel all the prefeching for the prefetcher.
  */
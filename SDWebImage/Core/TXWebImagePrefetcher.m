@@ -8,18 +8,89 @@
 
 #import "TXWebImagePrefetcher.h"
 #import "TXAsyncBlockOperation.h"
+#import "TXImageCache.h"
+#import "TXWebImageDownloader.h"
+#import "TXWebImageError.h"
 #import "TXInternalMacros.h"
+#import "TXWebImageCacheHitObserver.h"
 #import <stdatomic.h>
 
+// The operation for disk-only prefetching, cancel the disk query and the loader operation
+@interface SDWebImagePrefetchDataOperation : NSObject <TXWebImageOperation>
+
+@property (nonatomic, assign, readonly, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, strong, nullable) id<TXWebImageOperation> loaderOperation;
+
+@end
+
+@implementation SDWebImagePrefetchDataOperation
+
+@synthesize cancelled = _cancelled;
+@synthesize loaderOperation = _loaderOperation;
+
+- (BOOL)isCancelled {
+    @synchronized (self) {
+        return _cancelled;
+    }
+}
+
+- (id<TXWebImageOperation>)loaderOperation {
+    @synchronized (self) {
+        return _loaderOperation;
+    }
+}
+
+- (void)setLoaderOperation:(id<TXWebImageOperation>)loaderOperation {
+    @synchronized (self) {
+        _loaderOperation = loaderOperation;
+        if (_cancelled) {
+            // Cancelled before the loader operation returned
+            [loaderOperation cancel];
+        }
+    }
+}
+
+- (void)cancel {
+    @synchronized (self) {
+        if (_cancelled) {
+            return;
+        }
+        _cancelled = YES;
+        [_loaderOperation cancel];
+    }
+}
+
+@end
+
+typedef NS_ENUM(NSUInteger, SDWebImagePrefetchItemState) {
+    SDWebImagePrefetchItemStatePending = 0,
+    SDWebImagePrefetchItemStateRunning,
+    SDWebImagePrefetchItemStateFinished,
+    SDWebImagePrefetchItemStateDropped
+};
+
+@interface SDWebImagePrefetchItem ()
+
+@property (atomic, assign, readwrite) CGFloat distance;
+// These are protected by the prefetcher's items lock
+@property (nonatomic, assign) BOOL visible;
+@property (nonatomic, assign) SDWebImagePrefetchItemState state;
+@property (nonatomic, weak) SDWebImagePrefetchToken *token;
+@property (nonatomic, weak) id<TXWebImageOperation> operation;
+
+@end
+
 @interface SDWebImagePrefetchToken () {
     @public
     // Though current implementation, `TXWebImageManager` completion block is always on main queue. But however, there is no guarantee in docs. And we may introduce config to specify custom queue in the future.
     // These value are just used as incrementing counter, keep thread-safe using memory_order_relaxed for performance.
     atomic_ulong _skippedCount;
     atomic_ulong _finishedCount;
+    atomic_ulong _receivedBytes;
     atomic_flag  _isAllFinished;
     
     unsigned long _totalCount;
+    unsigned long _maxBytes;
     
     // Used to ensure NSPointerArray thread safe
     SD_LOCK_DECLARE(_prefetchOperationsLock);
@@ -27,6 +98,7 @@
 }
 
 @property (nonatomic, copy, readwrite) NSArray<NSURL *> *urls;
+@property (nonatomic, copy, readwrite) NSArray<SDWebImagePrefetchItem *> *items;
 @property (nonatomic, strong) NSPointerArray *loadOperations;
 @property (nonatomic, strong) NSPointerArray *prefetchOperations;
 @property (nonatomic, weak) TXWebImagePrefetcher *prefetcher;
@@ -35,11 +107,30 @@
 
 @end
 
-@interface TXWebImagePrefetcher ()
+@interface TXWebImagePrefetcher () <TXWebImageCacheHitObserver> {
+    SD_LOCK_DECLARE(_itemsLock); // a lock to keep the viewport and items thread-safe
+    CGFloat _viewportOffset;
+    CGFloat _viewportLength;
+    CGFloat _viewportVelocity;
+    BOOL _hasViewport;
+    atomic_ulong _prefetchedCount;
+    atomic_ulong _laterHitCount;
+    SD_LOCK_DECLARE(_prefetchedURLsLock); // a lock to count each prefetched URL once
+    atomic_ulong _currentConcurrentPrefetchCount;
+    atomic_ulong _receivedBytes;
+    SD_LOCK_DECLARE(_byteSamplesLock); // a lock to keep the byte samples of last minute thread-safe
+    NSUInteger _receivedBytesInLastMinute;
+    BOOL _isResumeScheduled;
+}
 
 @property (strong, nonatomic, nonnull) TXWebImageManager *manager;
+@property (strong, nonatomic, nonnull) NSMutableArray<SDWebImagePrefetchItem *> *pendingItems; // sorted by distance
+@property (strong, nonatomic, nonnull) NSMutableArray<SDWebImagePrefetchItem *> *runningItems; // the promoted items are not included
 @property (strong, atomic, nonnull) NSMutableSet<SDWebImagePrefetchToken *> *runningTokens;
 @property (strong, nonatomic, nonnull) NSOperationQueue *prefetchQueue;
+@property (strong, nonatomic, nonnull) NSCache<NSURL *, NSNumber *> *prefetchedURLs; // the prefetched URLs which are not hit yet
+@property (strong, nonatomic, nonnull) NSMutableArray<NSNumber *> *byteSampleTimes; // the time of each download in last minute, ascending
+@property (strong, nonatomic, nonnull) NSMutableArray<NSNumber *> *byteSampleBytes; // the bytes of each download in last minute
 
 @end
 
@@ -65,17 +156,180 @@
         _options = SDWebImageLowPriority;
         _delegateQueue = dispatch_get_main_queue();
         _prefetchQueue = [NSOperationQueue new];
-        self.maxConcurrentPrefetchCount = 3;
+        _maxConcurrentPrefetchCount = 3;
+        _minConcurrentPrefetchCount = 1;
+        _viewportVelocityLookahead = 0.5;
+        _pendingItems = [NSMutableArray array];
+        _runningItems = [NSMutableArray array];
+        SD_LOCK_INIT(_itemsLock);
+        _prefetchedURLs = [NSCache new];
+        _prefetchedURLs.countLimit = 10000;
+        SD_LOCK_INIT(_prefetchedURLsLock);
+        _byteSampleTimes = [NSMutableArray array];
+        _byteSampleBytes = [NSMutableArray array];
+        SD_LOCK_INIT(_byteSamplesLock);
+        [TXWebImageManager addCacheHitObserver:self];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveDownloadNotification:) name:SDWebImageDownloadStartNotification object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveDownloadNotification:) name:SDWebImageDownloadStopNotification object:nil];
+        [self updateConcurrentPrefetchCount];
     }
     return self;
 }
 
+- (void)dealloc {
+    [TXWebImageManager removeCacheHitObserver:self];
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (void)setMaxConcurrentPrefetchCount:(NSUInteger)maxConcurrentPrefetchCount {
-    self.prefetchQueue.maxConcurrentOperationCount = maxConcurrentPrefetchCount;
+    _maxConcurrentPrefetchCount = maxConcurrentPrefetchCount;
+    [self updateConcurrentPrefetchCount];
 }
 
-- (NSUInteger)maxConcurrentPrefetchCount {
-    return self.prefetchQueue.maxConcurrentOperationCount;
+- (void)setMinConcurrentPrefetchCount:(NSUInteger)minConcurrentPrefetchCount {
+    _minConcurrentPrefetchCount = minConcurrentPrefetchCount;
+    [self updateConcurrentPrefetchCount];
+}
+
+- (void)setAdaptiveConcurrency:(BOOL)adaptiveConcurrency {
+    _adaptiveConcurrency = adaptiveConcurrency;
+    [self updateConcurrentPrefetchCount];
+}
+
+- (void)setMaxBytesPerMinute:(NSUInteger)maxBytesPerMinute {
+    _maxBytesPerMinute = maxBytesPerMinute;
+    [self updateConcurrentPrefetchCount];
+}
+
+- (NSUInteger)currentConcurrentPrefetchCount {
+    return atomic_load_explicit(&_currentConcurrentPrefetchCount, memory_order_relaxed);
+}
+
+#pragma mark - Concurrency
+- (void)didReceiveDownloadNotification:(NSNotification *)notification {
+    if (!self.adaptiveConcurrency) {
+        return;
+    }
+    [self updateConcurrentPrefetchCount];
+}
+
+- (NSUInteger)adaptiveConcurrentPrefetchCount {
+    NSUInteger maxConcurrentCount = self.maxConcurrentPrefetchCount;
+    if (!self.adaptiveConcurrency || ![self.manager.imageLoader isKindOfClass:[TXWebImageDownloader class]]) {
+        return maxConcurrentCount;
+    }
+    TXWebImageDownloader *downloader = (TXWebImageDownloader *)self.manager.imageLoader;
+    if (downloader.pendingForegroundDownloadCount > 0) {
+        // Yield to the waiting foreground downloads
+        return MIN(self.minConcurrentPrefetchCount, maxConcurrentCount);
+    }
+    if (downloader.currentForegroundDownloadCount == 0) {
+        // The downloader is idle, use all of its slots
+        return MAX(maxConcurrentCount, (NSUInteger)MAX(downloader.config.maxConcurrentDownloads, 0));
+    }
+    return maxConcurrentCount;
+}
+
+- (void)updateConcurrentPrefetchCount {
+    NSUInteger count = [self adaptiveConcurrentPrefetchCount];
+    if (self.maxBytesPerMinute > 0 && self.receivedBytesInLastMinute >= self.maxBytesPerMinute) {
+        // Pause until the downloads in last minute expire
+        count = 0;
+        [self scheduleResume];
+    }
+    NSUInteger oldCount = atomic_exchange_explicit(&_currentConcurrentPrefetchCount, count, memory_order_relaxed);
+    if (count > 0) {
+        self.prefetchQueue.maxConcurrentOperationCount = count;
+    }
+    self.prefetchQueue.suspended = count == 0;
+    if (count > oldCount) {
+        [self startPendingItems];
+    }
+}
+
+- (void)scheduleResume {
+    SD_LOCK(_byteSamplesLock);
+    NSNumber *oldestTime = self.byteSampleTimes.firstObject;
+    BOOL shouldSchedule = !_isResumeScheduled && oldestTime;
+    if (shouldSchedule) {
+        _isResumeScheduled = YES;
+    }
+    SD_UNLOCK(_byteSamplesLock);
+    if (!shouldSchedule) {
+        return;
+    }
+    NSTimeInterval delay = MAX(oldestTime.doubleValue + 60 - CFAbsoluteTimeGetCurrent(), 0);
+    @weakify(self);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        SD_LOCK(self->_byteSamplesLock);
+        self->_isResumeScheduled = NO;
+        SD_UNLOCK(self->_byteSamplesLock);
+        [self updateConcurrentPrefetchCount];
+    });
+}
+
+#pragma mark - Byte Budget
+- (void)addReceivedBytes:(NSUInteger)bytes {
+    atomic_fetch_add_explicit(&_receivedBytes, bytes, memory_order_relaxed);
+    SD_LOCK(_byteSamplesLock);
+    [self.byteSampleTimes addObject:@(CFAbsoluteTimeGetCurrent())];
+    [self.byteSampleBytes addObject:@(bytes)];
+    _receivedBytesInLastMinute += bytes;
+    SD_UNLOCK(_byteSamplesLock);
+    if (self.maxBytesPerMinute > 0) {
+        [self updateConcurrentPrefetchCount];
+    }
+}
+
+- (NSUInteger)receivedBytes {
+    return atomic_load_explicit(&_receivedBytes, memory_order_relaxed);
+}
+
+- (NSUInteger)receivedBytesInLastMinute {
+    CFAbsoluteTime expiredTime = CFAbsoluteTimeGetCurrent() - 60;
+    SD_LOCK(_byteSamplesLock);
+    NSUInteger expiredCount = 0;
+    for (NSNumber *time in self.byteSampleTimes) {
+        if (time.doubleValue > expiredTime) {
+            break;
+        }
+        _receivedBytesInLastMinute -= self.byteSampleBytes[expiredCount].unsignedIntegerValue;
+        expiredCount++;
+    }
+    if (expiredCount > 0) {
+        [self.byteSampleTimes removeObjectsInRange:NSMakeRange(0, expiredCount)];
+        [self.byteSampleBytes removeObjectsInRange:NSMakeRange(0, expiredCount)];
+    }
+    NSUInteger bytes = _receivedBytesInLastMinute;
+    SD_UNLOCK(_byteSamplesLock);
+    return bytes;
+}
+
+- (double)byteBudgetUtilization {
+    double utilization = 0;
+    NSUInteger maxBytesPerMinute = self.maxBytesPerMinute;
+    if (maxBytesPerMinute > 0) {
+        utilization = MAX(utilization, (double)self.receivedBytesInLastMinute / maxBytesPerMinute);
+    }
+    NSUInteger maxTotalBytes = self.maxTotalBytes;
+    if (maxTotalBytes > 0) {
+        utilization = MAX(utilization, (double)self.receivedBytes / maxTotalBytes);
+    }
+    return utilization;
+}
+
+- (void)resetReceivedBytes {
+    atomic_store_explicit(&_receivedBytes, 0, memory_order_relaxed);
+    SD_LOCK(_byteSamplesLock);
+    [self.byteSampleTimes removeAllObjects];
+    [self.byteSampleBytes removeAllObjects];
+    _receivedBytesInLastMinute = 0;
+    SD_UNLOCK(_byteSamplesLock);
+    [self updateConcurrentPrefetchCount];
 }
 
 #pragma mark - Prefetch
@@ -98,6 +352,8 @@
     token->_skippedCount = 0;
     token->_finishedCount = 0;
     token->_totalCount = token.urls.count;
+    token->_receivedBytes = 0;
+    token->_maxBytes = self.maxBytesPerToken;
     atomic_flag_clear(&(token->_isAllFinished));
     token.loadOperations = [NSPointerArray weakObjectsPointerArray];
     token.prefetchOperations = [NSPointerArray weakObjectsPointerArray];
@@ -118,33 +374,20 @@
                 if (!self || asyncOperation.isCancelled) {
                     return;
                 }
-                id<TXWebImageOperation> operation = [self.manager loadImageWithURL:url options:self.options context:self.context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+                id<TXWebImageOperation> operation = [self prefetchURL:url options:self.options token:token completed:^(NSError * _Nullable error) {
                     @strongify(self);
                     if (!self) {
                         return;
                     }
-                    if (!finished) {
-                        return;
-                    }
-                    atomic_fetch_add_explicit(&(token->_finishedCount), 1, memory_order_relaxed);
-                    if (error) {
-                        // Add last failed
-                        atomic_fetch_add_explicit(&(token->_skippedCount), 1, memory_order_relaxed);
-                    }
-                    
-                    // Current operation finished
-                    [self callProgressBlockForToken:token imageURL:imageURL];
-                    
-                    if (atomic_load_explicit(&(token->_finishedCount), memory_order_relaxed) == token->_totalCount) {
-                        // All finished
-                        if (!atomic_flag_test_and_set_explicit(&(token->_isAllFinished), memory_order_relaxed)) {
-                            [self callCompletionBlockForToken:token];
-                            [self removeRunningToken:token];
-                        }
-                    }
+                    [self finishPrefetchingForToken:token imageURL:url skipped:(error != nil)];
                     [asyncOperation complete];
                 }];
-                NSAssert(operation != nil, @"Operation should not be nil, [TXWebImageManager loadImageWithURL:options:context:progress:completed:] break prefetch logic");
+                if (!operation) {
+                    // The byte budget is exhausted
+                    [self finishPrefetchingForToken:token imageURL:url skipped:YES];
+                    [asyncOperation complete];
+                    return;
+                }
                 SD_LOCK(token->_loadOperationsLock);
                 [token.loadOperations addPointer:(__bridge void *)operation];
                 SD_UNLOCK(token->_loadOperationsLock);
@@ -157,6 +400,385 @@
     }
 }
 
+// Load the URL by the prefetch mode, the completion block is called once when finished. Return nil if the byte budget of token or the total byte budget is exhausted.
+- (nullable id<TXWebImageOperation>)prefetchURL:(nonnull NSURL *)url
+                                        options:(SDWebImageOptions)options
+                                          token:(nullable SDWebImagePrefetchToken *)token
+                                      completed:(nonnull void(^)(NSError * _Nullable error))completedBlock {
+    if (token && token->_maxBytes > 0 && atomic_load_explicit(&(token->_receivedBytes), memory_order_relaxed) >= token->_maxBytes) {
+        return nil;
+    }
+    NSUInteger maxTotalBytes = self.maxTotalBytes;
+    if (maxTotalBytes > 0 && self.receivedBytes >= maxTotalBytes) {
+        return nil;
+    }
+    SDWebImageContext *context = self.context;
+    SDWebImagePrefetchMode mode = self.mode;
+    // The prefetching itself is not the later hit
+    SDWebImageMutableContext *mutableContext = context ? [context mutableCopy] : [NSMutableDictionary dictionary];
+    mutableContext[SDWebImageContextIgnoresCacheHitObservers] = @(YES);
+    context = [mutableContext copy];
+    if (mode == SDWebImagePrefetchModeDiskOnly) {
+        id<TXImageCache> imageCache;
+        if ([context[SDWebImageContextImageCache] conformsToProtocol:@protocol(TXImageCache)]) {
+            imageCache = context[SDWebImageContextImageCache];
+        } else {
+            imageCache = self.manager.imageCache;
+        }
+        if ([imageCache isKindOfClass:[TXImageCache class]]) {
+            return [self prefetchDataWithURL:url options:options context:context imageCache:(TXImageCache *)imageCache token:token completed:completedBlock];
+        }
+    } else if (mode == SDWebImagePrefetchModeThumbnail) {
+        CGSize thumbnailPixelSize = self.thumbnailPixelSize;
+        if (thumbnailPixelSize.width > 0 && thumbnailPixelSize.height > 0) {
+            mutableContext[SDWebImageContextImageThumbnailPixelSize] = @(thumbnailPixelSize);
+            context = [mutableContext copy];
+        }
+    }
+    @weakify(self);
+    return [self.manager loadImageWithURL:url options:options context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        if (!finished) {
+            return;
+        }
+        if (!error && cacheType == TXImageCacheTypeNone) {
+            [self didPrefetchURL:url bytes:data.length token:token];
+        }
+        completedBlock(error);
+    }];
+}
+
+// Download and store the image data to disk cache only, without decoding
+- (nonnull id<TXWebImageOperation>)prefetchDataWithURL:(nonnull NSURL *)url
+                                               options:(SDWebImageOptions)options
+                                               context:(nullable SDWebImageContext *)context
+                                            imageCache:(nonnull TXImageCache *)imageCache
+                                                 token:(nullable SDWebImagePrefetchToken *)token
+                                             completed:(nonnull void(^)(NSError * _Nullable error))completedBlock {
+    NSString *key = [self.manager cacheKeyForURL:url context:context];
+    id<TXImageLoader> imageLoader;
+    if ([context[SDWebImageContextImageLoader] conformsToProtocol:@protocol(TXImageLoader)]) {
+        imageLoader = context[SDWebImageContextImageLoader];
+    } else {
+        imageLoader = self.manager.imageLoader;
+    }
+    SDWebImageMutableContext *mutableContext = context ? [context mutableCopy] : [NSMutableDictionary dictionary];
+    mutableContext[SDWebImageContextDownloadDataOnly] = @(YES);
+    SDWebImageContext *dataContext = [mutableContext copy];
+    
+    SDWebImagePrefetchDataOperation *operation = [SDWebImagePrefetchDataOperation new];
+    @weakify(self);
+    [imageCache diskImageExistsWithKey:key completion:^(BOOL isInCache) {
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        if (operation.isCancelled) {
+            completedBlock([NSError errorWithDomain:TXWebImageErrorDomain code:TXWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user before sending the request"}]);
+            return;
+        }
+        if (isInCache) {
+            completedBlock(nil);
+            return;
+        }
+        // The item and the token hold the operation weakly, the loader completion block keeps it alive until the download ends, so that it can be cancelled
+        operation.loaderOperation = [imageLoader requestImageWithURL:url options:options context:dataContext progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            if (!finished) {
+                return;
+            }
+            BOOL isCancelled = operation.isCancelled;
+            operation.loaderOperation = nil;
+            if (isCancelled && !error) {
+                error = [NSError errorWithDomain:TXWebImageErrorDomain code:TXWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user during the download"}];
+            }
+            if (error || data.length == 0) {
+                completedBlock(error ?: [NSError errorWithDomain:TXWebImageErrorDomain code:TXWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : @"Image data is nil"}]);
+                return;
+            }
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+                [imageCache storeImageDataToDisk:data forKey:key];
+                @strongify(self);
+                [self didPrefetchURL:url bytes:data.length token:token];
+                completedBlock(nil);
+            });
+        }];
+    }];
+    return operation;
+}
+
+- (void)finishPrefetchingForToken:(SDWebImagePrefetchToken *)token imageURL:(NSURL *)imageURL skipped:(BOOL)skipped {
+    if (!token) {
+        return;
+    }
+    atomic_fetch_add_explicit(&(token->_finishedCount), 1, memory_order_relaxed);
+    if (skipped) {
+        // Add last failed
+        atomic_fetch_add_explicit(&(token->_skippedCount), 1, memory_order_relaxed);
+    }
+    
+    // Current operation finished
+    [self callProgressBlockForToken:token imageURL:imageURL];
+    
+    if (atomic_load_explicit(&(token->_finishedCount), memory_order_relaxed) == token->_totalCount) {
+        // All finished
+        if (!atomic_flag_test_and_set_explicit(&(token->_isAllFinished), memory_order_relaxed)) {
+            [self callCompletionBlockForToken:token];
+            [self removeRunningToken:token];
+        }
+    }
+}
+
+#pragma mark - Viewport Prefetch
+- (nullable SDWebImagePrefetchToken *)prefetchItems:(nullable NSArray<SDWebImagePrefetchItem *> *)items
+                                           progress:(nullable TXWebImagePrefetcherProgressBlock)progressBlock
+                                          completed:(nullable TXWebImagePrefetcherCompletionBlock)completionBlock {
+    if (!items || items.count == 0) {
+        if (completionBlock) {
+            completionBlock(0, 0);
+        }
+        return nil;
+    }
+    SDWebImagePrefetchToken *token = [SDWebImagePrefetchToken new];
+    token.prefetcher = self;
+    token.items = items;
+    token.urls = [items valueForKey:NSStringFromSelector(@selector(url))];
+    token->_skippedCount = 0;
+    token->_finishedCount = 0;
+    token->_totalCount = token.items.count;
+    token->_receivedBytes = 0;
+    token->_maxBytes = self.maxBytesPerToken;
+    atomic_flag_clear(&(token->_isAllFinished));
+    token.loadOperations = [NSPointerArray weakObjectsPointerArray];
+    token.prefetchOperations = [NSPointerArray weakObjectsPointerArray];
+    token.progressBlock = progressBlock;
+    token.completionBlock = completionBlock;
+    [self addRunningToken:token];
+    
+    NSMutableArray<SDWebImagePrefetchItem *> *droppedItems = [NSMutableArray array];
+    NSMutableArray<SDWebImagePrefetchItem *> *promotedItems = [NSMutableArray array];
+    SD_LOCK(_itemsLock);
+    CGFloat prefetchLength = [self currentViewportPrefetchLength];
+    for (SDWebImagePrefetchItem *item in items) {
+        item.token = token;
+        item.state = SDWebImagePrefetchItemStatePending;
+        [self updateDistanceForItem:item];
+        if (_hasViewport && item.visible) {
+            item.state = SDWebImagePrefetchItemStateRunning;
+            [promotedItems addObject:item];
+        } else if (_hasViewport && item.distance > prefetchLength) {
+            item.state = SDWebImagePrefetchItemStateDropped;
+            [droppedItems addObject:item];
+        } else {
+            [self.pendingItems addObject:item];
+        }
+    }
+    [self sortPendingItems];
+    SD_UNLOCK(_itemsLock);
+    
+    for (SDWebImagePrefetchItem *item in promotedItems) {
+        [self startItem:item promoted:YES];
+    }
+    for (SDWebImagePrefetchItem *item in droppedItems) {
+        [self finishPrefetchingForToken:token imageURL:item.url skipped:YES];
+    }
+    [self startPendingItems];
+    
+    return token;
+}
+
+- (void)updateViewportWithOffset:(CGFloat)offset length:(CGFloat)length velocity:(CGFloat)velocity {
+    NSMutableArray<SDWebImagePrefetchItem *> *droppedItems = [NSMutableArray array];
+    NSMutableArray<SDWebImagePrefetchItem *> *promotedItems = [NSMutableArray array];
+    NSMutableArray<id<TXWebImageOperation>> *droppedOperations = [NSMutableArray array];
+    SD_LOCK(_itemsLock);
+    _viewportOffset = offset;
+    _viewportLength = MAX(length, 0);
+    _viewportVelocity = velocity;
+    _hasViewport = YES;
+    CGFloat prefetchLength = [self currentViewportPrefetchLength];
+    NSMutableIndexSet *removedIndexes = [NSMutableIndexSet indexSet];
+    [self.pendingItems enumerateObjectsUsingBlock:^(SDWebImagePrefetchItem * _Nonnull item, NSUInteger idx, BOOL * _Nonnull stop) {
+        [self updateDistanceForItem:item];
+        if (item.visible) {
+            // Promote to start immediately
+            item.state = SDWebImagePrefetchItemStateRunning;
+            [promotedItems addObject:item];
+            [removedIndexes addIndex:idx];
+        } else if (item.distance > prefetchLength) {
+            item.state = SDWebImagePrefetchItemStateDropped;
+            [droppedItems addObject:item];
+            [removedIndexes addIndex:idx];
+        }
+    }];
+    [self.pendingItems removeObjectsAtIndexes:removedIndexes];
+    [removedIndexes removeAllIndexes];
+    [self.runningItems enumerateObjectsUsingBlock:^(SDWebImagePrefetchItem * _Nonnull item, NSUInteger idx, BOOL * _Nonnull stop) {
+        [self updateDistanceForItem:item];
+        if (!item.visible && item.distance > prefetchLength) {
+            item.state = SDWebImagePrefetchItemStateDropped;
+            [droppedItems addObject:item];
+            [removedIndexes addIndex:idx];
+            id<TXWebImageOperation> operation = item.operation;
+            if (operation) {
+                [droppedOperations addObject:operation];
+            }
+        }
+    }];
+    [self.runningItems removeObjectsAtIndexes:removedIndexes];
+    [self sortPendingItems];
+    SD_UNLOCK(_itemsLock);
+    
+    for (id<TXWebImageOperation> operation in droppedOperations) {
+        [operation cancel];
+    }
+    for (SDWebImagePrefetchItem *item in droppedItems) {
+        [self finishPrefetchingForToken:item.token imageURL:item.url skipped:YES];
+    }
+    for (SDWebImagePrefetchItem *item in promotedItems) {
+        [self startItem:item promoted:YES];
+    }
+    [self startPendingItems];
+}
+
+// Start the nearest pending items until reach the concurrent limit
+- (void)startPendingItems {
+    NSMutableArray<SDWebImagePrefetchItem *> *startedItems = [NSMutableArray array];
+    NSUInteger maxConcurrentCount = self.currentConcurrentPrefetchCount;
+    SD_LOCK(_itemsLock);
+    while (self.runningItems.count < maxConcurrentCount && self.pendingItems.count > 0) {
+        SDWebImagePrefetchItem *item = self.pendingItems.firstObject;
+        [self.pendingItems removeObjectAtIndex:0];
+        item.state = SDWebImagePrefetchItemStateRunning;
+        [self.runningItems addObject:item];
+        [startedItems addObject:item];
+    }
+    SD_UNLOCK(_itemsLock);
+    
+    for (SDWebImagePrefetchItem *item in startedItems) {
+        [self startItem:item promoted:NO];
+    }
+}
+
+- (void)startItem:(SDWebImagePrefetchItem *)item promoted:(BOOL)promoted {
+    SDWebImageOptions options = self.options;
+    if (promoted) {
+        options = (options & ~SDWebImageLowPriority) | SDWebImageHighPriority;
+    }
+    @weakify(self);
+    id<TXWebImageOperation> operation = [self prefetchURL:item.url options:options token:item.token completed:^(NSError * _Nullable error) {
+        @strongify(self);
+        [self finishItem:item skipped:(error != nil)];
+    }];
+    if (!operation) {
+        // The byte budget is exhausted
+        [self finishItem:item skipped:YES];
+        return;
+    }
+    SD_LOCK(_itemsLock);
+    BOOL isDropped = item.state == SDWebImagePrefetchItemStateDropped;
+    if (!isDropped) {
+        item.operation = operation;
+    }
+    SD_UNLOCK(_itemsLock);
+    if (isDropped) {
+        // Dropped before the operation returned
+        [operation cancel];
+        return;
+    }
+    SDWebImagePrefetchToken *token = item.token;
+    if (token) {
+        SD_LOCK(token->_loadOperationsLock);
+        [token.loadOperations addPointer:(__bridge void *)operation];
+        SD_UNLOCK(token->_loadOperationsLock);
+    }
+}
+
+- (void)finishItem:(SDWebImagePrefetchItem *)item skipped:(BOOL)skipped {
+    SD_LOCK(_itemsLock);
+    // The dropped or cancelled item is already counted
+    BOOL isRunning = item.state == SDWebImagePrefetchItemStateRunning;
+    if (isRunning) {
+        item.state = SDWebImagePrefetchItemStateFinished;
+        [self.runningItems removeObjectIdenticalTo:item];
+    }
+    SD_UNLOCK(_itemsLock);
+    if (isRunning) {
+        [self finishPrefetchingForToken:item.token imageURL:item.url skipped:skipped];
+    }
+    [self startPendingItems];
+}
+
+- (void)cancelItemsForToken:(SDWebImagePrefetchToken *)token {
+    if (!token.items) {
+        return;
+    }
+    SD_LOCK(_itemsLock);
+    for (SDWebImagePrefetchItem *item in token.items) {
+        if (item.state == SDWebImagePrefetchItemStatePending || item.state == SDWebImagePrefetchItemStateRunning) {
+            item.state = SDWebImagePrefetchItemStateDropped;
+        }
+    }
+    [self.pendingItems filterUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(SDWebImagePrefetchItem * _Nullable item, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return item.token != token;
+    }]];
+    [self.runningItems filterUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(SDWebImagePrefetchItem * _Nullable item, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return item.token != token;
+    }]];
+    SD_UNLOCK(_itemsLock);
+    // The load operations are cancelled by token
+    [self startPendingItems];
+}
+
+// Should be called inside the items lock
+- (CGFloat)currentViewportPrefetchLength {
+    CGFloat prefetchLength = self.viewportPrefetchLength;
+    if (prefetchLength <= 0) {
+        prefetchLength = _viewportLength * 2;
+    }
+    return prefetchLength;
+}
+
+// Should be called inside the items lock
+- (void)updateDistanceForItem:(SDWebImagePrefetchItem *)item {
+    CGFloat itemStart = item.position;
+    CGFloat itemEnd = item.position + MAX(item.length, 0);
+    CGFloat viewportStart = _viewportOffset;
+    CGFloat viewportEnd = _viewportOffset + _viewportLength;
+    CGFloat distance;
+    BOOL isAhead;
+    if (itemEnd <= viewportStart) {
+        distance = viewportStart - itemEnd;
+        isAhead = _viewportVelocity < 0;
+    } else if (itemStart >= viewportEnd) {
+        distance = itemStart - viewportEnd;
+        isAhead = _viewportVelocity > 0;
+    } else {
+        item.visible = YES;
+        item.distance = 0;
+        return;
+    }
+    CGFloat lookahead = fabs(_viewportVelocity) * self.viewportVelocityLookahead;
+    item.visible = NO;
+    item.distance = isAhead ? MAX(distance - lookahead, 0) : distance + lookahead;
+}
+
+// Should be called inside the items lock
+- (void)sortPendingItems {
+    [self.pendingItems sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(SDWebImagePrefetchItem * _Nonnull item1, SDWebImagePrefetchItem * _Nonnull item2) {
+        CGFloat distance1 = item1.distance;
+        CGFloat distance2 = item2.distance;
+        if (distance1 < distance2) {
+            return NSOrderedAscending;
+        } else if (distance1 > distance2) {
+            return NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+}
+
 #pragma mark - Cancel
 - (void)cancelPrefetching {
     @synchronized(self.runningTokens) {
@@ -204,6 +826,39 @@
     });
 }
 
+#pragma mark - Later Hit
+- (void)didPrefetchURL:(NSURL *)url bytes:(NSUInteger)bytes token:(SDWebImagePrefetchToken *)token {
+    if (token) {
+        atomic_fetch_add_explicit(&(token->_receivedBytes), bytes, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&_prefetchedCount, 1, memory_order_relaxed);
+    SD_LOCK(_prefetchedURLsLock);
+    [self.prefetchedURLs setObject:@(YES) forKey:url];
+    SD_UNLOCK(_prefetchedURLsLock);
+    [self addReceivedBytes:bytes];
+}
+
+// The loads of any manager, except the prefetching itself
+- (void)imageManager:(TXWebImageManager *)imageManager didHitCacheWithURL:(NSURL *)url cacheType:(TXImageCacheType)cacheType {
+    SD_LOCK(_prefetchedURLsLock);
+    BOOL isPrefetched = [self.prefetchedURLs objectForKey:url] != nil;
+    if (isPrefetched) {
+        [self.prefetchedURLs removeObjectForKey:url];
+    }
+    SD_UNLOCK(_prefetchedURLsLock);
+    if (isPrefetched) {
+        atomic_fetch_add_explicit(&_laterHitCount, 1, memory_order_relaxed);
+    }
+}
+
+- (NSUInteger)prefetchedCount {
+    return atomic_load_explicit(&_prefetchedCount, memory_order_relaxed);
+}
+
+- (NSUInteger)laterHitCount {
+    return atomic_load_explicit(&_laterHitCount, memory_order_relaxed);
+}
+
 #pragma mark - Helper
 - (NSUInteger)tokenTotalCount {
     NSUInteger tokenTotalCount = 0;
@@ -263,6 +918,19 @@
 
 @end
 
+@implementation SDWebImagePrefetchItem
+
++ (instancetype)itemWithURL:(NSURL *)url position:(CGFloat)position length:(CGFloat)length {
+    SDWebImagePrefetchItem *item = [[self alloc] init];
+    item->_url = url;
+    item->_position = position;
+    item->_length = length;
+    item->_distance = position;
+    return item;
+}
+
+@end
+
 @implementation SDWebImagePrefetchToken
 
 - (instancetype)init {
@@ -274,7 +942,12 @@
     return self;
 }
 
+- (NSUInteger)receivedBytes {
+    return atomic_load_explicit(&_receivedBytes, memory_order_relaxed);
+}
+
 - (void)cancel {
+    [self.prefetcher cancelItemsForToken:self];
     SD_LOCK(_prefetchOperationsLock);
     [self.prefetchOperations compact];
     for (id operation in self.prefetchOperations) {
@@ -0,0 +1,133 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageCompat.h"
+#import "TXWebImageDefine.h"
+#import "TXImageCacheDefine.h"
+
+/// The stage of an image request. The stage named with `Wait` is the time waiting in a queue, before the stage following it starts to execute.
+typedef NS_ENUM(NSUInteger, SDWebImageTimelineStage) {
+    /// Lookup the memory cache
+    SDWebImageTimelineStageMemoryQuery = 0,
+    /// Wait in the `ioQueue` of `TXImageCache` before reading disk
+    SDWebImageTimelineStageDiskQueueWait,
+    /// Read the data from disk cache
+    SDWebImageTimelineStageDiskRead,
+    /// The whole image loader request, from the request sent to the completion, including the download and decode below. The coalesced requests sharing one download only have this stage.
+    SDWebImageTimelineStageLoad,
+    /// Wait in the download queue of `TXWebImageDownloader`
+    SDWebImageTimelineStageDownloadQueueWait,
+    /// Download from network, from the operation started to the response completed
+    SDWebImageTimelineStageDownload,
+    /// Wait in the coder queue before decoding the downloaded data
+    SDWebImageTimelineStageDecodeQueueWait,
+    /// Decode the image data, from disk cache or network
+    SDWebImageTimelineStageDecode,
+    /// Wait in the global queue before transforming
+    SDWebImageTimelineStageTransformQueueWait,
+    /// Apply the transformer
+    SDWebImageTimelineStageTransform,
+    /// Store the image to cache, until the store finished if `SDWebImageWaitStoreCache` is set, else until the store is submitted
+    SDWebImageTimelineStageStore,
+};
+
+/**
+ The timeline of an image request by `TXWebImageManager`, the timestamps of each stage and the result. It's available through `SDWebImageCombinedOperation.timeline` and delivered to the `TXWebImageTimelineObserver`.
+ The timestamps are in nanoseconds from the monotonic clock (see `+currentTime`), only useful for the relative time. If a stage happens more than once (like the image refresh), the last one is kept.
+ @note The timeline is only created when the manager has a `timelineObserver`, so there is near-zero overhead without an observer. It's passed through the context with `SDWebImageContextTimeline`, a custom image cache or loader can record the stages as well.
+ @note This class is thread-safe.
+ */
+@interface TXWebImageTimeline : NSObject
+
+/// The image URL
+@property (nonatomic, strong, readonly, nullable) NSURL *url;
+/// The time when the request started
+@property (nonatomic, assign, readonly) uint64_t startTime;
+/// The time when the request finished, 0 if not finished yet
+@property (atomic, assign, readonly) uint64_t endTime;
+/// Whether the request is finished, the observer is called at that time
+@property (atomic, assign, readonly, getter=isFinished) BOOL finished;
+
+/// The cache type where the image is hit, `TXImageCacheTypeNone` if loaded from the image loader
+@property (atomic, assign) TXImageCacheType cacheType;
+/// The image data length, from disk cache or network
+@property (atomic, assign) NSUInteger dataLength;
+/// The pixel count of the decoded image
+@property (atomic, assign) NSUInteger decodedPixels;
+/// The class name of the coder which decoded the image
+@property (atomic, copy, nullable) NSString *coderName;
+/// The error of the request, nil if succeed
+@property (atomic, strong, nullable) NSError *error;
+
+/// Create the timeline, the start time is now
+- (nonnull instancetype)initWithURL:(nullable NSURL *)url NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/// The current time of the monotonic clock, in nanoseconds
++ (uint64_t)currentTime;
+/// The name of the stage for display, like "DiskRead"
++ (nonnull NSString *)nameForStage:(SDWebImageTimelineStage)stage;
+/// All the stages in the pipeline order
++ (nonnull NSArray<NSNumber *> *)allStages;
+
+/// Mark the stage started now
+- (void)beginStage:(SDWebImageTimelineStage)stage;
+/// Mark the stage ended now
+- (void)endStage:(SDWebImageTimelineStage)stage;
+/// Mark the wait stage ended and the execution stage started, with the same timestamp
+- (void)endStage:(SDWebImageTimelineStage)waitStage beginStage:(SDWebImageTimelineStage)stage;
+
+/// The start time of the stage, 0 if the stage is not started
+- (uint64_t)startTimeForStage:(SDWebImageTimelineStage)stage;
+/// The end time of the stage, 0 if the stage is not ended
+- (uint64_t)endTimeForStage:(SDWebImageTimelineStage)stage;
+/// The duration of the stage in nanoseconds, 0 if the stage is not ended
+- (uint64_t)durationForStage:(SDWebImageTimelineStage)stage;
+
+/// Record the decoded image, the pixel count and the coder which can decode the data. The coder is from `SDWebImageContextImageCoder` if provided, else the one picked by `TXImageCodersManager`.
+- (void)recordDecodedImage:(nullable UIImage *)image data:(nullable NSData *)data context:(nullable SDWebImageContext *)context;
+
+/// Mark the request finished now. Return NO if already finished.
+- (BOOL)finishWithError:(nullable NSError *)error;
+
+@end
+
+/**
+ The observer of the finished image request timeline, see `TXWebImageManager.timelineObserver`.
+ */
+@protocol TXWebImageTimelineObserver <NSObject>
+
+/// Called once when the request finished (including error and cancel), on the queue which finishes the request, before the completion block is dispatched to the main queue. The observer should return quickly.
+- (void)didFinishTimeline:(nonnull TXWebImageTimeline *)timeline;
+
+@end
+
+/**
+ The observer which collects the timelines, and export to the Chrome trace event JSON format. Open the file with `chrome://tracing` or Perfetto UI to visualize the requests, each request is shown in its own row.
+ */
+@interface TXWebImageTraceExporter : NSObject <TXWebImageTimelineObserver>
+
+/// The maximum count of the timelines kept, the oldest one is removed when exceeding. Defaults to 10000.
+@property (atomic, assign) NSUInteger maxTimelineCount;
+
+/// The collected timelines, in finish order
+@property (nonatomic, copy, readonly, nonnull) NSArray<TXWebImageTimeline *> *timelines;
+
+/// Remove all the collected timelines
+- (void)removeAllTimelines;
+
+/// Export the collected timelines to the Chrome trace event JSON
+- (nullable NSData *)traceEventJSONData;
+
+/// Export the collected timelines and write to the file
+- (BOOL)writeTraceEventJSONToFile:(nonnull NSString *)path error:(NSError * _Nullable * _Nullable)error;
+
+/// Export the timelines to the Chrome trace event JSON. The time is relative to the earliest start time of the timelines.
++ (nullable NSData *)traceEventJSONDataWithTimelines:(nonnull NSArray<TXWebImageTimeline *> *)timelines;
+
+@end
@@ -0,0 +1,317 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageTimeline.h"
+#import "TXImageCodersManager.h"
+#import "TXInternalMacros.h"
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+#define SD_TIMELINE_STAGE_COUNT (SDWebImageTimelineStageStore + 1)
+
+@interface TXWebImageTimeline () {
+    SD_LOCK_DECLARE(_stagesLock);
+    uint64_t _stageStartTimes[SD_TIMELINE_STAGE_COUNT];
+    uint64_t _stageEndTimes[SD_TIMELINE_STAGE_COUNT];
+    atomic_flag _isFinished;
+}
+
+@property (atomic, assign, readwrite) uint64_t endTime;
+@property (atomic, assign, readwrite, getter=isFinished) BOOL finished;
+
+@end
+
+@implementation TXWebImageTimeline
+
++ (uint64_t)currentTime {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    uint64_t time = mach_absolute_time();
+    if (timebase.numer == timebase.denom) {
+        return time;
+    }
+    return (uint64_t)((double)time * timebase.numer / timebase.denom);
+}
+
++ (NSString *)nameForStage:(SDWebImageTimelineStage)stage {
+    switch (stage) {
+        case SDWebImageTimelineStageMemoryQuery:
+            return @"MemoryQuery";
+        case SDWebImageTimelineStageDiskQueueWait:
+            return @"DiskQueueWait";
+        case SDWebImageTimelineStageDiskRead:
+            return @"DiskRead";
+        case SDWebImageTimelineStageLoad:
+            return @"Load";
+        case SDWebImageTimelineStageDownloadQueueWait:
+            return @"DownloadQueueWait";
+        case SDWebImageTimelineStageDownload:
+            return @"Download";
+        case SDWebImageTimelineStageDecodeQueueWait:
+            return @"DecodeQueueWait";
+        case SDWebImageTimelineStageDecode:
+            return @"Decode";
+        case SDWebImageTimelineStageTransformQueueWait:
+            return @"TransformQueueWait";
+        case SDWebImageTimelineStageTransform:
+            return @"Transform";
+        case SDWebImageTimelineStageStore:
+            return @"Store";
+    }
+    return @"Unknown";
+}
+
++ (NSArray<NSNumber *> *)allStages {
+    static NSArray<NSNumber *> *stages;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableArray<NSNumber *> *mutableStages = [NSMutableArray arrayWithCapacity:SD_TIMELINE_STAGE_COUNT];
+        for (NSUInteger stage = 0; stage < SD_TIMELINE_STAGE_COUNT; stage++) {
+            [mutableStages addObject:@(stage)];
+        }
+        stages = [mutableStages copy];
+    });
+    return stages;
+}
+
+- (instancetype)initWithURL:(NSURL *)url {
+    self = [super init];
+    if (self) {
+        _url = url;
+        _startTime = [TXWebImageTimeline currentTime];
+        _cacheType = TXImageCacheTypeNone;
+        SD_LOCK_INIT(_stagesLock);
+        atomic_flag_clear(&_isFinished);
+    }
+    return self;
+}
+
+- (void)beginStage:(SDWebImageTimelineStage)stage {
+    if (stage >= SD_TIMELINE_STAGE_COUNT) {
+        return;
+    }
+    uint64_t time = [TXWebImageTimeline currentTime];
+    SD_LOCK(_stagesLock);
+    _stageStartTimes[stage] = time;
+    _stageEndTimes[stage] = 0;
+    SD_UNLOCK(_stagesLock);
+}
+
+- (void)endStage:(SDWebImageTimelineStage)stage {
+    if (stage >= SD_TIMELINE_STAGE_COUNT) {
+        return;
+    }
+    uint64_t time = [TXWebImageTimeline currentTime];
+    SD_LOCK(_stagesLock);
+    if (_stageStartTimes[stage] > 0) {
+        _stageEndTimes[stage] = time;
+    }
+    SD_UNLOCK(_stagesLock);
+}
+
+- (void)endStage:(SDWebImageTimelineStage)waitStage beginStage:(SDWebImageTimelineStage)stage {
+    if (waitStage >= SD_TIMELINE_STAGE_COUNT || stage >= SD_TIMELINE_STAGE_COUNT) {
+        return;
+    }
+    uint64_t time = [TXWebImageTimeline currentTime];
+    SD_LOCK(_stagesLock);
+    if (_stageStartTimes[waitStage] > 0) {
+        _stageEndTimes[waitStage] = time;
+    }
+    _stageStartTimes[stage] = time;
+    _stageEndTimes[stage] = 0;
+    SD_UNLOCK(_stagesLock);
+}
+
+- (uint64_t)startTimeForStage:(SDWebImageTimelineStage)stage {
+    if (stage >= SD_TIMELINE_STAGE_COUNT) {
+        return 0;
+    }
+    SD_LOCK(_stagesLock);
+    uint64_t time = _stageStartTimes[stage];
+    SD_UNLOCK(_stagesLock);
+    return time;
+}
+
+- (uint64_t)endTimeForStage:(SDWebImageTimelineStage)stage {
+    if (stage >= SD_TIMELINE_STAGE_COUNT) {
+        return 0;
+    }
+    SD_LOCK(_stagesLock);
+    uint64_t time = _stageEndTimes[stage];
+    SD_UNLOCK(_stagesLock);
+    return time;
+}
+
+- (uint64_t)durationForStage:(SDWebImageTimelineStage)stage {
+    if (stage >= SD_TIMELINE_STAGE_COUNT) {
+        return 0;
+    }
+    SD_LOCK(_stagesLock);
+    uint64_t startTime = _stageStartTimes[stage];
+    uint64_t endTime = _stageEndTimes[stage];
+    SD_UNLOCK(_stagesLock);
+    if (endTime < startTime) {
+        return 0;
+    }
+    return endTime - startTime;
+}
+
+- (void)recordDecodedImage:(UIImage *)image data:(NSData *)data context:(SDWebImageContext *)context {
+    if (image) {
+        CGImageRef imageRef = image.CGImage;
+        if (imageRef) {
+            self.decodedPixels = CGImageGetWidth(imageRef) * CGImageGetHeight(imageRef);
+        } else {
+            self.decodedPixels = (NSUInteger)(image.size.width * image.scale * image.size.height * image.scale);
+        }
+    }
+    if (!data) {
+        return;
+    }
+    id<TXImageCoder> imageCoder = context[SDWebImageContextImageCoder];
+    if (![imageCoder conformsToProtocol:@protocol(TXImageCoder)]) {
+        imageCoder = nil;
+        // Same order as `TXImageCodersManager`, the later added coder has the higher priority
+        for (id<TXImageCoder> coder in TXImageCodersManager.sharedManager.coders.reverseObjectEnumerator) {
+            if ([coder canDecodeFromData:data]) {
+                imageCoder = coder;
+                break;
+            }
+        }
+    }
+    if (imageCoder) {
+        self.coderName = NSStringFromClass(imageCoder.class);
+    }
+}
+
+- (BOOL)finishWithError:(NSError *)error {
+    if (atomic_flag_test_and_set(&_isFinished)) {
+        return NO;
+    }
+    self.error = error;
+    self.endTime = [TXWebImageTimeline currentTime];
+    self.finished = YES;
+    return YES;
+}
+
+- (NSString *)description {
+    NSMutableString *description = [NSMutableString stringWithFormat:@"<%@: %p, url: %@, cacheType: %ld", self.class, self, self.url, (long)self.cacheType];
+    for (NSNumber *stage in [TXWebImageTimeline allStages]) {
+        uint64_t duration = [self durationForStage:stage.unsignedIntegerValue];
+        if (duration > 0) {
+            [description appendFormat:@", %@: %.3fms", [TXWebImageTimeline nameForStage:stage.unsignedIntegerValue], duration / 1e6];
+        }
+    }
+    [description appendString:@">"];
+    return [description copy];
+}
+
+@end
+
+@interface TXWebImageTraceExporter () {
+    SD_LOCK_DECLARE(_timelinesLock);
+}
+
+@property (nonatomic, strong, nonnull) NSMutableArray<TXWebImageTimeline *> *mutableTimelines;
+
+@end
+
+@implementation TXWebImageTraceExporter
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _maxTimelineCount = 10000;
+        _mutableTimelines = [NSMutableArray array];
+        SD_LOCK_INIT(_timelinesLock);
+    }
+    return self;
+}
+
+- (void)didFinishTimeline:(TXWebImageTimeline *)timeline {
+    NSUInteger maxTimelineCount = self.maxTimelineCount;
+    SD_LOCK(_timelinesLock);
+    [self.mutableTimelines addObject:timeline];
+    if (maxTimelineCount > 0 && self.mutableTimelines.count > maxTimelineCount) {
+        [self.mutableTimelines removeObjectsInRange:NSMakeRange(0, self.mutableTimelines.count - maxTimelineCount)];
+    }
+    SD_UNLOCK(_timelinesLock);
+}
+
+- (NSArray<TXWebImageTimeline *> *)timelines {
+    SD_LOCK(_timelinesLock);
+    NSArray<TXWebImageTimeline *> *timelines = [self.mutableTimelines copy];
+    SD_UNLOCK(_timelinesLock);
+    return timelines;
+}
+
+- (void)removeAllTimelines {
+    SD_LOCK(_timelinesLock);
+    [self.mutableTimelines removeAllObjects];
+    SD_UNLOCK(_timelinesLock);
+}
+
+- (NSData *)traceEventJSONData {
+    return [[self class] traceEventJSONDataWithTimelines:self.timelines];
+}
+
+- (BOOL)writeTraceEventJSONToFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error {
+    NSData *data = [self traceEventJSONData];
+    if (!data) {
+        return NO;
+    }
+    return [data writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
++ (NSData *)traceEventJSONDataWithTimelines:(NSArray<TXWebImageTimeline *> *)timelines {
+    uint64_t baseTime = UINT64_MAX;
+    for (TXWebImageTimeline *timeline in timelines) {
+        baseTime = MIN(baseTime, timeline.startTime);
+    }
+    // The trace event uses microseconds
+    double (^timestamp)(uint64_t) = ^double(uint64_t time) {
+        return (double)(time - baseTime) / 1000.0;
+    };
+    NSMutableArray<NSDictionary *> *events = [NSMutableArray array];
+    [events addObject:@{@"name" : @"process_name", @"ph" : @"M", @"pid" : @1, @"args" : @{@"name" : @"SDWebImage"}}];
+    [timelines enumerateObjectsUsingBlock:^(TXWebImageTimeline * _Nonnull timeline, NSUInteger idx, BOOL * _Nonnull stop) {
+        // Each request has its own row (thread)
+        NSNumber *tid = @(idx + 1);
+        NSString *name = timeline.url.lastPathComponent.length > 0 ? timeline.url.lastPathComponent : (timeline.url.absoluteString ?: @"(nil)");
+        [events addObject:@{@"name" : @"thread_name", @"ph" : @"M", @"pid" : @1, @"tid" : tid, @"args" : @{@"name" : name}}];
+
+        NSMutableDictionary *args = [NSMutableDictionary dictionary];
+        args[@"url"] = timeline.url.absoluteString;
+        args[@"cacheType"] = @(timeline.cacheType);
+        args[@"dataLength"] = @(timeline.dataLength);
+        args[@"decodedPixels"] = @(timeline.decodedPixels);
+        args[@"coder"] = timeline.coderName;
+        args[@"error"] = timeline.error.localizedDescription;
+        uint64_t endTime = timeline.endTime;
+        if (endTime >= timeline.startTime && endTime > 0) {
+            [events addObject:@{@"name" : @"Request", @"cat" : @"request", @"ph" : @"X", @"pid" : @1, @"tid" : tid, @"ts" : @(timestamp(timeline.startTime)), @"dur" : @((endTime - timeline.startTime) / 1000.0), @"args" : [args copy]}];
+        }
+        for (NSNumber *stage in [TXWebImageTimeline allStages]) {
+            SDWebImageTimelineStage stageValue = stage.unsignedIntegerValue;
+            uint64_t startTime = [timeline startTimeForStage:stageValue];
+            uint64_t stageEndTime = [timeline endTimeForStage:stageValue];
+            if (startTime == 0 || stageEndTime < startTime) {
+                continue;
+            }
+            [events addObject:@{@"name" : [TXWebImageTimeline nameForStage:stageValue], @"cat" : @"stage", @"ph" : @"X", @"pid" : @1, @"tid" : tid, @"ts" : @(timestamp(startTime)), @"dur" : @((stageEndTime - startTime) / 1000.0)}];
+        }
+    }];
+    NSDictionary *trace = @{@"traceEvents" : events, @"displayTimeUnit" : @"ms"};
+    return [NSJSONSerialization dataWithJSONObject:trace options:0 error:nil];
+}
+
+@end
@@ -14,6 +14,42 @@ typedef NS_ENUM(NSUInteger, SDImageScaleMode) {
     SDImageScaleModeAspectFill = 2
 };
 
+/// The quality/speed preset of blur effect
+typedef NS_ENUM(NSUInteger, SDImageBlurQuality) {
+    /// Use the system framework, three box blurs with vImage to approximate Gaussian at full resolution (or Core Image for `CIImage`). This is the default.
+    SDImageBlurQualitySystem = 0,
+    /// Gaussian blur, downsample only for the very large radius. Best quality.
+    SDImageBlurQualityHigh,
+    /// Gaussian blur, downsample for the large radius (more than about 6 pixels), then upsample. The result is visually the same as high for background blur.
+    SDImageBlurQualityBalanced,
+    /// Gaussian blur, downsample aggressively (more than about 3 pixels), then upsample. Fastest.
+    SDImageBlurQualityFast
+};
+
+/// The pixel format of the pixel buffer, 4 bytes per pixel, 8 bits per component, premultiplied alpha
+typedef NS_ENUM(NSUInteger, SDImagePixelFormat) {
+    /// The byte order is B, G, R, A (`kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst`), which is the native format on Apple GPU.
+    SDImagePixelFormatBGRA8888 = 0,
+    /// The byte order is R, G, B, A (`kCGBitmapByteOrder32Big | kCGImageAlphaPremultipliedLast`)
+    SDImagePixelFormatRGBA8888
+};
+
+/// The read-only view of the pixels, the rows are from the top to the bottom
+typedef struct SDImagePixelBuffer {
+    /// The first pixel (the top-left one) of the rect
+    const uint8_t * _Nonnull data;
+    /// The width in pixels
+    size_t width;
+    /// The height in pixels
+    size_t height;
+    /// The bytes per row, which may be larger than `width * 4`
+    size_t bytesPerRow;
+    /// The pixel format
+    SDImagePixelFormat format;
+    /// Whether the alpha byte is unused (`kCGImageAlphaNoneSkipFirst` / `kCGImageAlphaNoneSkipLast`, like the decoded opaque image), the alpha should be treated as 255 and the byte value ignored
+    BOOL opaque;
+} SDImagePixelBuffer;
+
 #if SD_UIKIT || SD_WATCH
 typedef UIRectCorner SDRectCorner;
 #else
@@ -121,6 +157,47 @@ typedef NS_OPTIONS(NSUInteger, SDRectCorner) {
  */
 - (nullable NSArray<UIColor *> *)sd_colorsWithRect:(CGRect)rect;
 
+#pragma mark - Image Pixel Buffer
+
+/**
+ Visit the read-only pixel buffer with specify rectangle and pixel format. The rect is from the top-left to the bottom-right and 0-based, like `sd_colorsWithRect:`. The image must be CG-based.
+ If the backing `CGImage` is already in the pixel format (like the decoded image), its bitmap data is used directly without redraw, otherwise only the rect is redrawn into the pixel format.
+ The byte layout of the skipped alpha (no alpha channel) is also used directly, check the `opaque` of the buffer.
+ @note The buffer is only valid inside the block, do not keep the data pointer.
+ 
+ @param format The pixel format
+ @param rect The rectangle of pixels
+ @param block The block to visit the pixel buffer, called synchronously
+ @return YES if the block is called, NO if any error occur (e.g. the rect is out of bounds)
+ */
+- (BOOL)sd_accessPixelBufferWithFormat:(SDImagePixelFormat)format rect:(CGRect)rect block:(nonnull NS_NOESCAPE void (^)(SDImagePixelBuffer buffer))block;
+
+/**
+ Return the pixel format which the backing `CGImage` is already in, so `sd_accessPixelBufferWithFormat:rect:block:` does not need to redraw. The skipped alpha layout matches the format with the same byte order.
+ 
+ @param format The matched pixel format
+ @return YES if the backing `CGImage` is in one of the pixel formats
+ */
+- (BOOL)sd_getNativePixelFormat:(nonnull SDImagePixelFormat *)format;
+
+/**
+ Return the average color of the pixels with specify rectangle, computed on the raw pixel buffer with SIMD. The rect is the same as `sd_colorsWithRect:`.
+ The color is weighted by alpha, so the transparent pixels do not darken the color.
+
+ @param rect The rectangle of pixels
+ @return The average color, or nil if any error occur
+ */
+- (nullable UIColor *)sd_averageColorWithRect:(CGRect)rect;
+
+/**
+ Return the dominant (most frequent) color of the pixels with specify rectangle, computed on the raw pixel buffer with SIMD. The rect is the same as `sd_colorsWithRect:`.
+ The colors are quantized to 4 bits per component, and the mostly transparent pixels are ignored. The returned color is the average of the pixels in the most frequent bucket.
+
+ @param rect The rectangle of pixels
+ @return The dominant color, or nil if any error occur (e.g. all the pixels are transparent)
+ */
+- (nullable UIColor *)sd_dominantColorWithRect:(CGRect)rect;
+
 #pragma mark - Image Effect
 
 /**
@@ -132,6 +209,17 @@ typedef NS_OPTIONS(NSUInteger, SDRectCorner) {
  */
 - (nullable UIImage *)sd_blurredImageWithRadius:(CGFloat)blurRadius;
 
+/**
+ Return a new image applied a blur effect, with the quality/speed preset.
+ The non-system presets use a portable separable Gaussian kernel (vectorized with SSE2/AVX2/NEON), the image is downsampled before blur for the large radius, and upsampled after blur, so the cost does not grow with the radius.
+ 
+ @param blurRadius     The radius (the standard deviation) of the blur in points, 0 means no blur effect.
+ @param quality        The quality/speed preset. `SDImageBlurQualitySystem` is the same as `sd_blurredImageWithRadius:`.
+ 
+ @return               The new image with blur effect, or nil if an error occurs (e.g. no enough memory).
+ */
+- (nullable UIImage *)sd_blurredImageWithRadius:(CGFloat)blurRadius quality:(SDImageBlurQuality)quality;
+
 #if SD_UIKIT || SD_MAC
 /**
  Return a new image applied a CIFilter.
@@ -10,53 +10,15 @@
 #import "NSImage+Compatibility.h"
 #import "TXImageGraphics.h"
 #import "TXGraphicsImageRenderer.h"
-#import "NSBezierPath+SDRoundedCorners.h"
+#import "TXImageTransformCanvas.h"
+#import "TXImageCoderHelper.h"
+#import "TXImageResampler.h"
+#import "TXImagePixelStatistics.h"
 #import <Accelerate/Accelerate.h>
 #if SD_UIKIT || SD_MAC
 #import <CoreImage/CoreImage.h>
 #endif
 
-static inline CGRect SDCGRectFitWithScaleMode(CGRect rect, CGSize size, SDImageScaleMode scaleMode) {
-    rect = CGRectStandardize(rect);
-    size.width = size.width < 0 ? -size.width : size.width;
-    size.height = size.height < 0 ? -size.height : size.height;
-    CGPoint center = CGPointMake(CGRectGetMidX(rect), CGRectGetMidY(rect));
-    switch (scaleMode) {
-        case SDImageScaleModeAspectFit:
-        case SDImageScaleModeAspectFill: {
-            if (rect.size.width < 0.01 || rect.size.height < 0.01 ||
-                size.width < 0.01 || size.height < 0.01) {
-                rect.origin = center;
-                rect.size = CGSizeZero;
-            } else {
-                CGFloat scale;
-                if (scaleMode == SDImageScaleModeAspectFit) {
-                    if (size.width / size.height < rect.size.width / rect.size.height) {
-                        scale = rect.size.height / size.height;
-                    } else {
-                        scale = rect.size.width / size.width;
-                    }
-                } else {
-                    if (size.width / size.height < rect.size.width / rect.size.height) {
-                        scale = rect.size.width / size.width;
-                    } else {
-                        scale = rect.size.height / size.height;
-                    }
-                }
-                size.width *= scale;
-                size.height *= scale;
-                rect.size = size;
-                rect.origin = CGPointMake(center.x - size.width * 0.5, center.y - size.height * 0.5);
-            }
-        } break;
-        case SDImageScaleModeFill:
-        default: {
-            rect = rect;
-        }
-    }
-    return rect;
-}
-
 static inline UIColor * SDGetColorFromPixel(Pixel_8888 pixel, CGBitmapInfo bitmapInfo) {
     // Get alpha info, byteOrder info
     CGImageAlphaInfo alphaInfo = bitmapInfo & kCGBitmapAlphaInfoMask;
@@ -164,6 +126,68 @@ static inline UIColor * SDGetColorFromPixel(Pixel_8888 pixel, CGBitmapInfo bitma
     return [UIColor colorWithRed:r green:g blue:b alpha:a];
 }
 
+static inline CGBitmapInfo SDBitmapInfoFromPixelFormat(SDImagePixelFormat format) {
+    switch (format) {
+        case SDImagePixelFormatRGBA8888:
+            return kCGBitmapByteOrder32Big | kCGImageAlphaPremultipliedLast;
+        default:
+            return kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst;
+    }
+}
+
+// Whether the bitmap of CGImage can be used as the pixel buffer directly, the skipped alpha byte is reported as opaque
+static BOOL SDCGImageGetPixelFormat(CGImageRef _Nullable imageRef, SDImagePixelFormat *format, BOOL * _Nullable opaque) {
+    if (!imageRef) {
+        return NO;
+    }
+    if (CGImageGetBitsPerPixel(imageRef) != 32 || CGImageGetBitsPerComponent(imageRef) != 8 || CGImageGetDecode(imageRef) != NULL) {
+        return NO;
+    }
+    CGColorSpaceRef colorSpace = CGImageGetColorSpace(imageRef);
+    if (!colorSpace || CGColorSpaceGetModel(colorSpace) != kCGColorSpaceModelRGB) {
+        return NO;
+    }
+    CGBitmapInfo bitmapInfo = CGImageGetBitmapInfo(imageRef);
+    if (bitmapInfo & kCGBitmapFloatComponents) {
+        return NO;
+    }
+    CGImageAlphaInfo alphaInfo = bitmapInfo & kCGBitmapAlphaInfoMask;
+    CGBitmapInfo byteOrderInfo = bitmapInfo & kCGBitmapByteOrderMask;
+    BOOL isFirst = alphaInfo == kCGImageAlphaPremultipliedFirst || alphaInfo == kCGImageAlphaNoneSkipFirst;
+    BOOL isLast = alphaInfo == kCGImageAlphaPremultipliedLast || alphaInfo == kCGImageAlphaNoneSkipLast;
+    if (isFirst && byteOrderInfo == kCGBitmapByteOrder32Little) {
+        *format = SDImagePixelFormatBGRA8888;
+    } else if (isLast && (byteOrderInfo == kCGBitmapByteOrder32Big || byteOrderInfo == kCGBitmapByteOrderDefault)) {
+        *format = SDImagePixelFormatRGBA8888;
+    } else {
+        return NO;
+    }
+    if (opaque) {
+        *opaque = alphaInfo == kCGImageAlphaNoneSkipFirst || alphaInfo == kCGImageAlphaNoneSkipLast;
+    }
+    return YES;
+}
+
+// Convert the premultiplied sums of byte lanes to the color, weighted by alpha
+static inline UIColor * SDGetColorFromPixelSums(const uint64_t sums[4], uint64_t count, SDImagePixelFormat format) {
+    uint64_t alphaSum = sums[3];
+    if (count == 0 || alphaSum == 0) {
+        return [UIColor colorWithRed:0 green:0 blue:0 alpha:0];
+    }
+    CGFloat r, g, b;
+    if (format == SDImagePixelFormatRGBA8888) {
+        r = (CGFloat)sums[0] / alphaSum;
+        g = (CGFloat)sums[1] / alphaSum;
+        b = (CGFloat)sums[2] / alphaSum;
+    } else {
+        b = (CGFloat)sums[0] / alphaSum;
+        g = (CGFloat)sums[1] / alphaSum;
+        r = (CGFloat)sums[2] / alphaSum;
+    }
+    CGFloat a = (CGFloat)alphaSum / (count * 255);
+    return [UIColor colorWithRed:MIN(r, 1) green:MIN(g, 1) blue:MIN(b, 1) alpha:a];
+}
+
 #if SD_UIKIT || SD_MAC
 // Create-Rule, caller should call CGImageRelease
 static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull ciImage) {
@@ -181,6 +205,61 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
 }
 #endif
 
+// The max standard deviation in pixels to blur at, the larger one is blurred on the downsampled image
+static inline CGFloat SDBlurMaxSigmaForQuality(SDImageBlurQuality quality) {
+    switch (quality) {
+        case SDImageBlurQualityHigh:
+            return 16;
+        case SDImageBlurQualityBalanced:
+            return 6;
+        case SDImageBlurQualityFast:
+            return 3;
+        default:
+            return CGFLOAT_MAX;
+    }
+}
+
+// Downsample (area average), Gaussian blur, then upsample (bilinear), on the BGRA8888 premultiplied bitmap
+static CGImageRef SDCGImageCreateGaussianBlurred(CGImageRef imageRef, CGFloat sigma, SDImageBlurQuality quality) CF_RETURNS_RETAINED {
+    if (!imageRef) {
+        return NULL;
+    }
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst;
+    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, [TXImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        return NULL;
+    }
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef);
+    SDImageResamplerBuffer buffer = {CGBitmapContextGetData(context), width, height, CGBitmapContextGetBytesPerRow(context)};
+    SDImageResamplerISA isa = SDImageResamplerGetBestISA();
+    
+    CGFloat factor = MAX(sigma / SDBlurMaxSigmaForQuality(quality), 1);
+    size_t workWidth = MAX(1, (size_t)round(width / factor));
+    size_t workHeight = MAX(1, (size_t)round(height / factor));
+    BOOL success;
+    if (workWidth == width && workHeight == height) {
+        success = SDImageResamplerBlur(&buffer, &buffer, sigma, isa);
+    } else {
+        // The area average downsample and bilinear upsample blur as well (the variance is about factor^2 / 12 and factor^2 / 6), remove them from the Gaussian one
+        factor = (CGFloat)width / workWidth;
+        CGFloat workSigma = sqrt(MAX(sigma * sigma - factor * factor / 4, 0)) / factor;
+        size_t workRowBytes = workWidth * 4;
+        void *workData = malloc(workRowBytes * workHeight);
+        SDImageResamplerBuffer workBuffer = {workData, workWidth, workHeight, workRowBytes};
+        success = workData
+        && SDImageResamplerScale(&buffer, &workBuffer, SDImageResamplerKernelBox, SDImageResamplerFormatBGRA8, isa)
+        && SDImageResamplerBlur(&workBuffer, &workBuffer, workSigma, isa)
+        && SDImageResamplerScale(&workBuffer, &buffer, SDImageResamplerKernelBilinear, SDImageResamplerFormatBGRA8, isa);
+        free(workData);
+    }
+    CGImageRef outputImageRef = success ? CGBitmapContextCreateImage(context) : NULL;
+    CGContextRelease(context);
+    return outputImageRef;
+}
+
 @implementation UIImage (Transform)
 
 - (void)sd_drawInRect:(CGRect)rect context:(CGContextRef)context scaleMode:(SDImageScaleMode)scaleMode clipsToBounds:(BOOL)clips {
@@ -258,15 +337,8 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
         
         CGFloat minSize = MIN(self.size.width, self.size.height);
         if (borderWidth < minSize / 2) {
-#if SD_UIKIT || SD_WATCH
-            UIBezierPath *path = [UIBezierPath bezierPathWithRoundedRect:CGRectInset(rect, borderWidth, borderWidth) byRoundingCorners:corners cornerRadii:CGSizeMake(cornerRadius, cornerRadius)];
-#else
-            NSBezierPath *path = [NSBezierPath sd_bezierPathWithRoundedRect:CGRectInset(rect, borderWidth, borderWidth) byRoundingCorners:corners cornerRadius:cornerRadius];
-#endif
-            [path closePath];
-            
             CGContextSaveGState(context);
-            [path addClip];
+            SDGraphicsClipRoundedRect(CGRectInset(rect, borderWidth, borderWidth), corners, cornerRadius);
             [self drawInRect:rect];
             CGContextRestoreGState(context);
         }
@@ -275,16 +347,7 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
             CGFloat strokeInset = (floor(borderWidth * self.scale) + 0.5) / self.scale;
             CGRect strokeRect = CGRectInset(rect, strokeInset, strokeInset);
             CGFloat strokeRadius = cornerRadius > self.scale / 2 ? cornerRadius - self.scale / 2 : 0;
-#if SD_UIKIT || SD_WATCH
-            UIBezierPath *path = [UIBezierPath bezierPathWithRoundedRect:strokeRect byRoundingCorners:corners cornerRadii:CGSizeMake(strokeRadius, strokeRadius)];
-#else
-            NSBezierPath *path = [NSBezierPath sd_bezierPathWithRoundedRect:strokeRect byRoundingCorners:corners cornerRadius:strokeRadius];
-#endif
-            [path closePath];
-            
-            path.lineWidth = borderWidth;
-            [borderColor setStroke];
-            [path stroke];
+            SDGraphicsStrokeRoundedRect(strokeRect, corners, strokeRadius, borderWidth, borderColor);
         }
     }];
     return image;
@@ -557,10 +620,116 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
     return [colors copy];
 }
 
+#pragma mark - Image Pixel Buffer
+
+- (BOOL)sd_accessPixelBufferWithFormat:(SDImagePixelFormat)format rect:(CGRect)rect block:(NS_NOESCAPE void (^)(SDImagePixelBuffer))block {
+    if (!block) {
+        return NO;
+    }
+    CGImageRef imageRef = NULL;
+    // CIImage compatible
+#if SD_UIKIT || SD_MAC
+    if (self.CIImage) {
+        imageRef = SDCreateCGImageFromCIImage(self.CIImage);
+    }
+#endif
+    if (!imageRef) {
+        imageRef = self.CGImage;
+        CGImageRetain(imageRef);
+    }
+    if (!imageRef) {
+        return NO;
+    }
+    
+    // Check rect
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    rect = CGRectIntegral(rect);
+    if (CGRectGetWidth(rect) <= 0 || CGRectGetHeight(rect) <= 0 || CGRectGetMinX(rect) < 0 || CGRectGetMinY(rect) < 0 || CGRectGetMaxX(rect) > width || CGRectGetMaxY(rect) > height) {
+        CGImageRelease(imageRef);
+        return NO;
+    }
+    size_t minX = CGRectGetMinX(rect);
+    size_t minY = CGRectGetMinY(rect);
+    size_t maxX = CGRectGetMaxX(rect);
+    size_t maxY = CGRectGetMaxY(rect);
+    
+    // Use the bitmap directly if it's already in the format
+    SDImagePixelFormat imageFormat;
+    BOOL opaque = NO;
+    if (SDCGImageGetPixelFormat(imageRef, &imageFormat, &opaque) && imageFormat == format) {
+        CGDataProviderRef provider = CGImageGetDataProvider(imageRef);
+        CFDataRef data = provider ? CGDataProviderCopyData(provider) : NULL;
+        if (data) {
+            size_t bytesPerRow = CGImageGetBytesPerRow(imageRef);
+            size_t end = bytesPerRow * (maxY - 1) + maxX * 4;
+            if (CFDataGetLength(data) >= (CFIndex)end) {
+                SDImagePixelBuffer buffer = {CFDataGetBytePtr(data) + bytesPerRow * minY + minX * 4, maxX - minX, maxY - minY, bytesPerRow, format, opaque};
+                block(buffer);
+                CFRelease(data);
+                CGImageRelease(imageRef);
+                return YES;
+            }
+            CFRelease(data);
+        }
+    }
+    
+    // Redraw the rect only, the context is y-up
+    CGContextRef context = CGBitmapContextCreate(NULL, maxX - minX, maxY - minY, 8, 0, [TXImageCoderHelper colorSpaceGetDeviceRGB], SDBitmapInfoFromPixelFormat(format));
+    if (!context) {
+        CGImageRelease(imageRef);
+        return NO;
+    }
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextDrawImage(context, CGRectMake(-(CGFloat)minX, -(CGFloat)(height - maxY), width, height), imageRef);
+    CGImageRelease(imageRef);
+    SDImagePixelBuffer buffer = {CGBitmapContextGetData(context), maxX - minX, maxY - minY, CGBitmapContextGetBytesPerRow(context), format, NO};
+    block(buffer);
+    CGContextRelease(context);
+    return YES;
+}
+
+- (BOOL)sd_getNativePixelFormat:(SDImagePixelFormat *)format {
+    if (!format) {
+        return NO;
+    }
+    return SDCGImageGetPixelFormat(self.CGImage, format, NULL);
+}
+
+- (nullable UIColor *)sd_averageColorWithRect:(CGRect)rect {
+    SDImagePixelFormat format = SDImagePixelFormatBGRA8888;
+    [self sd_getNativePixelFormat:&format];
+    __block UIColor *color;
+    [self sd_accessPixelBufferWithFormat:format rect:rect block:^(SDImagePixelBuffer buffer) {
+        uint64_t sums[4];
+        SDImagePixelSums(buffer.data, buffer.width, buffer.height, buffer.bytesPerRow, buffer.opaque, sums);
+        color = SDGetColorFromPixelSums(sums, buffer.width * buffer.height, buffer.format);
+    }];
+    return color;
+}
+
+- (nullable UIColor *)sd_dominantColorWithRect:(CGRect)rect {
+    SDImagePixelFormat format = SDImagePixelFormatBGRA8888;
+    [self sd_getNativePixelFormat:&format];
+    __block UIColor *color;
+    [self sd_accessPixelBufferWithFormat:format rect:rect block:^(SDImagePixelBuffer buffer) {
+        uint64_t sums[4];
+        uint64_t count;
+        if (SDImagePixelDominantSums(buffer.data, buffer.width, buffer.height, buffer.bytesPerRow, buffer.opaque, sums, &count)) {
+            color = SDGetColorFromPixelSums(sums, count, buffer.format);
+        }
+    }];
+    return color;
+}
+
 #pragma mark - Image Effect
 
 // We use vImage to do box convolve for performance and support for watchOS. However, you can just use `CIFilter.CIGaussianBlur`. For other blur effect, use any filter in `CICategoryBlur`
 - (nullable UIImage *)sd_blurredImageWithRadius:(CGFloat)blurRadius {
+    return [self sd_blurredImageWithRadius:blurRadius quality:SDImageBlurQualitySystem];
+}
+
+- (nullable UIImage *)sd_blurredImageWithRadius:(CGFloat)blurRadius quality:(SDImageBlurQuality)quality {
     if (self.size.width < 1 || self.size.height < 1) {
         return nil;
     }
@@ -589,6 +758,20 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
     
     CGImageRef imageRef = self.CGImage;
     
+    if (quality != SDImageBlurQualitySystem) {
+        CGImageRef blurredImageRef = SDCGImageCreateGaussianBlurred(imageRef, inputRadius, quality);
+        if (!blurredImageRef) {
+            return nil;
+        }
+#if SD_UIKIT || SD_WATCH
+        UIImage *outputImage = [UIImage imageWithCGImage:blurredImageRef scale:self.scale orientation:self.imageOrientation];
+#else
+        UIImage *outputImage = [[UIImage alloc] initWithCGImage:blurredImageRef scale:self.scale orientation:kCGImagePropertyOrientationUp];
+#endif
+        CGImageRelease(blurredImageRef);
+        return outputImage;
+    }
+    
     //convert to BGRA if it isn't
     if (CGImageGetBitsPerPixel(imageRef) != 32 ||
         CGImageGetBitsPerComponent(imageRef) != 8 ||
@@ -0,0 +1,56 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "TXWebImageCompat.h"
+
+/// The client which shares the frame budget, like animated image player. All the methods are called on main thread.
+@protocol TXAnimatedFrameBudgetClient <NSObject>
+
+/// The bytes of one buffered frame. 0 means unknown.
+@property (nonatomic, assign, readonly) NSUInteger bytesPerFrame;
+/// The total frame count, the client never needs more than this count of frames.
+@property (nonatomic, assign, readonly) NSUInteger totalFrameCount;
+/// The frames displayed per second. 0 means unknown.
+@property (nonatomic, assign, readonly) double framesPerSecond;
+/// Whether the client is playing and visible. The inactive client gets much less budget.
+@property (nonatomic, assign, readonly) BOOL isFrameBudgetActive;
+/// The buffer size specified by the client itself. 0 means managed by the budget. The specified size still takes up the total budget.
+@property (nonatomic, assign, readonly) NSUInteger maxBufferSize;
+
+/// Called when the buffer count allocated to the client changed. Call `bufferCountForClient:` to get the new value.
+- (void)frameBudgetDidChange;
+
+@end
+
+/// A process-wide frame memory budget, which is allocated across all the animated image players, so the total frame buffer memory stays bounded no matter how many players exist.
+/// Each client is guaranteed one frame, the remaining budget is allocated by weight (the frame rate, much lower for inactive one), and the client never gets more than its total frames, the excess is given to the others.
+/// @note The clients are weakly referenced. All the methods should be called on main thread.
+@interface TXAnimatedFrameBudgetManager : NSObject
+
+/// The shared manager
+@property (nonatomic, class, readonly, nonnull) TXAnimatedFrameBudgetManager *sharedManager;
+
+/// The total buffer bytes for all clients. Default is 0.
+/// `0` means automatically adjust by calculating current memory usage.
+/// @note The setter can be called on any thread, the value is applied on main thread asynchronously.
+@property (nonatomic, assign) NSUInteger maxBufferSize;
+
+/// The total bytes allocated to the clients managed by budget.
+@property (nonatomic, assign, readonly) NSUInteger allocatedBufferSize;
+
+/// Returns the buffer frame count allocated to the client, at least 1. Add the client if it's not added yet.
+- (NSUInteger)bufferCountForClient:(nonnull id<TXAnimatedFrameBudgetClient>)client;
+
+/// Mark the client's properties changed, add the client if it's not added yet. The budget is allocated again, and the other clients which allocation changed will be notified asynchronously.
+- (void)setNeedsUpdateClient:(nonnull id<TXAnimatedFrameBudgetClient>)client;
+
+/// Remove the client, its budget is given to the others.
+- (void)removeClient:(nonnull id<TXAnimatedFrameBudgetClient>)client;
+
+@end
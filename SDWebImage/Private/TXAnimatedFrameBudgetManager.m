@@ -0,0 +1,243 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "TXAnimatedFrameBudgetManager.h"
+#import "TXDeviceHelper.h"
+
+// The weight factor for the client which is paused or invisible
+static const double kSDAnimatedFrameBudgetInactiveWeight = 0.05;
+// Used when the client does not know its frame bytes yet
+static const NSUInteger kSDAnimatedFrameBudgetDefaultBytesPerFrame = 1024;
+
+@interface TXAnimatedFrameBudgetEntry : NSObject
+
+@property (nonatomic, weak) id<TXAnimatedFrameBudgetClient> client;
+@property (nonatomic, assign) BOOL managed; // NO if the client specify its own buffer size
+@property (nonatomic, assign) NSUInteger bytesPerFrame;
+@property (nonatomic, assign) double demand; // The bytes to buffer all frames
+@property (nonatomic, assign) double weight;
+@property (nonatomic, assign) double grant; // The bytes allocated
+@property (nonatomic, assign) NSUInteger bufferCount; // The frame count allocated
+@property (nonatomic, assign) NSUInteger appliedBufferCount; // The frame count which the client get last time
+
+@end
+
+@implementation TXAnimatedFrameBudgetEntry
+@end
+
+@interface TXAnimatedFrameBudgetManager ()
+
+@property (nonatomic, strong) NSMutableArray<TXAnimatedFrameBudgetEntry *> *entries;
+@property (nonatomic, assign, readwrite) NSUInteger allocatedBufferSize;
+@property (nonatomic, assign) BOOL needsAllocate;
+@property (nonatomic, assign) BOOL notifyScheduled;
+
+@end
+
+@implementation TXAnimatedFrameBudgetManager
+
++ (TXAnimatedFrameBudgetManager *)sharedManager {
+    static dispatch_once_t onceToken;
+    static TXAnimatedFrameBudgetManager *manager;
+    dispatch_once(&onceToken, ^{
+        manager = [[TXAnimatedFrameBudgetManager alloc] init];
+    });
+    return manager;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _entries = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)setMaxBufferSize:(NSUInteger)maxBufferSize {
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            self.maxBufferSize = maxBufferSize;
+        });
+        return;
+    }
+    _maxBufferSize = maxBufferSize;
+    self.needsAllocate = YES;
+    [self scheduleNotifyClients];
+}
+
+#pragma mark - Client
+
+- (TXAnimatedFrameBudgetEntry *)entryForClient:(id<TXAnimatedFrameBudgetClient>)client {
+    for (TXAnimatedFrameBudgetEntry *entry in self.entries) {
+        if (entry.client == client) {
+            return entry;
+        }
+    }
+    TXAnimatedFrameBudgetEntry *entry = [TXAnimatedFrameBudgetEntry new];
+    entry.client = client;
+    [self.entries addObject:entry];
+    self.needsAllocate = YES;
+    return entry;
+}
+
+- (NSUInteger)bufferCountForClient:(id<TXAnimatedFrameBudgetClient>)client {
+    TXAnimatedFrameBudgetEntry *entry = [self entryForClient:client];
+    if (self.needsAllocate) {
+        [self allocate];
+    }
+    entry.appliedBufferCount = entry.bufferCount;
+    return MAX(entry.bufferCount, 1);
+}
+
+- (void)setNeedsUpdateClient:(id<TXAnimatedFrameBudgetClient>)client {
+    if (!client) {
+        return;
+    }
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self setNeedsUpdateClient:client];
+        });
+        return;
+    }
+    [self entryForClient:client];
+    self.needsAllocate = YES;
+    [self scheduleNotifyClients];
+}
+
+- (void)removeClient:(id<TXAnimatedFrameBudgetClient>)client {
+    if (!client) {
+        return;
+    }
+    for (TXAnimatedFrameBudgetEntry *entry in self.entries) {
+        if (entry.client == client) {
+            [self.entries removeObjectIdenticalTo:entry];
+            self.needsAllocate = YES;
+            [self scheduleNotifyClients];
+            return;
+        }
+    }
+}
+
+#pragma mark - Allocate
+
+- (void)scheduleNotifyClients {
+    // Coalesce the changes in the same runloop
+    if (self.notifyScheduled) {
+        return;
+    }
+    self.notifyScheduled = YES;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self notifyClients];
+    });
+}
+
+- (void)notifyClients {
+    self.notifyScheduled = NO;
+    if (self.needsAllocate) {
+        [self allocate];
+    }
+    // The client may change the budget during callback
+    NSArray<TXAnimatedFrameBudgetEntry *> *entries = [self.entries copy];
+    for (TXAnimatedFrameBudgetEntry *entry in entries) {
+        if (!entry.managed || entry.bufferCount == entry.appliedBufferCount) {
+            continue;
+        }
+        [entry.client frameBudgetDidChange];
+    }
+}
+
+- (void)allocate {
+    self.needsAllocate = NO;
+    double budget = self.maxBufferSize;
+    if (budget == 0) {
+        // Calculate based on current memory, these factors are by experience
+        NSUInteger total = [TXDeviceHelper totalMemory];
+        NSUInteger free = [TXDeviceHelper freeMemory];
+        budget = MIN(total * 0.2, free * 0.6);
+    }
+
+    // Each client gets at least one frame, the self-managed one takes its own size
+    double remaining = budget;
+    NSMutableArray<TXAnimatedFrameBudgetEntry *> *candidates = [NSMutableArray arrayWithCapacity:self.entries.count];
+    for (NSInteger i = self.entries.count - 1; i >= 0; i--) {
+        TXAnimatedFrameBudgetEntry *entry = self.entries[i];
+        id<TXAnimatedFrameBudgetClient> client = entry.client;
+        if (!client) {
+            [self.entries removeObjectAtIndex:i];
+            continue;
+        }
+        NSUInteger bytesPerFrame = client.bytesPerFrame;
+        if (bytesPerFrame == 0) {
+            bytesPerFrame = kSDAnimatedFrameBudgetDefaultBytesPerFrame;
+        }
+        entry.bytesPerFrame = bytesPerFrame;
+        entry.demand = (double)bytesPerFrame * MAX(client.totalFrameCount, 1);
+        NSUInteger maxBufferSize = client.maxBufferSize;
+        if (maxBufferSize > 0) {
+            entry.managed = NO;
+            entry.grant = MIN((double)maxBufferSize, entry.demand);
+            remaining -= entry.grant;
+            continue;
+        }
+        entry.managed = YES;
+        entry.grant = bytesPerFrame;
+        remaining -= bytesPerFrame;
+        double framesPerSecond = client.framesPerSecond;
+        if (framesPerSecond <= 0) {
+            framesPerSecond = 1;
+        }
+        entry.weight = client.isFrameBudgetActive ? framesPerSecond : framesPerSecond * kSDAnimatedFrameBudgetInactiveWeight;
+        if (entry.grant < entry.demand) {
+            [candidates addObject:entry];
+        }
+    }
+
+    // Allocate the remaining by weight, the client which is satisfied give back the excess to the others
+    while (remaining > 0 && candidates.count > 0) {
+        double totalWeight = 0;
+        for (TXAnimatedFrameBudgetEntry *entry in candidates) {
+            totalWeight += entry.weight;
+        }
+        if (totalWeight <= 0) {
+            break;
+        }
+        BOOL satisfied = NO;
+        double allocated = 0;
+        for (NSInteger i = candidates.count - 1; i >= 0; i--) {
+            TXAnimatedFrameBudgetEntry *entry = candidates[i];
+            double share = remaining * entry.weight / totalWeight;
+            if (entry.grant + share >= entry.demand) {
+                allocated += entry.demand - entry.grant;
+                entry.grant = entry.demand;
+                [candidates removeObjectAtIndex:i];
+                satisfied = YES;
+            }
+        }
+        if (satisfied) {
+            // Allocate again with the excess
+            remaining -= allocated;
+            continue;
+        }
+        for (TXAnimatedFrameBudgetEntry *entry in candidates) {
+            entry.grant += remaining * entry.weight / totalWeight;
+        }
+        remaining = 0;
+    }
+
+    NSUInteger allocatedBufferSize = 0;
+    for (TXAnimatedFrameBudgetEntry *entry in self.entries) {
+        if (!entry.managed) {
+            continue;
+        }
+        entry.bufferCount = MAX((NSUInteger)(entry.grant / entry.bytesPerFrame), 1);
+        allocatedBufferSize += entry.bufferCount * entry.bytesPerFrame;
+    }
+    self.allocatedBufferSize = allocatedBufferSize;
+}
+
+@end
@@ -0,0 +1,52 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "TXWebImageCompat.h"
+
+@class TXAnimatedFrameDecodeQueue;
+
+/// A pool of decoding workers shared by all animated image players, which replaces each player's private operation queue.
+/// Each player owns a `TXAnimatedFrameDecodeQueue`, the workers pick tasks from these queues in round-robin order, so a heavy animated image which always has many pending frames does not starve the others.
+@interface TXAnimatedFrameDecodePool : NSObject
+
+/// The shared pool
+@property (nonatomic, class, readonly, nonnull) TXAnimatedFrameDecodePool *sharedPool;
+
+/// The max count of tasks running at the same time across all queues. Defaults to the active processor count.
+@property (atomic, assign) NSUInteger maxConcurrentCount;
+
+/// Create a pool with the max concurrent count.
+- (nonnull instancetype)initWithMaxConcurrentCount:(NSUInteger)maxConcurrentCount NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/// A FIFO task queue in the decode pool.
+@interface TXAnimatedFrameDecodeQueue : NSObject
+
+/// The pool which runs the tasks
+@property (nonatomic, strong, readonly, nonnull) TXAnimatedFrameDecodePool *pool;
+
+/// The max count of tasks in this queue running at the same time. Defaults to 1, which means the tasks are executed one by one.
+@property (atomic, assign) NSUInteger maxConcurrentCount;
+
+/// The count of tasks which are not started yet
+@property (atomic, assign, readonly) NSUInteger pendingCount;
+
+/// Create a queue in the pool.
+- (nonnull instancetype)initWithPool:(nonnull TXAnimatedFrameDecodePool *)pool NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/// Add a task, which will be executed in background thread.
+- (void)addTask:(nonnull dispatch_block_t)task;
+
+/// Remove all the tasks which are not started yet. The running tasks are not affected.
+- (void)cancelAllTasks;
+
+@end
@@ -0,0 +1,190 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "TXAnimatedFrameDecodePool.h"
+#import "TXInternalMacros.h"
+
+@interface TXAnimatedFrameDecodeQueue ()
+
+@property (nonatomic, strong) NSMutableArray<dispatch_block_t> *tasks; // Guarded by pool's lock
+@property (nonatomic, assign) NSUInteger runningCount; // Guarded by pool's lock
+
+@end
+
+@interface TXAnimatedFrameDecodePool () {
+    SD_LOCK_DECLARE(_lock);
+}
+
+@property (nonatomic, strong) NSMutableArray<TXAnimatedFrameDecodeQueue *> *queues; // The queues which have pending tasks, in round-robin order
+@property (nonatomic, assign) NSUInteger workerCount;
+
+- (void)addTask:(dispatch_block_t)task toQueue:(TXAnimatedFrameDecodeQueue *)queue;
+- (void)cancelTasksInQueue:(TXAnimatedFrameDecodeQueue *)queue;
+- (NSUInteger)pendingCountInQueue:(TXAnimatedFrameDecodeQueue *)queue;
+- (void)queueDidChangeMaxConcurrentCount:(TXAnimatedFrameDecodeQueue *)queue;
+
+@end
+
+@implementation TXAnimatedFrameDecodePool
+
++ (TXAnimatedFrameDecodePool *)sharedPool {
+    static dispatch_once_t onceToken;
+    static TXAnimatedFrameDecodePool *pool;
+    dispatch_once(&onceToken, ^{
+        pool = [[TXAnimatedFrameDecodePool alloc] initWithMaxConcurrentCount:[NSProcessInfo processInfo].activeProcessorCount];
+    });
+    return pool;
+}
+
+- (instancetype)initWithMaxConcurrentCount:(NSUInteger)maxConcurrentCount {
+    self = [super init];
+    if (self) {
+        _maxConcurrentCount = maxConcurrentCount;
+        _queues = [NSMutableArray array];
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+#pragma mark - Queue
+
+- (void)addTask:(dispatch_block_t)task toQueue:(TXAnimatedFrameDecodeQueue *)queue {
+    SD_LOCK(_lock);
+    if (queue.tasks.count == 0) {
+        [self.queues addObject:queue];
+    }
+    [queue.tasks addObject:task];
+    [self scheduleWorkerIfNeeded];
+    SD_UNLOCK(_lock);
+}
+
+- (void)cancelTasksInQueue:(TXAnimatedFrameDecodeQueue *)queue {
+    SD_LOCK(_lock);
+    if (queue.tasks.count > 0) {
+        [queue.tasks removeAllObjects];
+        [self.queues removeObjectIdenticalTo:queue];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (NSUInteger)pendingCountInQueue:(TXAnimatedFrameDecodeQueue *)queue {
+    SD_LOCK(_lock);
+    NSUInteger count = queue.tasks.count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (void)queueDidChangeMaxConcurrentCount:(TXAnimatedFrameDecodeQueue *)queue {
+    SD_LOCK(_lock);
+    [self scheduleWorkerIfNeeded];
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Worker
+
+// Must be called with lock held. Pop the next task in round-robin order, skip the queues which reach their concurrent limit.
+- (dispatch_block_t)dequeueTaskWithQueue:(TXAnimatedFrameDecodeQueue **)outQueue {
+    NSUInteger count = self.queues.count;
+    for (NSUInteger i = 0; i < count; i++) {
+        TXAnimatedFrameDecodeQueue *queue = self.queues[i];
+        if (queue.runningCount >= MAX(queue.maxConcurrentCount, 1)) {
+            continue;
+        }
+        dispatch_block_t task = queue.tasks.firstObject;
+        [queue.tasks removeObjectAtIndex:0];
+        queue.runningCount++;
+        // Move to the tail, the other queues go first next time
+        [self.queues removeObjectAtIndex:i];
+        if (queue.tasks.count > 0) {
+            [self.queues addObject:queue];
+        }
+        *outQueue = queue;
+        return task;
+    }
+    return nil;
+}
+
+// Must be called with lock held
+- (void)scheduleWorkerIfNeeded {
+    if (self.workerCount >= MAX(self.maxConcurrentCount, 1) || self.queues.count == 0) {
+        return;
+    }
+    self.workerCount++;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self runWorker];
+    });
+}
+
+- (void)runWorker {
+    while (YES) {
+        TXAnimatedFrameDecodeQueue *queue;
+        SD_LOCK(_lock);
+        dispatch_block_t task = [self dequeueTaskWithQueue:&queue];
+        if (!task) {
+            // Nothing to do, or all the pending queues reach their limit, the running workers will pick them later
+            self.workerCount--;
+            SD_UNLOCK(_lock);
+            return;
+        }
+        SD_UNLOCK(_lock);
+
+        @autoreleasepool {
+            task();
+        }
+
+        SD_LOCK(_lock);
+        queue.runningCount--;
+        // The queue which was waiting for its limit may be runnable now
+        [self scheduleWorkerIfNeeded];
+        SD_UNLOCK(_lock);
+    }
+}
+
+@end
+
+@implementation TXAnimatedFrameDecodeQueue
+
+- (instancetype)initWithPool:(TXAnimatedFrameDecodePool *)pool {
+    self = [super init];
+    if (self) {
+        _pool = pool;
+        _tasks = [NSMutableArray array];
+        _maxConcurrentCount = 1;
+    }
+    return self;
+}
+
+- (void)setMaxConcurrentCount:(NSUInteger)maxConcurrentCount {
+    @synchronized (self) {
+        _maxConcurrentCount = maxConcurrentCount;
+    }
+    [self.pool queueDidChangeMaxConcurrentCount:self];
+}
+
+- (NSUInteger)maxConcurrentCount {
+    @synchronized (self) {
+        return _maxConcurrentCount;
+    }
+}
+
+- (NSUInteger)pendingCount {
+    return [self.pool pendingCountInQueue:self];
+}
+
+- (void)addTask:(dispatch_block_t)task {
+    if (!task) {
+        return;
+    }
+    [self.pool addTask:[task copy] toQueue:self];
+}
+
+- (void)cancelAllTasks {
+    [self.pool cancelTasksInQueue:self];
+}
+
+@end
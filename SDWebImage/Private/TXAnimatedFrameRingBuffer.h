@@ -0,0 +1,64 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "TXWebImageCompat.h"
+
+/// A fixed-capacity ring buffer keyed by frame index, used as animated image frame cache. Frame at index `i` is stored in slot `i % capacity`.
+/// Each slot is a lock-free state machine (empty -> pending -> writing -> full -> empty), so the handoff between the decoding thread and the rendering thread does not need any lock or allocation:
+/// * The consumer (the rendering thread, which is main thread) reserves a slot for the frame it wants, reads full slots, and is the only one who evicts full slots.
+/// * The producer (the decoding thread) only writes to the slot which is reserved for the same frame index, and never touches a full slot.
+/// @note The consumer methods must be called on the same thread. The producer methods can be called from any thread.
+@interface TXAnimatedFrameRingBuffer : NSObject
+
+/// The slot count
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+/// The count of frames which are stored (full slots)
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// Create a ring buffer with the specify capacity. Capacity less than 1 will be treated as 1.
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+#pragma mark - Consumer
+
+/// Returns the frame stored at index, or nil if the frame is not available yet.
+- (nullable id)frameAtIndex:(NSUInteger)index;
+
+/// Reserve the slot for the frame at index, so that producer can fill it later.
+/// If the slot is stored with another frame, the old one is evicted.
+/// @return YES if the slot is reserved, NO if the frame is already stored, or the slot is being filled (pending or writing).
+- (BOOL)reserveFrameAtIndex:(NSUInteger)index;
+
+/// Directly store a frame from consumer thread, like the poster frame. This evict the old frame in that slot if need.
+- (void)setFrame:(nonnull id)frame atIndex:(NSUInteger)index;
+
+/// Evict the frame at index. Return YES if there is a frame evicted.
+- (BOOL)removeFrameAtIndex:(NSUInteger)index;
+
+/// Evict all frames except the one at index, and cancel all the pending reservations.
+- (void)removeAllFramesExceptIndex:(NSUInteger)index;
+
+/// Evict all frames, and cancel all the pending reservations.
+- (void)removeAllFrames;
+
+/// Cancel all the pending reservations, which is useful when the decoding operations are cancelled before starting.
+- (void)cancelPendingFrames;
+
+/// Enumerate all the stored frames, in slot order.
+- (void)enumerateFramesUsingBlock:(nonnull NS_NOESCAPE void (^)(NSUInteger index, id _Nonnull frame))block;
+
+#pragma mark - Producer
+
+/// Fill the slot reserved for the frame at index.
+/// @param frame The frame, nil means the decoding failed and the reservation is cancelled
+/// @param index The frame index
+/// @return YES if the frame is stored. NO if the slot is not reserved for this index (like cancelled or reserved by other index)
+- (BOOL)fulfillFrame:(nullable id)frame atIndex:(NSUInteger)index;
+
+@end
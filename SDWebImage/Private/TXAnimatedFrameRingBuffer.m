@@ -0,0 +1,222 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "TXAnimatedFrameRingBuffer.h"
+#import <stdatomic.h>
+#import <sched.h>
+
+// Slot state
+static const uint_fast32_t kSDFrameSlotEmpty = 0; // No frame, owned by nobody
+static const uint_fast32_t kSDFrameSlotPending = 1; // Reserved by consumer, waiting for producer
+static const uint_fast32_t kSDFrameSlotWriting = 2; // Exclusively owned by the one who moves it into this state
+static const uint_fast32_t kSDFrameSlotFull = 3; // Frame stored, only consumer can evict
+
+typedef struct {
+    _Atomic(uint_fast32_t) state;
+    NSUInteger index; // Only written by consumer, stable when pending or full
+    void *frame; // +1 retained, only valid when full
+} SDFrameSlot;
+
+@implementation TXAnimatedFrameRingBuffer {
+    SDFrameSlot *_slots;
+    NSUInteger _capacity;
+    _Atomic(NSUInteger) _count;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, 1);
+        _slots = calloc(_capacity, sizeof(SDFrameSlot));
+        for (NSUInteger i = 0; i < _capacity; i++) {
+            atomic_init(&_slots[i].state, kSDFrameSlotEmpty);
+        }
+        atomic_init(&_count, 0);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        SDFrameSlot *slot = &_slots[i];
+        if (atomic_load_explicit(&slot->state, memory_order_acquire) == kSDFrameSlotFull && slot->frame) {
+            CFRelease(slot->frame);
+            slot->frame = NULL;
+        }
+    }
+    free(_slots);
+    _slots = NULL;
+}
+
+- (NSUInteger)capacity {
+    return _capacity;
+}
+
+- (NSUInteger)count {
+    return atomic_load_explicit(&_count, memory_order_relaxed);
+}
+
+#pragma mark - Private
+
+static inline SDFrameSlot * SDFrameSlotAtIndex(SDFrameSlot *slots, NSUInteger capacity, NSUInteger index) {
+    return &slots[index % capacity];
+}
+
+// Consumer only, the slot must be full
+- (void)evictSlot:(SDFrameSlot *)slot {
+    void *frame = slot->frame;
+    slot->frame = NULL;
+    atomic_fetch_sub_explicit(&_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->state, kSDFrameSlotEmpty, memory_order_release);
+    if (frame) {
+        CFRelease(frame);
+    }
+}
+
+#pragma mark - Consumer
+
+- (id)frameAtIndex:(NSUInteger)index {
+    SDFrameSlot *slot = SDFrameSlotAtIndex(_slots, _capacity, index);
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) != kSDFrameSlotFull || slot->index != index) {
+        return nil;
+    }
+    return (__bridge id)slot->frame;
+}
+
+- (BOOL)reserveFrameAtIndex:(NSUInteger)index {
+    SDFrameSlot *slot = SDFrameSlotAtIndex(_slots, _capacity, index);
+    uint_fast32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+    if (state == kSDFrameSlotFull) {
+        if (slot->index == index) {
+            // Already stored
+            return NO;
+        }
+        // Stale frame which occupied the slot
+        [self evictSlot:slot];
+        state = kSDFrameSlotEmpty;
+    }
+    if (state != kSDFrameSlotEmpty) {
+        // Pending or writing
+        return NO;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&slot->state, &state, kSDFrameSlotWriting, memory_order_acquire, memory_order_relaxed)) {
+        return NO;
+    }
+    slot->index = index;
+    atomic_store_explicit(&slot->state, kSDFrameSlotPending, memory_order_release);
+    return YES;
+}
+
+- (void)setFrame:(id)frame atIndex:(NSUInteger)index {
+    if (!frame) {
+        return;
+    }
+    SDFrameSlot *slot = SDFrameSlotAtIndex(_slots, _capacity, index);
+    while (YES) {
+        uint_fast32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == kSDFrameSlotFull) {
+            [self evictSlot:slot];
+            continue;
+        }
+        if (state == kSDFrameSlotWriting) {
+            // Producer is storing the pointer, which is short
+            sched_yield();
+            continue;
+        }
+        // Empty, or take over the pending reservation (the producer will fail to fulfill)
+        if (atomic_compare_exchange_weak_explicit(&slot->state, &state, kSDFrameSlotWriting, memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+    }
+    slot->index = index;
+    slot->frame = (void *)CFBridgingRetain(frame);
+    atomic_fetch_add_explicit(&_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->state, kSDFrameSlotFull, memory_order_release);
+}
+
+- (BOOL)removeFrameAtIndex:(NSUInteger)index {
+    SDFrameSlot *slot = SDFrameSlotAtIndex(_slots, _capacity, index);
+    if (atomic_load_explicit(&slot->state, memory_order_acquire) != kSDFrameSlotFull || slot->index != index) {
+        return NO;
+    }
+    [self evictSlot:slot];
+    return YES;
+}
+
+- (void)removeAllFramesExceptIndex:(NSUInteger)index {
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        SDFrameSlot *slot = &_slots[i];
+        uint_fast32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == kSDFrameSlotFull) {
+            if (slot->index != index) {
+                [self evictSlot:slot];
+            }
+        } else if (state == kSDFrameSlotPending) {
+            atomic_compare_exchange_strong_explicit(&slot->state, &state, kSDFrameSlotEmpty, memory_order_release, memory_order_relaxed);
+        }
+    }
+}
+
+- (void)removeAllFrames {
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        SDFrameSlot *slot = &_slots[i];
+        uint_fast32_t state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == kSDFrameSlotFull) {
+            [self evictSlot:slot];
+        } else if (state == kSDFrameSlotPending) {
+            atomic_compare_exchange_strong_explicit(&slot->state, &state, kSDFrameSlotEmpty, memory_order_release, memory_order_relaxed);
+        }
+    }
+}
+
+- (void)cancelPendingFrames {
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        SDFrameSlot *slot = &_slots[i];
+        uint_fast32_t state = kSDFrameSlotPending;
+        atomic_compare_exchange_strong_explicit(&slot->state, &state, kSDFrameSlotEmpty, memory_order_release, memory_order_relaxed);
+    }
+}
+
+- (void)enumerateFramesUsingBlock:(NS_NOESCAPE void (^)(NSUInteger, id _Nonnull))block {
+    if (!block) {
+        return;
+    }
+    for (NSUInteger i = 0; i < _capacity; i++) {
+        SDFrameSlot *slot = &_slots[i];
+        if (atomic_load_explicit(&slot->state, memory_order_acquire) == kSDFrameSlotFull) {
+            block(slot->index, (__bridge id)slot->frame);
+        }
+    }
+}
+
+#pragma mark - Producer
+
+- (BOOL)fulfillFrame:(id)frame atIndex:(NSUInteger)index {
+    SDFrameSlot *slot = SDFrameSlotAtIndex(_slots, _capacity, index);
+    uint_fast32_t state = kSDFrameSlotPending;
+    if (!atomic_compare_exchange_strong_explicit(&slot->state, &state, kSDFrameSlotWriting, memory_order_acquire, memory_order_relaxed)) {
+        // Cancelled, or taken over by consumer
+        return NO;
+    }
+    if (slot->index != index) {
+        // Reserved by other frame index, give it back
+        atomic_store_explicit(&slot->state, kSDFrameSlotPending, memory_order_release);
+        return NO;
+    }
+    if (!frame) {
+        // Decode failed, cancel the reservation so it can be reserved again
+        atomic_store_explicit(&slot->state, kSDFrameSlotEmpty, memory_order_release);
+        return NO;
+    }
+    slot->frame = (void *)CFBridgingRetain(frame);
+    atomic_fetch_add_explicit(&_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->state, kSDFrameSlotFull, memory_order_release);
+    return YES;
+}
+
+@end
@@ -8,14 +8,18 @@
 
 #import <Foundation/Foundation.h>
 #import "TXWebImageCompat.h"
+#import "TXWebImageOperation.h"
 
-/// This is used for operation management, but not for operation queue execute
-@interface TXImageCachesManagerOperation : NSOperation
+/// This is used for operation management, but not for operation queue execute. Cancel it will cancel the operations of each cache added by `addCacheOperation:`
+@interface TXImageCachesManagerOperation : TXWebImageCancellationToken
 
 @property (nonatomic, assign, readonly) NSUInteger pendingCount;
+@property (nonatomic, assign, readonly, getter=isFinished) BOOL finished;
 
 - (void)beginWithTotalCount:(NSUInteger)totalCount;
 - (void)completeOne;
 - (void)done;
+/// Cancel the operation of the cache together with this one
+- (void)addCacheOperation:(nullable id<TXWebImageOperation>)cacheOperation;
 
 @end
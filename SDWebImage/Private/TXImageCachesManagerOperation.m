@@ -13,10 +13,8 @@
     SD_LOCK_DECLARE(_pendingCountLock);
 }
 
-@synthesize executing = _executing;
-@synthesize finished = _finished;
-@synthesize cancelled = _cancelled;
 @synthesize pendingCount = _pendingCount;
+@synthesize finished = _finished;
 
 - (instancetype)init {
     if (self = [super init]) {
@@ -27,9 +25,10 @@
 }
 
 - (void)beginWithTotalCount:(NSUInteger)totalCount {
-    self.executing = YES;
-    self.finished = NO;
+    SD_LOCK(_pendingCountLock);
+    _finished = NO;
     _pendingCount = totalCount;
+    SD_UNLOCK(_pendingCountLock);
 }
 
 - (NSUInteger)pendingCount {
@@ -39,21 +38,38 @@
     return pendingCount;
 }
 
+- (BOOL)isFinished {
+    SD_LOCK(_pendingCountLock);
+    BOOL finished = _finished;
+    SD_UNLOCK(_pendingCountLock);
+    return finished;
+}
+
 - (void)completeOne {
     SD_LOCK(_pendingCountLock);
     _pendingCount = _pendingCount > 0 ? _pendingCount - 1 : 0;
     SD_UNLOCK(_pendingCountLock);
 }
 
+- (void)addCacheOperation:(id<TXWebImageOperation>)cacheOperation {
+    if (!cacheOperation) {
+        return;
+    }
+    [self addCancellationHandler:^{
+        [cacheOperation cancel];
+    }];
+}
+
 - (void)cancel {
-    self.cancelled = YES;
+    [super cancel];
     [self reset];
 }
 
 - (void)done {
-    self.finished = YES;
-    self.executing = NO;
-    [self reset];
+    SD_LOCK(_pendingCountLock);
+    _finished = YES;
+    _pendingCount = 0;
+    SD_UNLOCK(_pendingCountLock);
 }
 
 - (void)reset {
@@ -62,22 +78,4 @@
     SD_UNLOCK(_pendingCountLock);
 }
 
-- (void)setFinished:(BOOL)finished {
-    [self willChangeValueForKey:@"isFinished"];
-    _finished = finished;
-    [self didChangeValueForKey:@"isFinished"];
-}
-
-- (void)setExecuting:(BOOL)executing {
-    [self willChangeValueForKey:@"isExecuting"];
-    _executing = executing;
-    [self didChangeValueForKey:@"isExecuting"];
-}
-
-- (void)setCancelled:(BOOL)cancelled {
-    [self willChangeValueForKey:@"isCancelled"];
-    _cancelled = cancelled;
-    [self didChangeValueForKey:@"isCancelled"];
-}
-
 @end
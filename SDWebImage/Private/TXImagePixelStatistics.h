@@ -0,0 +1,38 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+// Portable color statistics on 32-bit pixel buffers (4 bytes per pixel, the alpha is the last byte), like the average and dominant color.
+// This is plain C without Apple framework dependency, the inner loops are vectorized with SSE2 on x86 and NEON on ARM, with a scalar fallback.
+// The sums are returned per byte lane, so the caller maps the lanes to the channels of its pixel format.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The pixels with alpha less than this (a quarter) are ignored by `SDImagePixelDominantSums`
+#define kSDImagePixelDominantMinAlpha 64
+
+/// Sum each byte lane of all the pixels.
+/// @param opaque Whether the alpha byte is unused, which is treated as 255
+/// @param sums The sums of lane 0 to lane 3
+void SDImagePixelSums(const uint8_t *data, size_t width, size_t height, size_t rowBytes, bool opaque, uint64_t sums[4]);
+
+/// Find the most frequent color, the lane 0 to lane 2 are quantized to 4 bits each (4096 bins), the mostly transparent pixels are ignored.
+/// @param opaque Whether the alpha byte is unused, which is treated as 255
+/// @param sums The sums of lane 0 to lane 3 of the pixels in the most frequent bin, so the average is more accurate than the bin center
+/// @param count The pixel count in the most frequent bin
+/// @return false if no pixel counted, or out of memory
+bool SDImagePixelDominantSums(const uint8_t *data, size_t width, size_t height, size_t rowBytes, bool opaque, uint64_t sums[4], uint64_t *count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,205 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#include "TXImagePixelStatistics.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#define SD_PIXEL_STATISTICS_X86 1
+#include <emmintrin.h>
+#else
+#define SD_PIXEL_STATISTICS_X86 0
+#endif
+
+// The horizontal add is only available on arm64
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#define SD_PIXEL_STATISTICS_NEON 1
+#include <arm_neon.h>
+#else
+#define SD_PIXEL_STATISTICS_NEON 0
+#endif
+
+#define kSDPixelBinCount 4096
+
+// The bin of lane 0 to lane 2 with 4 bits each
+static inline uint32_t SDPixelBinIndex(uint32_t pixel) {
+    uint32_t value = pixel >> 4;
+    return (value & 0xF) | ((value >> 4) & 0xF0) | ((value >> 8) & 0xF00);
+}
+
+#pragma mark - Sums
+
+// Sum one row, return the pixel count done by SIMD, the rest is done by scalar
+static size_t SDPixelSumsRowSIMD(const uint8_t *row, size_t width, uint64_t sums[4]) {
+    size_t x = 0;
+#if SD_PIXEL_STATISTICS_X86
+    // `sad` against zero sums 8 bytes into 64 bits, mask out the other lanes first
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(row + x * 4));
+        sum0 = _mm_add_epi64(sum0, _mm_sad_epu8(_mm_and_si128(pixels, mask), zero));
+        sum1 = _mm_add_epi64(sum1, _mm_sad_epu8(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask), zero));
+        sum2 = _mm_add_epi64(sum2, _mm_sad_epu8(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask), zero));
+        sum3 = _mm_add_epi64(sum3, _mm_sad_epu8(_mm_srli_epi32(pixels, 24), zero));
+    }
+    uint64_t values[2];
+    _mm_storeu_si128((__m128i *)values, sum0);
+    sums[0] += values[0] + values[1];
+    _mm_storeu_si128((__m128i *)values, sum1);
+    sums[1] += values[0] + values[1];
+    _mm_storeu_si128((__m128i *)values, sum2);
+    sums[2] += values[0] + values[1];
+    _mm_storeu_si128((__m128i *)values, sum3);
+    sums[3] += values[0] + values[1];
+#elif SD_PIXEL_STATISTICS_NEON
+    // Deinterleave 16 pixels, pairwise add into 32 bits, which does not overflow for any row width in practice (2^32 / 255 / 4 pixels)
+    uint32x4_t sum0 = vdupq_n_u32(0), sum1 = vdupq_n_u32(0), sum2 = vdupq_n_u32(0), sum3 = vdupq_n_u32(0);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x4_t pixels = vld4q_u8(row + x * 4);
+        sum0 = vpadalq_u16(sum0, vpaddlq_u8(pixels.val[0]));
+        sum1 = vpadalq_u16(sum1, vpaddlq_u8(pixels.val[1]));
+        sum2 = vpadalq_u16(sum2, vpaddlq_u8(pixels.val[2]));
+        sum3 = vpadalq_u16(sum3, vpaddlq_u8(pixels.val[3]));
+    }
+    sums[0] += vaddlvq_u32(sum0);
+    sums[1] += vaddlvq_u32(sum1);
+    sums[2] += vaddlvq_u32(sum2);
+    sums[3] += vaddlvq_u32(sum3);
+#endif
+    return x;
+}
+
+void SDImagePixelSums(const uint8_t *data, size_t width, size_t height, size_t rowBytes, bool opaque, uint64_t sums[4]) {
+    memset(sums, 0, sizeof(uint64_t) * 4);
+    if (!data) {
+        return;
+    }
+    for (size_t y = 0; y < height; y++) {
+        const uint8_t *row = data + y * rowBytes;
+        for (size_t x = SDPixelSumsRowSIMD(row, width, sums); x < width; x++) {
+            sums[0] += row[x * 4 + 0];
+            sums[1] += row[x * 4 + 1];
+            sums[2] += row[x * 4 + 2];
+            sums[3] += row[x * 4 + 3];
+        }
+    }
+    if (opaque) {
+        sums[3] = (uint64_t)width * height * 255;
+    }
+}
+
+#pragma mark - Dominant
+
+typedef struct SDPixelBin {
+    uint64_t count;
+    uint64_t sums[4];
+} SDPixelBin;
+
+static inline void SDPixelBinAdd(SDPixelBin *bins, uint32_t index, uint32_t pixel) {
+    SDPixelBin *bin = bins + index;
+    bin->count++;
+    bin->sums[0] += pixel & 0xFF;
+    bin->sums[1] += (pixel >> 8) & 0xFF;
+    bin->sums[2] += (pixel >> 16) & 0xFF;
+    bin->sums[3] += pixel >> 24;
+}
+
+// Add one row, return the pixel count done by SIMD, the rest is done by scalar
+static size_t SDPixelDominantRowSIMD(const uint8_t *row, size_t width, uint32_t alphaFill, SDPixelBin *bins) {
+    size_t x = 0;
+#if SD_PIXEL_STATISTICS_X86
+    // Compute the bin index and alpha test of 4 pixels at once, then scatter
+    const __m128i lowMask = _mm_set1_epi32(0xF);
+    const __m128i middleMask = _mm_set1_epi32(0xF0);
+    const __m128i highMask = _mm_set1_epi32(0xF00);
+    const __m128i minAlpha = _mm_set1_epi32(kSDImagePixelDominantMinAlpha - 1);
+    const __m128i alpha = _mm_set1_epi32((int)alphaFill);
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_or_si128(_mm_loadu_si128((const __m128i *)(row + x * 4)), alpha);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_srli_epi32(pixels, 24), minAlpha)));
+        if (!mask) {
+            continue;
+        }
+        __m128i value = _mm_srli_epi32(pixels, 4);
+        __m128i index = _mm_or_si128(_mm_and_si128(value, lowMask), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(value, 4), middleMask), _mm_and_si128(_mm_srli_epi32(value, 8), highMask)));
+        uint32_t indexes[4], values[4];
+        _mm_storeu_si128((__m128i *)indexes, index);
+        _mm_storeu_si128((__m128i *)values, pixels);
+        for (int i = 0; i < 4; i++) {
+            if (mask & (1 << i)) {
+                SDPixelBinAdd(bins, indexes[i], values[i]);
+            }
+        }
+    }
+#elif SD_PIXEL_STATISTICS_NEON
+    const uint32x4_t lowMask = vdupq_n_u32(0xF);
+    const uint32x4_t middleMask = vdupq_n_u32(0xF0);
+    const uint32x4_t highMask = vdupq_n_u32(0xF00);
+    const uint32x4_t minAlpha = vdupq_n_u32(kSDImagePixelDominantMinAlpha);
+    const uint32x4_t alpha = vdupq_n_u32(alphaFill);
+    for (; x + 4 <= width; x += 4) {
+        uint32x4_t pixels = vorrq_u32(vld1q_u32((const uint32_t *)(row + x * 4)), alpha);
+        uint32x4_t mask = vcgeq_u32(vshrq_n_u32(pixels, 24), minAlpha);
+        if (vmaxvq_u32(mask) == 0) {
+            continue;
+        }
+        uint32x4_t value = vshrq_n_u32(pixels, 4);
+        uint32x4_t index = vorrq_u32(vandq_u32(value, lowMask), vorrq_u32(vandq_u32(vshrq_n_u32(value, 4), middleMask), vandq_u32(vshrq_n_u32(value, 8), highMask)));
+        uint32_t indexes[4], values[4], masks[4];
+        vst1q_u32(indexes, index);
+        vst1q_u32(values, pixels);
+        vst1q_u32(masks, mask);
+        for (int i = 0; i < 4; i++) {
+            if (masks[i]) {
+                SDPixelBinAdd(bins, indexes[i], values[i]);
+            }
+        }
+    }
+#endif
+    return x;
+}
+
+bool SDImagePixelDominantSums(const uint8_t *data, size_t width, size_t height, size_t rowBytes, bool opaque, uint64_t sums[4], uint64_t *count) {
+    memset(sums, 0, sizeof(uint64_t) * 4);
+    *count = 0;
+    if (!data || width == 0 || height == 0) {
+        return false;
+    }
+    SDPixelBin *bins = calloc(kSDPixelBinCount, sizeof(SDPixelBin));
+    if (!bins) {
+        return false;
+    }
+    // Fill the unused alpha byte, so it's counted as 255
+    uint32_t alphaFill = opaque ? 0xFF000000 : 0;
+    for (size_t y = 0; y < height; y++) {
+        const uint8_t *row = data + y * rowBytes;
+        for (size_t x = SDPixelDominantRowSIMD(row, width, alphaFill, bins); x < width; x++) {
+            uint32_t pixel;
+            memcpy(&pixel, row + x * 4, 4);
+            pixel |= alphaFill;
+            if ((pixel >> 24) >= kSDImagePixelDominantMinAlpha) {
+                SDPixelBinAdd(bins, SDPixelBinIndex(pixel), pixel);
+            }
+        }
+    }
+    const SDPixelBin *dominant = bins;
+    for (size_t i = 1; i < kSDPixelBinCount; i++) {
+        if (bins[i].count > dominant->count) {
+            dominant = bins + i;
+        }
+    }
+    *count = dominant->count;
+    for (int i = 0; i < 4; i++) {
+        sums[i] = dominant->sums[i];
+    }
+    free(bins);
+    return *count > 0;
+}
@@ -0,0 +1,94 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+// Portable separable image resampling and blur on 32-bit pixel buffers.
+// This is plain C without Apple framework dependency, so it can be built and profiled on other platforms as well.
+// The inner loops are vectorized with SSE2/AVX2 on x86 and NEON on ARM, with a scalar fallback.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The resampling filter kernel
+typedef enum SDImageResamplerKernel {
+    /// Box filter (area average when scaling down), fastest
+    SDImageResamplerKernelBox = 0,
+    /// Triangle filter, the bilinear interpolation scaled to the area when scaling down
+    SDImageResamplerKernelBilinear,
+    /// Lanczos windowed sinc with 3 lobes, sharpest
+    SDImageResamplerKernelLanczos3,
+} SDImageResamplerKernel;
+
+/// The instruction set used by the inner loops
+typedef enum SDImageResamplerISA {
+    SDImageResamplerISAScalar = 0,
+    SDImageResamplerISASSE2,
+    SDImageResamplerISAAVX2,
+    SDImageResamplerISANEON,
+} SDImageResamplerISA;
+
+/// The pixel format, 4 bytes per pixel, 8 bits per component
+typedef enum SDImageResamplerFormat {
+    /// Premultiplied alpha in the last byte, like BGRA8888 (`kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst` on little endian)
+    SDImageResamplerFormatBGRA8 = 0,
+    /// No alpha, the last byte is ignored, like RGBX8888 (`kCGBitmapByteOrderDefault | kCGImageAlphaNoneSkipLast`)
+    SDImageResamplerFormatRGBX8,
+} SDImageResamplerFormat;
+
+/// A pixel buffer, the first row is the top one
+typedef struct SDImageResamplerBuffer {
+    void *data;
+    size_t width;
+    size_t height;
+    size_t rowBytes;
+} SDImageResamplerBuffer;
+
+/// Whether the ISA can be used on current CPU
+bool SDImageResamplerISAIsSupported(SDImageResamplerISA isa);
+/// The fastest ISA supported on current CPU
+SDImageResamplerISA SDImageResamplerGetBestISA(void);
+/// The ISA name for logging, like "AVX2"
+const char *SDImageResamplerISAName(SDImageResamplerISA isa);
+/// The kernel name for logging, like "Lanczos3"
+const char *SDImageResamplerKernelName(SDImageResamplerKernel kernel);
+
+/// Scale the whole source buffer into the whole destination buffer.
+/// @return false if the arguments are invalid, the ISA is not supported, or out of memory
+bool SDImageResamplerScale(const SDImageResamplerBuffer *src, const SDImageResamplerBuffer *dst, SDImageResamplerKernel kernel, SDImageResamplerFormat format, SDImageResamplerISA isa);
+
+/// Get the source rows needed to produce the destination rows, which should be available in the source band passed to `SDImageResamplerScaleRows`.
+/// @param srcHeight The full source height
+/// @param dstHeight The full destination height
+/// @param dstY The first destination row
+/// @param dstRowCount The destination row count
+/// @param outSrcY The first source row needed
+/// @param outSrcRowCount The source row count needed
+void SDImageResamplerGetSourceRows(size_t srcHeight, size_t dstHeight, size_t dstY, size_t dstRowCount, SDImageResamplerKernel kernel, size_t *outSrcY, size_t *outSrcRowCount);
+
+/// Scale a band of the source image into a band of the destination image, so a large image can be processed band by band, each band independently (and concurrently).
+/// @param src The source band, which contains the full width and the rows starting from `srcY`
+/// @param srcY The first row of the source band in the full source image
+/// @param srcHeight The full source height
+/// @param dst The destination band, which contains the full width and the rows starting from `dstY`. All of its rows are produced.
+/// @param dstY The first row of the destination band in the full destination image
+/// @param dstHeight The full destination height
+/// @return false if the source band does not contain the rows needed (see `SDImageResamplerGetSourceRows`), or the same as `SDImageResamplerScale`
+bool SDImageResamplerScaleRows(const SDImageResamplerBuffer *src, size_t srcY, size_t srcHeight, const SDImageResamplerBuffer *dst, size_t dstY, size_t dstHeight, SDImageResamplerKernel kernel, SDImageResamplerFormat format, SDImageResamplerISA isa);
+
+/// Blur the source buffer into the destination buffer with the separable Gaussian kernel, which is truncated at 3 sigma. The destination can be the same as the source.
+/// @param sigma The standard deviation in pixels, the cost is linear to it, so downsample first for the large one
+/// @return false if the sizes are not the same, or the same as `SDImageResamplerScale`
+bool SDImageResamplerBlur(const SDImageResamplerBuffer *src, const SDImageResamplerBuffer *dst, double sigma, SDImageResamplerISA isa);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,615 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#include "TXImageResampler.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#define SD_RESAMPLER_X86 1
+#include <immintrin.h>
+#else
+#define SD_RESAMPLER_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SD_RESAMPLER_NEON 1
+#include <arm_neon.h>
+#else
+#define SD_RESAMPLER_NEON 0
+#endif
+
+// The weights are fixed-point with this precision, the sum of weights for one output is exactly `1 << kSDResamplerPrecisionBits`
+// 14 bits keep each weight in int16 (the Lanczos lobes are within [-0.3, 1]) and the 255 * sum |weight| in int32
+#define kSDResamplerPrecisionBits 14
+#define kSDResamplerRounding (1 << (kSDResamplerPrecisionBits - 1))
+
+#pragma mark - Coefficients
+
+// The contributions of source pixels for each output pixel along one axis
+typedef struct SDResamplerCoefficients {
+    size_t count; // the output count
+    size_t maxTaps; // the stride of weights
+    size_t *starts; // the first source index
+    size_t *taps; // the source count
+    int16_t *weights;
+} SDResamplerCoefficients;
+
+static double SDResamplerKernelSupport(SDImageResamplerKernel kernel) {
+    switch (kernel) {
+        case SDImageResamplerKernelBox:
+            return 0.5;
+        case SDImageResamplerKernelBilinear:
+            return 1.0;
+        case SDImageResamplerKernelLanczos3:
+            return 3.0;
+    }
+    return 1.0;
+}
+
+static inline double SDResamplerSinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= M_PI;
+    return sin(x) / x;
+}
+
+static double SDResamplerKernelWeight(SDImageResamplerKernel kernel, double x) {
+    switch (kernel) {
+        case SDImageResamplerKernelBox:
+            return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+        case SDImageResamplerKernelBilinear:
+            x = fabs(x);
+            return x < 1.0 ? 1.0 - x : 0.0;
+        case SDImageResamplerKernelLanczos3:
+            if (x > -3.0 && x < 3.0) {
+                return SDResamplerSinc(x) * SDResamplerSinc(x / 3.0);
+            }
+            return 0.0;
+    }
+    return 0.0;
+}
+
+static void SDResamplerCoefficientsFree(SDResamplerCoefficients *coeffs) {
+    free(coeffs->starts);
+    free(coeffs->taps);
+    free(coeffs->weights);
+    memset(coeffs, 0, sizeof(SDResamplerCoefficients));
+}
+
+// Normalize, and give the rounding error to the largest weight, so a flat color keeps the same
+static void SDResamplerWeightsNormalize(int16_t *weights, const double *values, size_t taps, double total) {
+    int32_t sum = 0;
+    size_t largest = 0;
+    for (size_t k = 0; k < taps; k++) {
+        int32_t weight = (int32_t)lround(values[k] / total * (1 << kSDResamplerPrecisionBits));
+        weights[k] = (int16_t)weight;
+        sum += weight;
+        if (weight > weights[largest]) {
+            largest = k;
+        }
+    }
+    weights[largest] += (1 << kSDResamplerPrecisionBits) - sum;
+}
+
+// Compute the coefficients of `outCount` outputs starting from `outStart`, for scaling `inSize` to `outSize`
+static bool SDResamplerCoefficientsCreate(SDResamplerCoefficients *coeffs, size_t inSize, size_t outSize, size_t outStart, size_t outCount, SDImageResamplerKernel kernel) {
+    memset(coeffs, 0, sizeof(SDResamplerCoefficients));
+    double scale = (double)inSize / (double)outSize;
+    // Scale the kernel when scaling down, so each output covers its source area
+    double filterScale = scale > 1.0 ? scale : 1.0;
+    double support = SDResamplerKernelSupport(kernel) * filterScale;
+    size_t maxTaps = (size_t)ceil(support) * 2 + 1;
+    coeffs->count = outCount;
+    coeffs->maxTaps = maxTaps;
+    coeffs->starts = malloc(outCount * sizeof(size_t));
+    coeffs->taps = malloc(outCount * sizeof(size_t));
+    coeffs->weights = calloc(outCount * maxTaps, sizeof(int16_t));
+    double *values = malloc(maxTaps * sizeof(double));
+    if (!coeffs->starts || !coeffs->taps || !coeffs->weights || !values) {
+        free(values);
+        SDResamplerCoefficientsFree(coeffs);
+        return false;
+    }
+    for (size_t i = 0; i < outCount; i++) {
+        double center = ((double)(outStart + i) + 0.5) * scale;
+        double minValue = floor(center - support + 0.5);
+        double maxValue = floor(center + support + 0.5);
+        size_t min = minValue < 0 ? 0 : (size_t)minValue;
+        size_t max = maxValue > (double)inSize ? inSize : (size_t)maxValue;
+        if (max <= min) {
+            // Out of source, use the nearest one
+            min = center >= (double)inSize ? inSize - 1 : (size_t)center;
+            max = min + 1;
+        }
+        size_t taps = max - min;
+        if (taps > maxTaps) {
+            taps = maxTaps;
+        }
+        double total = 0;
+        for (size_t k = 0; k < taps; k++) {
+            double value = SDResamplerKernelWeight(kernel, ((double)(min + k) - center + 0.5) / filterScale);
+            values[k] = value;
+            total += value;
+        }
+        int16_t *weights = coeffs->weights + i * maxTaps;
+        if (total == 0) {
+            // The box filter may miss all samples when scaling up, use the nearest one
+            size_t nearest = (size_t)(center - (double)min);
+            weights[nearest < taps ? nearest : taps - 1] = 1 << kSDResamplerPrecisionBits;
+        } else {
+            SDResamplerWeightsNormalize(weights, values, taps, total);
+        }
+        coeffs->starts[i] = min;
+        coeffs->taps[i] = taps;
+    }
+    free(values);
+    return true;
+}
+
+// Compute the Gaussian coefficients of `size` outputs without scaling, the kernel is truncated at 3 sigma, and normalized within the image, so the edge keeps the same color
+static bool SDResamplerCoefficientsCreateGaussian(SDResamplerCoefficients *coeffs, size_t size, double sigma) {
+    memset(coeffs, 0, sizeof(SDResamplerCoefficients));
+    size_t radius = (size_t)ceil(sigma * 3.0);
+    size_t maxTaps = radius * 2 + 1;
+    coeffs->count = size;
+    coeffs->maxTaps = maxTaps;
+    coeffs->starts = malloc(size * sizeof(size_t));
+    coeffs->taps = malloc(size * sizeof(size_t));
+    coeffs->weights = calloc(size * maxTaps, sizeof(int16_t));
+    double *kernel = malloc(maxTaps * sizeof(double));
+    if (!coeffs->starts || !coeffs->taps || !coeffs->weights || !kernel) {
+        free(kernel);
+        SDResamplerCoefficientsFree(coeffs);
+        return false;
+    }
+    for (size_t k = 0; k < maxTaps; k++) {
+        double x = (double)k - (double)radius;
+        kernel[k] = exp(-x * x / (2.0 * sigma * sigma));
+    }
+    for (size_t i = 0; i < size; i++) {
+        size_t min = i > radius ? i - radius : 0;
+        size_t max = i + radius + 1 < size ? i + radius + 1 : size;
+        const double *values = kernel + (min + radius - i);
+        double total = 0;
+        for (size_t k = 0; k < max - min; k++) {
+            total += values[k];
+        }
+        SDResamplerWeightsNormalize(coeffs->weights + i * maxTaps, values, max - min, total);
+        coeffs->starts[i] = min;
+        coeffs->taps[i] = max - min;
+    }
+    free(kernel);
+    return true;
+}
+
+static inline uint8_t SDResamplerClip8(int32_t value) {
+    value >>= kSDResamplerPrecisionBits;
+    return value < 0 ? 0 : (value > 255 ? 255 : (uint8_t)value);
+}
+
+#pragma mark - Scalar
+
+// Resample one row horizontally
+static void SDResamplerHorizontalScalar(const uint8_t *src, uint8_t *dst, const SDResamplerCoefficients *coeffs) {
+    for (size_t x = 0; x < coeffs->count; x++) {
+        const uint8_t *pixel = src + coeffs->starts[x] * 4;
+        const int16_t *weights = coeffs->weights + x * coeffs->maxTaps;
+        size_t taps = coeffs->taps[x];
+        int32_t c0 = kSDResamplerRounding, c1 = kSDResamplerRounding, c2 = kSDResamplerRounding, c3 = kSDResamplerRounding;
+        for (size_t k = 0; k < taps; k++) {
+            int32_t weight = weights[k];
+            c0 += pixel[k * 4 + 0] * weight;
+            c1 += pixel[k * 4 + 1] * weight;
+            c2 += pixel[k * 4 + 2] * weight;
+            c3 += pixel[k * 4 + 3] * weight;
+        }
+        dst[x * 4 + 0] = SDResamplerClip8(c0);
+        dst[x * 4 + 1] = SDResamplerClip8(c1);
+        dst[x * 4 + 2] = SDResamplerClip8(c2);
+        dst[x * 4 + 3] = SDResamplerClip8(c3);
+    }
+}
+
+// Resample one row vertically, `src` is the first source row, `bytes` is the row bytes to produce
+static void SDResamplerVerticalScalar(const uint8_t *src, size_t rowBytes, uint8_t *dst, size_t bytes, const int16_t *weights, size_t taps, size_t x) {
+    for (; x < bytes; x++) {
+        int32_t value = kSDResamplerRounding;
+        for (size_t k = 0; k < taps; k++) {
+            value += src[k * rowBytes + x] * weights[k];
+        }
+        dst[x] = SDResamplerClip8(value);
+    }
+}
+
+#pragma mark - SSE2 & AVX2
+
+#if SD_RESAMPLER_X86
+// Pack the weight pair for `madd`, the low one is for the first pixel
+static inline int32_t SDResamplerWeightPair(int16_t first, int16_t second) {
+    return (int32_t)(((uint32_t)(uint16_t)second << 16) | (uint16_t)first);
+}
+
+// Use `madd` to multiply-add 2 taps at once: interleave the 2 pixels channel by channel, then multiply with the interleaved weight pair
+static void SDResamplerHorizontalSSE2(const uint8_t *src, uint8_t *dst, const SDResamplerCoefficients *coeffs) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(kSDResamplerRounding);
+    for (size_t x = 0; x < coeffs->count; x++) {
+        const uint8_t *pixel = src + coeffs->starts[x] * 4;
+        const int16_t *weights = coeffs->weights + x * coeffs->maxTaps;
+        size_t taps = coeffs->taps[x];
+        __m128i sum = rounding;
+        size_t k = 0;
+        for (; k + 1 < taps; k += 2) {
+            __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(pixel + k * 4)), zero);
+            pixels = _mm_unpacklo_epi16(pixels, _mm_srli_si128(pixels, 8));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, _mm_set1_epi32(SDResamplerWeightPair(weights[k], weights[k + 1]))));
+        }
+        if (k < taps) {
+            int32_t value;
+            memcpy(&value, pixel + k * 4, 4);
+            __m128i pixels = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, _mm_set1_epi32(SDResamplerWeightPair(weights[k], 0))));
+        }
+        sum = _mm_srai_epi32(sum, kSDResamplerPrecisionBits);
+        sum = _mm_packs_epi32(sum, sum);
+        sum = _mm_packus_epi16(sum, sum);
+        int32_t value = _mm_cvtsi128_si32(sum);
+        memcpy(dst + x * 4, &value, 4);
+    }
+}
+
+// 4 pixels (16 bytes) each time, with 2 rows at once like horizontal one
+static void SDResamplerVerticalSSE2(const uint8_t *src, size_t rowBytes, uint8_t *dst, size_t bytes, const int16_t *weights, size_t taps) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(kSDResamplerRounding);
+    size_t x = 0;
+    for (; x + 16 <= bytes; x += 16) {
+        __m128i sum0 = rounding, sum1 = rounding, sum2 = rounding, sum3 = rounding;
+        for (size_t k = 0; k < taps; k += 2) {
+            __m128i row0 = _mm_loadu_si128((const __m128i *)(src + k * rowBytes + x));
+            __m128i row1 = zero;
+            int16_t weight1 = 0;
+            if (k + 1 < taps) {
+                row1 = _mm_loadu_si128((const __m128i *)(src + (k + 1) * rowBytes + x));
+                weight1 = weights[k + 1];
+            }
+            __m128i weight = _mm_set1_epi32(SDResamplerWeightPair(weights[k], weight1));
+            __m128i low = _mm_unpacklo_epi8(row0, row1);
+            __m128i high = _mm_unpackhi_epi8(row0, row1);
+            sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi8(low, zero), weight));
+            sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi8(low, zero), weight));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi8(high, zero), weight));
+            sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi8(high, zero), weight));
+        }
+        sum0 = _mm_srai_epi32(sum0, kSDResamplerPrecisionBits);
+        sum1 = _mm_srai_epi32(sum1, kSDResamplerPrecisionBits);
+        sum2 = _mm_srai_epi32(sum2, kSDResamplerPrecisionBits);
+        sum3 = _mm_srai_epi32(sum3, kSDResamplerPrecisionBits);
+        __m128i result = _mm_packus_epi16(_mm_packs_epi32(sum0, sum1), _mm_packs_epi32(sum2, sum3));
+        _mm_storeu_si128((__m128i *)(dst + x), result);
+    }
+    SDResamplerVerticalScalar(src, rowBytes, dst, bytes, weights, taps, x);
+}
+
+// The same as SSE2 one with 8 pixels (32 bytes) each time. The unpack and pack work in each 128-bit lane, so the pixel order is kept.
+__attribute__((target("avx2")))
+static void SDResamplerVerticalAVX2(const uint8_t *src, size_t rowBytes, uint8_t *dst, size_t bytes, const int16_t *weights, size_t taps) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi32(kSDResamplerRounding);
+    size_t x = 0;
+    for (; x + 32 <= bytes; x += 32) {
+        __m256i sum0 = rounding, sum1 = rounding, sum2 = rounding, sum3 = rounding;
+        for (size_t k = 0; k < taps; k += 2) {
+            __m256i row0 = _mm256_loadu_si256((const __m256i *)(src + k * rowBytes + x));
+            __m256i row1 = zero;
+            int16_t weight1 = 0;
+            if (k + 1 < taps) {
+                row1 = _mm256_loadu_si256((const __m256i *)(src + (k + 1) * rowBytes + x));
+                weight1 = weights[k + 1];
+            }
+            __m256i weight = _mm256_set1_epi32(SDResamplerWeightPair(weights[k], weight1));
+            __m256i low = _mm256_unpacklo_epi8(row0, row1);
+            __m256i high = _mm256_unpackhi_epi8(row0, row1);
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_unpacklo_epi8(low, zero), weight));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_unpackhi_epi8(low, zero), weight));
+            sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_unpacklo_epi8(high, zero), weight));
+            sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_unpackhi_epi8(high, zero), weight));
+        }
+        sum0 = _mm256_srai_epi32(sum0, kSDResamplerPrecisionBits);
+        sum1 = _mm256_srai_epi32(sum1, kSDResamplerPrecisionBits);
+        sum2 = _mm256_srai_epi32(sum2, kSDResamplerPrecisionBits);
+        sum3 = _mm256_srai_epi32(sum3, kSDResamplerPrecisionBits);
+        __m256i result = _mm256_packus_epi16(_mm256_packs_epi32(sum0, sum1), _mm256_packs_epi32(sum2, sum3));
+        _mm256_storeu_si256((__m256i *)(dst + x), result);
+    }
+    SDResamplerVerticalSSE2(src + x, rowBytes, dst + x, bytes - x, weights, taps);
+}
+#endif
+
+#pragma mark - NEON
+
+#if SD_RESAMPLER_NEON
+static void SDResamplerHorizontalNEON(const uint8_t *src, uint8_t *dst, const SDResamplerCoefficients *coeffs) {
+    for (size_t x = 0; x < coeffs->count; x++) {
+        const uint8_t *pixel = src + coeffs->starts[x] * 4;
+        const int16_t *weights = coeffs->weights + x * coeffs->maxTaps;
+        size_t taps = coeffs->taps[x];
+        int32x4_t sum = vdupq_n_s32(kSDResamplerRounding);
+        for (size_t k = 0; k < taps; k++) {
+            uint32_t value;
+            memcpy(&value, pixel + k * 4, 4);
+            int16x4_t pixels = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(value)))));
+            sum = vmlal_n_s16(sum, pixels, weights[k]);
+        }
+        uint16x4_t result = vqshrun_n_s32(sum, kSDResamplerPrecisionBits);
+        uint32_t value = vget_lane_u32(vreinterpret_u32_u8(vqmovn_u16(vcombine_u16(result, result))), 0);
+        memcpy(dst + x * 4, &value, 4);
+    }
+}
+
+// 4 pixels (16 bytes) each time
+static void SDResamplerVerticalNEON(const uint8_t *src, size_t rowBytes, uint8_t *dst, size_t bytes, const int16_t *weights, size_t taps) {
+    size_t x = 0;
+    for (; x + 16 <= bytes; x += 16) {
+        int32x4_t sum0 = vdupq_n_s32(kSDResamplerRounding), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (size_t k = 0; k < taps; k++) {
+            uint8x16_t row = vld1q_u8(src + k * rowBytes + x);
+            int16x8_t low = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(row)));
+            int16x8_t high = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(row)));
+            int16_t weight = weights[k];
+            sum0 = vmlal_n_s16(sum0, vget_low_s16(low), weight);
+            sum1 = vmlal_n_s16(sum1, vget_high_s16(low), weight);
+            sum2 = vmlal_n_s16(sum2, vget_low_s16(high), weight);
+            sum3 = vmlal_n_s16(sum3, vget_high_s16(high), weight);
+        }
+        uint16x8_t low = vcombine_u16(vqshrun_n_s32(sum0, kSDResamplerPrecisionBits), vqshrun_n_s32(sum1, kSDResamplerPrecisionBits));
+        uint16x8_t high = vcombine_u16(vqshrun_n_s32(sum2, kSDResamplerPrecisionBits), vqshrun_n_s32(sum3, kSDResamplerPrecisionBits));
+        vst1q_u8(dst + x, vcombine_u8(vqmovn_u16(low), vqmovn_u16(high)));
+    }
+    SDResamplerVerticalScalar(src, rowBytes, dst, bytes, weights, taps, x);
+}
+#endif
+
+#pragma mark - Dispatch
+
+typedef void (*SDResamplerHorizontalFunction)(const uint8_t *src, uint8_t *dst, const SDResamplerCoefficients *coeffs);
+typedef void (*SDResamplerVerticalFunction)(const uint8_t *src, size_t rowBytes, uint8_t *dst, size_t bytes, const int16_t *weights, size_t taps);
+
+static void SDResamplerVerticalScalarRow(const uint8_t *src, size_t rowBytes, uint8_t *dst, size_t bytes, const int16_t *weights, size_t taps) {
+    SDResamplerVerticalScalar(src, rowBytes, dst, bytes, weights, taps, 0);
+}
+
+static bool SDResamplerGetFunctions(SDImageResamplerISA isa, SDResamplerHorizontalFunction *horizontal, SDResamplerVerticalFunction *vertical) {
+    if (!SDImageResamplerISAIsSupported(isa)) {
+        return false;
+    }
+    switch (isa) {
+#if SD_RESAMPLER_X86
+        case SDImageResamplerISASSE2:
+            *horizontal = SDResamplerHorizontalSSE2;
+            *vertical = SDResamplerVerticalSSE2;
+            return true;
+        case SDImageResamplerISAAVX2:
+            // The horizontal pass gathers few pixels for each output, the wider register does not help
+            *horizontal = SDResamplerHorizontalSSE2;
+            *vertical = SDResamplerVerticalAVX2;
+            return true;
+#endif
+#if SD_RESAMPLER_NEON
+        case SDImageResamplerISANEON:
+            *horizontal = SDResamplerHorizontalNEON;
+            *vertical = SDResamplerVerticalNEON;
+            return true;
+#endif
+        default:
+            *horizontal = SDResamplerHorizontalScalar;
+            *vertical = SDResamplerVerticalScalarRow;
+            return true;
+    }
+}
+
+bool SDImageResamplerISAIsSupported(SDImageResamplerISA isa) {
+    switch (isa) {
+        case SDImageResamplerISAScalar:
+            return true;
+        case SDImageResamplerISASSE2:
+            return SD_RESAMPLER_X86;
+        case SDImageResamplerISAAVX2:
+#if SD_RESAMPLER_X86 && defined(__GNUC__)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case SDImageResamplerISANEON:
+            return SD_RESAMPLER_NEON;
+    }
+    return false;
+}
+
+SDImageResamplerISA SDImageResamplerGetBestISA(void) {
+    static const SDImageResamplerISA candidates[] = {SDImageResamplerISAAVX2, SDImageResamplerISASSE2, SDImageResamplerISANEON};
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (SDImageResamplerISAIsSupported(candidates[i])) {
+            return candidates[i];
+        }
+    }
+    return SDImageResamplerISAScalar;
+}
+
+const char *SDImageResamplerISAName(SDImageResamplerISA isa) {
+    switch (isa) {
+        case SDImageResamplerISAScalar:
+            return "Scalar";
+        case SDImageResamplerISASSE2:
+            return "SSE2";
+        case SDImageResamplerISAAVX2:
+            return "AVX2";
+        case SDImageResamplerISANEON:
+            return "NEON";
+    }
+    return "Unknown";
+}
+
+const char *SDImageResamplerKernelName(SDImageResamplerKernel kernel) {
+    switch (kernel) {
+        case SDImageResamplerKernelBox:
+            return "Box";
+        case SDImageResamplerKernelBilinear:
+            return "Bilinear";
+        case SDImageResamplerKernelLanczos3:
+            return "Lanczos3";
+    }
+    return "Unknown";
+}
+
+#pragma mark - Scale
+
+void SDImageResamplerGetSourceRows(size_t srcHeight, size_t dstHeight, size_t dstY, size_t dstRowCount, SDImageResamplerKernel kernel, size_t *outSrcY, size_t *outSrcRowCount) {
+    size_t srcY = 0, srcRowCount = 0;
+    SDResamplerCoefficients coeffs;
+    if (srcHeight > 0 && dstHeight > 0 && dstRowCount > 0 && SDResamplerCoefficientsCreate(&coeffs, srcHeight, dstHeight, dstY, dstRowCount, kernel)) {
+        // The starts are ascending
+        srcY = coeffs.starts[0];
+        srcRowCount = coeffs.starts[dstRowCount - 1] + coeffs.taps[dstRowCount - 1] - srcY;
+        SDResamplerCoefficientsFree(&coeffs);
+    }
+    if (outSrcY) {
+        *outSrcY = srcY;
+    }
+    if (outSrcRowCount) {
+        *outSrcRowCount = srcRowCount;
+    }
+}
+
+bool SDImageResamplerScaleRows(const SDImageResamplerBuffer *src, size_t srcY, size_t srcHeight, const SDImageResamplerBuffer *dst, size_t dstY, size_t dstHeight, SDImageResamplerKernel kernel, SDImageResamplerFormat format, SDImageResamplerISA isa) {
+    if (!src || !dst || !src->data || !dst->data || src->width == 0 || dst->width == 0 || dst->height == 0 || srcHeight == 0 || dstHeight == 0) {
+        return false;
+    }
+    if (src->rowBytes < src->width * 4 || dst->rowBytes < dst->width * 4 || dstY + dst->height > dstHeight) {
+        return false;
+    }
+    SDResamplerHorizontalFunction horizontal;
+    SDResamplerVerticalFunction vertical;
+    if (!SDResamplerGetFunctions(isa, &horizontal, &vertical)) {
+        return false;
+    }
+    SDResamplerCoefficients verticalCoeffs;
+    if (!SDResamplerCoefficientsCreate(&verticalCoeffs, srcHeight, dstHeight, dstY, dst->height, kernel)) {
+        return false;
+    }
+    // Check the source band contains all the rows needed
+    size_t minY = verticalCoeffs.starts[0];
+    size_t maxY = verticalCoeffs.starts[dst->height - 1] + verticalCoeffs.taps[dst->height - 1];
+    if (minY < srcY || maxY > srcY + src->height) {
+        SDResamplerCoefficientsFree(&verticalCoeffs);
+        return false;
+    }
+
+    // Horizontal pass into the intermediate rows, skip if the width is the same
+    const uint8_t *rows = (const uint8_t *)src->data + (minY - srcY) * src->rowBytes;
+    size_t rowBytes = src->rowBytes;
+    uint8_t *buffer = NULL;
+    if (src->width != dst->width) {
+        SDResamplerCoefficients horizontalCoeffs;
+        if (!SDResamplerCoefficientsCreate(&horizontalCoeffs, src->width, dst->width, 0, dst->width, kernel)) {
+            SDResamplerCoefficientsFree(&verticalCoeffs);
+            return false;
+        }
+        rowBytes = dst->width * 4;
+        buffer = malloc(rowBytes * (maxY - minY));
+        if (!buffer) {
+            SDResamplerCoefficientsFree(&horizontalCoeffs);
+            SDResamplerCoefficientsFree(&verticalCoeffs);
+            return false;
+        }
+        for (size_t y = 0; y < maxY - minY; y++) {
+            horizontal(rows + y * src->rowBytes, buffer + y * rowBytes, &horizontalCoeffs);
+        }
+        SDResamplerCoefficientsFree(&horizontalCoeffs);
+        rows = buffer;
+    }
+
+    // Vertical pass into the destination
+    size_t bytes = dst->width * 4;
+    for (size_t y = 0; y < dst->height; y++) {
+        const int16_t *weights = verticalCoeffs.weights + y * verticalCoeffs.maxTaps;
+        uint8_t *dstRow = (uint8_t *)dst->data + y * dst->rowBytes;
+        vertical(rows + (verticalCoeffs.starts[y] - minY) * rowBytes, rowBytes, dstRow, bytes, weights, verticalCoeffs.taps[y]);
+        // The negative lobes may overshoot, the premultiplied color should not exceed the alpha
+        if (kernel == SDImageResamplerKernelLanczos3 && format == SDImageResamplerFormatBGRA8) {
+            for (size_t x = 0; x < bytes; x += 4) {
+                uint8_t alpha = dstRow[x + 3];
+                if (dstRow[x] > alpha) dstRow[x] = alpha;
+                if (dstRow[x + 1] > alpha) dstRow[x + 1] = alpha;
+                if (dstRow[x + 2] > alpha) dstRow[x + 2] = alpha;
+            }
+        }
+    }
+    free(buffer);
+    SDResamplerCoefficientsFree(&verticalCoeffs);
+    return true;
+}
+
+bool SDImageResamplerScale(const SDImageResamplerBuffer *src, const SDImageResamplerBuffer *dst, SDImageResamplerKernel kernel, SDImageResamplerFormat format, SDImageResamplerISA isa) {
+    if (!src || !dst) {
+        return false;
+    }
+    return SDImageResamplerScaleRows(src, 0, src->height, dst, 0, dst->height, kernel, format, isa);
+}
+
+#pragma mark - Blur
+
+bool SDImageResamplerBlur(const SDImageResamplerBuffer *src, const SDImageResamplerBuffer *dst, double sigma, SDImageResamplerISA isa) {
+    if (!src || !dst || !src->data || !dst->data || src->width == 0 || src->height == 0 || src->width != dst->width || src->height != dst->height) {
+        return false;
+    }
+    if (src->rowBytes < src->width * 4 || dst->rowBytes < dst->width * 4) {
+        return false;
+    }
+    size_t width = src->width, height = src->height, bytes = width * 4;
+    if (!(sigma > 0)) {
+        if (src->data != dst->data) {
+            for (size_t y = 0; y < height; y++) {
+                memmove((uint8_t *)dst->data + y * dst->rowBytes, (const uint8_t *)src->data + y * src->rowBytes, bytes);
+            }
+        }
+        return true;
+    }
+    SDResamplerHorizontalFunction horizontal;
+    SDResamplerVerticalFunction vertical;
+    if (!SDResamplerGetFunctions(isa, &horizontal, &vertical)) {
+        return false;
+    }
+    SDResamplerCoefficients horizontalCoeffs, verticalCoeffs;
+    if (!SDResamplerCoefficientsCreateGaussian(&horizontalCoeffs, width, sigma)) {
+        return false;
+    }
+    if (!SDResamplerCoefficientsCreateGaussian(&verticalCoeffs, height, sigma)) {
+        SDResamplerCoefficientsFree(&horizontalCoeffs);
+        return false;
+    }
+    // The vertical pass only reads the intermediate rows, so the destination can be the source
+    uint8_t *buffer = malloc(bytes * height);
+    if (buffer) {
+        for (size_t y = 0; y < height; y++) {
+            horizontal((const uint8_t *)src->data + y * src->rowBytes, buffer + y * bytes, &horizontalCoeffs);
+        }
+        for (size_t y = 0; y < height; y++) {
+            const int16_t *weights = verticalCoeffs.weights + y * verticalCoeffs.maxTaps;
+            vertical(buffer + verticalCoeffs.starts[y] * bytes, bytes, (uint8_t *)dst->data + y * dst->rowBytes, bytes, weights, verticalCoeffs.taps[y]);
+        }
+        free(buffer);
+    }
+    SDResamplerCoefficientsFree(&horizontalCoeffs);
+    SDResamplerCoefficientsFree(&verticalCoeffs);
+    return buffer != NULL;
+}
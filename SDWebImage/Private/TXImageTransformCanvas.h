@@ -0,0 +1,65 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "TXWebImageCompat.h"
+#import "TXImageTransformer.h"
+#import "UIImage+Transform.h"
+
+/// Returns the rect to draw the content with size into the rect, using the scale mode. Used by resize transform.
+FOUNDATION_EXPORT CGRect SDCGRectFitWithScaleMode(CGRect rect, CGSize size, SDImageScaleMode scaleMode);
+/// Clip the current graphics context with the rounded rect. Used by round corner transform.
+FOUNDATION_EXPORT void SDGraphicsClipRoundedRect(CGRect rect, SDRectCorner corners, CGFloat cornerRadius);
+/// Stroke the rounded rect in current graphics context. Used by round corner transform.
+FOUNDATION_EXPORT void SDGraphicsStrokeRoundedRect(CGRect rect, SDRectCorner corners, CGFloat cornerRadius, CGFloat lineWidth, UIColor * _Nonnull strokeColor);
+
+@class TXImageTransformCanvas;
+
+/// The transformer which can be composed into a canvas, instead of rendering a new image. Used by `SDImagePipelineTransformer`.
+@protocol TXImageFusibleTransformer <TXImageTransformer>
+
+/// Apply the transform to the canvas.
+/// @return NO if it can not be fused with current canvas state, the canvas should not be changed, and the transformer will be applied to the rendered image instead.
+- (BOOL)fuseIntoCanvas:(nonnull TXImageTransformCanvas *)canvas;
+
+@end
+
+/// A canvas which records the geometric and mask transforms, then renders them in one pass into one output bitmap.
+/// Each transform maps the previous canvas into a new canvas coordinate, these transforms are composed into one affine transform per drawing, and the clips (including each intermediate canvas bounds) are replayed in the final context. So resize -> crop -> round corner -> border costs one bitmap, instead of one per stage.
+@interface TXImageTransformCanvas : NSObject
+
+/// The source image
+@property (nonatomic, strong, readonly, nonnull) UIImage *image;
+/// The current canvas size in points
+@property (nonatomic, assign, readonly) CGSize size;
+/// The output image scale, which is the same as source image
+@property (nonatomic, assign, readonly) CGFloat scale;
+/// Whether the current canvas content has up orientation. This is NO only when the source image is not up orientation and no transform applied yet, the pixel based crop can not be fused in this case.
+@property (nonatomic, assign, readonly) BOOL isOrientationUp;
+/// The count of transforms recorded
+@property (nonatomic, assign, readonly) NSUInteger operationCount;
+
+/// Create a canvas with the source image. Returns nil if the image is not bitmap based, like CIImage based image, which should be transformed sequentially.
+- (nullable instancetype)initWithImage:(nonnull UIImage *)image NS_DESIGNATED_INITIALIZER;
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/// Map the current canvas content into a new canvas.
+/// @param transform The transform from current canvas coordinate to the new canvas coordinate
+/// @param size The new canvas size, the content out of it is clipped
+- (void)applyTransform:(CGAffineTransform)transform size:(CGSize)size;
+
+/// Clip the current canvas content. The actions are called during rendering, with the context in current canvas coordinate.
+- (void)clipWithActions:(nonnull void (^)(CGContextRef _Nonnull context))actions;
+
+/// Draw over the current canvas content. The actions are called during rendering, with the context in current canvas coordinate. The drawing is clipped by the later transforms as well.
+- (void)drawWithActions:(nonnull void (^)(CGContextRef _Nonnull context))actions;
+
+/// Render all the transforms into a new image.
+- (nullable UIImage *)render;
+
+@end
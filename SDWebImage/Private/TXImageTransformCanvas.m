@@ -0,0 +1,251 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "TXImageTransformCanvas.h"
+#import "NSImage+Compatibility.h"
+#import "TXGraphicsImageRenderer.h"
+#import "NSBezierPath+SDRoundedCorners.h"
+
+CGRect SDCGRectFitWithScaleMode(CGRect rect, CGSize size, SDImageScaleMode scaleMode) {
+    rect = CGRectStandardize(rect);
+    size.width = size.width < 0 ? -size.width : size.width;
+    size.height = size.height < 0 ? -size.height : size.height;
+    CGPoint center = CGPointMake(CGRectGetMidX(rect), CGRectGetMidY(rect));
+    switch (scaleMode) {
+        case SDImageScaleModeAspectFit:
+        case SDImageScaleModeAspectFill: {
+            if (rect.size.width < 0.01 || rect.size.height < 0.01 ||
+                size.width < 0.01 || size.height < 0.01) {
+                rect.origin = center;
+                rect.size = CGSizeZero;
+            } else {
+                CGFloat scale;
+                if (scaleMode == SDImageScaleModeAspectFit) {
+                    if (size.width / size.height < rect.size.width / rect.size.height) {
+                        scale = rect.size.height / size.height;
+                    } else {
+                        scale = rect.size.width / size.width;
+                    }
+                } else {
+                    if (size.width / size.height < rect.size.width / rect.size.height) {
+                        scale = rect.size.width / size.width;
+                    } else {
+                        scale = rect.size.height / size.height;
+                    }
+                }
+                size.width *= scale;
+                size.height *= scale;
+                rect.size = size;
+                rect.origin = CGPointMake(center.x - size.width * 0.5, center.y - size.height * 0.5);
+            }
+        } break;
+        case SDImageScaleModeFill:
+        default: {
+            rect = rect;
+        }
+    }
+    return rect;
+}
+
+void SDGraphicsClipRoundedRect(CGRect rect, SDRectCorner corners, CGFloat cornerRadius) {
+#if SD_UIKIT || SD_WATCH
+    UIBezierPath *path = [UIBezierPath bezierPathWithRoundedRect:rect byRoundingCorners:corners cornerRadii:CGSizeMake(cornerRadius, cornerRadius)];
+#else
+    NSBezierPath *path = [NSBezierPath sd_bezierPathWithRoundedRect:rect byRoundingCorners:corners cornerRadius:cornerRadius];
+#endif
+    [path closePath];
+    [path addClip];
+}
+
+void SDGraphicsStrokeRoundedRect(CGRect rect, SDRectCorner corners, CGFloat cornerRadius, CGFloat lineWidth, UIColor *strokeColor) {
+#if SD_UIKIT || SD_WATCH
+    UIBezierPath *path = [UIBezierPath bezierPathWithRoundedRect:rect byRoundingCorners:corners cornerRadii:CGSizeMake(cornerRadius, cornerRadius)];
+#else
+    NSBezierPath *path = [NSBezierPath sd_bezierPathWithRoundedRect:rect byRoundingCorners:corners cornerRadius:cornerRadius];
+#endif
+    [path closePath];
+
+    path.lineWidth = lineWidth;
+    [strokeColor setStroke];
+    [path stroke];
+}
+
+// Set the CTM to `transform` in the `base` coordinate, the current CTM must be invertible
+static inline void SDContextSetTransform(CGContextRef context, CGAffineTransform base, CGAffineTransform transform) {
+    CGAffineTransform current = CGContextGetCTM(context);
+    CGAffineTransform target = CGAffineTransformConcat(transform, base);
+    CGContextConcatCTM(context, CGAffineTransformConcat(target, CGAffineTransformInvert(current)));
+}
+
+static inline BOOL SDAffineTransformIsInvertible(CGAffineTransform transform) {
+    return fabs(transform.a * transform.d - transform.b * transform.c) > __FLT_EPSILON__;
+}
+
+typedef NS_ENUM(NSUInteger, SDImageTransformCanvasCommandType) {
+    SDImageTransformCanvasCommandTypeDraw,
+    SDImageTransformCanvasCommandTypeClip,
+    SDImageTransformCanvasCommandTypeBounds, // The canvas bounds clip, which applies to the drawings on the same canvas as well
+};
+
+@interface TXImageTransformCanvasCommand : NSObject
+
+@property (nonatomic, assign) SDImageTransformCanvasCommandType type;
+@property (nonatomic, assign) NSUInteger step; // The canvas index which this command is recorded in
+@property (nonatomic, assign) CGSize size; // The canvas size, for bounds
+@property (nonatomic, copy) void (^actions)(CGContextRef context);
+
+@end
+
+@implementation TXImageTransformCanvasCommand
+@end
+
+@interface TXImageTransformCanvas ()
+
+@property (nonatomic, strong, readwrite, nonnull) UIImage *image;
+@property (nonatomic, assign, readwrite) CGSize size;
+@property (nonatomic, assign, readwrite) CGFloat scale;
+@property (nonatomic, assign, readwrite) BOOL isOrientationUp;
+@property (nonatomic, assign, readwrite) NSUInteger operationCount;
+@property (nonatomic, strong) NSMutableArray<TXImageTransformCanvasCommand *> *commands;
+@property (nonatomic, strong) NSMutableData *transforms; // `CGAffineTransform` array, the one at index `i` maps canvas `i` to canvas `i + 1`
+
+@end
+
+@implementation TXImageTransformCanvas
+
+- (instancetype)initWithImage:(UIImage *)image {
+    self = [super init];
+    if (self) {
+#if SD_UIKIT || SD_MAC
+        if (image.CIImage) {
+            return nil;
+        }
+#endif
+        if (!image.CGImage || image.size.width <= 0 || image.size.height <= 0) {
+            return nil;
+        }
+        _image = image;
+        _size = image.size;
+        _scale = image.scale;
+#if SD_UIKIT || SD_WATCH
+        _isOrientationUp = image.imageOrientation == UIImageOrientationUp;
+#else
+        _isOrientationUp = YES;
+#endif
+        _commands = [NSMutableArray array];
+        _transforms = [NSMutableData data];
+        // The source image, then its bounds
+        CGSize size = _size;
+        [self addCommandWithType:SDImageTransformCanvasCommandTypeDraw actions:^(CGContextRef  _Nonnull context) {
+            // Only resample once, use the high quality
+            CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+            [image drawInRect:CGRectMake(0, 0, size.width, size.height)];
+        }];
+        [self addCommandWithType:SDImageTransformCanvasCommandTypeBounds actions:nil];
+    }
+    return self;
+}
+
+- (NSUInteger)currentStep {
+    return self.transforms.length / sizeof(CGAffineTransform);
+}
+
+- (void)addCommandWithType:(SDImageTransformCanvasCommandType)type actions:(void (^)(CGContextRef context))actions {
+    TXImageTransformCanvasCommand *command = [TXImageTransformCanvasCommand new];
+    command.type = type;
+    command.step = self.currentStep;
+    command.size = self.size;
+    command.actions = actions;
+    [self.commands addObject:command];
+}
+
+#pragma mark - Record
+
+- (void)applyTransform:(CGAffineTransform)transform size:(CGSize)size {
+    [self.transforms appendBytes:&transform length:sizeof(CGAffineTransform)];
+    self.size = size;
+    self.isOrientationUp = YES;
+    self.operationCount++;
+    [self addCommandWithType:SDImageTransformCanvasCommandTypeBounds actions:nil];
+}
+
+- (void)clipWithActions:(void (^)(CGContextRef _Nonnull))actions {
+    if (!actions) {
+        return;
+    }
+    self.operationCount++;
+    [self addCommandWithType:SDImageTransformCanvasCommandTypeClip actions:actions];
+}
+
+- (void)drawWithActions:(void (^)(CGContextRef _Nonnull))actions {
+    if (!actions) {
+        return;
+    }
+    self.operationCount++;
+    [self addCommandWithType:SDImageTransformCanvasCommandTypeDraw actions:actions];
+}
+
+#pragma mark - Render
+
+- (UIImage *)render {
+    CGSize size = self.size;
+    if (size.width <= 0 || size.height <= 0) {
+        return nil;
+    }
+    // Compose the transforms from each canvas to the final one
+    NSUInteger stepCount = self.currentStep + 1;
+    const CGAffineTransform *transforms = self.transforms.bytes;
+    NSMutableData *finalTransformsData = [NSMutableData dataWithLength:stepCount * sizeof(CGAffineTransform)];
+    CGAffineTransform *finalTransforms = finalTransformsData.mutableBytes;
+    finalTransforms[stepCount - 1] = CGAffineTransformIdentity;
+    for (NSInteger step = stepCount - 2; step >= 0; step--) {
+        finalTransforms[step] = CGAffineTransformConcat(transforms[step], finalTransforms[step + 1]);
+    }
+    NSArray<TXImageTransformCanvasCommand *> *commands = [self.commands copy];
+
+    TXGraphicsImageRendererFormat *format = [[TXGraphicsImageRendererFormat alloc] init];
+    format.scale = self.scale;
+    TXGraphicsImageRenderer *renderer = [[TXGraphicsImageRenderer alloc] initWithSize:size format:format];
+    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+        CGAffineTransform base = CGContextGetCTM(context);
+        NSUInteger count = commands.count;
+        for (NSUInteger i = 0; i < count; i++) {
+            TXImageTransformCanvasCommand *drawing = commands[i];
+            if (drawing.type != SDImageTransformCanvasCommandTypeDraw) {
+                continue;
+            }
+            CGAffineTransform drawingTransform = finalTransforms[drawing.step];
+            if (!SDAffineTransformIsInvertible(drawingTransform)) {
+                // Collapsed to zero size, so are the clips after it
+                continue;
+            }
+            CGContextSaveGState(context);
+            // The drawing is clipped by the clips after it, and the bounds of the canvas it's drawn on
+            for (NSUInteger j = 0; j < count; j++) {
+                TXImageTransformCanvasCommand *clip = commands[j];
+                BOOL isBounds = clip.type == SDImageTransformCanvasCommandTypeBounds;
+                BOOL isClip = clip.type == SDImageTransformCanvasCommandTypeClip;
+                if (!((isClip && j > i) || (isBounds && clip.step >= drawing.step))) {
+                    continue;
+                }
+                SDContextSetTransform(context, base, finalTransforms[clip.step]);
+                if (isBounds) {
+                    CGContextClipToRect(context, CGRectMake(0, 0, clip.size.width, clip.size.height));
+                } else {
+                    clip.actions(context);
+                }
+            }
+            SDContextSetTransform(context, base, drawingTransform);
+            drawing.actions(context);
+            CGContextRestoreGState(context);
+        }
+    }];
+    return image;
+}
+
+@end
@@ -0,0 +1,55 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "TXWebImageCompat.h"
+
+/// The max palette entry count for indexed frame, which matches GIF/APNG palette limit.
+FOUNDATION_EXPORT const NSUInteger TXIndexedImageFrameMaxPaletteCount;
+
+/// Expand 8-bit color indices into 32-bit pixels through the palette lookup table. `count` is the pixel count, `palette` must contains 256 entries (fill the unused ones with 0).
+/// Use the byte table lookup (`vqtbl4q_u8`) on ARM64, the SIMD gather on the CPU supports AVX2 (detected at runtime), unrolled table lookup otherwise.
+FOUNDATION_EXPORT void TXIndexedImageFrameExpandPixels(const uint8_t * _Nonnull indices, const uint32_t * _Nonnull palette, uint32_t * _Nonnull pixels, size_t count);
+
+/// A thread-safe pool of the bitmap buffers for the expanded image. The buffer is returned to the pool when the expanded image's `CGImage` is released, so the next frame can reuse it instead of allocating a new one.
+@interface TXIndexedImageFrameBufferPool : NSObject
+
+/// Create the pool which keeps at most `maxCount` free buffers, the other ones are freed.
+- (nonnull instancetype)initWithMaxCount:(NSUInteger)maxCount;
+
+/// The count of the free buffers in the pool
+@property (nonatomic, assign, readonly) NSUInteger freeBufferCount;
+
+@end
+
+/// A frame stored as 8-bit color indices plus a BGRA8888 palette, instead of a full 32-bit bitmap.
+/// This is used for animated image frame buffer, palette based format (GIF/APNG) frames usually contains no more than 256 colors, which cost 1/4 memory compared to decoded bitmap.
+@interface TXIndexedImageFrame : NSObject
+
+/// Pixel width of frame
+@property (nonatomic, assign, readonly) size_t width;
+/// Pixel height of frame
+@property (nonatomic, assign, readonly) size_t height;
+/// The palette entry count, from 1 to 256
+@property (nonatomic, assign, readonly) NSUInteger paletteCount;
+/// The bytes used to store this frame, including the indices and palette
+@property (nonatomic, assign, readonly) NSUInteger bytesCount;
+
+/// Create an indexed frame from the image. Returns nil if the image contains more than 256 unique colors, or can not be rasterized.
+/// @note This is lossless, the expanded image's pixel is the same as the BGRA8888 bitmap of input image.
+/// @param image The frame image
++ (nullable instancetype)frameWithImage:(nonnull UIImage *)image;
+
+/// Expand the indices into a BGRA8888 bitmap image. The scale and orientation is the same as input image.
+- (nullable UIImage *)expandedImage;
+
+/// Expand the indices into a BGRA8888 bitmap image, the bitmap buffer is reused from the pool.
+/// @param bufferPool The buffer pool, pass nil to allocate a new buffer
+- (nullable UIImage *)expandedImageWithBufferPool:(nullable TXIndexedImageFrameBufferPool *)bufferPool;
+
+@end
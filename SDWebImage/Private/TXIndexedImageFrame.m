@@ -0,0 +1,364 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "TXIndexedImageFrame.h"
+#import "TXImageCoderHelper.h"
+#import "NSImage+Compatibility.h"
+#import "UIImage+Metadata.h"
+#import "UIImage+ForceDecode.h"
+#import "TXInternalMacros.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SD_INDEXED_FRAME_X86 1
+#import <immintrin.h>
+#else
+#define SD_INDEXED_FRAME_X86 0
+#endif
+
+// `vqtbl4q_u8` is only available on AArch64
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (defined(__aarch64__) || defined(__arm64__))
+#define SD_INDEXED_FRAME_NEON 1
+#import <arm_neon.h>
+#else
+#define SD_INDEXED_FRAME_NEON 0
+#endif
+
+const NSUInteger TXIndexedImageFrameMaxPaletteCount = 256;
+
+// Open addressing hash table size for palette building, keep it 4x larger than palette to reduce probe
+static const size_t kPaletteHashSize = 1024;
+
+static inline size_t SDPaletteHash(uint32_t color) {
+    // Knuth multiplicative hash
+    return (size_t)((color * 2654435761u) >> 22) & (kPaletteHashSize - 1);
+}
+
+static inline void SDIndexedImageFrameExpandPixelsScalar(const uint8_t *indices, const uint32_t *palette, uint32_t *pixels, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        pixels[i] = palette[indices[i]];
+        pixels[i + 1] = palette[indices[i + 1]];
+        pixels[i + 2] = palette[indices[i + 2]];
+        pixels[i + 3] = palette[indices[i + 3]];
+    }
+    for (; i < count; i++) {
+        pixels[i] = palette[indices[i]];
+    }
+}
+
+#if SD_INDEXED_FRAME_X86
+// Compiled for AVX2 regardless of the build flags, called only when the CPU supports it
+__attribute__((target("avx2")))
+static void SDIndexedImageFrameExpandPixelsAVX2(const uint8_t *indices, const uint32_t *palette, uint32_t *pixels, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indices + i)));
+        __m256i color = _mm256_i32gather_epi32((const int *)palette, index, 4);
+        _mm256_storeu_si256((__m256i *)(pixels + i), color);
+    }
+    SDIndexedImageFrameExpandPixelsScalar(indices + i, palette, pixels + i, count - i);
+}
+
+static BOOL SDIndexedImageFrameSupportsAVX2(void) {
+    static BOOL supportsAVX2;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+#if defined(__GNUC__)
+        __builtin_cpu_init();
+        supportsAVX2 = __builtin_cpu_supports("avx2") ? YES : NO;
+#endif
+    });
+    return supportsAVX2;
+}
+#endif
+
+#if SD_INDEXED_FRAME_NEON
+// NEON does not provide 32-bit gather. Split the palette into 4 byte planes, each plane is 4 tables of 64 entries, look up 16 pixels each time with the byte table lookup, and interleave the planes back into pixels
+static void SDIndexedImageFrameExpandPixelsNEON(const uint8_t *indices, const uint32_t *palette, uint32_t *pixels, size_t count) {
+    uint8_t planes[4][256];
+    for (size_t i = 0; i < 256; i += 16) {
+        uint8x16x4_t colors = vld4q_u8((const uint8_t *)(palette + i));
+        vst1q_u8(planes[0] + i, colors.val[0]);
+        vst1q_u8(planes[1] + i, colors.val[1]);
+        vst1q_u8(planes[2] + i, colors.val[2]);
+        vst1q_u8(planes[3] + i, colors.val[3]);
+    }
+    uint8x16x4_t tables[4][4];
+    for (size_t plane = 0; plane < 4; plane++) {
+        for (size_t table = 0; table < 4; table++) {
+            tables[plane][table] = vld1q_u8_x4(planes[plane] + table * 64);
+        }
+    }
+    const uint8x16_t offset = vdupq_n_u8(64);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // The index out of [0, 64) returns 0 for `vqtbl4q_u8` and keeps the value for `vqtbx4q_u8`, the subtraction wraps around for the lower index
+        uint8x16_t index0 = vld1q_u8(indices + i);
+        uint8x16_t index1 = vsubq_u8(index0, offset);
+        uint8x16_t index2 = vsubq_u8(index1, offset);
+        uint8x16_t index3 = vsubq_u8(index2, offset);
+        uint8x16x4_t result;
+        for (size_t plane = 0; plane < 4; plane++) {
+            uint8x16_t value = vqtbl4q_u8(tables[plane][0], index0);
+            value = vqtbx4q_u8(value, tables[plane][1], index1);
+            value = vqtbx4q_u8(value, tables[plane][2], index2);
+            value = vqtbx4q_u8(value, tables[plane][3], index3);
+            result.val[plane] = value;
+        }
+        vst4q_u8((uint8_t *)(pixels + i), result);
+    }
+    SDIndexedImageFrameExpandPixelsScalar(indices + i, palette, pixels + i, count - i);
+}
+#endif
+
+void TXIndexedImageFrameExpandPixels(const uint8_t *indices, const uint32_t *palette, uint32_t *pixels, size_t count) {
+#if SD_INDEXED_FRAME_NEON
+    SDIndexedImageFrameExpandPixelsNEON(indices, palette, pixels, count);
+#else
+#if SD_INDEXED_FRAME_X86
+    if (SDIndexedImageFrameSupportsAVX2()) {
+        SDIndexedImageFrameExpandPixelsAVX2(indices, palette, pixels, count);
+        return;
+    }
+#endif
+    SDIndexedImageFrameExpandPixelsScalar(indices, palette, pixels, count);
+#endif
+}
+
+#pragma mark - Buffer Pool
+
+@interface TXIndexedImageFrameBufferPool () {
+    SD_LOCK_DECLARE(_lock);
+    void **_buffers;
+    size_t *_lengths;
+    NSUInteger _count;
+    NSUInteger _maxCount;
+}
+
+- (nullable void *)dequeueBufferWithLength:(size_t)length;
+- (void)enqueueBuffer:(nonnull void *)buffer length:(size_t)length;
+
+@end
+
+@implementation TXIndexedImageFrameBufferPool
+
+- (instancetype)init {
+    return [self initWithMaxCount:3];
+}
+
+- (instancetype)initWithMaxCount:(NSUInteger)maxCount {
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_lock);
+        _maxCount = maxCount;
+        _buffers = calloc(MAX(maxCount, 1), sizeof(void *));
+        _lengths = calloc(MAX(maxCount, 1), sizeof(size_t));
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _count; i++) {
+        free(_buffers[i]);
+    }
+    free(_buffers);
+    free(_lengths);
+}
+
+- (NSUInteger)freeBufferCount {
+    SD_LOCK(_lock);
+    NSUInteger count = _count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (void *)dequeueBufferWithLength:(size_t)length {
+    void *buffer = NULL;
+    SD_LOCK(_lock);
+    for (NSUInteger i = 0; i < _count; i++) {
+        if (_lengths[i] == length) {
+            buffer = _buffers[i];
+            // Move the last one to fill the hole
+            _count--;
+            _buffers[i] = _buffers[_count];
+            _lengths[i] = _lengths[_count];
+            break;
+        }
+    }
+    SD_UNLOCK(_lock);
+    if (!buffer) {
+        buffer = malloc(length);
+    }
+    return buffer;
+}
+
+- (void)enqueueBuffer:(void *)buffer length:(size_t)length {
+    SD_LOCK(_lock);
+    if (_count < _maxCount) {
+        _buffers[_count] = buffer;
+        _lengths[_count] = length;
+        _count++;
+        buffer = NULL;
+    }
+    SD_UNLOCK(_lock);
+    // The pool is full, or the frame size changed
+    free(buffer);
+}
+
+@end
+
+static void SDIndexedImageFrameReleaseData(void *info, const void *data, size_t size) {
+    if (info) {
+        // Give back to the pool
+        TXIndexedImageFrameBufferPool *bufferPool = (__bridge_transfer TXIndexedImageFrameBufferPool *)info;
+        [bufferPool enqueueBuffer:(void *)data length:size];
+    } else {
+        free((void *)data);
+    }
+}
+
+@interface TXIndexedImageFrame () {
+    uint32_t _palette[256];
+}
+
+@property (nonatomic, assign, readwrite) size_t width;
+@property (nonatomic, assign, readwrite) size_t height;
+@property (nonatomic, assign, readwrite) NSUInteger paletteCount;
+@property (nonatomic, strong) NSData *indices;
+@property (nonatomic, assign) CGFloat scale;
+#if SD_UIKIT || SD_WATCH
+@property (nonatomic, assign) UIImageOrientation orientation;
+#endif
+@property (nonatomic, assign) SDImageFormat imageFormat;
+
+@end
+
+@implementation TXIndexedImageFrame
+
++ (instancetype)frameWithImage:(UIImage *)image {
+    CGImageRef cgImage = image.CGImage;
+    if (!cgImage) {
+        return nil;
+    }
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    if (width == 0 || height == 0) {
+        return nil;
+    }
+    size_t pixelCount = width * height;
+    // Rasterize into BGRA8888, the same pixel format we use to expand
+    uint32_t *pixels = malloc(pixelCount * sizeof(uint32_t));
+    if (!pixels) {
+        return nil;
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst;
+    CGContextRef context = CGBitmapContextCreate(pixels, width, height, 8, width * sizeof(uint32_t), [TXImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        free(pixels);
+        return nil;
+    }
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage);
+    CGContextRelease(context);
+
+    uint8_t *indices = malloc(pixelCount);
+    if (!indices) {
+        free(pixels);
+        return nil;
+    }
+    TXIndexedImageFrame *frame = [[TXIndexedImageFrame alloc] init];
+    // Slot value is palette index + 1, 0 means empty
+    uint16_t slots[kPaletteHashSize] = {0};
+    uint32_t *palette = frame->_palette;
+    NSUInteger paletteCount = 0;
+    // Palette frames usually contains long runs of the same color, skip the hash lookup for them
+    uint32_t lastColor = 0;
+    uint8_t lastIndex = 0;
+    BOOL hasLast = NO;
+    for (size_t i = 0; i < pixelCount; i++) {
+        uint32_t color = pixels[i];
+        if (hasLast && color == lastColor) {
+            indices[i] = lastIndex;
+            continue;
+        }
+        size_t slot = SDPaletteHash(color);
+        while (slots[slot] != 0 && palette[slots[slot] - 1] != color) {
+            slot = (slot + 1) & (kPaletteHashSize - 1);
+        }
+        if (slots[slot] == 0) {
+            if (paletteCount == TXIndexedImageFrameMaxPaletteCount) {
+                // Too many colors, not a palette frame
+                free(pixels);
+                free(indices);
+                return nil;
+            }
+            palette[paletteCount] = color;
+            paletteCount++;
+            slots[slot] = (uint16_t)paletteCount;
+        }
+        lastColor = color;
+        lastIndex = (uint8_t)(slots[slot] - 1);
+        hasLast = YES;
+        indices[i] = lastIndex;
+    }
+    free(pixels);
+
+    frame.width = width;
+    frame.height = height;
+    frame.paletteCount = paletteCount;
+    frame.indices = [NSData dataWithBytesNoCopy:indices length:pixelCount freeWhenDone:YES];
+    frame.scale = image.scale;
+#if SD_UIKIT || SD_WATCH
+    frame.orientation = image.imageOrientation;
+#endif
+    frame.imageFormat = image.sd_imageFormat;
+    return frame;
+}
+
+- (NSUInteger)bytesCount {
+    return self.indices.length + self.paletteCount * sizeof(uint32_t);
+}
+
+- (UIImage *)expandedImage {
+    return [self expandedImageWithBufferPool:nil];
+}
+
+- (UIImage *)expandedImageWithBufferPool:(TXIndexedImageFrameBufferPool *)bufferPool {
+    size_t pixelCount = self.width * self.height;
+    size_t length = pixelCount * sizeof(uint32_t);
+    uint32_t *pixels = bufferPool ? [bufferPool dequeueBufferWithLength:length] : malloc(length);
+    if (!pixels) {
+        return nil;
+    }
+    TXIndexedImageFrameExpandPixels(self.indices.bytes, _palette, pixels, pixelCount);
+
+    // The pool is retained by the provider until the buffer is given back
+    void *info = bufferPool ? (__bridge_retained void *)bufferPool : NULL;
+    CGDataProviderRef provider = CGDataProviderCreateWithData(info, pixels, length, SDIndexedImageFrameReleaseData);
+    if (!provider) {
+        SDIndexedImageFrameReleaseData(info, pixels, length);
+        return nil;
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst;
+    CGImageRef imageRef = CGImageCreate(self.width, self.height, 8, 32, self.width * sizeof(uint32_t), [TXImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    if (!imageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:self.scale orientation:self.orientation];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:self.scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(imageRef);
+    image.sd_imageFormat = self.imageFormat;
+    image.sd_isDecoded = YES;
+    return image;
+}
+
+@end
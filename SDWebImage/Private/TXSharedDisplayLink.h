@@ -0,0 +1,50 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "TXWebImageCompat.h"
+
+/// The target driven by shared display link. All the methods are called on main thread.
+@protocol TXSharedDisplayLinkTarget <NSObject>
+
+/// Called when the target is due.
+/// @param duration The time from the previous refresh of this target to the upcoming display refresh. For the first refresh, this is the display refresh interval.
+/// @return The time interval after the upcoming display refresh, until the target needs the next refresh. `0` means the next display refresh. Negative value means the target does not need refresh anymore, and it will be removed.
+- (NSTimeInterval)sharedDisplayLinkDidRefreshWithDuration:(NSTimeInterval)duration;
+
+@optional
+/// Whether the target is visible. The invisible target is skipped (its time does not elapse), and checked again with a low rate.
+- (BOOL)isVisibleForSharedDisplayLink;
+
+@end
+
+/// A display link shared by all the targets using the same runloop mode, so N animated image players cost one display link callback per display refresh, instead of N.
+/// Each target reports when it needs the next refresh, the display link only calls the targets which are due, and stops itself (then wakes up by a one-shot timer) when the earliest due time is far away.
+/// @note The targets are weakly referenced. All the methods should be called on main thread, or they will be dispatched to main queue.
+@interface TXSharedDisplayLink : NSObject
+
+/// The runloop mode which the display link runs with
+@property (nonatomic, copy, readonly, nonnull) NSRunLoopMode runLoopMode;
+/// The count of targets currently added
+@property (nonatomic, assign, readonly) NSUInteger targetCount;
+/// The count of refresh ticks received on main thread. The wake up timer only restarts the display link, so each wakeup is counted once by the tick. This is used for performance monitoring.
+@property (nonatomic, assign, readonly) NSUInteger wakeupCount;
+/// The count of target refreshes. This is used for performance monitoring.
+@property (nonatomic, assign, readonly) NSUInteger refreshCount;
+
+/// Returns the shared display link for the runloop mode.
++ (nonnull instancetype)sharedDisplayLinkForRunLoopMode:(nonnull NSRunLoopMode)runLoopMode;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
+
+/// Add the target, which will be refreshed at the next display refresh. Adding a target which already exists does nothing.
+- (void)addTarget:(nonnull id<TXSharedDisplayLinkTarget>)target;
+/// Remove the target. The display link stops when there is no target.
+- (void)removeTarget:(nonnull id<TXSharedDisplayLinkTarget>)target;
+
+@end
@@ -0,0 +1,270 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "TXSharedDisplayLink.h"
+#import "TXDisplayLink.h"
+#import "TXWeakProxy.h"
+#import "TXInternalMacros.h"
+
+// The time interval to check again whether the invisible target becomes visible
+static const NSTimeInterval kSDSharedDisplayLinkInvisibleInterval = 0.2;
+// Stop the display link when the earliest due time is more than this count of refresh intervals away
+static const NSUInteger kSDSharedDisplayLinkSleepFrameCount = 3;
+// The due time tolerance by refresh interval, the timestamp from callback is not exactly aligned to display refresh
+static const double kSDSharedDisplayLinkDueTolerance = 0.25;
+// Used when the display link does not provide the refresh interval
+static const NSTimeInterval kSDSharedDisplayLinkDefaultInterval = 1.0 / 60;
+
+SD_LOCK_DECLARE_STATIC(_sharedDisplayLinksLock);
+
+@interface TXSharedDisplayLinkEntry : NSObject
+
+@property (nonatomic, weak) id<TXSharedDisplayLinkTarget> target;
+@property (nonatomic, assign) NSTimeInterval lastTimestamp; // The display timestamp of previous refresh, 0 means not refreshed yet
+@property (nonatomic, assign) NSTimeInterval dueTimestamp; // The display timestamp when the target needs the next refresh
+@property (nonatomic, assign) BOOL removed;
+
+@end
+
+@implementation TXSharedDisplayLinkEntry
+@end
+
+@interface TXSharedDisplayLink ()
+
+@property (nonatomic, copy, readwrite) NSRunLoopMode runLoopMode;
+@property (nonatomic, assign, readwrite) NSUInteger wakeupCount;
+@property (nonatomic, assign, readwrite) NSUInteger refreshCount;
+@property (nonatomic, strong) NSMutableArray<TXSharedDisplayLinkEntry *> *entries;
+@property (nonatomic, strong) TXDisplayLink *displayLink;
+@property (nonatomic, strong) NSTimer *wakeupTimer;
+@property (nonatomic, assign) BOOL isRefreshing;
+
+@end
+
+@implementation TXSharedDisplayLink
+
++ (instancetype)sharedDisplayLinkForRunLoopMode:(NSRunLoopMode)runLoopMode {
+    static NSMutableDictionary<NSRunLoopMode, TXSharedDisplayLink *> *sharedDisplayLinks;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        SD_LOCK_INIT(_sharedDisplayLinksLock);
+        sharedDisplayLinks = [NSMutableDictionary dictionary];
+    });
+    SD_LOCK(_sharedDisplayLinksLock);
+    TXSharedDisplayLink *displayLink = sharedDisplayLinks[runLoopMode];
+    if (!displayLink) {
+        displayLink = [[TXSharedDisplayLink alloc] initWithRunLoopMode:runLoopMode];
+        sharedDisplayLinks[runLoopMode] = displayLink;
+    }
+    SD_UNLOCK(_sharedDisplayLinksLock);
+    return displayLink;
+}
+
+- (instancetype)initWithRunLoopMode:(NSRunLoopMode)runLoopMode {
+    self = [super init];
+    if (self) {
+        _runLoopMode = [runLoopMode copy];
+        _entries = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (TXDisplayLink *)displayLink {
+    if (!_displayLink) {
+        _displayLink = [TXDisplayLink displayLinkWithTarget:self selector:@selector(displayLinkDidRefresh:)];
+        [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:self.runLoopMode];
+        [_displayLink stop];
+    }
+    return _displayLink;
+}
+
+- (NSUInteger)targetCount {
+    NSUInteger count = 0;
+    for (TXSharedDisplayLinkEntry *entry in self.entries) {
+        if (!entry.removed && entry.target) {
+            count++;
+        }
+    }
+    return count;
+}
+
+#pragma mark - Target
+
+- (TXSharedDisplayLinkEntry *)entryForTarget:(id<TXSharedDisplayLinkTarget>)target {
+    for (TXSharedDisplayLinkEntry *entry in self.entries) {
+        if (entry.target == target) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+- (void)addTarget:(id<TXSharedDisplayLinkTarget>)target {
+    if (!target) {
+        return;
+    }
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self addTarget:target];
+        });
+        return;
+    }
+    TXSharedDisplayLinkEntry *entry = [self entryForTarget:target];
+    if (entry && !entry.removed) {
+        return;
+    }
+    if (!entry) {
+        entry = [TXSharedDisplayLinkEntry new];
+        entry.target = target;
+        [self.entries addObject:entry];
+    }
+    entry.removed = NO;
+    entry.lastTimestamp = 0;
+    entry.dueTimestamp = 0;
+    if (!self.isRefreshing) {
+        // Otherwise it will be scheduled at the end of current refresh
+        [self resume];
+    }
+}
+
+- (void)removeTarget:(id<TXSharedDisplayLinkTarget>)target {
+    if (!target) {
+        return;
+    }
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self removeTarget:target];
+        });
+        return;
+    }
+    TXSharedDisplayLinkEntry *entry = [self entryForTarget:target];
+    if (!entry) {
+        return;
+    }
+    if (self.isRefreshing) {
+        // Can not mutate the entries during refresh, purged at the end of current refresh
+        entry.removed = YES;
+        return;
+    }
+    [self.entries removeObject:entry];
+    if (self.entries.count == 0) {
+        [self suspend];
+    }
+}
+
+#pragma mark - Refresh
+
+- (void)resume {
+    [self.wakeupTimer invalidate];
+    self.wakeupTimer = nil;
+    if (!self.displayLink.isRunning) {
+        [self.displayLink start];
+    }
+}
+
+- (void)suspend {
+    [self.wakeupTimer invalidate];
+    self.wakeupTimer = nil;
+    [_displayLink stop];
+}
+
+- (void)wakeupTimerDidFire:(NSTimer *)timer {
+    // Not counted as a wakeup, the display link tick it starts is
+    self.wakeupTimer = nil;
+    // Let the display link do the refresh, which is aligned to display refresh
+    [self.displayLink start];
+}
+
+- (void)displayLinkDidRefresh:(TXDisplayLink *)displayLink {
+    NSTimeInterval interval = displayLink.duration;
+    if (interval <= 0) {
+        interval = kSDSharedDisplayLinkDefaultInterval;
+    }
+    [self refreshWithInterval:interval];
+}
+
+// This is the per-tick path, only the due targets are called
+- (void)refreshWithInterval:(NSTimeInterval)interval {
+    self.wakeupCount++;
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    // The timestamp when this refresh will be displayed
+    NSTimeInterval timestamp = now + interval;
+    NSTimeInterval tolerance = interval * kSDSharedDisplayLinkDueTolerance;
+
+    self.isRefreshing = YES;
+    // The target may add or remove targets during refresh, the added ones are refreshed at the next tick
+    NSUInteger count = self.entries.count;
+    for (NSUInteger i = 0; i < count; i++) {
+        TXSharedDisplayLinkEntry *entry = self.entries[i];
+        if (entry.removed || entry.dueTimestamp > timestamp + tolerance) {
+            continue;
+        }
+        id<TXSharedDisplayLinkTarget> target = entry.target;
+        if (!target) {
+            entry.removed = YES;
+            continue;
+        }
+        if ([target respondsToSelector:@selector(isVisibleForSharedDisplayLink)] && ![target isVisibleForSharedDisplayLink]) {
+            // Skip the invisible target, and its time does not elapse
+            entry.lastTimestamp = 0;
+            entry.dueTimestamp = timestamp + kSDSharedDisplayLinkInvisibleInterval;
+            continue;
+        }
+        // Treat the due time as reached when it's within tolerance, so the target does not wait one more refresh
+        NSTimeInterval refreshTimestamp = MAX(timestamp, entry.dueTimestamp);
+        NSTimeInterval duration = entry.lastTimestamp > 0 ? refreshTimestamp - entry.lastTimestamp : interval;
+        entry.lastTimestamp = refreshTimestamp;
+        self.refreshCount++;
+        NSTimeInterval delay = [target sharedDisplayLinkDidRefreshWithDuration:duration];
+        if (entry.removed) {
+            // Removed during callback
+            continue;
+        }
+        if (delay < 0) {
+            entry.removed = YES;
+            continue;
+        }
+        entry.dueTimestamp = refreshTimestamp + delay;
+    }
+    self.isRefreshing = NO;
+
+    // Purge the removed targets, and find the earliest due time
+    NSTimeInterval earliestDueTimestamp = DBL_MAX;
+    for (NSInteger i = self.entries.count - 1; i >= 0; i--) {
+        TXSharedDisplayLinkEntry *entry = self.entries[i];
+        if (entry.removed || !entry.target) {
+            [self.entries removeObjectAtIndex:i];
+            continue;
+        }
+        earliestDueTimestamp = MIN(earliestDueTimestamp, entry.dueTimestamp);
+    }
+
+    if (self.entries.count == 0) {
+        [self suspend];
+        return;
+    }
+    NSTimeInterval sleepInterval = earliestDueTimestamp - timestamp;
+    if (sleepInterval <= interval * kSDSharedDisplayLinkSleepFrameCount) {
+        // Keep the display link running
+        if (!self.displayLink.isRunning) {
+            [self.displayLink start];
+        }
+        return;
+    }
+    // Stop the display link, and wake up two refreshes before the earliest due time
+    [self suspend];
+    NSTimeInterval wakeupInterval = earliestDueTimestamp - now - interval * 2;
+    TXWeakProxy *weakProxy = [TXWeakProxy proxyWithTarget:self];
+    NSTimer *wakeupTimer = [NSTimer timerWithTimeInterval:wakeupInterval target:weakProxy selector:@selector(wakeupTimerDidFire:) userInfo:nil repeats:NO];
+    // Allow the system to coalesce the wakeups
+    wakeupTimer.tolerance = interval;
+    [[NSRunLoop mainRunLoop] addTimer:wakeupTimer forMode:self.runLoopMode];
+    self.wakeupTimer = wakeupTimer;
+}
+
+@end
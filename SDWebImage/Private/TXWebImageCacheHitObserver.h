@@ -0,0 +1,28 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "TXWebImageManager.h"
+
+/// Exclude the load from the cache hit observers, like the prefetcher's own loads. It does not prevent the coalescing with other loads. (NSNumber of BOOL)
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextIgnoresCacheHitObservers;
+
+/// The observer of the image loads finished with the image from the image cache (memory or disk)
+@protocol TXWebImageCacheHitObserver <NSObject>
+
+/// Called synchronously on the thread which finishes the load, before the completion block is dispatched, so keep it fast
+- (void)imageManager:(nonnull TXWebImageManager *)imageManager didHitCacheWithURL:(nonnull NSURL *)url cacheType:(TXImageCacheType)cacheType;
+
+@end
+
+@interface TXWebImageManager (CacheHitObserver)
+
+/// Add the observer for the loads of all the managers, it's weakly referenced. When there is no observer, a load only checks the observer count.
++ (void)addCacheHitObserver:(nonnull id<TXWebImageCacheHitObserver>)observer;
++ (void)removeCacheHitObserver:(nonnull id<TXWebImageCacheHitObserver>)observer;
+
+@end
@@ -9,6 +9,11 @@
 
 #import "SDTestCase.h"
 #import "TXInternalMacros.h"
+#import "TXIndexedImageFrame.h"
+#import "TXAnimatedFrameRingBuffer.h"
+#import "TXSharedDisplayLink.h"
+#import "TXAnimatedFrameBudgetManager.h"
+#import "TXAnimatedFrameDecodePool.h"
 #import <KVOController/KVOController.h>
 #import <SDWebImageWebPCoder/SDWebImageWebPCoder.h>
 
@@ -49,6 +54,23 @@ static BOOL _isCalled;
 
 @end
 
+// Fake frame budget client
+@interface SDAnimatedFrameBudgetTestClient : NSObject <TXAnimatedFrameBudgetClient>
+
+@property (nonatomic, assign) NSUInteger bytesPerFrame;
+@property (nonatomic, assign) NSUInteger totalFrameCount;
+@property (nonatomic, assign) double framesPerSecond;
+@property (nonatomic, assign) BOOL isFrameBudgetActive;
+@property (nonatomic, assign) NSUInteger maxBufferSize;
+
+@end
+
+@implementation SDAnimatedFrameBudgetTestClient
+
+- (void)frameBudgetDidChange {}
+
+@end
+
 // Internal header
 @interface TXAnimatedImageView ()
 
@@ -59,7 +81,10 @@ static BOOL _isCalled;
 
 @interface TXAnimatedImagePlayer ()
 
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, UIImage *> *frameBuffer;
+@property (nonatomic, strong) TXAnimatedFrameRingBuffer *frameBuffer;
+@property (nonatomic, assign) NSUInteger maxBufferCount;
+
+- (void)renderFrameWithDuration:(NSTimeInterval)duration;
 
 @end
 
@@ -791,6 +816,310 @@ static BOOL _isCalled;
     }
 }
 
+- (void)test37AnimatedImageIndexedFrame {
+    TXAnimatedImage *image = [TXAnimatedImage imageWithData:[self testGIFData]];
+    UIImage *frame = [image animatedImageFrameAtIndex:1];
+    TXIndexedImageFrame *indexedFrame = [TXIndexedImageFrame frameWithImage:frame];
+    expect(indexedFrame).notTo.beNil();
+    expect(indexedFrame.paletteCount).beLessThanOrEqualTo(TXIndexedImageFrameMaxPaletteCount);
+    NSUInteger bitmapBytes = CGImageGetWidth(frame.CGImage) * CGImageGetHeight(frame.CGImage) * 4;
+    expect(indexedFrame.bytesCount).beLessThan(bitmapBytes / 2);
+    
+    UIImage *expandedImage = [indexedFrame expandedImage];
+    expect(CGImageGetWidth(expandedImage.CGImage)).equal(CGImageGetWidth(frame.CGImage));
+    expect(CGImageGetHeight(expandedImage.CGImage)).equal(CGImageGetHeight(frame.CGImage));
+    expect(expandedImage.scale).equal(frame.scale);
+    // Expand is lossless, index again should produce the same palette
+    TXIndexedImageFrame *reindexedFrame = [TXIndexedImageFrame frameWithImage:expandedImage];
+    expect(reindexedFrame.paletteCount).equal(indexedFrame.paletteCount);
+    
+    // The buffer is given back to the pool when the image is released, and reused by the next expand
+    TXIndexedImageFrameBufferPool *bufferPool = [[TXIndexedImageFrameBufferPool alloc] initWithMaxCount:1];
+    @autoreleasepool {
+        UIImage *pooledImage = [indexedFrame expandedImageWithBufferPool:bufferPool];
+        CFDataRef pooledData = CGDataProviderCopyData(CGImageGetDataProvider(pooledImage.CGImage));
+        CFDataRef expandedData = CGDataProviderCopyData(CGImageGetDataProvider(expandedImage.CGImage));
+        expect([(__bridge NSData *)pooledData isEqualToData:(__bridge NSData *)expandedData]).beTruthy();
+        CFRelease(pooledData);
+        CFRelease(expandedData);
+        expect(bufferPool.freeBufferCount).equal(0);
+    }
+    expect(bufferPool.freeBufferCount).equal(1);
+    @autoreleasepool {
+        UIImage *pooledImage = [indexedFrame expandedImageWithBufferPool:bufferPool];
+        expect(pooledImage).notTo.beNil();
+        expect(bufferPool.freeBufferCount).equal(0);
+    }
+    
+    // JPEG photo contains more than 256 colors
+    UIImage *photo = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    expect([TXIndexedImageFrame frameWithImage:photo]).beNil();
+}
+
+- (void)test38AnimatedImageViewIndexedFrameBuffer {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test TXAnimatedImageView indexed frame buffer"];
+    
+    TXAnimatedImageView *imageView = [TXAnimatedImageView new];
+    imageView.shouldUseIndexedFrameBuffer = YES;
+    
+#if SD_UIKIT
+    [self.window addSubview:imageView];
+#else
+    [self.window.contentView addSubview:imageView];
+#endif
+    TXAnimatedImage *image = [TXAnimatedImage imageWithData:[self testGIFData]];
+    imageView.image = image;
+    expect(imageView.player.shouldUseIndexedFrameBuffer).beTruthy();
+    NSUInteger bitmapBytes = CGImageGetBytesPerRow(image.CGImage) * CGImageGetHeight(image.CGImage);
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        expect(imageView.currentFrameIndex).beGreaterThan(0);
+        expect(imageView.currentFrame).notTo.beNil();
+        expect(imageView.player.bytesPerFrame).beLessThan(bitmapBytes);
+        __block BOOL hasIndexedFrame = NO;
+        [imageView.player.frameBuffer enumerateFramesUsingBlock:^(NSUInteger index, id  _Nonnull frame) {
+            if ([frame isKindOfClass:[TXIndexedImageFrame class]]) {
+                hasIndexedFrame = YES;
+            }
+        }];
+        expect(hasIndexedFrame).beTruthy();
+        
+        [imageView removeFromSuperview];
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test39AnimatedFrameRingBuffer {
+    TXAnimatedFrameRingBuffer *frameBuffer = [[TXAnimatedFrameRingBuffer alloc] initWithCapacity:2];
+    expect(frameBuffer.capacity).equal(2);
+    expect(frameBuffer.count).equal(0);
+    UIImage *frame0 = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    UIImage *frame2 = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    
+    // Producer can only fulfill the reserved slot
+    expect([frameBuffer fulfillFrame:frame0 atIndex:0]).beFalsy();
+    expect([frameBuffer reserveFrameAtIndex:0]).beTruthy();
+    expect([frameBuffer reserveFrameAtIndex:0]).beFalsy(); // pending
+    expect([frameBuffer fulfillFrame:frame0 atIndex:0]).beTruthy();
+    expect([frameBuffer reserveFrameAtIndex:0]).beFalsy(); // stored
+    expect([frameBuffer frameAtIndex:0]).equal(frame0);
+    expect(frameBuffer.count).equal(1);
+    
+    // Frame 2 use the same slot as frame 0, reserve evict the stale one
+    expect([frameBuffer reserveFrameAtIndex:2]).beTruthy();
+    expect([frameBuffer frameAtIndex:0]).beNil();
+    expect(frameBuffer.count).equal(0);
+    // Cancelled reservation can not be fulfilled
+    [frameBuffer cancelPendingFrames];
+    expect([frameBuffer fulfillFrame:frame2 atIndex:2]).beFalsy();
+    // Nil frame release the reservation
+    expect([frameBuffer reserveFrameAtIndex:2]).beTruthy();
+    expect([frameBuffer fulfillFrame:nil atIndex:2]).beFalsy();
+    expect([frameBuffer reserveFrameAtIndex:2]).beTruthy();
+    expect([frameBuffer fulfillFrame:frame2 atIndex:2]).beTruthy();
+    
+    [frameBuffer setFrame:frame0 atIndex:1];
+    expect(frameBuffer.count).equal(2);
+    [frameBuffer removeAllFramesExceptIndex:1];
+    expect(frameBuffer.count).equal(1);
+    expect([frameBuffer frameAtIndex:1]).equal(frame0);
+    [frameBuffer removeAllFrames];
+    expect(frameBuffer.count).equal(0);
+}
+
+- (void)test40AnimatedImagePlayerRenderBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    TXAnimatedImage *image = [TXAnimatedImage imageWithData:[self testAPNGPData]];
+    TXAnimatedImagePlayer *player = [TXAnimatedImagePlayer playerWithProvider:image];
+    player.maxBufferSize = NSUIntegerMax;
+    [player startPlaying];
+    // Warm up, fill the frame buffer
+    for (NSUInteger i = 0; i < player.totalFrameCount * 4; i++) {
+        [player renderFrameWithDuration:1.0 / 120];
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    // Simulate 10 seconds ticks at 120Hz, each operation is one tick
+    NSDictionary *parameters = @{@"frames" : @(player.totalFrameCount), @"tickHz" : @120};
+    [self benchmarkScenario:@"animatedPlayer.render" parameters:parameters iterations:1200 threads:1 block:^(NSUInteger index) {
+        [player renderFrameWithDuration:1.0 / 120];
+    }];
+    [player stopPlaying];
+}
+
+- (void)test41AnimatedImagePlayerPrefetchFrames {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test TXAnimatedImagePlayer prefetch frames in reverse mode"];
+    
+    TXAnimatedImage *image = [TXAnimatedImage imageWithData:[self testAPNGPData]];
+    expect(image.animatedImageFrameThreadSafe).beTruthy();
+    TXAnimatedImagePlayer *player = [TXAnimatedImagePlayer playerWithProvider:image];
+    player.prefetchFrameCount = 3;
+    player.playbackMode = TXAnimatedImagePlaybackModeReverse;
+    [player startPlaying];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        // The displayed frames, plus the upcoming frames in lookahead window
+        expect(player.frameBuffer.count).beGreaterThan(player.prefetchFrameCount);
+        NSUInteger totalFrameCount = player.totalFrameCount;
+        NSUInteger upcomingFrameIndex = (player.currentFrameIndex + totalFrameCount - 1) % totalFrameCount;
+        expect([player.frameBuffer reserveFrameAtIndex:upcomingFrameIndex]).beFalsy(); // stored or being fetched
+        expect(player.bufferMissCount).beLessThan(totalFrameCount);
+        [player stopPlaying];
+        expect(player.bufferMissCount).equal(0);
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test42AnimatedImagePlayerSharedDisplayLinkBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    TXAnimatedImage *image = [TXAnimatedImage imageWithData:[self testAPNGPData]];
+    [image preloadAllFrames];
+    NSMutableArray<TXAnimatedImagePlayer *> *players = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 50; i++) {
+        TXAnimatedImagePlayer *player = [TXAnimatedImagePlayer playerWithProvider:image];
+        player.runLoopMode = NSRunLoopCommonModes;
+        [players addObject:player];
+    }
+    // The invisible player does not advance
+    __block NSUInteger invisibleFrameChangeCount = 0;
+    TXAnimatedImagePlayer *invisiblePlayer = players.lastObject;
+    invisiblePlayer.animationVisibilityHandler = ^BOOL{
+        return NO;
+    };
+    invisiblePlayer.animationFrameHandler = ^(NSUInteger index, UIImage * _Nonnull frame) {
+        if (index != 0) {
+            invisibleFrameChangeCount++;
+        }
+    };
+    __block NSUInteger visibleFrameChangeCount = 0;
+    players.firstObject.animationFrameHandler = ^(NSUInteger index, UIImage * _Nonnull frame) {
+        visibleFrameChangeCount++;
+    };
+    
+    TXSharedDisplayLink *displayLink = [TXSharedDisplayLink sharedDisplayLinkForRunLoopMode:NSRunLoopCommonModes];
+    NSUInteger wakeupCount = displayLink.wakeupCount;
+    NSUInteger refreshCount = displayLink.refreshCount;
+    NSTimeInterval playDuration = 0.5;
+    NSUInteger measureCount = 10;
+    // The players run on the main run loop, so the rounds are measured here instead of `benchmarkScenario:`
+    TXImageCacheHistogram *latency = [TXImageCacheHistogram new];
+    [self beginBenchmarkMemorySampling];
+    uint64_t startTime = [TXWebImageTimeline currentTime];
+    for (NSUInteger i = 0; i < measureCount; i++) {
+        uint64_t roundStartTime = [TXWebImageTimeline currentTime];
+        for (TXAnimatedImagePlayer *player in players) {
+            [player startPlaying];
+        }
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:playDuration]];
+        for (TXAnimatedImagePlayer *player in players) {
+            [player stopPlaying];
+        }
+        [latency recordValue:[TXWebImageTimeline currentTime] - roundStartTime];
+    }
+    uint64_t duration = [TXWebImageTimeline currentTime] - startTime;
+    
+    // 50 players share one display link, which wakes up main thread at most once per display refresh (no more than 120Hz)
+    // The operations are the wakeups and the player refreshes, so `opsPerSec` is the rate per second
+    NSUInteger wakeups = displayLink.wakeupCount - wakeupCount;
+    NSUInteger refreshes = displayLink.refreshCount - refreshCount;
+    NSDictionary *parameters = @{@"players" : @(players.count), @"rounds" : @(measureCount), @"roundSec" : @(playDuration)};
+    NSDictionary *wakeupResult = [self reportBenchmarkScenario:@"sharedDisplayLink.wakeup" parameters:parameters operations:wakeups threads:1 duration:duration latency:latency];
+    [self reportBenchmarkScenario:@"sharedDisplayLink.refresh" parameters:parameters operations:refreshes threads:1 duration:duration latency:latency];
+    NSUInteger wakeupsPerSecond = [wakeupResult[@"opsPerSec"] unsignedIntegerValue];
+    expect(wakeupsPerSecond).beLessThanOrEqualTo(125);
+    expect(displayLink.targetCount).equal(0);
+    expect(visibleFrameChangeCount).beGreaterThan(measureCount);
+    expect(invisibleFrameChangeCount).equal(0);
+}
+
+- (void)test43AnimatedFrameBudgetManager {
+    TXAnimatedFrameBudgetManager *manager = [[TXAnimatedFrameBudgetManager alloc] init];
+    manager.maxBufferSize = 100 * 1000;
+    SDAnimatedFrameBudgetTestClient *fastClient = [SDAnimatedFrameBudgetTestClient new];
+    SDAnimatedFrameBudgetTestClient *slowClient = [SDAnimatedFrameBudgetTestClient new];
+    SDAnimatedFrameBudgetTestClient *hiddenClient = [SDAnimatedFrameBudgetTestClient new];
+    SDAnimatedFrameBudgetTestClient *smallClient = [SDAnimatedFrameBudgetTestClient new];
+    for (SDAnimatedFrameBudgetTestClient *client in @[fastClient, slowClient, hiddenClient, smallClient]) {
+        client.bytesPerFrame = 1000;
+        client.totalFrameCount = 100;
+        client.framesPerSecond = 60;
+        client.isFrameBudgetActive = YES;
+        [manager setNeedsUpdateClient:client];
+    }
+    slowClient.framesPerSecond = 10;
+    hiddenClient.isFrameBudgetActive = NO;
+    smallClient.totalFrameCount = 5;
+    
+    NSUInteger fastCount = [manager bufferCountForClient:fastClient];
+    NSUInteger slowCount = [manager bufferCountForClient:slowClient];
+    NSUInteger hiddenCount = [manager bufferCountForClient:hiddenClient];
+    NSUInteger smallCount = [manager bufferCountForClient:smallClient];
+    // The small one buffers all frames, the excess goes to the others by frame rate and visibility
+    expect(smallCount).equal(5);
+    expect(fastCount).beGreaterThan(slowCount);
+    expect(slowCount).beGreaterThan(hiddenCount);
+    expect(hiddenCount).beGreaterThanOrEqualTo(1);
+    expect(manager.allocatedBufferSize).beLessThanOrEqualTo(manager.maxBufferSize);
+    expect(manager.allocatedBufferSize).beGreaterThan(manager.maxBufferSize * 0.9);
+    
+    // The removed client's budget is given to the others
+    [manager removeClient:fastClient];
+    expect([manager bufferCountForClient:slowClient]).beGreaterThan(slowCount);
+    expect(manager.allocatedBufferSize).beLessThanOrEqualTo(manager.maxBufferSize);
+    
+    // The player shares the budget
+    TXAnimatedImage *image = [TXAnimatedImage imageWithData:[self testAPNGPData]];
+    TXAnimatedImagePlayer *player = [TXAnimatedImagePlayer playerWithProvider:image];
+    [player startPlaying];
+    expect(player.maxBufferCount).equal([TXAnimatedFrameBudgetManager.sharedManager bufferCountForClient:(id<TXAnimatedFrameBudgetClient>)player]);
+    [player stopPlaying];
+}
+
+- (void)test44AnimatedFrameDecodePoolFairness {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test TXAnimatedFrameDecodePool round-robin between queues"];
+    
+    TXAnimatedFrameDecodePool *pool = [[TXAnimatedFrameDecodePool alloc] initWithMaxConcurrentCount:1];
+    TXAnimatedFrameDecodeQueue *heavyQueue = [[TXAnimatedFrameDecodeQueue alloc] initWithPool:pool];
+    TXAnimatedFrameDecodeQueue *lightQueue = [[TXAnimatedFrameDecodeQueue alloc] initWithPool:pool];
+    NSMutableArray<NSString *> *order = [NSMutableArray array];
+    NSUInteger heavyCount = 10;
+    NSUInteger lightCount = 2;
+    void (^taskBlock)(NSString *) = ^(NSString *name) {
+        [NSThread sleepForTimeInterval:0.001];
+        @synchronized (order) {
+            [order addObject:name];
+            if (order.count == heavyCount + lightCount) {
+                [expectation fulfill];
+            }
+        }
+    };
+    for (NSUInteger i = 0; i < heavyCount; i++) {
+        [heavyQueue addTask:^{
+            taskBlock(@"heavy");
+        }];
+    }
+    for (NSUInteger i = 0; i < lightCount; i++) {
+        [lightQueue addTask:^{
+            taskBlock(@"light");
+        }];
+    }
+    
+    [self waitForExpectationsWithCommonTimeout];
+    // The light queue does not wait for all the heavy tasks
+    NSUInteger lastLightIndex = [order indexOfObjectWithOptions:NSEnumerationReverse passingTest:^BOOL(NSString * _Nonnull obj, NSUInteger idx, BOOL * _Nonnull stop) {
+        return [obj isEqualToString:@"light"];
+    }];
+    expect(lastLightIndex).beLessThanOrEqualTo(lightCount * 2);
+    expect(heavyQueue.pendingCount).equal(0);
+}
+
 #pragma mark - Helper
 - (UIWindow *)window {
     if (!_window) {
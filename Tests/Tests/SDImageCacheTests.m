@@ -136,14 +136,13 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
     XCTestExpectation *expectation = [self expectationWithDescription:@"queryCacheOperationForKey"];
     UIImage *imageForTesting = [self testJPEGImage];
     [[TXImageCache sharedImageCache] storeImage:imageForTesting forKey:kTestImageKeyJPEG completion:nil];
-    NSOperation *operation = [[TXImageCache sharedImageCache] queryCacheOperationForKey:kTestImageKeyJPEG done:^(UIImage *image, NSData *data, TXImageCacheType cacheType) {
+    TXWebImageCancellationToken *operation = [[TXImageCache sharedImageCache] queryCacheOperationForKey:kTestImageKeyJPEG done:^(UIImage *image, NSData *data, TXImageCacheType cacheType) {
         expect(image).to.equal(imageForTesting);
         [[TXImageCache sharedImageCache] removeImageForKey:kTestImageKeyJPEG withCompletion:^{
             [expectation fulfill];
         }];
     }];
     expect(operation).toNot.beNil;
-    [operation start];
     [self waitForExpectationsWithCommonTimeout];
 }
 
@@ -864,6 +863,322 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
     expect(cacheFiles.count).equal(0);
 }
 
+- (void)test59ImageCacheStatistics {
+    TXImageCacheConfig *config = [[TXImageCacheConfig alloc] init];
+    config.shouldRecordStatistics = YES;
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:@"Statistics" diskCacheDirectory:nil config:config];
+    
+    UIImage *image = [self testJPEGImage];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    NSString *key = @"statisticsKey";
+    [cache storeImageToMemory:image forKey:key];
+    [cache storeImageDataToDisk:imageData forKey:key];
+    // Memory hit and miss
+    expect([cache imageFromMemoryCacheForKey:key]).notTo.beNil();
+    expect([cache imageFromMemoryCacheForKey:@"notExistKey"]).beNil();
+    // Disk hit and miss
+    expect([cache diskImageDataForKey:key]).notTo.beNil();
+    expect([cache diskImageDataForKey:@"notExistKey"]).beNil();
+    // Remove
+    [cache removeImageFromMemoryForKey:key];
+    [cache removeImageFromDiskForKey:key];
+    
+    TXImageCacheStatistics *statistics = [cache.statistics copy];
+    expect(statistics.memory.hitCount).equal(1);
+    expect(statistics.memory.missCount).equal(1);
+    expect(statistics.memory.hitRate).equal(0.5);
+    expect(statistics.memory.storeCount).equal(1);
+    expect(statistics.memory.removeCount).equal(1);
+    expect(statistics.memory.bytesRead).equal(image.sd_memoryCost);
+    expect(statistics.memory.evictionCount).equal(0);
+    expect(statistics.disk.hitCount).equal(1);
+    expect(statistics.disk.missCount).equal(1);
+    expect(statistics.disk.storeCount).equal(1);
+    expect(statistics.disk.removeCount).equal(1);
+    expect(statistics.disk.bytesRead).equal(imageData.length);
+    expect(statistics.disk.bytesWritten).equal(imageData.length);
+    expect(statistics.disk.queryLatency.count).equal(2);
+    expect([statistics.disk.queryLatency valueAtPercentile:100]).equal(statistics.disk.queryLatency.maxValue);
+    
+    // Snapshot is not affected by later recording
+    [cache imageFromMemoryCacheForKey:key];
+    expect(statistics.memory.missCount).equal(1);
+    expect(cache.statistics.memory.missCount).equal(2);
+    
+    // Disabled by default
+    TXImageCache *disabledCache = [[TXImageCache alloc] initWithNamespace:@"StatisticsDisabled"];
+    [disabledCache storeImageToMemory:image forKey:key];
+    [disabledCache imageFromMemoryCacheForKey:key];
+    expect(disabledCache.statistics.memory.storeCount).equal(0);
+    expect(disabledCache.statistics.memory.hitCount).equal(0);
+}
+
+- (void)test60ImageCacheHistogramPercentile {
+    TXImageCacheHistogram *histogram = [TXImageCacheHistogram new];
+    expect([histogram valueAtPercentile:50]).equal(0);
+    for (uint64_t value = 1; value <= 1000; value++) {
+        [histogram recordValue:value * 1000];
+    }
+    expect(histogram.count).equal(1000);
+    expect(histogram.maxValue).equal(1000000);
+    expect(histogram.meanValue).equal(500500);
+    // The relative error of the bucket is less than 1/16
+    uint64_t p50 = [histogram valueAtPercentile:50];
+    uint64_t p99 = [histogram valueAtPercentile:99];
+    expect(p50).beGreaterThanOrEqualTo(500000);
+    expect(p50).beLessThanOrEqualTo(500000 + 500000 / 16);
+    expect(p99).beGreaterThanOrEqualTo(990000);
+    expect(p99).beLessThanOrEqualTo(1000000);
+    expect([histogram valueAtPercentile:100]).equal(1000000);
+    
+    TXImageCacheHistogram *aggregated = [histogram copy];
+    [aggregated addHistogram:histogram];
+    expect(aggregated.count).equal(2000);
+    expect([aggregated valueAtPercentile:50]).equal(p50);
+    [histogram reset];
+    expect(histogram.count).equal(0);
+    expect(aggregated.count).equal(2000);
+}
+
+- (void)test61ImageCachesManagerAggregatesStatistics {
+    TXImageCacheConfig *config = [[TXImageCacheConfig alloc] init];
+    config.shouldRecordStatistics = YES;
+    TXImageCache *cache1 = [[TXImageCache alloc] initWithNamespace:@"Statistics1" diskCacheDirectory:nil config:config];
+    TXImageCache *cache2 = [[TXImageCache alloc] initWithNamespace:@"Statistics2" diskCacheDirectory:nil config:config];
+    TXImageCachesManager *nestedManager = [[TXImageCachesManager alloc] init];
+    nestedManager.caches = @[cache2];
+    TXImageCachesManager *manager = [[TXImageCachesManager alloc] init];
+    // The duplicated cache is counted once
+    manager.caches = @[cache1, cache1, nestedManager, cache2];
+    
+    [cache1 imageFromMemoryCacheForKey:@"notExistKey"];
+    [cache2 imageFromMemoryCacheForKey:@"notExistKey"];
+    [cache2 imageFromMemoryCacheForKey:@"notExistKey"];
+    TXImageCacheStatistics *statistics = manager.statistics;
+    expect(statistics.memory.missCount).equal(cache1.statistics.memory.missCount + cache2.statistics.memory.missCount);
+    expect(statistics.memory.queryLatency.count).equal(cache1.statistics.memory.queryLatency.count + cache2.statistics.memory.queryLatency.count);
+    
+    // Reporter reports the delta since last report
+    __block NSUInteger reportCount = 0;
+    TXImageCacheStatisticsReporter *reporter = [[TXImageCacheStatisticsReporter alloc] initWithProvider:manager interval:60 queue:nil reportBlock:^(TXImageCacheStatistics * _Nonnull snapshot, NSDictionary<NSString *,id> * _Nonnull delta) {
+        reportCount++;
+        if (reportCount == 2) {
+            expect([delta[@"memory"][@"missCount"] unsignedIntegerValue]).equal(1);
+            expect([delta[@"disk"][@"missCount"] unsignedIntegerValue]).equal(0);
+        }
+        expect(snapshot.dictionaryRepresentation[@"memory"][@"queryLatency"][@"p99Us"]).notTo.beNil();
+    }];
+    [reporter reportNow];
+    [cache1 imageFromMemoryCacheForKey:@"notExistKey"];
+    [reporter reportNow];
+    expect(reportCount).equal(2);
+    [reporter start];
+    expect(reporter.isRunning).beTruthy();
+    [reporter stop];
+    expect(reporter.isRunning).beFalsy();
+}
+
+#pragma mark - Benchmark
+
+- (void)test62MemoryCacheBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    TXMemoryCache *memoryCache = [[TXMemoryCache alloc] initWithConfig:[[TXImageCacheConfig alloc] init]];
+    UIImage *image = [self testJPEGImage];
+    NSUInteger cost = image.sd_memoryCost;
+    NSUInteger keyCount = 10000;
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:keyCount];
+    for (NSUInteger i = 0; i < keyCount; i++) {
+        [keys addObject:[NSString stringWithFormat:@"http://example.com/image%lu.jpg", (unsigned long)i]];
+    }
+    NSUInteger iterations = 200000;
+    NSDictionary *parameters = @{@"keys" : @(keyCount)};
+    for (NSNumber *threads in @[@1, @4, @8]) {
+        [self benchmarkScenario:@"memoryCache.set" parameters:parameters iterations:iterations threads:threads.unsignedIntegerValue block:^(NSUInteger index) {
+            [memoryCache setObject:image forKey:keys[index % keyCount] cost:cost];
+        }];
+        [self benchmarkScenario:@"memoryCache.get" parameters:parameters iterations:iterations threads:threads.unsignedIntegerValue block:^(NSUInteger index) {
+            __unused id object = [memoryCache objectForKey:keys[index % keyCount]];
+        }];
+        // 90% get and 10% set, like the scrolling list
+        [self benchmarkScenario:@"memoryCache.mixed" parameters:parameters iterations:iterations threads:threads.unsignedIntegerValue block:^(NSUInteger index) {
+            NSString *key = keys[(index * 7919) % keyCount];
+            if (index % 10 == 0) {
+                [memoryCache setObject:image forKey:key cost:cost];
+            } else {
+                __unused id object = [memoryCache objectForKey:key];
+            }
+        }];
+        [memoryCache removeAllObjects];
+    }
+}
+
+- (void)test63DiskCacheBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    NSData *data = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    for (NSNumber *entryCountNumber in SDTestCase.benchmarkEntryCounts) {
+        NSUInteger entryCount = entryCountNumber.unsignedIntegerValue;
+        NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:[NSString stringWithFormat:@"benchmark%lu", (unsigned long)entryCount]];
+        TXImageCacheConfig *config = [[TXImageCacheConfig alloc] init];
+        TXDiskCache *diskCache = [[TXDiskCache alloc] initWithCachePath:cachePath config:config];
+        [diskCache removeAllData];
+        NSDictionary *parameters = @{@"entries" : @(entryCount), @"bytes" : @(data.length)};
+        // `TXImageCache` access the disk cache from its serial IO queue, so single thread here
+        [self benchmarkScenario:@"diskCache.set" parameters:parameters iterations:entryCount threads:1 block:^(NSUInteger index) {
+            [diskCache setData:data forKey:[NSString stringWithFormat:@"http://example.com/image%lu.jpg", (unsigned long)index]];
+        }];
+        [self benchmarkScenario:@"diskCache.get" parameters:parameters iterations:entryCount threads:1 block:^(NSUInteger index) {
+            // Visit in a scattered order instead of the write order
+            NSUInteger scatteredIndex = (index * 7919) % entryCount;
+            __unused NSData *cachedData = [diskCache dataForKey:[NSString stringWithFormat:@"http://example.com/image%lu.jpg", (unsigned long)scatteredIndex]];
+        }];
+        // Exceed the size limit, so the size-based pass removes about half of the entries
+        config.maxDiskSize = [diskCache totalSize] / 2;
+        [self benchmarkScenario:@"diskCache.expire" parameters:parameters iterations:1 threads:1 block:^(NSUInteger index) {
+            [diskCache removeExpiredData];
+        }];
+        [diskCache removeAllData];
+    }
+}
+
+- (void)test64DiskCacheFileNameMigrationFromLegacyName {
+    // The known digests of XXH3 128-bit (v2) and MD5 (v1)
+    expect(TXDiskCacheFileNameForKey(@"abc")).equal(@"06b05ab6733a618578af5f94892f3950");
+    expect(TXDiskCacheLegacyFileNameForKey(@"abc")).equal(@"900150983cd24fb0d6963f7d28e17f72");
+    expect(TXDiskCacheFileNameForKey(@"http://example.com/image0.jpg?size=100#fragment.png").pathExtension).equal(@"jpg");
+    expect(TXDiskCacheFileNameForKey(@"http://example.com").length).equal(32);
+
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"fileNameMigration"];
+    TXImageCacheConfig *config = [[TXImageCacheConfig alloc] init];
+    NSFileManager *fileManager = [[NSFileManager alloc] init];
+    config.fileManager = fileManager;
+    [fileManager removeItemAtPath:cachePath error:nil];
+    [fileManager createDirectoryAtPath:cachePath withIntermediateDirectories:YES attributes:nil error:nil];
+
+    // Fake the file stored by v1, before v2 opens the directory
+    NSString *key = @"http://example.com/image0.jpg";
+    NSData *data = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    NSDictionary<NSFileAttributeKey, id> *legacyAttributes = @{NSFileModificationDate : [NSDate dateWithTimeIntervalSinceNow:-60]};
+    NSString *legacyPath = [cachePath stringByAppendingPathComponent:@"7c300137190a2d10ccd13ebb7968b03f.jpg"];
+    NSString *currentPath = [cachePath stringByAppendingPathComponent:@"6d5f7f105ec6da5f209d60910599a089.jpg"];
+    [fileManager createFileAtPath:legacyPath contents:data attributes:legacyAttributes];
+    TXDiskCache *diskCache = [[TXDiskCache alloc] initWithCachePath:cachePath config:config];
+    expect([diskCache cachePathForKey:key]).equal(currentPath);
+
+    // Renamed on first query
+    expect([diskCache dataForKey:key]).equal(data);
+    expect([fileManager fileExistsAtPath:legacyPath]).beFalsy();
+    expect([fileManager fileExistsAtPath:currentPath]).beTruthy();
+    // The migration does not change the expiration
+    NSDate *modificationDate = [fileManager attributesOfItemAtPath:currentPath error:nil].fileModificationDate;
+    expect(modificationDate.timeIntervalSince1970).beCloseToWithin([legacyAttributes[NSFileModificationDate] timeIntervalSince1970], 1);
+    expect([diskCache containsDataForKey:key]).beTruthy();
+    // The file name computed by the caller
+    expect([diskCache dataForKey:key fileName:TXDiskCacheFileNameForKey(key)]).equal(data);
+
+    // The not migrated legacy file is removed as well
+    [fileManager createFileAtPath:legacyPath contents:data attributes:legacyAttributes];
+    [diskCache removeDataForKey:key];
+    expect([diskCache containsDataForKey:key]).beFalsy();
+    expect([fileManager fileExistsAtPath:legacyPath]).beFalsy();
+
+    // The sweep keeps the fallback until no legacy file is left
+    NSString *key2 = @"http://example.com/image2.jpg";
+    [fileManager createFileAtPath:[cachePath stringByAppendingPathComponent:TXDiskCacheLegacyFileNameForKey(key2)] contents:data attributes:legacyAttributes];
+    [diskCache removeExpiredData];
+    expect([diskCache dataForKey:key2]).equal(data);
+    [diskCache removeExpiredData];
+    // Migration completed, the legacy name is no longer looked up, even after reopening
+    NSString *key3 = @"http://example.com/image3.jpg";
+    [fileManager createFileAtPath:[cachePath stringByAppendingPathComponent:TXDiskCacheLegacyFileNameForKey(key3)] contents:data attributes:legacyAttributes];
+    expect([diskCache containsDataForKey:key3]).beFalsy();
+    expect([[[TXDiskCache alloc] initWithCachePath:cachePath config:config] dataForKey:key3]).beNil();
+    expect([diskCache containsDataForKey:key2]).beTruthy();
+
+    // v1 keeps the legacy name
+    config.diskCacheFileNameVersion = TXImageCacheConfigFileNameVersion1;
+    TXDiskCache *legacyDiskCache = [[TXDiskCache alloc] initWithCachePath:cachePath config:config];
+    [legacyDiskCache setData:data forKey:key];
+    expect([fileManager fileExistsAtPath:legacyPath]).beTruthy();
+    expect([legacyDiskCache dataForKey:key]).equal(data);
+    [legacyDiskCache removeAllData];
+}
+
+- (void)test65DiskCacheFileNameBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    NSUInteger iterations = 100000;
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:1000];
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [keys addObject:[NSString stringWithFormat:@"https://example.com/images/%lu/photo.jpg?width=750&quality=80", (unsigned long)i]];
+    }
+    NSDictionary *parameters = @{@"keys" : @(keys.count)};
+    // Key to file name, before (v1, MD5) and after (v2, XXH3)
+    [self benchmarkScenario:@"diskCacheFileName.md5" parameters:parameters iterations:iterations threads:1 block:^(NSUInteger index) {
+        __unused NSString *fileName = TXDiskCacheLegacyFileNameForKey(keys[index % keys.count]);
+    }];
+    [self benchmarkScenario:@"diskCacheFileName.xxh3" parameters:parameters iterations:iterations threads:1 block:^(NSUInteger index) {
+        __unused NSString *fileName = TXDiskCacheFileNameForKey(keys[index % keys.count]);
+    }];
+}
+
+- (void)test66CancellationTokenCancelQueryAndCacheOperations {
+    // The handler is called once, or immediately if already cancelled
+    TXWebImageCancellationToken *token = [TXWebImageCancellationToken new];
+    __block NSUInteger handlerCount = 0;
+    [token addCancellationHandler:^{
+        handlerCount++;
+    }];
+    expect(token.isCancelled).beFalsy();
+    [token cancel];
+    [token cancel];
+    expect(token.isCancelled).beTruthy();
+    expect(handlerCount).equal(1);
+    [token addCancellationHandler:^{
+        handlerCount++;
+    }];
+    expect(handlerCount).equal(2);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Cancelled disk query still callback"];
+    XCTestExpectation *queryExpectation = [self expectationWithDescription:@"Cancelled disk query callback"];
+    XCTestExpectation *cancelledExpectation = [self expectationWithDescription:@"Cancelled caches manager query never callback"];
+    cancelledExpectation.inverted = YES;
+    TXImageCache *cache1 = [[TXImageCache alloc] initWithNamespace:@"cancellationToken1"];
+    TXImageCache *cache2 = [[TXImageCache alloc] initWithNamespace:@"cancellationToken2"];
+    TXImageCachesManager *cachesManager = [[TXImageCachesManager alloc] init];
+    cachesManager.caches = @[cache1, cache2];
+    cachesManager.queryOperationPolicy = TXImageCachesManagerOperationPolicyConcurrent;
+    NSString *key = @"kCancellationTokenTestImageKey";
+    [cache1 storeImage:[self testJPEGImage] forKey:key toDisk:YES completion:nil];
+    [cache2 storeImage:[self testPNGImage] forKey:key toDisk:YES completion:^{
+        [cache1 clearMemory];
+        [cache2 clearMemory];
+        // The caller (like `TXWebImageManager`) relies on the done block to finish the cancelled load
+        TXWebImageCancellationToken *operation = [cache1 queryCacheOperationForKey:key done:^(UIImage * _Nullable image, NSData * _Nullable data, TXImageCacheType cacheType) {
+            expect(cacheType).equal(TXImageCacheTypeDisk);
+            [queryExpectation fulfill];
+        }];
+        expect(operation).notTo.beNil();
+        [operation cancel];
+        id<TXWebImageOperation> managerOperation = [cachesManager queryImageForKey:key options:0 context:nil cacheType:TXImageCacheTypeDisk completion:^(UIImage * _Nullable image, NSData * _Nullable data, TXImageCacheType cacheType) {
+            [cancelledExpectation fulfill];
+        }];
+        expect(managerOperation).notTo.beNil();
+        [managerOperation cancel];
+        [cache1 clearDiskOnCompletion:^{
+            [cache2 clearDiskOnCompletion:^{
+                [expectation fulfill];
+            }];
+        }];
+    }];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
 #pragma mark Helper methods
 
 - (UIImage *)testJPEGImage {
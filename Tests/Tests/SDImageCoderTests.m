@@ -341,6 +341,76 @@
     }
 }
 
+- (void)test23ThatDecodeOptionsIsTypedDictionary {
+    SDWebImageContext *context = @{SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(100, 50)), SDWebImageContextImagePreserveAspectRatio : @(NO)};
+    TXImageDecodeOptions *decodeOptions = [TXImageDecodeOptions decodeOptionsWithCacheKey:@"http://example.com/image@2x.png" options:SDWebImageDecodeFirstFrameOnly context:context];
+    expect(decodeOptions.scaleFactor).equal(2);
+    expect(decodeOptions.thumbnailPixelSize).equal(CGSizeMake(100, 50));
+    expect(decodeOptions.preserveAspectRatio).beFalsy();
+    expect(decodeOptions.firstFrameOnly).beTruthy();
+    // Dictionary form for the coders which do not opt in
+    expect(decodeOptions[TXImageCoderDecodeScaleFactor]).equal(@2);
+    expect(decodeOptions[TXImageCoderDecodeThumbnailPixelSize]).equal(@(CGSizeMake(100, 50)));
+    expect(decodeOptions[TXImageCoderDecodePreserveAspectRatio]).equal(@NO);
+    expect(decodeOptions[TXImageCoderDecodeFirstFrameOnly]).equal(@YES);
+    expect(decodeOptions.count).equal(decodeOptions.allKeys.count);
+    expect([decodeOptions copy]).beIdenticalTo(decodeOptions);
+    expect([TXImageDecodeOptions decodeOptionsWithCoderOptions:decodeOptions]).beIdenticalTo(decodeOptions);
+
+    // From the dictionary, the absent one uses the default value
+    TXImageDecodeOptions *defaultOptions = [TXImageDecodeOptions decodeOptionsWithCoderOptions:@{TXImageCoderDecodeScaleFactor : @3}];
+    expect(defaultOptions.scaleFactor).equal(3);
+    expect(defaultOptions.thumbnailPixelSize).equal(CGSizeZero);
+    expect(defaultOptions.preserveAspectRatio).beTruthy();
+    expect(defaultOptions.firstFrameOnly).beFalsy();
+    expect(defaultOptions[TXImageCoderDecodeThumbnailPixelSize]).beNil();
+
+    // Coder decodes with the typed options
+    NSURL *jpegURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"TestImage" withExtension:@"jpg"];
+    NSData *data = [NSData dataWithContentsOfURL:jpegURL];
+    UIImage *image = [TXImageIOCoder.sharedCoder decodedImageWithData:data options:decodeOptions];
+    expect(image.scale).equal(2);
+    expect(MAX(CGImageGetWidth(image.CGImage), CGImageGetHeight(image.CGImage))).beLessThanOrEqualTo(100);
+}
+
+#pragma mark - Benchmark
+
+- (void)test22DecodeBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    // The bundled corpus, small and large for each format
+    NSArray<NSString *> *fileNames = @[@"TestImage.jpg", @"TestImageLarge.jpg", @"TestImage.png", @"TestImageLarge.png", @"TestImage.gif", @"TestImage.heic", @"TestImageStatic.webp"];
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    for (NSString *fileName in fileNames) {
+        NSData *data = [NSData dataWithContentsOfFile:[testBundle pathForResource:fileName.stringByDeletingPathExtension ofType:fileName.pathExtension]];
+        id<TXImageCoder> coder = TXImageCodersManager.sharedManager;
+        if (![coder canDecodeFromData:data]) {
+            coder = SDImageWebPCoder.sharedCoder;
+        }
+        UIImage *sampleImage = [coder decodedImageWithData:data options:@{TXImageCoderDecodeFirstFrameOnly : @YES}];
+        if (!sampleImage) {
+            // The format is not supported on this platform
+            continue;
+        }
+        CGSize pixelSize = CGSizeMake(CGImageGetWidth(sampleImage.CGImage), CGImageGetHeight(sampleImage.CGImage));
+        NSDictionary *parameters = @{@"file" : fileName,
+                                     @"format" : fileName.pathExtension,
+                                     @"width" : @(pixelSize.width),
+                                     @"height" : @(pixelSize.height),
+                                     @"bytes" : @(data.length),
+                                     @"coder" : NSStringFromClass([(NSObject *)coder class])};
+        NSUInteger iterations = pixelSize.width * pixelSize.height > 1000 * 1000 ? 20 : 200;
+        for (NSNumber *threads in @[@1, @4]) {
+            // Decode and force the bitmap, as the image pipeline does in background
+            [self benchmarkScenario:@"coder.decode" parameters:parameters iterations:iterations threads:threads.unsignedIntegerValue block:^(NSUInteger index) {
+                UIImage *image = [coder decodedImageWithData:data options:@{TXImageCoderDecodeFirstFrameOnly : @YES}];
+                __unused UIImage *decodedImage = [TXImageCoderHelper decodedImageWithImage:image];
+            }];
+        }
+    }
+}
+
 #pragma mark - Utils
 
 - (void)verifyCoder:(id<TXImageCoder>)coder
@@ -33,3 +33,29 @@ FOUNDATION_EXPORT NSString * _Nonnull const kTestAPNGPURL;
 - (void)waitForExpectationsWithCommonTimeoutUsingHandler:(nullable XCWaitCompletionHandler)handler;
 
 @end
+
+/**
+ The benchmark cases (named with `Benchmark`) are skipped unless the `SD_BENCHMARK=1` environment is set, for example `TEST_RUNNER_SD_BENCHMARK=1 xcodebuild test ...`. Other environments:
+ `SD_BENCHMARK_OUTPUT`: the file path to append the results as JSON Lines, one object per scenario. The results are logged with `[SDBenchmark]` prefix as well.
+ `SD_BENCHMARK_COMMIT`: the label (like the git commit) written to each result, to compare across commits.
+ `SD_BENCHMARK_MAX_ENTRIES`: the max entry count of the cache scenarios among 10k/100k/1M. Defaults to 10000.
+ Each result contains the scenario name and parameters, `operations`, `threads`, `durationSec`, `opsPerSec`, the latency `p50Us`/`p90Us`/`p99Us`/`maxUs`, and the current physical footprint `footprintBytes`.
+ The memory of each scenario is reported as the deltas from the footprint at its beginning, `footprintDeltaBytes` (retained at the end) and `peakFootprintDeltaBytes` (sampled every millisecond, so a shorter spike may be missed). The process wide peak RSS is not reported, because it only grows across the scenarios.
+ */
+@interface SDTestCase (Benchmark)
+
+/// Whether the benchmark is enabled by the environment
+@property (nonatomic, class, readonly) BOOL isBenchmarkEnabled;
+/// The entry counts for the cache scenarios, limited by `SD_BENCHMARK_MAX_ENTRIES`
+@property (nonatomic, class, readonly, nonnull) NSArray<NSNumber *> *benchmarkEntryCounts;
+
+/// Call the block `iterations` times with the index, split across `threads` concurrent workers, record the latency of each call and report. Return the result.
+- (nonnull NSDictionary<NSString *, id> *)benchmarkScenario:(nonnull NSString *)scenario parameters:(nullable NSDictionary<NSString *, id> *)parameters iterations:(NSUInteger)iterations threads:(NSUInteger)threads block:(nonnull void(^)(NSUInteger index))block;
+
+/// Begin to sample the memory for the scenario measured by the caller, the next report contains the deltas. `benchmarkScenario:` calls this.
+- (void)beginBenchmarkMemorySampling;
+
+/// Report the result measured by the caller, like the async scenario. The duration and latency are in nanoseconds. Return the result.
+- (nonnull NSDictionary<NSString *, id> *)reportBenchmarkScenario:(nonnull NSString *)scenario parameters:(nullable NSDictionary<NSString *, id> *)parameters operations:(NSUInteger)operations threads:(NSUInteger)threads duration:(uint64_t)duration latency:(nonnull TXImageCacheHistogram *)latency;
+
+@end
@@ -8,6 +8,7 @@
  */
 
 #import "SDTestCase.h"
+#import <mach/mach.h>
 
 const int64_t kAsyncTestTimeout = 5;
 const int64_t kMinDelayNanosecond = NSEC_PER_MSEC * 100; // 0.1s
@@ -17,6 +18,74 @@ NSString *const kTestPNGURL = @"http://via.placeholder.com/50x50.png";
 NSString *const kTestGIFURL = @"https://media.giphy.com/media/UEsrLdv7ugRTq/giphy.gif";
 NSString *const kTestAPNGPURL = @"https://upload.wikimedia.org/wikipedia/commons/1/14/Animated_PNG_example_bouncing_beach_ball.png";
 
+// The physical footprint is what the system uses to decide memory pressure and jetsam, unlike `ru_maxrss` which only grows for the process lifetime
+static uint64_t SDCurrentPhysicalFootprint(void) {
+    task_vm_info_data_t vmInfo;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&vmInfo, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return vmInfo.phys_footprint;
+}
+
+// Sample the footprint every millisecond on a background queue, to get the peak of one scenario
+@interface SDBenchmarkMemorySampler : NSObject
+
+@property (nonatomic, assign, readonly) uint64_t beginFootprint;
+@property (atomic, assign, readonly) uint64_t peakFootprint;
+
+- (void)stop;
+
+@end
+
+@interface SDBenchmarkMemorySampler ()
+
+@property (atomic, assign, readwrite) uint64_t peakFootprint;
+@property (nonatomic, strong) dispatch_source_t timer;
+
+@end
+
+@implementation SDBenchmarkMemorySampler
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _beginFootprint = SDCurrentPhysicalFootprint();
+        _peakFootprint = _beginFootprint;
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_queue_create("com.hackemist.SDBenchmarkMemorySampler", DISPATCH_QUEUE_SERIAL));
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_NOW, NSEC_PER_MSEC, NSEC_PER_MSEC / 10);
+        __weak typeof(self) wself = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [wself sample];
+        });
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (void)sample {
+    uint64_t footprint = SDCurrentPhysicalFootprint();
+    if (footprint > self.peakFootprint) {
+        self.peakFootprint = footprint;
+    }
+}
+
+- (void)stop {
+    if (self.timer) {
+        dispatch_source_cancel(self.timer);
+        self.timer = nil;
+    }
+    [self sample];
+}
+
+@end
+
+@interface SDTestCase ()
+
+@property (nonatomic, strong, nullable) SDBenchmarkMemorySampler *benchmarkMemorySampler;
+
+@end
+
 @implementation SDTestCase
 
 - (void)waitForExpectationsWithCommonTimeout {
@@ -28,3 +97,92 @@ NSString *const kTestAPNGPURL = @"https://upload.wikimedia.org/wikipedia/commons
 }
 
 @end
+
+@implementation SDTestCase (Benchmark)
+
++ (BOOL)isBenchmarkEnabled {
+    return [NSProcessInfo.processInfo.environment[@"SD_BENCHMARK"] boolValue];
+}
+
++ (NSArray<NSNumber *> *)benchmarkEntryCounts {
+    NSUInteger maxCount = [NSProcessInfo.processInfo.environment[@"SD_BENCHMARK_MAX_ENTRIES"] integerValue];
+    if (maxCount == 0) {
+        maxCount = 10000;
+    }
+    NSMutableArray<NSNumber *> *entryCounts = [NSMutableArray array];
+    for (NSNumber *entryCount in @[@10000, @100000, @1000000]) {
+        if (entryCount.unsignedIntegerValue <= maxCount) {
+            [entryCounts addObject:entryCount];
+        }
+    }
+    return [entryCounts copy];
+}
+
+- (void)beginBenchmarkMemorySampling {
+    [self.benchmarkMemorySampler stop];
+    self.benchmarkMemorySampler = [SDBenchmarkMemorySampler new];
+}
+
+- (NSDictionary<NSString *, id> *)benchmarkScenario:(NSString *)scenario parameters:(NSDictionary<NSString *, id> *)parameters iterations:(NSUInteger)iterations threads:(NSUInteger)threads block:(void (^)(NSUInteger))block {
+    threads = MAX(threads, 1);
+    [self beginBenchmarkMemorySampling];
+    TXImageCacheHistogram *latency = [TXImageCacheHistogram new];
+    uint64_t startTime = [TXWebImageTimeline currentTime];
+    dispatch_apply(threads, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t thread) {
+        for (NSUInteger i = thread; i < iterations; i += threads) {
+            @autoreleasepool {
+                uint64_t operationStartTime = [TXWebImageTimeline currentTime];
+                block(i);
+                [latency recordValue:[TXWebImageTimeline currentTime] - operationStartTime];
+            }
+        }
+    });
+    uint64_t duration = [TXWebImageTimeline currentTime] - startTime;
+    return [self reportBenchmarkScenario:scenario parameters:parameters operations:iterations threads:threads duration:duration latency:latency];
+}
+
+- (NSDictionary<NSString *, id> *)reportBenchmarkScenario:(NSString *)scenario parameters:(NSDictionary<NSString *, id> *)parameters operations:(NSUInteger)operations threads:(NSUInteger)threads duration:(uint64_t)duration latency:(TXImageCacheHistogram *)latency {
+    NSMutableDictionary<NSString *, id> *result = [NSMutableDictionary dictionary];
+    result[@"scenario"] = scenario;
+    result[@"commit"] = NSProcessInfo.processInfo.environment[@"SD_BENCHMARK_COMMIT"] ?: @"";
+    result[@"os"] = NSProcessInfo.processInfo.operatingSystemVersionString;
+    result[@"parameters"] = parameters ?: @{};
+    result[@"operations"] = @(operations);
+    result[@"threads"] = @(threads);
+    result[@"durationSec"] = @(duration / (double)NSEC_PER_SEC);
+    result[@"opsPerSec"] = @(duration > 0 ? operations / (duration / (double)NSEC_PER_SEC) : 0);
+    result[@"p50Us"] = @([latency valueAtPercentile:50] / 1000.0);
+    result[@"p90Us"] = @([latency valueAtPercentile:90] / 1000.0);
+    result[@"p99Us"] = @([latency valueAtPercentile:99] / 1000.0);
+    result[@"maxUs"] = @(latency.maxValue / 1000.0);
+    uint64_t footprint = SDCurrentPhysicalFootprint();
+    result[@"footprintBytes"] = @(footprint);
+    // The deltas of this scenario only, the memory kept by the previous scenarios in the same process is excluded
+    SDBenchmarkMemorySampler *sampler = self.benchmarkMemorySampler;
+    if (sampler) {
+        [sampler stop];
+        self.benchmarkMemorySampler = nil;
+        result[@"footprintDeltaBytes"] = @((int64_t)footprint - (int64_t)sampler.beginFootprint);
+        result[@"peakFootprintDeltaBytes"] = @((int64_t)sampler.peakFootprint - (int64_t)sampler.beginFootprint);
+    }
+    
+    NSData *data = [NSJSONSerialization dataWithJSONObject:result options:0 error:nil];
+    NSString *line = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    NSLog(@"[SDBenchmark] %@", line);
+    NSString *outputPath = NSProcessInfo.processInfo.environment[@"SD_BENCHMARK_OUTPUT"];
+    if (outputPath.length > 0 && data) {
+        @synchronized (SDTestCase.class) {
+            if (![NSFileManager.defaultManager fileExistsAtPath:outputPath]) {
+                [NSFileManager.defaultManager createFileAtPath:outputPath contents:nil attributes:nil];
+            }
+            NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:outputPath];
+            [fileHandle seekToEndOfFile];
+            [fileHandle writeData:data];
+            [fileHandle writeData:[@"\n" dataUsingEncoding:NSUTF8StringEncoding]];
+            [fileHandle closeFile];
+        }
+    }
+    return [result copy];
+}
+
+@end
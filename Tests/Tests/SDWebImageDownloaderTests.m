@@ -26,6 +26,42 @@
 @property (strong, nonatomic, nonnull) NSOperationQueue *downloadQueue;
 @end
 
+static NSString * const kBenchmarkHost = @"benchmark.sdwebimage.test";
+static NSData *kBenchmarkResponseData;
+
+/**
+ *  The local HTTP stand-in for the benchmark, serve `kBenchmarkResponseData` for any request to `kBenchmarkHost` without network
+ */
+@interface SDBenchmarkURLProtocol : NSURLProtocol
+@end
+
+@implementation SDBenchmarkURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return [request.URL.host isEqualToString:kBenchmarkHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    NSData *data = kBenchmarkResponseData;
+    NSDictionary *headerFields = @{@"Content-Type" : @"image/jpeg", @"Content-Length" : [NSString stringWithFormat:@"%lu", (unsigned long)data.length]};
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:headerFields];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    // Deliver in chunks as the network does
+    NSUInteger chunkLength = 16 * 1024;
+    for (NSUInteger offset = 0; offset < data.length; offset += chunkLength) {
+        [self.client URLProtocol:self didLoadData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, data.length - offset))]];
+    }
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {
+}
+
+@end
 
 @interface TXWebImageDownloaderTests : SDTestCase
 
@@ -820,4 +856,59 @@
     return [testBundle pathForResource:@"TestImage" ofType:@"png"];
 }
 
+#pragma mark - Benchmark
+
+- (void)test32DownloaderBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    for (NSString *fileName in @[@"TestImage.jpg", @"TestImageLarge.jpg"]) {
+        kBenchmarkResponseData = [NSData dataWithContentsOfFile:[testBundle pathForResource:fileName.stringByDeletingPathExtension ofType:fileName.pathExtension]];
+        NSUInteger operations = kBenchmarkResponseData.length > 100 * 1024 ? 50 : 200;
+        for (NSNumber *concurrency in @[@1, @6]) {
+            NSURLSessionConfiguration *sessionConfiguration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+            sessionConfiguration.protocolClasses = @[SDBenchmarkURLProtocol.class];
+            TXWebImageDownloaderConfig *config = [[TXWebImageDownloaderConfig alloc] init];
+            config.sessionConfiguration = sessionConfiguration;
+            config.maxConcurrentDownloads = concurrency.integerValue;
+            TXWebImageDownloader *downloader = [[TXWebImageDownloader alloc] initWithConfig:config];
+            
+            XCTestExpectation *expectation = [self expectationWithDescription:@"Downloader benchmark"];
+            TXImageCacheHistogram *latency = [TXImageCacheHistogram new];
+            __block NSUInteger failedCount = 0;
+            dispatch_group_t group = dispatch_group_create();
+            [self beginBenchmarkMemorySampling];
+            uint64_t startTime = [TXWebImageTimeline currentTime];
+            for (NSUInteger i = 0; i < operations; i++) {
+                // Different URLs, so the downloads are not coalesced
+                NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://%@/%lu/%@", kBenchmarkHost, (unsigned long)i, fileName]];
+                uint64_t requestStartTime = [TXWebImageTimeline currentTime];
+                dispatch_group_enter(group);
+                [downloader downloadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+                    [latency recordValue:[TXWebImageTimeline currentTime] - requestStartTime];
+                    if (!image) {
+                        @synchronized (latency) {
+                            failedCount++;
+                        }
+                    }
+                    dispatch_group_leave(group);
+                }];
+            }
+            dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+                [expectation fulfill];
+            });
+            [self waitForExpectationsWithTimeout:120 handler:nil];
+            uint64_t duration = [TXWebImageTimeline currentTime] - startTime;
+            
+            NSDictionary *parameters = @{@"file" : fileName,
+                                         @"bytes" : @(kBenchmarkResponseData.length),
+                                         @"failed" : @(failedCount)};
+            [self reportBenchmarkScenario:@"downloader.download" parameters:parameters operations:operations threads:concurrency.unsignedIntegerValue duration:duration latency:latency];
+            expect(failedCount).equal(0);
+            [downloader invalidateSessionAndCancel:YES];
+        }
+    }
+}
+
 @end
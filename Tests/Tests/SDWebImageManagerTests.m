@@ -417,6 +417,247 @@
     [self waitForExpectationsWithTimeout:kAsyncTestTimeout * 10 handler:nil];
 }
 
+- (void)test17ThatTimelineObserverReceivesStages {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Timeline observer receives the stages of download and cache hit"];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/104x104.jpg"];
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:cache loader:TXWebImageDownloader.sharedDownloader];
+    // No timeline without observer
+    SDWebImageCombinedOperation *operation = [manager loadImageWithURL:nil options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {}];
+    expect(operation.timeline).beNil();
+    
+    TXWebImageTraceExporter *exporter = [TXWebImageTraceExporter new];
+    manager.timelineObserver = exporter;
+    [manager loadImageWithURL:url options:SDWebImageWaitStoreCache progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(image).notTo.beNil();
+        TXWebImageTimeline *timeline = exporter.timelines.lastObject;
+        expect(timeline.isFinished).beTruthy();
+        expect(timeline.url).equal(url);
+        expect(timeline.cacheType).equal(TXImageCacheTypeNone);
+        expect(timeline.dataLength).equal(data.length);
+        expect(timeline.decodedPixels).equal(104 * 104);
+        expect(timeline.coderName).notTo.beNil();
+        expect([timeline durationForStage:SDWebImageTimelineStageMemoryQuery]).beGreaterThan(0);
+        expect([timeline durationForStage:SDWebImageTimelineStageDownload]).beGreaterThan(0);
+        expect([timeline durationForStage:SDWebImageTimelineStageDecode]).beGreaterThan(0);
+        expect([timeline endTimeForStage:SDWebImageTimelineStageStore]).beGreaterThanOrEqualTo([timeline endTimeForStage:SDWebImageTimelineStageLoad]);
+        expect(timeline.endTime).beGreaterThanOrEqualTo([timeline endTimeForStage:SDWebImageTimelineStageStore]);
+        
+        [manager loadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image2, NSData * _Nullable data2, NSError * _Nullable error2, TXImageCacheType cacheType2, BOOL finished2, NSURL * _Nullable imageURL2) {
+            TXWebImageTimeline *hitTimeline = exporter.timelines.lastObject;
+            expect(exporter.timelines.count).equal(2);
+            expect(hitTimeline.cacheType).equal(TXImageCacheTypeMemory);
+            expect([hitTimeline startTimeForStage:SDWebImageTimelineStageLoad]).equal(0);
+            
+            NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[exporter traceEventJSONData] options:0 error:nil];
+            NSArray<NSDictionary *> *events = trace[@"traceEvents"];
+            NSArray<NSDictionary *> *downloadEvents = [events filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == %@", @"Download"]];
+            expect(downloadEvents.count).equal(1);
+            expect([downloadEvents.firstObject[@"dur"] doubleValue]).beGreaterThan(0);
+            [cache clearWithCacheType:TXImageCacheTypeAll completion:nil];
+            [expectation fulfill];
+        }];
+    }];
+    
+    [self waitForExpectationsWithTimeout:kAsyncTestTimeout * 2 handler:nil];
+}
+
+- (void)test18ThatIdenticalRequestsAreCoalesced {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Identical requests share one load, and cancel only detaches the caller"];
+    expectation.expectedFulfillmentCount = 3;
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/105x105.png"];
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:cache loader:TXWebImageDownloader.sharedDownloader];
+    SDWebImageTestTransformer *transformer = [[SDWebImageTestTransformer alloc] init];
+    transformer.testImage = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    SDWebImageContext *context = @{SDWebImageContextImageTransformer : transformer};
+    
+    SDWebImageCombinedOperation *operation1 = [manager loadImageWithURL:url options:0 context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(error.code).equal(TXWebImageErrorCancelled);
+        [expectation fulfill];
+    }];
+    SDWebImageCombinedOperation *operation2 = [manager loadImageWithURL:url options:0 context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(error).beNil();
+        expect(image).equal(transformer.testImage);
+        expect(imageURL).equal(url);
+        [expectation fulfill];
+    }];
+    // Different options do not coalesce
+    SDWebImageCombinedOperation *operation3 = [manager loadImageWithURL:url options:SDWebImageAvoidDecodeImage context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(image).notTo.beNil();
+        [expectation fulfill];
+    }];
+    expect(operation1).notTo.equal(operation2);
+    expect(operation1.cacheOperation).notTo.beNil();
+    expect(operation2.cacheOperation).equal(operation1.cacheOperation);
+    expect(operation3.cacheOperation).notTo.equal(operation1.cacheOperation);
+    // The shared load continues for the second caller
+    [operation1 cancel];
+    expect(operation1.cacheOperation).beNil();
+    expect(operation2.cacheOperation).notTo.beNil();
+    
+    [self waitForExpectationsWithTimeout:kAsyncTestTimeout * 2 handler:^(NSError * _Nullable error) {
+        [cache clearWithCacheType:TXImageCacheTypeAll completion:nil];
+    }];
+}
+
+- (void)test19ThatFailedURLCacheBacksOffAndExpires {
+    TXWebImageFailedURLCache *failedURLCache = [[TXWebImageFailedURLCache alloc] init];
+    failedURLCache.baseRetryInterval = 10;
+    failedURLCache.maxRetryInterval = 30;
+    failedURLCache.jitterFactor = 0;
+    failedURLCache.countLimit = 2;
+    NSURL *url1 = [NSURL URLWithString:@"http://via.placeholder.com/1x1.png"];
+    NSURL *url2 = [NSURL URLWithString:@"http://via.placeholder.com/2x2.png"];
+    NSURL *url3 = [NSURL URLWithString:@"http://via.placeholder.com/3x3.png"];
+    
+    // Exponential backoff, capped by max interval
+    [failedURLCache recordFailureForURL:url1 error:nil];
+    expect([failedURLCache isBlockedURL:url1]).beTruthy();
+    expect([failedURLCache retryIntervalForURL:url1]).beCloseToWithin(10, 1);
+    [failedURLCache recordFailureForURL:url1 error:nil];
+    expect([failedURLCache retryIntervalForURL:url1]).beCloseToWithin(20, 1);
+    [failedURLCache recordFailureForURL:url1 error:nil];
+    expect([failedURLCache retryIntervalForURL:url1]).beCloseToWithin(30, 1);
+    expect([failedURLCache failureCountForURL:url1]).equal(3);
+    
+    // Retry-After header, both delay seconds and HTTP date
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url2 statusCode:503 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Retry-After" : @"5"}];
+    NSError *error = [NSError errorWithDomain:TXWebImageErrorDomain code:TXWebImageErrorInvalidDownloadStatusCode userInfo:@{TXWebImageErrorDownloadStatusCodeKey : @(503), TXWebImageErrorDownloadResponseKey : response}];
+    expect([TXWebImageDownloader.sharedDownloader shouldBlockFailedURLWithURL:url2 error:error options:0 context:nil]).beTruthy();
+    [failedURLCache recordFailureForURL:url2 error:error];
+    expect([failedURLCache retryIntervalForURL:url2]).beCloseToWithin(5, 1);
+    NSHTTPURLResponse *dateResponse = [[NSHTTPURLResponse alloc] initWithURL:url2 statusCode:429 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Retry-After" : @"Wed, 21 Oct 2015 07:28:00 GMT"}];
+    expect([TXWebImageFailedURLCache retryAfterIntervalForResponse:dateResponse]).equal(0);
+    expect([TXWebImageFailedURLCache retryAfterIntervalForResponse:nil]).equal(-1);
+    
+    // The least recently failed one is removed when exceeding the count limit
+    [failedURLCache recordFailureForURL:url3 error:nil];
+    expect(failedURLCache.count).equal(2);
+    expect([failedURLCache isBlockedURL:url1]).beFalsy();
+    expect([failedURLCache failureCountForURL:url1]).equal(0);
+    expect([failedURLCache isBlockedURL:url3]).beTruthy();
+    
+    // Expired entry can retry, but keeps the failure count for the next backoff
+    failedURLCache.maxRetryInterval = 0;
+    [failedURLCache recordFailureForURL:url3 error:nil];
+    expect([failedURLCache isBlockedURL:url3]).beFalsy();
+    expect([failedURLCache failureCountForURL:url3]).equal(2);
+    [failedURLCache removeURL:url3];
+    expect([failedURLCache failureCountForURL:url3]).equal(0);
+}
+
+- (void)test20ThatImageCacheKeyIsInternedAndMatchesString {
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:[TXImageCache sharedImageCache] loader:TXWebImageDownloader.sharedDownloader];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/106x106.png?size=1"];
+    SDImageRotationTransformer *transformer = [SDImageRotationTransformer transformerWithAngle:M_PI_4 fitSize:YES];
+    SDWebImageContext *context = @{SDWebImageContextImageTransformer : transformer,
+                                   SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(50, 50)),
+                                   SDWebImageContextImagePreserveAspectRatio : @NO};
+    TXWebImageCacheKey *cacheKey = [manager imageCacheKeyForURL:url context:context];
+    // The same string as the legacy key functions
+    NSString *expectedKey = SDTransformedKeyForKey(SDThumbnailedKeyForKey(url.absoluteString, CGSizeMake(50, 50), NO), transformer.transformerKey);
+    expect(cacheKey.stringValue).equal(expectedKey);
+    expect([manager cacheKeyForURL:url context:context]).equal(expectedKey);
+    expect(cacheKey.originalKey.stringValue).equal(SDThumbnailedKeyForKey(url.absoluteString, CGSizeMake(50, 50), NO));
+    expect(cacheKey.diskFileName).equal(TXDiskCacheFileNameForKey(expectedKey));
+    // Interned
+    SDImageRotationTransformer *sameTransformer = [SDImageRotationTransformer transformerWithAngle:M_PI_4 fitSize:YES];
+    TXWebImageCacheKey *sameKey = [manager imageCacheKeyForURL:url context:@{SDWebImageContextImageTransformer : sameTransformer,
+                                                                             SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(50, 50)),
+                                                                             SDWebImageContextImagePreserveAspectRatio : @NO}];
+    expect(sameKey == cacheKey).beTruthy();
+    // Different components
+    TXWebImageCacheKey *otherKey = [manager imageCacheKeyForURL:url context:@{SDWebImageContextImageTransformer : transformer}];
+    expect(otherKey).notTo.equal(cacheKey);
+    expect(otherKey.hash64).notTo.equal(cacheKey.hash64);
+    expect([manager imageCacheKeyForURL:nil context:nil]).beNil();
+}
+
+- (void)test21CacheKeyBenchmark {
+    if (!SDTestCase.isBenchmarkEnabled) {
+        return;
+    }
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:[TXImageCache sharedImageCache] loader:TXWebImageDownloader.sharedDownloader];
+    SDImagePipelineTransformer *transformer = [SDImagePipelineTransformer transformerWithTransformers:@[
+        [SDImageResizingTransformer transformerWithSize:CGSizeMake(100, 100) scaleMode:SDImageScaleModeAspectFill],
+        [SDImageFlippingTransformer transformerWithHorizontal:YES vertical:NO]]];
+    SDWebImageContext *context = @{SDWebImageContextImageTransformer : transformer,
+                                   SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(200, 200))};
+    // The same URLs are loaded again and again, like the cells in a list
+    NSUInteger urlCount = 1000;
+    NSMutableArray<NSURL *> *urls = [NSMutableArray arrayWithCapacity:urlCount];
+    for (NSUInteger i = 0; i < urlCount; i++) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"https://cdn.sdwebimage.test/images/%lu.jpg?quality=80", (unsigned long)i]]];
+    }
+    NSDictionary *parameters = @{@"urls" : @(urlCount), @"thumbnail" : @YES, @"transformers" : @(transformer.transformers.count)};
+    NSUInteger iterations = 100000;
+    for (NSNumber *threads in @[@1, @4]) {
+        // The key string, the original key string and the disk file name, computed as before for each request
+        [self benchmarkScenario:@"cacheKey.string" parameters:parameters iterations:iterations threads:threads.unsignedIntegerValue block:^(NSUInteger index) {
+            NSURL *url = urls[index % urlCount];
+            NSString *originalKey = SDThumbnailedKeyForKey(url.absoluteString, CGSizeMake(200, 200), YES);
+            NSString *key = SDTransformedKeyForKey(originalKey, transformer.transformerKey);
+            __unused NSString *fileName = TXDiskCacheFileNameForKey(key);
+        }];
+        [self benchmarkScenario:@"cacheKey.interned" parameters:parameters iterations:iterations threads:threads.unsignedIntegerValue block:^(NSUInteger index) {
+            NSURL *url = urls[index % urlCount];
+            TXWebImageCacheKey *cacheKey = [manager imageCacheKeyForURL:url context:context];
+            __unused NSString *originalKey = cacheKey.originalKey.stringValue;
+            __unused NSString *fileName = cacheKey.diskFileName;
+        }];
+    }
+}
+
+- (void)test22ThatNilCacheKeyIsNotCoalesced {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The cache key filter returns nil does not coalesce"];
+    expectation.expectedFulfillmentCount = 2;
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/106x106.png"];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:[[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString] loader:TXWebImageDownloader.sharedDownloader];
+    manager.cacheKeyFilter = [TXWebImageCacheKeyFilter cacheKeyFilterWithBlock:^NSString * _Nullable(NSURL * _Nonnull imageURL) {
+        return nil;
+    }];
+    expect(manager.shouldCoalesceRequests).beTruthy();
+    for (NSUInteger i = 0; i < 2; i++) {
+        [manager loadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+            expect(image).notTo.beNil();
+            expect(cacheType).equal(TXImageCacheTypeNone);
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test23ThatTransformedAnimatedImageIsNotEncodedToDisk {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The lazily transformed animated image is rebuilt from the original data"];
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:cache loader:TXWebImageDownloader.sharedDownloader];
+    manager.transformer = [SDImageFlippingTransformer transformerWithHorizontal:YES vertical:NO];
+    SDWebImageContext *context = @{SDWebImageContextAnimatedImageClass : TXAnimatedImage.class};
+    NSURL *url = [NSURL URLWithString:kTestGIFURL];
+    NSString *originalKey = [manager cacheKeyForURL:url];
+    NSString *transformedKey = [manager cacheKeyForURL:url context:context];
+    
+    [manager loadImageWithURL:url options:SDWebImageTransformAnimatedImage | SDWebImageWaitStoreCache context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(image).beKindOf(TXTransformedAnimatedImage.class);
+        expect(image.sd_memoryCost).beGreaterThan(data.length);
+        // The transformed frames are not encoded, only the original data is on disk
+        expect([cache diskImageDataExistsWithKey:originalKey]).beTruthy();
+        expect([cache diskImageDataExistsWithKey:transformedKey]).beFalsy();
+        expect([cache imageFromMemoryCacheForKey:transformedKey]).equal(image);
+        [cache clearMemory];
+        [manager loadImageWithURL:url options:SDWebImageTransformAnimatedImage context:context progress:nil completed:^(UIImage * _Nullable image2, NSData * _Nullable data2, NSError * _Nullable error2, TXImageCacheType cacheType2, BOOL finished2, NSURL * _Nullable imageURL2) {
+            expect(image2).beKindOf(TXTransformedAnimatedImage.class);
+            expect(image2.sd_imageFrameCount).equal(image.sd_imageFrameCount);
+            [cache clearDiskOnCompletion:nil];
+            [expectation fulfill];
+        }];
+    }];
+    
+    [self waitForExpectationsWithTimeout:kAsyncTestTimeout * 2 handler:nil];
+}
+
 - (NSString *)testJPEGPath {
     NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
     return [testBundle pathForResource:@"TestImage" ofType:@"jpg"];
@@ -9,6 +9,193 @@
 
 #import "SDTestCase.h"
 
+// A fake load operation for the scroll trace simulation
+@interface SDWebImagePrefetchTraceOperation : NSObject <TXWebImageOperation>
+
+@property (atomic, assign, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, copy) dispatch_block_t cancelBlock;
+
+@end
+
+@implementation SDWebImagePrefetchTraceOperation
+
+- (void)cancel {
+    self.cancelled = YES;
+    if (self.cancelBlock) {
+        self.cancelBlock();
+    }
+}
+
+@end
+
+// A fake loader for the scroll trace simulation, each image is loaded after the latency without network, and the bytes are counted
+@interface SDWebImagePrefetchTraceLoader : NSObject <TXImageLoader>
+
+@property (nonatomic, assign) NSTimeInterval latency;
+@property (nonatomic, assign) NSUInteger bytesPerImage;
+@property (nonatomic, strong) NSMutableArray<NSURL *> *requestedURLs;
+@property (nonatomic, strong) NSMutableDictionary<NSURL *, NSNumber *> *requestedOptions;
+@property (nonatomic, strong) NSMutableSet<NSURL *> *loadedURLs;
+@property (nonatomic, assign) NSUInteger cancelledCount;
+@property (nonatomic, assign) double cancelledBytes;
+@property (nonatomic, strong) NSData *imageData;
+@property (nonatomic, assign) NSUInteger dataOnlyCount;
+
+@end
+
+@implementation SDWebImagePrefetchTraceLoader
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _latency = 0.05;
+        _bytesPerImage = 100 * 1024;
+        _requestedURLs = [NSMutableArray array];
+        _requestedOptions = [NSMutableDictionary dictionary];
+        _loadedURLs = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (BOOL)isLoadedURL:(NSURL *)url {
+    @synchronized (self) {
+        return [self.loadedURLs containsObject:url];
+    }
+}
+
+- (BOOL)canRequestImageForURL:(NSURL *)url {
+    return YES;
+}
+
+- (id<TXWebImageOperation>)requestImageWithURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context progress:(TXImageLoaderProgressBlock)progressBlock completed:(TXImageLoaderCompletedBlock)completedBlock {
+    SDWebImagePrefetchTraceOperation *operation = [SDWebImagePrefetchTraceOperation new];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    __weak typeof(self) wself = self;
+    operation.cancelBlock = ^{
+        // The partially transferred bytes are wasted as well
+        double progress = MIN((CFAbsoluteTimeGetCurrent() - startTime) / wself.latency, 1);
+        @synchronized (wself) {
+            wself.cancelledCount++;
+            wself.cancelledBytes += wself.bytesPerImage * progress;
+        }
+    };
+    @synchronized (self) {
+        [self.requestedURLs addObject:url];
+        self.requestedOptions[url] = @(options);
+        if ([context[SDWebImageContextDownloadDataOnly] boolValue]) {
+            self.dataOnlyCount++;
+        }
+    }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.latency * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        if (operation.isCancelled) {
+            if (completedBlock) {
+                completedBlock(nil, nil, [NSError errorWithDomain:TXWebImageErrorDomain code:TXWebImageErrorCancelled userInfo:nil], YES);
+            }
+            return;
+        }
+        @synchronized (self) {
+            [self.loadedURLs addObject:url];
+        }
+        if (completedBlock) {
+            NSData *imageData = self.imageData;
+            if ([context[SDWebImageContextDownloadDataOnly] boolValue]) {
+                completedBlock(nil, imageData, nil, YES);
+            } else {
+                completedBlock(imageData ? [UIImage imageWithData:imageData] : [[UIImage alloc] init], imageData, nil, YES);
+            }
+        }
+    });
+    return operation;
+}
+
+- (BOOL)shouldBlockFailedURLWithURL:(NSURL *)url error:(NSError *)error {
+    return NO;
+}
+
+@end
+
+// Replay a scroll trace on a list, and report the wasted bytes (loaded but never shown) and the hit rate (already loaded when shown)
+@interface SDWebImagePrefetchTraceSimulator : NSObject
+
+@property (nonatomic, assign) NSUInteger itemCount;
+@property (nonatomic, assign) CGFloat itemLength;
+@property (nonatomic, assign) CGFloat viewportLength;
+@property (nonatomic, assign) NSTimeInterval interval;
+
+- (void)replayOffsets:(NSArray<NSNumber *> *)offsets viewportAware:(BOOL)viewportAware completion:(void (^)(NSUInteger wastedBytes, double hitRate))completion;
+
+@end
+
+@implementation SDWebImagePrefetchTraceSimulator
+
+- (void)replayOffsets:(NSArray<NSNumber *> *)offsets viewportAware:(BOOL)viewportAware completion:(void (^)(NSUInteger, double))completion {
+    SDWebImagePrefetchTraceLoader *loader = [SDWebImagePrefetchTraceLoader new];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:TXImageCache.sharedImageCache loader:loader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    prefetcher.options = SDWebImageLowPriority | SDWebImageFromLoaderOnly;
+    prefetcher.context = @{SDWebImageContextStoreCacheType : @(TXImageCacheTypeNone), SDWebImageContextOriginalStoreCacheType : @(TXImageCacheTypeNone)};
+    
+    NSString *prefix = [NSUUID UUID].UUIDString;
+    NSMutableArray<NSURL *> *urls = [NSMutableArray arrayWithCapacity:self.itemCount];
+    NSMutableArray<SDWebImagePrefetchItem *> *items = [NSMutableArray arrayWithCapacity:self.itemCount];
+    for (NSUInteger i = 0; i < self.itemCount; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://trace.test/%@/%lu.jpg", prefix, (unsigned long)i]];
+        [urls addObject:url];
+        [items addObject:[SDWebImagePrefetchItem itemWithURL:url position:i * self.itemLength length:self.itemLength]];
+    }
+    SDWebImagePrefetchToken *token;
+    if (viewportAware) {
+        [prefetcher updateViewportWithOffset:offsets.firstObject.doubleValue length:self.viewportLength velocity:0];
+        token = [prefetcher prefetchItems:items progress:nil completed:nil];
+    } else {
+        token = [prefetcher prefetchURLs:urls];
+    }
+    
+    NSMutableSet<NSURL *> *shownURLs = [NSMutableSet set];
+    __block NSUInteger hitCount = 0;
+    __block NSUInteger step = 0;
+    __block CGFloat previousOffset = offsets.firstObject.doubleValue;
+    __block void (^replayBlock)(void);
+    replayBlock = ^{
+        if (step >= offsets.count) {
+            replayBlock = nil;
+            [prefetcher cancelPrefetching];
+            NSUInteger wastedBytes = (NSUInteger)loader.cancelledBytes;
+            @synchronized (loader) {
+                for (NSURL *url in loader.loadedURLs) {
+                    if (![shownURLs containsObject:url]) {
+                        wastedBytes += loader.bytesPerImage;
+                    }
+                }
+            }
+            completion(wastedBytes, shownURLs.count > 0 ? (double)hitCount / shownURLs.count : 0);
+            return;
+        }
+        CGFloat offset = offsets[step].doubleValue;
+        if (viewportAware) {
+            [prefetcher updateViewportWithOffset:offset length:self.viewportLength velocity:(offset - previousOffset) / self.interval];
+        }
+        NSInteger firstIndex = MAX((NSInteger)floor(offset / self.itemLength), 0);
+        NSInteger lastIndex = MIN((NSInteger)ceil((offset + self.viewportLength) / self.itemLength), (NSInteger)self.itemCount) - 1;
+        for (NSInteger i = firstIndex; i <= lastIndex; i++) {
+            NSURL *url = urls[i];
+            if (![shownURLs containsObject:url]) {
+                [shownURLs addObject:url];
+                if ([loader isLoadedURL:url]) {
+                    hitCount++;
+                }
+            }
+        }
+        previousOffset = offset;
+        step++;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.interval * NSEC_PER_SEC)), dispatch_get_main_queue(), replayBlock);
+    };
+    replayBlock();
+    (void)token;
+}
+
+@end
+
 @interface TXWebImagePrefetcher ()
 
 @property (strong, atomic, nonnull) NSMutableSet<SDWebImagePrefetchToken *> *runningTokens;
@@ -176,6 +363,253 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)test08PrefetchItemsByViewportDistance {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prefetch items by the distance to viewport"];
+    SDWebImagePrefetchTraceLoader *loader = [SDWebImagePrefetchTraceLoader new];
+    loader.latency = 10; // never finish during test
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:TXImageCache.sharedImageCache loader:loader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    prefetcher.maxConcurrentPrefetchCount = 1;
+    prefetcher.options = SDWebImageLowPriority | SDWebImageFromLoaderOnly;
+    NSMutableArray<SDWebImagePrefetchItem *> *items = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 10; i++) {
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://viewport.test/%lu.jpg", (unsigned long)i]];
+        [items addObject:[SDWebImagePrefetchItem itemWithURL:url position:i * 100 length:100]];
+    }
+    __block NSUInteger progressFinishedCount = 0;
+    SDWebImagePrefetchToken *token = [prefetcher prefetchItems:items progress:^(NSUInteger noOfFinishedUrls, NSUInteger noOfTotalUrls) {
+        progressFinishedCount = noOfFinishedUrls;
+    } completed:nil];
+    expect(token.items).equal(items);
+    
+    // Viewport is [500, 600], the prefetch window is 200 on each side
+    [prefetcher updateViewportWithOffset:500 length:100 velocity:0];
+    expect(items[5].distance).equal(0);
+    expect(items[3].distance).equal(100);
+    expect(items[7].distance).equal(100);
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, kMinDelayNanosecond), dispatch_get_main_queue(), ^{
+        // The first item is started before viewport, then dropped. The visible one is promoted. Then the nearest one.
+        NSArray<NSURL *> *requestedURLs = @[items[0].url, items[5].url, items[4].url];
+        expect(loader.requestedURLs).equal(requestedURLs);
+        expect(loader.cancelledCount).equal(1);
+        SDWebImageOptions promotedOptions = loader.requestedOptions[items[5].url].unsignedIntegerValue;
+        expect(promotedOptions & SDWebImageLowPriority).equal(0);
+        expect(promotedOptions & SDWebImageHighPriority).notTo.equal(0);
+        // Item 0, 1, 9 are dropped
+        expect(progressFinishedCount).equal(3);
+        
+        // Scroll down fast, the items above are dropped, the items below are ranked first
+        [prefetcher updateViewportWithOffset:550 length:100 velocity:1000];
+        expect(items[8].distance).beLessThan(items[2].distance);
+        [token cancel];
+        expect(prefetcher.runningTokens.count).equal(0);
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test09PrefetchScrollTraceSimulation {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Replay scroll trace for viewport prefetching"];
+    SDWebImagePrefetchTraceSimulator *simulator = [SDWebImagePrefetchTraceSimulator new];
+    simulator.itemCount = 300;
+    simulator.itemLength = 100;
+    simulator.viewportLength = 600;
+    simulator.interval = 1.0 / 30;
+    // Restore the scroll position in the middle of the list, scroll down at 2400 points per second for 1 second, pause, then fling back up
+    NSMutableArray<NSNumber *> *offsets = [NSMutableArray array];
+    CGFloat offset = 12000;
+    [offsets addObject:@(offset)];
+    for (NSUInteger i = 0; i < 30; i++) {
+        offset += 80;
+        [offsets addObject:@(offset)];
+    }
+    for (NSUInteger i = 0; i < 10; i++) {
+        [offsets addObject:@(offset)];
+    }
+    for (NSUInteger i = 0; i < 15; i++) {
+        offset -= 100;
+        [offsets addObject:@(offset)];
+    }
+    
+    [simulator replayOffsets:offsets viewportAware:NO completion:^(NSUInteger listWastedBytes, double listHitRate) {
+        [simulator replayOffsets:offsets viewportAware:YES completion:^(NSUInteger viewportWastedBytes, double viewportHitRate) {
+            // The list order spends the bandwidth on the items above the restored position, which are never shown
+            expect(viewportHitRate).beGreaterThan(listHitRate);
+            expect(viewportWastedBytes).beLessThan(listWastedBytes);
+            [expectation fulfill];
+        }];
+    }];
+    
+    [self waitForExpectationsWithTimeout:kAsyncTestTimeout * 2 handler:nil];
+}
+
+- (void)test10PrefetchDiskOnlyWithByteBudget {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Disk only prefetching stops at the byte budget and counts the later hit"];
+    NSData *imageData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    SDWebImagePrefetchTraceLoader *loader = [SDWebImagePrefetchTraceLoader new];
+    loader.imageData = imageData;
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:cache loader:loader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    prefetcher.mode = SDWebImagePrefetchModeDiskOnly;
+    prefetcher.maxConcurrentPrefetchCount = 1;
+    prefetcher.maxBytesPerToken = imageData.length * 2;
+    
+    NSString *prefix = [NSUUID UUID].UUIDString;
+    NSMutableArray<NSURL *> *urls = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 5; i++) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"https://disk.test/%@/%lu.jpg", prefix, (unsigned long)i]]];
+    }
+    __block SDWebImagePrefetchToken *token = [prefetcher prefetchURLs:urls progress:nil completed:^(NSUInteger noOfFinishedUrls, NSUInteger noOfSkippedUrls) {
+        expect(noOfFinishedUrls).equal(5);
+        expect(noOfSkippedUrls).equal(3);
+        expect(token.receivedBytes).equal(imageData.length * 2);
+        expect(loader.dataOnlyCount).equal(2);
+        expect(prefetcher.prefetchedCount).equal(2);
+        NSString *key = [manager cacheKeyForURL:urls.firstObject];
+        expect([cache diskImageDataExistsWithKey:key]).beTruthy();
+        expect([cache imageFromMemoryCacheForKey:key]).beNil();
+        expect([cache diskImageDataExistsWithKey:[manager cacheKeyForURL:urls.lastObject]]).beFalsy();
+        // Load from disk cache later, which is a hit of the prefetched entry
+        [manager loadImageWithURL:urls.firstObject options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+            expect(image).notTo.beNil();
+            expect(cacheType).equal(TXImageCacheTypeDisk);
+            expect(prefetcher.laterHitCount).equal(1);
+            [cache clearDiskOnCompletion:nil];
+            [expectation fulfill];
+        }];
+    }];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test11AdaptiveConcurrencyYieldsToForegroundDownloads {
+    TXWebImageDownloader *downloader = [[TXWebImageDownloader alloc] initWithConfig:nil];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:TXImageCache.sharedImageCache loader:downloader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    prefetcher.maxConcurrentPrefetchCount = 3;
+    expect(prefetcher.currentConcurrentPrefetchCount).equal(3);
+    
+    // A foreground download waiting in the queue
+    downloader.suspended = YES;
+    SDWebImageDownloadToken *downloadToken = [downloader downloadImageWithURL:[NSURL URLWithString:kTestJPEGURL] completed:nil];
+    expect(downloader.pendingForegroundDownloadCount).equal(1);
+    prefetcher.adaptiveConcurrency = YES;
+    expect(prefetcher.currentConcurrentPrefetchCount).equal(1);
+    
+    // The downloader is idle
+    [downloadToken cancel];
+    expect(downloader.currentForegroundDownloadCount).equal(0);
+    prefetcher.maxConcurrentPrefetchCount = 3;
+    expect(prefetcher.currentConcurrentPrefetchCount).equal(downloader.config.maxConcurrentDownloads);
+    
+    prefetcher.adaptiveConcurrency = NO;
+    expect(prefetcher.currentConcurrentPrefetchCount).equal(3);
+    [downloader invalidateSessionAndCancel:YES];
+}
+
+- (void)test12PrefetchByteBudgets {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Prefetching stops at the total byte budget and pauses at the byte rate budget"];
+    SDWebImagePrefetchTraceLoader *loader = [SDWebImagePrefetchTraceLoader new];
+    loader.imageData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    NSUInteger bytesPerImage = loader.imageData.length;
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:TXImageCache.sharedImageCache loader:loader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    prefetcher.maxConcurrentPrefetchCount = 1;
+    prefetcher.context = @{SDWebImageContextStoreCacheType : @(TXImageCacheTypeNone), SDWebImageContextOriginalStoreCacheType : @(TXImageCacheTypeNone)};
+    prefetcher.options = SDWebImageFromLoaderOnly;
+    prefetcher.maxTotalBytes = bytesPerImage * 2;
+    
+    NSString *prefix = [NSUUID UUID].UUIDString;
+    NSMutableArray<NSURL *> *urls = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 4; i++) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"https://budget.test/%@/%lu.jpg", prefix, (unsigned long)i]]];
+    }
+    [prefetcher prefetchURLs:urls progress:nil completed:^(NSUInteger noOfFinishedUrls, NSUInteger noOfSkippedUrls) {
+        expect(noOfSkippedUrls).equal(2);
+        expect(prefetcher.receivedBytes).equal(bytesPerImage * 2);
+        expect(prefetcher.byteBudgetUtilization).beGreaterThanOrEqualTo(1);
+        
+        // Restart with the rate budget of one image per minute
+        prefetcher.maxTotalBytes = 0;
+        prefetcher.maxBytesPerMinute = bytesPerImage;
+        [prefetcher resetReceivedBytes];
+        expect(prefetcher.currentConcurrentPrefetchCount).equal(1);
+        [prefetcher prefetchURLs:urls progress:^(NSUInteger noOfFinishedUrls, NSUInteger noOfTotalUrls) {
+            if (noOfFinishedUrls != 1) {
+                return;
+            }
+            expect(prefetcher.receivedBytesInLastMinute).equal(bytesPerImage);
+            expect(prefetcher.currentConcurrentPrefetchCount).equal(0);
+            [prefetcher cancelPrefetching];
+            expect(loader.requestedURLs.count).equal(2 + 1);
+            [expectation fulfill];
+        } completed:nil];
+    }];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test13PrefetchingAgainIsNotLaterHit {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The prefetcher's own cache hit is not counted as the later hit"];
+    SDWebImagePrefetchTraceLoader *loader = [SDWebImagePrefetchTraceLoader new];
+    loader.imageData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:cache loader:loader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://hit.test/%@.jpg", [NSUUID UUID].UUIDString]];
+    
+    [prefetcher prefetchURLs:@[url] progress:nil completed:^(NSUInteger noOfFinishedUrls, NSUInteger noOfSkippedUrls) {
+        expect(prefetcher.prefetchedCount).equal(1);
+        // Prefetch again, which is from cache
+        [prefetcher prefetchURLs:@[url] progress:nil completed:^(NSUInteger noOfFinishedUrls2, NSUInteger noOfSkippedUrls2) {
+            expect(loader.requestedURLs.count).equal(1);
+            expect(prefetcher.laterHitCount).equal(0);
+            // The load of the view is the later hit
+            [manager loadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, TXImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+                expect(cacheType).notTo.equal(TXImageCacheTypeNone);
+                expect(prefetcher.laterHitCount).equal(1);
+                [cache clearDiskOnCompletion:nil];
+                [expectation fulfill];
+            }];
+        }];
+    }];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test14CancelDiskOnlyPrefetchingDuringDownload {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Cancel the token cancels the disk only download"];
+    SDWebImagePrefetchTraceLoader *loader = [SDWebImagePrefetchTraceLoader new];
+    loader.imageData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    loader.latency = 0.5;
+    TXImageCache *cache = [[TXImageCache alloc] initWithNamespace:[NSUUID UUID].UUIDString];
+    TXWebImageManager *manager = [[TXWebImageManager alloc] initWithCache:cache loader:loader];
+    TXWebImagePrefetcher *prefetcher = [[TXWebImagePrefetcher alloc] initWithImageManager:manager];
+    prefetcher.mode = SDWebImagePrefetchModeDiskOnly;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"https://cancel.test/%@.jpg", [NSUUID UUID].UUIDString]];
+    
+    SDWebImagePrefetchToken *token = [prefetcher prefetchURLs:@[url] progress:nil completed:^(NSUInteger noOfFinishedUrls, NSUInteger noOfSkippedUrls) {
+        expect(noOfSkippedUrls).equal(1);
+    }];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.2 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        expect(loader.requestedURLs.count).equal(1);
+        [token cancel];
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            expect(loader.cancelledCount).equal(1);
+            expect([loader isLoadedURL:url]).beFalsy();
+            expect([cache diskImageDataExistsWithKey:[manager cacheKeyForURL:url]]).beFalsy();
+            expect(prefetcher.prefetchedCount).equal(0);
+            [cache clearDiskOnCompletion:nil];
+            [expectation fulfill];
+        });
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
 - (void)imagePrefetcher:(TXWebImagePrefetcher *)imagePrefetcher didFinishWithTotalCount:(NSUInteger)totalCount skippedCount:(NSUInteger)skippedCount {
     expect(imagePrefetcher).to.equal(self.prefetcher);
     self.skippedCount = skippedCount;
@@ -18,6 +18,8 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 // In this header, you should import all the public headers of your framework using statements like #import <SDWebImage/PublicHeader.h>
 
 #import <SDWebImage/TXWebImageManager.h>
+#import <SDWebImage/TXWebImageFailedURLCache.h>
+#import <SDWebImage/TXWebImageCacheKey.h>
 #import <SDWebImage/TXWebImageCacheKeyFilter.h>
 #import <SDWebImage/TXWebImageCacheSerializer.h>
 #import <SDWebImage/TXImageCacheConfig.h>
@@ -26,6 +28,7 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/TXDiskCache.h>
 #import <SDWebImage/TXImageCacheDefine.h>
 #import <SDWebImage/TXImageCachesManager.h>
+#import <SDWebImage/TXImageCacheStatistics.h>
 #import <SDWebImage/UIView+WebCache.h>
 #import <SDWebImage/UIImageView+WebCache.h>
 #import <SDWebImage/UIImageView+HighlightedWebCache.h>
@@ -48,13 +51,16 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/TXWebImageTransition.h>
 #import <SDWebImage/TXWebImageIndicator.h>
 #import <SDWebImage/TXImageTransformer.h>
+#import <SDWebImage/TXImageTransformPrefixCache.h>
 #import <SDWebImage/UIImage+Transform.h>
 #import <SDWebImage/TXAnimatedImage.h>
+#import <SDWebImage/TXTransformedAnimatedImage.h>
 #import <SDWebImage/TXAnimatedImageView.h>
 #import <SDWebImage/TXAnimatedImageView+WebCache.h>
 #import <SDWebImage/TXAnimatedImagePlayer.h>
 #import <SDWebImage/TXImageCodersManager.h>
 #import <SDWebImage/TXImageCoder.h>
+#import <SDWebImage/TXImageDecodeOptions.h>
 #import <SDWebImage/TXImageAPNGCoder.h>
 #import <SDWebImage/TXImageGIFCoder.h>
 #import <SDWebImage/TXImageIOCoder.h>
@@ -68,6 +74,7 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/TXWebImageDefine.h>
 #import <SDWebImage/TXWebImageError.h>
 #import <SDWebImage/TXWebImageOptionsProcessor.h>
+#import <SDWebImage/TXWebImageTimeline.h>
 #import <SDWebImage/TXImageIOAnimatedCoder.h>
 #import <SDWebImage/TXImageHEICCoder.h>
 #import <SDWebImage/TXImageAWebPCoder.h>